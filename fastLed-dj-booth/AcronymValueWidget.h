@@ -2,18 +2,19 @@
 #include "Widget.h"
 #include "WidgetColorTheme.h"
 #include "ThemeManager.h"
+#include "FrameLog.h"
 
 class AcronymValueWidget : public Widget {
 private:
-    String acronym;
+    const char* acronym;
     int value;
     const WidgetColorTheme& theme;
 public:
-    AcronymValueWidget(const String& acr, int val, const WidgetColorTheme& themeRef = ThemeManager::get())
+    AcronymValueWidget(const char* acr, int val, const WidgetColorTheme& themeRef = ThemeManager::get())
         : acronym(acr), value(val), theme(themeRef) {}
     void draw(TFT_eSPI& tft, int x, int y, int width, int height) override {
-        Serial.printf("[AcronymValueWidget] draw: %s=%d at (%d,%d,%d,%d)\n", acronym.c_str(), value, x, y, width, height);
-        if (acronym.length() == 0) {
+        FRAME_LOG("[AcronymValueWidget] draw: %s=%d at (%d,%d,%d,%d)\n", acronym, value, x, y, width, height);
+        if (!acronym || !acronym[0]) {
             Serial.println("[AcronymValueWidget] ERROR: acronym is empty!");
             return;
         }
@@ -21,7 +22,7 @@ public:
         tft.setTextSize(2);
         tft.setTextColor(theme.text, theme.background);
         tft.setCursor(x, y);
-        tft.printf("%s: %d", acronym.c_str(), value);
+        tft.printf("%s: %d", acronym, value);
     }
     int getMinWidth() const override { return 80; }
     int getMinHeight() const override { return 20; }
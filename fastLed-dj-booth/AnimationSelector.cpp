@@ -0,0 +1,123 @@
+#include "AnimationSelector.h"
+#include "config.h"
+
+// Frame counts assume the ~8 fps main loop
+AnimationSelector::AnimationSelector()
+    : energyFast(1.0f / 8), energyMid(1.0f / 32), energySlow(1.0f / 240),
+      energyPeak(0.998f), bassFast(1.0f / 4), bassSlow(1.0f / 64),
+      highFlux(1.0f / 16), highFluxSlow(1.0f / 128), bassFlux(1.0f / 3),
+      prevBass(0), prevMid(0), prevTreble(0), framesSinceBuildUp(1000),
+      buildUp(false), drop(false), lastBpm(0), recentPos(0), lastReason("Init") {
+    for (int i = 0; i < RECENT_COUNT; i++) recent[i] = -1;
+}
+
+void AnimationSelector::observe(const AudioFeatures& features) {
+    float volume = features.volume;
+    energyFast.update(volume);
+    energyMid.update(volume);
+    energySlow.update(volume);
+    energyPeak.update(energyFast.value);
+
+    float bass = features.bass;
+    float mid = features.mid;
+    float treble = features.treble;
+
+    float bassRise = bass - prevBass;
+    float highRise = max(0.0f, mid - prevMid) + max(0.0f, treble - prevTreble);
+    bassFast.update(bass);
+    bassSlow.update(bass);
+    bassFlux.update(bassRise > 0 ? bassRise : 0.0f);
+    highFlux.update(highRise);
+    highFluxSlow.update(highRise);
+    prevBass = bass;
+    prevMid = mid;
+    prevTreble = treble;
+
+    // Build-up: energy climbing against the phrase average while the highs get busier
+    // and the low end stays thin
+    buildUp = energyMid.value > energySlow.value * 1.15f &&
+              highFlux.value > highFluxSlow.value * 1.2f &&
+              bassFast.value <= bassSlow.value * 1.1f;
+    framesSinceBuildUp = buildUp ? 0 : min(framesSinceBuildUp + 1, 1000);
+
+    // Drop: the bass comes back hard, ideally right after a build-up
+    bool bassSlam = bassFast.value > bassSlow.value * 1.6f && bassFlux.value > 0.08f;
+    drop = bassSlam && (framesSinceBuildUp < 64 || energyFast.value > energySlow.value * 1.5f);
+
+    if (features.bpm > 0) lastBpm = features.bpm;
+}
+
+float AnimationSelector::getEnergy() const {
+    if (energyPeak.value <= 0.0001f) return 0.0f;
+    return constrain(energyFast.value / energyPeak.value, 0.0f, 1.0f);
+}
+
+EnergyLevel AnimationSelector::getTargetEnergy() const {
+    if (drop) return EnergyLevel::High;
+    float e = getEnergy();
+    if (e > 0.7f) return EnergyLevel::High;
+    if (e > 0.4f) return EnergyLevel::Medium;
+    return EnergyLevel::Low;
+}
+
+int AnimationSelector::score(const AnimationEntry& entry, int index, float bpm, EnergyLevel targetEnergy) const {
+    int s = 0;
+
+    // Energy match dominates: 30 exact, 12 one step off, 0 opposite end
+    int target = (int)targetEnergy;
+    int distance = abs((int)entry.energy - target);
+    s += distance == 0 ? 30 : (distance == 1 ? 12 : 0);
+
+    // Tempo fit: full marks inside the preferred range, fading over 30 BPM outside
+    if (bpm > 0) {
+        float outside = 0;
+        if (bpm < entry.minBpm) outside = entry.minBpm - bpm;
+        else if (bpm > entry.maxBpm) outside = bpm - entry.maxBpm;
+        s += (int)(15.0f * max(0.0f, 1.0f - outside / 30.0f));
+    }
+
+    // Heavy effects are only worth it when the music carries them
+    if (entry.cost == CostClass::Heavy && target != (int)EnergyLevel::High) s -= 8;
+
+    // Don't bounce between the same few effects
+    for (int i = 0; i < RECENT_COUNT; i++) {
+        if (recent[i] == index) s -= 10 * (RECENT_COUNT - ((recentPos - 1 - i + RECENT_COUNT) % RECENT_COUNT));
+    }
+    return s;
+}
+
+int AnimationSelector::choose(const AnimationEntry* table, int count, int current, EnergyLevel target) {
+    int best = (current + 1) % count;
+    int bestScore = -10000;
+    for (int i = 0; i < count; i++) {
+        if (i == current) continue;
+        // A little jitter so equally good candidates take turns
+        int s = score(table[i], i, lastBpm, target) + random8(4);
+        if (s > bestScore) {
+            bestScore = s;
+            best = i;
+        }
+    }
+
+    recent[recentPos] = current;
+    recentPos = (recentPos + 1) % RECENT_COUNT;
+    return best;
+}
+
+int AnimationSelector::pick(const AnimationEntry* table, int count, int current) {
+    if (count <= 1) return 0;
+
+    EnergyLevel target = getTargetEnergy();
+    int best = choose(table, count, current, target);
+
+    static const char* reasons[] = { "Low energy pick", "Mid energy pick", "High energy pick" };
+    lastReason = drop ? "Drop pick" : reasons[(int)target];
+    return best;
+}
+
+int AnimationSelector::pickForEnergy(const AnimationEntry* table, int count, int current, EnergyLevel target) {
+    if (count <= 1) return 0;
+
+    lastReason = "Cue pick";
+    return choose(table, count, current, target);
+}
@@ -0,0 +1,60 @@
+// AnimationSelector.h
+#pragma once
+
+#include <Arduino.h>
+#include "AudioProcessor.h"
+#include "Animations.h"
+#include "RollingStats.h"
+
+// Follows the longer-horizon shape of the music (energy trend over phrases,
+// build-ups and drops from band flux, tempo) and scores animations against it
+// using the metadata in ANIMATION_TABLE.
+class AnimationSelector {
+public:
+    AnimationSelector();
+
+    // Feed one analysis frame; O(1)
+    void observe(const AudioFeatures& features);
+
+    // Best next animation for the current music, never `current`
+    int pick(const AnimationEntry* table, int count, int current);
+    // Same, aimed at a given energy instead of the live one (cue tracks)
+    int pickForEnergy(const AnimationEntry* table, int count, int current, EnergyLevel target);
+
+    bool isBuildUp() const { return buildUp; }
+    bool isDrop() const { return drop; }
+    // Current energy relative to the recent peak, 0.0 - 1.0
+    float getEnergy() const;
+    // Short-term energy minus the phrase-length average
+    float getEnergyTrend() const { return energyMid.value - energySlow.value; }
+    EnergyLevel getTargetEnergy() const;
+    const char* getLastReason() const { return lastReason; }
+
+private:
+    static constexpr int RECENT_COUNT = 4;
+
+    Ema energyFast;    // ~1 s
+    Ema energyMid;     // ~4 s
+    Ema energySlow;    // ~one 16-bar phrase
+    PeakTracker energyPeak;
+    Ema bassFast;
+    Ema bassSlow;
+    Ema highFlux;      // positive mid+treble change per frame
+    Ema highFluxSlow;
+    Ema bassFlux;
+
+    float prevBass;
+    float prevMid;
+    float prevTreble;
+    int framesSinceBuildUp;
+    bool buildUp;
+    bool drop;
+    float lastBpm;
+
+    int recent[RECENT_COUNT];
+    int recentPos;
+    const char* lastReason;
+
+    int score(const AnimationEntry& entry, int index, float bpm, EnergyLevel target) const;
+    int choose(const AnimationEntry* table, int count, int current, EnergyLevel target);
+};
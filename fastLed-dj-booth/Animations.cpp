@@ -1,8 +1,33 @@
 #include "Animations.h"
-#include "Config.h"  // where NUM_LEDS is defined
-#include <vector>
-// Declare drips globally if needed across multiple functions
-static std::vector<int> drips;
+#include "config.h"  // where NUM_LEDS is defined
+#include "Modulation.h"
+#include "PaletteManager.h"
+#include "LedKernels.h"
+#include "QualityGovernor.h"
+#include "FixedVector.h"
+#include "SpatialMap.h"
+#include <algorithm>
+
+// fadeToBlackBy() / blur1d(), through the kernels with LED_KERNEL_FADES
+static void fadeLeds(CRGB* leds, int numLeds, uint8_t amount) {
+#if LED_KERNEL_FADES
+    ledFade((uint8_t*)leds, numLeds * 3, amount);
+#else
+    fadeToBlackBy(leds, numLeds, amount);
+#endif
+}
+
+static void blurLeds(CRGB* leds, int numLeds, uint8_t amount) {
+    if (!QualityGovernor::blurEnabled()) return;
+#if LED_KERNEL_FADES
+    alignas(4) static uint8_t scratch[6 * NUM_LEDS];
+    if (numLeds <= NUM_LEDS) {
+        ledBlur((uint8_t*)leds, numLeds, amount, scratch);
+        return;
+    }
+#endif
+    blur1d(leds, numLeds, amount);
+}
 
 // Firestorm: Flames that pulse harder with bass
 void firestormAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
@@ -27,7 +52,7 @@ void firestormAnimation(CRGB* leds, int numLeds, const AudioFeatures& features)
     }
 
     for (int j = 0; j < numLeds; j++) {
-        leds[j] = HeatColor(heat[j]);
+        leds[j] = PaletteManager::heat(heat[j]);
     }
 }
 
@@ -36,22 +61,18 @@ void rippleCascadeAnimation(CRGB* leds, int numLeds, const AudioFeatures& featur
     static uint8_t rippleColor = 0;
     static int rippleStep = -1;
 
-    if (features.beatDetected) {
+    if (Modulation::trigger(ModTrigger::Beat)) {
         rippleColor = random8();
         rippleStep = 0;
     }
 
-    fadeToBlackBy(leds, numLeds, 64);
+    fadeLeds(leds, numLeds, 64);
 
     if (rippleStep >= 0) {
-        for (int i = 0; i < numLeds; i++) {
-            int dist = abs((numLeds / 2) - i);
-            if (dist == rippleStep) {
-                leds[i] = CHSV(rippleColor, 255, 255 - dist * 20);
-            }
-        }
+        CRGB c = PaletteManager::color(rippleColor, 255 - rippleStep * 20);
+        for (uint16_t i : SpatialMap::ring(rippleStep)) leds[i] = c;
         rippleStep++;
-        if (rippleStep > numLeds / 2) rippleStep = -1;
+        if (rippleStep >= SpatialMap::ringCount()) rippleStep = -1;
     }
 }
 
@@ -60,13 +81,14 @@ void colorTunnelAnimation(CRGB* leds, int numLeds, const AudioFeatures& features
     static uint8_t hue = 0;
     hue += features.volume * 8;
 
+    uint8_t drift = Modulation::phase8(ModRate::Bar);
     for (int i = 0; i < numLeds; i++) {
-        leds[i] = CHSV(hue + i * 3, 255, sin8(i * 5 + millis() / 12));
+        leds[i] = PaletteManager::color(hue + i * 3, sine8(i * 5 + drift));
     }
 
     if (features.beatDetected) {
         for (int i = 0; i < numLeds; i += 2) {
-            leds[i] += CHSV(hue + i * 3, 255, 255);
+            leds[i] += PaletteManager::color(hue + i * 3);
         }
     }
 }
@@ -77,25 +99,30 @@ void energySwirlAnimation(CRGB* leds, int numLeds, const AudioFeatures& features
     swirl += features.mid * 8;
 
     for (int i = 0; i < numLeds; i++) {
-        leds[i] = CHSV((i * 5 + swirl), 255, features.volume * 255);
+        leds[i] = PaletteManager::color(i * 5 + swirl, features.volume * 255);
     }
 
-    blur1d(leds, numLeds, 30);
+    blurLeds(leds, numLeds, 30);
 }
 
 // Strobe Matrix
 void strobeMatrixAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
+    // On and off every eighth of a beat while the bass is heavy, every quarter
+    // otherwise. It flips on crossing into the next one rather than sampling a
+    // square wave: at 120 BPM an eighth is half a 125 ms frame and the samples
+    // would always land on the same half. Flipping at most once a frame caps
+    // the strobe at half the frame rate.
     static bool state = false;
-    static unsigned long lastChange = 0;
-
-    if (millis() - lastChange > (features.bass > 0.5 ? 60 : 180)) {
+    static uint32_t lastStep = 0;
+    uint32_t step = Modulation::getPosition() >> (features.bass > 0.5 ? 13 : 14);
+    if (step != lastStep) {
         state = !state;
-        lastChange = millis();
+        lastStep = step;
     }
 
     if (state) {
         for (int i = 0; i < numLeds; i += random8(1, 5)) {
-            leds[i] = CHSV(random8(), 255, 255);
+            leds[i] = PaletteManager::color(random8());
         }
     } else {
         fill_solid(leds, numLeds, CRGB::Black);
@@ -108,26 +135,25 @@ void bassBloomAnimation(CRGB* leds, int numLeds, const AudioFeatures& features)
     static int size = 0;
 
     if (features.bass > 0.5 || features.beatDetected) {
-        size = numLeds / 2;
+        size = SpatialMap::ringCount() - 1;
         hue = random8();
     }
 
-    fadeToBlackBy(leds, numLeds, 25);
+    fadeLeds(leds, numLeds, 25);
     for (int i = 0; i < size; i++) {
-        int l = (numLeds / 2) - i;
-        int r = (numLeds / 2) + i;
-        if (l >= 0) leds[l] += CHSV(hue + i * 2, 255, 255 - i * 5);
-        if (r < numLeds) leds[r] += CHSV(hue + i * 2, 255, 255 - i * 5);
+        CRGB c = PaletteManager::color(hue + i * 2, 255 - i * 5);
+        for (uint16_t p : SpatialMap::ring(i)) leds[p] += c;
     }
     if (size > 0) size--;
 }
 
 // Color Drip
 void colorDripAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
-    static std::vector<int> drips;
+    // One drip can start per frame and each lasts numLeds frames
+    static FixedVector<int, NUM_LEDS + 1> drips;
     static uint8_t hue = 0;
 
-    fadeToBlackBy(leds, numLeds, 30);
+    fadeLeds(leds, numLeds, 30);
 
     if (features.treble > 0.25 || random8() < 4) {
         drips.push_back(0);
@@ -137,50 +163,51 @@ void colorDripAnimation(CRGB* leds, int numLeds, const AudioFeatures& features)
     for (int i = 0; i < drips.size(); ++i) {
         int pos = drips[i];
         if (pos < numLeds) {
-            leds[pos] = CHSV(hue, 200, 255);
+            leds[pos] = PaletteManager::color(hue, 255, 200);
             if (pos > 0) leds[pos - 1].fadeToBlackBy(180);
             drips[i]++;
         }
     }
 
-    drips.erase(std::remove_if(drips.begin(), drips.end(), [numLeds](int p) {
+    drips.resize(std::remove_if(drips.begin(), drips.end(), [numLeds](int p) {
         return p >= numLeds;
-    }), drips.end());
+    }) - drips.begin());
 }
 
 // Frequency River
 void frequencyRiverAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
     int third = numLeds / 3;
-    fill_solid(leds, third, CHSV(160, 255, features.bass * 255));
-    fill_solid(leds + third, third, CHSV(96, 255, features.mid * 255));
-    fill_solid(leds + 2 * third, third, CHSV(0, 255, features.treble * 255));
-    blur1d(leds, numLeds, 16);
+    fill_solid(leds, third, PaletteManager::color(160, features.bass * 255));
+    fill_solid(leds + third, third, PaletteManager::color(96, features.mid * 255));
+    fill_solid(leds + 2 * third, third, PaletteManager::color(0, features.treble * 255));
+    blurLeds(leds, numLeds, 16);
 }
 
 // Party Pulse
 void partyPulseAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
     static uint8_t hue = 0;
-    if (features.beatDetected) hue += 30;
+    if (Modulation::trigger(ModTrigger::Beat)) hue += 30;
 
-    fill_gradient(leds, numLeds, CHSV(hue, 255, features.volume * 180), CHSV(hue + 64, 255, features.volume * 180));
+    uint8_t level = features.volume * 180;
+    for (int i = 0; i < numLeds; i++) {
+        leds[i] = PaletteManager::color(hue + i * 64 / max(1, numLeds - 1), level);
+    }
 
     static int radius = 0;
-    if (features.bass > 0.5) radius = numLeds / 2;
+    if (features.bass > 0.5) radius = SpatialMap::ringCount() - 1;
 
     for (int i = 0; i < radius; i++) {
-        int l = (numLeds / 2) - i;
-        int r = (numLeds / 2) + i;
-        if (l >= 0) leds[l] += CHSV(hue + 60, 255, 255 - i * 4);
-        if (r < numLeds) leds[r] += CHSV(hue + 60, 255, 255 - i * 4);
+        CRGB c = PaletteManager::color(hue + 60, 255 - i * 4);
+        for (uint16_t p : SpatialMap::ring(i)) leds[p] += c;
     }
     if (radius > 0) radius--;
 
     for (int i = 0; i < numLeds / 6; i++) {
         if (random8() < features.treble * 255 || random8() < features.mid * 100) {
-            leds[random16(numLeds)] += CHSV(hue + random8(), 200, 255);
+            leds[random16(numLeds)] += PaletteManager::color(hue + random8(), 255, 200);
         }
     }
-    blur1d(leds, numLeds, 18);
+    blurLeds(leds, numLeds, 18);
 }
 
 // Cyber Flux
@@ -190,62 +217,72 @@ void cyberFluxAnimation(CRGB* leds, int numLeds, const AudioFeatures& features)
 
     if (features.bass > 0.4) {
         int center = random16(numLeds);
-        leds[center] = CHSV(hue, 255, 255);
-        if (center > 0) leds[center - 1] = CHSV(hue + 20, 255, 180);
-        if (center < numLeds - 1) leds[center + 1] = CHSV(hue - 20, 255, 180);
+        leds[center] = PaletteManager::color(hue);
+        if (center > 0) leds[center - 1] = PaletteManager::color(hue + 20, 180);
+        if (center < numLeds - 1) leds[center + 1] = PaletteManager::color(hue - 20, 180);
     }
 
-    for (int i = 0; i < numLeds; i++) {
-        leds[i] += CHSV(hue + (i * 2), 255, sin8(i * 4 + millis() / 6));
+    alignas(4) CRGB layer[NUM_LEDS];
+    uint8_t sparkle[NUM_LEDS];
+    int count = min(numLeds, NUM_LEDS);
+    uint8_t drift = Modulation::phase8(ModRate::TwoBeats);
+    for (int i = 0; i < count; i++) {
+        layer[i] = PaletteManager::color(hue + (i * 2), sine8(i * 4 + drift));
     }
+    ledAdd((uint8_t*)leds, (const uint8_t*)layer, count * 3);
 
-    for (int i = 0; i < numLeds; i++) {
-        if (random8() < features.treble * 220) {
-            leds[i] = CRGB::White;
-        }
-    }
-    fadeToBlackBy(leds, numLeds, 22);
+    // random8() < treble * 220, drawn for every pixel in order
+    uint16_t threshold = constrain(ceil(features.treble * 220), 0, 256);
+    random16_set_seed(ledRandomGate(sparkle, count, threshold, random16_get_seed()));
+    ledSetWhere((uint8_t*)leds, sparkle, count, 255, 255, 255);
+    fadeLeds(leds, numLeds, 22);
 }
 
 // Bio-Signal
 void bioSignalAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
-    static uint8_t offset = 0;
-    offset += 2;
-
-    uint8_t breath = sin8(millis() / 12);
+    // One wave per phrase, breathing over two bars
+    uint8_t offset = Modulation::phase8(ModRate::Phrase);
+    uint8_t breath = Modulation::lfo(ModRate::TwoBars);
     uint8_t brightness = (features.bass > 0.3) ? breath : 25;
 
     for (int i = 0; i < numLeds; i++) {
-        uint8_t wave = sin8(i * 3 + offset);
-        leds[i] = CHSV(wave + offset, 220, brightness);
+        uint8_t wave = sine8(i * 3 + offset);
+        leds[i] = PaletteManager::color(wave + offset, brightness, 220);
         if (random8() < features.treble * 200) {
-            leds[i] += CHSV(random8(), 255, 255);
+            leds[i] += PaletteManager::color(random8());
         }
     }
     if (features.beatDetected) {
-        for (int i = 0; i < numLeds; i++) {
-            leds[i] += CHSV(0, 0, 40);
-        }
+        const CRGB glow = CHSV(0, 0, 40);
+        ledAddColor((uint8_t*)leds, numLeds, glow.r, glow.g, glow.b);
     }
-    blur1d(leds, numLeds, 30);
+    blurLeds(leds, numLeds, 30);
 }
 
 void chaosEngineAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
-    fill_rainbow(leds, numLeds, millis() / 10, 7);
+    // fill_rainbow() colours: saturation 240
+    uint8_t hue = Modulation::phase8(ModRate::Bar);
+    for (int i = 0; i < numLeds; i++) {
+        leds[i] = PaletteManager::color(hue + i * 7, 255, 240);
+    }
 }
 
 void galacticDriftAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
+    uint8_t hueDrift = Modulation::phase8(ModRate::TwoBeats);
+    uint8_t waveDrift = Modulation::phase8(ModRate::Bar);
     for (int i = 0; i < numLeds; i++) {
-        leds[i] = CHSV((i * 4 + millis() / 5) % 255, 255, sin8(i * 3 + millis() / 7));
+        leds[i] = PaletteManager::color((i * 4 + hueDrift) % 255, sine8(i * 3 + waveDrift));
     }
 }
 
 void audioStormAnimation(CRGB* leds, int numLeds, const AudioFeatures& features) {
     static uint8_t baseHue = 0;
     baseHue += features.volume * 10;
+    // Flares on each onset and dies away over the beat
+    uint8_t level = 128 + scale8(127, Modulation::envelope(ModEnvelope::Onset));
     for (int i = 0; i < numLeds; i++) {
-        leds[i] = CHSV(baseHue + i * 5, 255, features.beatDetected ? 255 : 128);
+        leds[i] = PaletteManager::color(baseHue + i * 5, level);
     }
-    fadeToBlackBy(leds, numLeds, 10);
+    fadeLeds(leds, numLeds, 10);
 }
 
@@ -6,53 +6,77 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include "AudioProcessor.h"
-#include "Config.h"
+#include "config.h"
 
 // Define a type for animation function pointers
 typedef void (*AnimationFunction)(CRGB*, int, const AudioFeatures&);
 
-// Struct to hold an animation's name and its corresponding function
+// How hard an effect hits; used when matching effects to the music
+enum class EnergyLevel : uint8_t { Low, Medium, High };
+
+// Rough per-frame render cost, so the controller can avoid heavy effects when busy
+enum class CostClass : uint8_t { Light, Medium, Heavy };
+
+// Struct to hold an animation's name, function and selection metadata
 struct AnimationEntry {
     const char* name;            // Animation name
     AnimationFunction function;  // Pointer to the animation function
+    EnergyLevel energy;
+    uint8_t minBpm;              // Preferred tempo range
+    uint8_t maxBpm;
+    CostClass cost;
 };
 
+// The single list of animations. Adding an effect is one line here plus its
+// function in Animations.cpp; declarations, the table, the count and name
+// lookup are all generated from it at compile time.
+//
+//  X(function,               name,                        energy, minBpm, maxBpm, cost)
+#define ANIMATION_TABLE(X) \
+    X(bioSignalAnimation,      "Bio-Signal",               Low,     70, 120, Medium) \
+    X(firestormAnimation,      "Bass-Driven Firestorm",    High,   120, 175, Medium) \
+    X(rippleCascadeAnimation,  "Spectrum Ripple Cascade",  Medium,  90, 140, Light)  \
+    X(colorTunnelAnimation,    "Beat-Synced Color Tunnel", Medium, 100, 150, Medium) \
+    X(energySwirlAnimation,    "Dynamic Energy Swirl",     Medium,  90, 140, Medium) \
+    X(strobeMatrixAnimation,   "Rhythmic Strobe Matrix",   High,   128, 180, Light)  \
+    X(bassBloomAnimation,      "Bass Bloom",               High,   110, 150, Light)  \
+    X(colorDripAnimation,      "Color Drip",               Low,     60, 110, Light)  \
+    X(frequencyRiverAnimation, "Frequency River",          Medium,  80, 140, Medium) \
+    X(partyPulseAnimation,     "Party Pulse",              High,   118, 140, Heavy)  \
+    X(cyberFluxAnimation,      "Cyber Flux",               High,   125, 175, Heavy)  \
+    X(chaosEngineAnimation,    "Chaos Engine",             Low,     60, 200, Light)  \
+    X(galacticDriftAnimation,  "Galactic Drift",           Low,     60, 110, Medium) \
+    X(audioStormAnimation,     "Audio Storm",              Medium, 100, 160, Light)
+
 // Declare all animation functions
-extern void bioSignalAnimation(CRGB*, int, const AudioFeatures&);
-extern void firestormAnimation(CRGB*, int, const AudioFeatures&);
-extern void rippleCascadeAnimation(CRGB*, int, const AudioFeatures&);
-extern void colorTunnelAnimation(CRGB*, int, const AudioFeatures&);
-extern void energySwirlAnimation(CRGB*, int, const AudioFeatures&);
-extern void strobeMatrixAnimation(CRGB*, int, const AudioFeatures&);
-extern void bassBloomAnimation(CRGB*, int, const AudioFeatures&);
-extern void colorDripAnimation(CRGB*, int, const AudioFeatures&);
-extern void frequencyRiverAnimation(CRGB*, int, const AudioFeatures&);
-extern void partyPulseAnimation(CRGB*, int, const AudioFeatures&);
-extern void cyberFluxAnimation(CRGB*, int, const AudioFeatures&);
-extern void chaosEngineAnimation(CRGB*, int, const AudioFeatures&);
-extern void galacticDriftAnimation(CRGB*, int, const AudioFeatures&);
-extern void audioStormAnimation(CRGB*, int, const AudioFeatures&);
-
-// Define an array to hold all animation entries
-const AnimationEntry animations[] = {
-    { "Bio-Signal", bioSignalAnimation },
-    { "Bass-Driven Firestorm", firestormAnimation },
-    { "Spectrum Ripple Cascade", rippleCascadeAnimation },
-    { "Beat-Synced Color Tunnel", colorTunnelAnimation },
-    { "Dynamic Energy Swirl", energySwirlAnimation },
-    { "Rhythmic Strobe Matrix", strobeMatrixAnimation },
-    { "Bass Bloom", bassBloomAnimation },
-    { "Color Drip", colorDripAnimation },
-    { "Frequency River", frequencyRiverAnimation },
-    { "Party Pulse", partyPulseAnimation },
-    { "Cyber Flux", cyberFluxAnimation },
-    { "Chaos Engine", chaosEngineAnimation },
-    { "Galactic Drift", galacticDriftAnimation },
-    { "Audio Storm", audioStormAnimation }
+#define ANIMATION_DECLARE(fn, name, energy, minBpm, maxBpm, cost) \
+    extern void fn(CRGB*, int, const AudioFeatures&);
+ANIMATION_TABLE(ANIMATION_DECLARE)
+#undef ANIMATION_DECLARE
+
+// Table of all animation entries; constexpr keeps it (and the name literals) in flash
+#define ANIMATION_ENTRY(fn, name, energy, minBpm, maxBpm, cost) \
+    { name, fn, EnergyLevel::energy, minBpm, maxBpm, CostClass::cost },
+constexpr AnimationEntry animations[] = {
+    ANIMATION_TABLE(ANIMATION_ENTRY)
 };
+#undef ANIMATION_ENTRY
+
+#define ANIMATION_COUNT_ONE(...) + 1
+constexpr int ANIMATION_COUNT = 0 ANIMATION_TABLE(ANIMATION_COUNT_ONE);
+#undef ANIMATION_COUNT_ONE
+
+static_assert(ANIMATION_COUNT > 0, "ANIMATION_TABLE must list at least one animation");
+
+// Compile-time name lookup, e.g. animationIndex("Bass Bloom"); -1 if unknown
+constexpr bool animationNameEquals(const char* a, const char* b) {
+    return *a == *b && (*a == '\0' || animationNameEquals(a + 1, b + 1));
+}
 
-// Ensure HYBRID_ANIM_COUNT matches the number of defined animations
-static_assert(HYBRID_ANIM_COUNT == (sizeof(animations) / sizeof(animations[0])),
-              "HYBRID_ANIM_COUNT does not match the number of defined animations!");
+constexpr int animationIndex(const char* name, int i = 0) {
+    return i >= ANIMATION_COUNT ? -1
+         : animationNameEquals(animations[i].name, name) ? i
+         : animationIndex(name, i + 1);
+}
 
-#endif // ANIMATIONS_H
\ No newline at end of file
+#endif // ANIMATIONS_H
@@ -0,0 +1,26 @@
+// AudioFeatures.h
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+
+struct AudioFeatures {
+    double volume = 0.0;
+    double bass = 0.0;
+    double mid = 0.0;
+    double treble = 0.0;
+    bool beatDetected = false;
+    double bpm = 0.0;
+    int loudness = 0;
+    // Beat grid position (see BeatGrid)
+    bool gridLocked = false;
+    bool gridBeat = false;          // grid crossed a beat this frame
+    uint32_t beatIndex = 0;
+    uint8_t beatInBar = 0;
+    uint32_t bar = 0;
+    float beatPhase = 0.0f;
+    // How sure TempoTracker is of bpm and beatPhase, 0 - 1 (0 before it has run)
+    float tempoConfidence = 0.0f;
+    double spectrum[NUM_SAMPLES/2] = {0};
+    const int16_t* waveform = nullptr;  // Initialize to nullptr
+};
@@ -1,10 +1,11 @@
 #include "AudioProcessor.h"
-#include "Config.h"
+#include "config.h"
+#include "FrameLog.h"
+#include "FrameClock.h"
+#include "TuningParams.h"
 
-AudioProcessor::AudioProcessor()
-    : previousVolume(0.0), lastBeatTime(0), currentBPM(0.0),
-      normalizedVolume(0.0), rollingMin(1.0), rollingMax(0.0),
-      FFT(nullptr)
+AudioProcessor::AudioProcessor(AudioSource& source)
+    : FFT(nullptr), extractor(NUM_SAMPLES, SAMPLE_RATE), source(source)
 {
     FFT = new ArduinoFFT<double>(vReal, vImag, NUM_SAMPLES, SAMPLE_RATE);
 }
@@ -14,45 +15,27 @@ AudioProcessor::~AudioProcessor() {
 }
 
 void AudioProcessor::begin() {
-    const i2s_config_t i2s_config = {
-        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-        .sample_rate = SAMPLE_RATE,
-        .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
-        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-        .intr_alloc_flags = 0,
-        .dma_buf_count = 8,
-        .dma_buf_len = 64,
-        .use_apll = false,
-        .tx_desc_auto_clear = false,
-        .fixed_mclk = 0
-    };
-
-    const i2s_pin_config_t pin_config = {
-        .bck_io_num = I2S_SCK,
-        .ws_io_num = I2S_WS,
-        .data_out_num = -1,
-        .data_in_num = I2S_SD
-    };
-
-    i2s_driver_install(I2S_PORT, &i2s_config, 0, NULL);
-    i2s_set_pin(I2S_PORT, &pin_config);
-    i2s_start(I2S_PORT);
+    if (!source.begin()) Serial.println("[AudioProcessor] ERROR: audio input didn't start");
 }
 
 void AudioProcessor::captureAudio() {
-    Serial.println("[AudioProcessor] captureAudio() called");
-    size_t bytesRead = 0;
+    FRAME_LOG("[AudioProcessor] captureAudio() called\n");
     static int32_t i2sBuffer[NUM_SAMPLES]; // Static buffer to avoid stack overuse
-    i2s_read(I2S_PORT, (void*)i2sBuffer, sizeof(i2sBuffer), &bytesRead, portMAX_DELAY);
-    int samplesRead = bytesRead / sizeof(int32_t);
+    int samplesRead = source.read(i2sBuffer, NUM_SAMPLES);
 
     for (int i = 0; i < 10 && i < samplesRead; i++) {
-        Serial.printf("i2sBuffer[%d]=%ld\n", i, i2sBuffer[i]);
+        FRAME_LOG("i2sBuffer[%d]=%ld\n", i, (long)i2sBuffer[i]);
     }
 
+    loadSamples(i2sBuffer, samplesRead);
+    FRAME_LOG("[AudioProcessor] samplesRead: %d\n", samplesRead);
+}
+
+// Fill the analysis buffers from 24-bit PCM held in 32-bit words (I2S layout).
+// Used by captureAudio() and by the golden-frame self test to inject fixed input.
+void AudioProcessor::loadSamples(const int32_t* samples, int samplesRead) {
     for (int i = 0; i < samplesRead && i < NUM_SAMPLES; i++) {
-        float normalized = i2sBuffer[i] / 8388608.0f;  // Normalize 24-bit signed PCM
+        float normalized = samples[i] / 8388608.0f;  // Normalize 24-bit signed PCM
         vReal[i] = normalized;
         vImag[i] = 0.0;
         buffer[i] = (int16_t)(normalized * 32767);  // For waveform
@@ -64,50 +47,23 @@ void AudioProcessor::captureAudio() {
         memset(vImag + samplesRead, 0, (NUM_SAMPLES - samplesRead) * sizeof(double));
         memset(buffer + samplesRead, 0, (NUM_SAMPLES - samplesRead) * sizeof(int16_t));
     }
-    Serial.printf("[AudioProcessor] samplesRead: %d\n", samplesRead);
+}
+
+// Forget all smoothing/beat history so a fixed input always yields the same features
+void AudioProcessor::reset() {
+    extractor.reset();
 }
 
 AudioFeatures AudioProcessor::analyzeAudio() {
-    Serial.println("[AudioProcessor] analyzeAudio() called");
+    FRAME_LOG("[AudioProcessor] analyzeAudio() called\n");
     AudioFeatures features = {};
     
     // Set the waveform pointer to the buffer
     features.waveform = buffer;
-    Serial.printf("[AudioProcessor] Setting waveform pointer: %p\n", (void*)features.waveform);
+    FRAME_LOG("[AudioProcessor] Setting waveform pointer: %p\n", (void*)features.waveform);
 
-    // Volume (RMS)
-    double sumSquares = 0.0;
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        vReal[i] = constrain(vReal[i], -1.0f, 1.0f);
-        sumSquares += vReal[i] * vReal[i];
-    }
-
-    double rawVolume = sqrt(sumSquares / NUM_SAMPLES);
-    normalizedVolume = gainSmoothing * normalizedVolume + (1 - gainSmoothing) * rawVolume;
-    features.volume = normalizedVolume;
-
-    // Loudness: scale volume to 0–100
-    static float smoothedLoudness = 0;
-    float rawLoudness = features.volume * 100.0f;
-    smoothedLoudness = 0.9f * smoothedLoudness + 0.1f * rawLoudness;
-    features.loudness = constrain(smoothedLoudness, 0, 100);
-
-    Serial.printf("[AudioProcessor] After RMS: vol=%.3f, loud=%d\n", features.volume, features.loudness);
-
-    // Beat detection
-    double volumeChange = features.volume - previousVolume;
-    unsigned long now = millis();
-    if (volumeChange > 0.05 && (now - lastBeatTime) > 250) {
-        features.beatDetected = true;
-        unsigned long beatInterval = now - lastBeatTime;
-        if (beatInterval > 250 && beatInterval < 2000) {
-            currentBPM = 60000.0 / beatInterval;
-        }
-        lastBeatTime = now;
-    } else {
-        features.beatDetected = false;
-    }
-    features.bpm = currentBPM;
+    // Volume (RMS) before the FFT overwrites the samples
+    double rawVolume = FeatureExtractor::measureVolume(vReal, NUM_SAMPLES);
 
     // FFT
     if (FFT) {
@@ -119,31 +75,21 @@ AudioFeatures AudioProcessor::analyzeAudio() {
     // Copy FFT spectrum
     memcpy(features.spectrum, vReal, sizeof(double) * (NUM_SAMPLES / 2));
 
-    // Frequency band bin mapping
-    int bassLimit = (int)(200.0 * NUM_SAMPLES / SAMPLE_RATE);
-    int midLimit  = (int)(2000.0 * NUM_SAMPLES / SAMPLE_RATE);
-    int trebleLimit = NUM_SAMPLES / 2;
+    extractor.process(rawVolume, vReal, FrameClock::now(), features);
 
-    double bassSum = 0.0, midSum = 0.0, trebleSum = 0.0;
-
-    for (int i = 0; i < bassLimit; i++) bassSum += vReal[i];
-    for (int i = bassLimit; i < midLimit; i++) midSum += vReal[i];
-    for (int i = midLimit; i < trebleLimit; i++) trebleSum += vReal[i];
-
-    // Normalize for display (0.0 – 1.0)
-    features.bass = constrain((bassSum / bassLimit) / 100.0, 0.0, 1.0);
-    features.mid  = constrain((midSum / (midLimit - bassLimit)) / 80.0, 0.0, 1.0);
-    features.treble = constrain((trebleSum / (trebleLimit - midLimit)) / 50.0, 0.0, 1.0);
-
-    Serial.printf("[AudioProcessor] After FFT: bass=%.3f, mid=%.3f, treb=%.3f\n", features.bass, features.mid, features.treble);
+    FRAME_LOG("[AudioProcessor] After RMS: vol=%.3f, loud=%d\n", features.volume, features.loudness);
+    FRAME_LOG("[AudioProcessor] After FFT: bass=%.3f, mid=%.3f, treb=%.3f\n", features.bass, features.mid, features.treble);
 
 #if AUDIO_DEBUG
-    Serial.printf("Bands | Bass: %.2f | Mid: %.2f | Treble: %.2f\n",
+    FRAME_LOG("Bands | Bass: %.2f | Mid: %.2f | Treble: %.2f\n",
                   features.bass, features.mid, features.treble);
+    const GainState& gain = extractor.getGainState();
+    FRAME_LOG("Gain | x%.2f | level %.4f | floor %.4f%s | bands x%.2f x%.2f x%.2f\n",
+                  gain.gain, gain.level, gain.noiseFloor, gain.gated ? " (gated)" : "",
+                  gain.bandGain[GAIN_BASS], gain.bandGain[GAIN_MID], gain.bandGain[GAIN_TREBLE]);
 #endif
 
-    previousVolume = features.volume;
-    Serial.printf("[AudioProcessor] Returning features: %p\n", (void*)&features);
+    FRAME_LOG("[AudioProcessor] Returning features: %p\n", (void*)&features);
     return features;
 }
 
@@ -156,9 +102,17 @@ const int16_t* AudioProcessor::getRawAudio() const {
 }
 
 float AudioProcessor::getCurrentBPM() const {
-    return currentBPM;
+    return extractor.getCurrentBPM();
 }
 
 float AudioProcessor::getNormalizedVolume() const {
-    return normalizedVolume;
+    return extractor.getNormalizedVolume();
+}
+
+const BeatGrid& AudioProcessor::getBeatGrid() const {
+    return extractor.getBeatGrid();
+}
+
+const GainState& AudioProcessor::getGainState() const {
+    return extractor.getGainState();
 }
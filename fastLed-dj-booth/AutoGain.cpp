@@ -0,0 +1,101 @@
+#include "AutoGain.h"
+#include "TuningParams.h"
+#include <math.h>
+
+// Loud inputs are turned down no further than this
+#define AGC_MIN_GAIN 0.05f
+// The floor estimate drops to a quieter frame within about this long
+#define NOISE_FLOOR_FALL_MS 500.0f
+// Floor estimate limits (RMS): where it starts, and a cap so a long quiet
+// breakdown can't walk it up into the music
+#define NOISE_FLOOR_MIN 0.0005f
+#define NOISE_FLOOR_MAX 0.05f
+// An open gate closes this far below the opening threshold, once the input
+// has stayed there this long
+#define NOISE_GATE_HYSTERESIS 0.7f
+#define NOISE_GATE_HOLD_MS 500.0f
+
+static inline float follow(float dtMs, float tauMs) {
+    return tauMs > 0.0f ? 1.0f - expf(-dtMs / tauMs) : 1.0f;
+}
+
+static inline double clampUnit(double v) {
+    return v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+}
+
+static float gainFor(float envelope) {
+    if (envelope < 1e-6f) return tuning.agcMaxGain;
+    float gain = tuning.agcTarget / envelope;
+    return gain < AGC_MIN_GAIN ? AGC_MIN_GAIN : (gain > tuning.agcMaxGain ? tuning.agcMaxGain : gain);
+}
+
+AutoGain::AutoGain()
+    : level(0.0f, 0.0f),
+      bandLevel{ Envelope(0.0f, 0.0f), Envelope(0.0f, 0.0f), Envelope(0.0f, 0.0f) } {
+    reset();
+}
+
+void AutoGain::reset() {
+    level.value = 0.0f;
+    for (int b = 0; b < GAIN_BAND_COUNT; b++) bandLevel[b].value = 0.0f;
+    noiseFloor = NOISE_FLOOR_MIN;
+    lastTime = 0;
+    quietMs = 0.0f;
+    started = false;
+    primed = false;
+    state = GainState();
+}
+
+double AutoGain::process(double rms, double bands[GAIN_BAND_COUNT], unsigned long now) {
+    if (!tuning.agcEnabled) {
+        state = GainState();
+        for (int b = 0; b < GAIN_BAND_COUNT; b++) bands[b] = clampUnit(bands[b]);
+        return rms;
+    }
+
+    float dtMs = started ? (float)(now - lastTime) : 0.0f;
+    lastTime = now;
+    started = true;
+
+    // Noise floor: down fast to quieter frames, up slowly, so under music it
+    // settles near the quietest frames and in a silent room on the hiss
+    noiseFloor += (rms - noiseFloor) * follow(dtMs, rms < noiseFloor ? NOISE_FLOOR_FALL_MS : tuning.noiseFloorRiseMs);
+    noiseFloor = noiseFloor < NOISE_FLOOR_MIN ? NOISE_FLOOR_MIN : (noiseFloor > NOISE_FLOOR_MAX ? NOISE_FLOOR_MAX : noiseFloor);
+    state.noiseFloor = noiseFloor;
+
+    // Gate: opens at once, closes after the input has stayed below the
+    // (lower) closing threshold for a while, so it rides over gaps between beats
+    float ratio = tuning.noiseGateRatio;
+    float threshold = noiseFloor * ratio;
+    if (ratio <= 1.0f || rms >= threshold) {
+        state.gated = false;
+        quietMs = 0.0f;
+    } else if (!state.gated && rms < threshold * NOISE_GATE_HYSTERESIS) {
+        quietMs += dtMs;
+        state.gated = quietMs >= NOISE_GATE_HOLD_MS;
+    }
+    if (state.gated) {
+        // Envelopes hold, so the gain is where it was when the music comes back
+        for (int b = 0; b < GAIN_BAND_COUNT; b++) bands[b] = 0.0;
+        return 0.0;
+    }
+
+    float signal = rms > noiseFloor ? rms - noiseFloor : 0.0f;
+    level.attackMs = tuning.agcAttackMs;
+    level.releaseMs = tuning.agcReleaseMs;
+    if (!primed) level.value = signal;
+    state.level = level.update(signal, dtMs);
+    state.gain = gainFor(state.level);
+
+    for (int b = 0; b < GAIN_BAND_COUNT; b++) {
+        Envelope& env = bandLevel[b];
+        env.attackMs = tuning.agcAttackMs;
+        env.releaseMs = tuning.agcReleaseMs;
+        if (!primed) env.value = bands[b];
+        state.bandGain[b] = gainFor(env.update(bands[b], dtMs));
+        bands[b] = clampUnit(bands[b] * state.bandGain[b]);
+    }
+    primed = true;
+
+    return clampUnit(signal * state.gain);
+}
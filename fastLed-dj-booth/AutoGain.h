@@ -0,0 +1,49 @@
+// AutoGain.h
+#pragma once
+
+#include <stdint.h>
+#include "RollingStats.h"
+
+enum GainBand : uint8_t { GAIN_BASS, GAIN_MID, GAIN_TREBLE, GAIN_BAND_COUNT };
+
+// Gain stage state, for the dashboard log and telemetry
+struct GainState {
+    float gain = 1.0f;           // applied to volume
+    float level = 0.0f;          // envelope of the RMS above the noise floor
+    float noiseFloor = 0.0f;     // RMS
+    bool gated = false;
+    float bandGain[GAIN_BAND_COUNT] = { 1.0f, 1.0f, 1.0f };
+};
+
+// Automatic gain control between the raw measurements and the features, so
+// the lights respond the same in a quiet bar and next to the PA. Once per
+// frame it takes the frame's RMS and band levels (already scaled by the
+// tuning divisors, nominally 0-1) and:
+//  - tracks the noise floor: falls quickly to any quieter frame and rises
+//    slowly (tuning.noiseFloorRiseMs), so it sits under the music;
+//  - gates: once the input has stayed below tuning.noiseGateRatio times the
+//    floor for a moment everything reads 0 and the envelopes hold, so the
+//    gain doesn't climb on hiss;
+//  - follows the volume above the floor and each band with attack/release
+//    envelopes and scales them so recent peaks land at tuning.agcTarget.
+// With tuning.agcEnabled off the inputs pass through unchanged.
+class AutoGain {
+public:
+    AutoGain();
+
+    void reset();
+    // `bands` is scaled in place; returns the gained volume
+    double process(double rms, double bands[GAIN_BAND_COUNT], unsigned long now);
+
+    const GainState& getState() const { return state; }
+
+private:
+    Envelope level;
+    Envelope bandLevel[GAIN_BAND_COUNT];
+    float noiseFloor;
+    unsigned long lastTime;
+    float quietMs;    // time below the gate's closing threshold
+    bool started;
+    bool primed;      // envelopes start at the first ungated frame's levels
+    GainState state;
+};
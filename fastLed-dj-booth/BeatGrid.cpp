@@ -0,0 +1,86 @@
+#include "BeatGrid.h"
+
+// Onsets within this fraction of a period of the prediction count as the same beat
+#define BEAT_CAPTURE_WINDOW 0.3f
+// Flywheel beats without a confirming onset before the grid gives up (8 bars)
+#define BEAT_MAX_UNCONFIRMED 32
+
+BeatGrid::BeatGrid() {
+    reset();
+}
+
+void BeatGrid::reset() {
+    periodMs = 0;
+    lastBeatMs = 0;
+    nextBeatMs = 0;
+    beatIndex = 0;
+    unconfirmed = 0;
+    locked = false;
+    tick = false;
+}
+
+void BeatGrid::advance(unsigned long beatMs) {
+    lastBeatMs = beatMs;
+    nextBeatMs = beatMs + (unsigned long)periodMs;
+    beatIndex++;
+    tick = true;
+}
+
+void BeatGrid::update(unsigned long now, bool onset, float bpm) {
+    tick = false;
+
+    // The tracker's BPM is jittery; follow it slowly
+    if (bpm > 0) {
+        float target = 60000.0f / bpm;
+        periodMs = periodMs <= 0 ? target : periodMs + 0.1f * (target - periodMs);
+    }
+    if (periodMs <= 0) return;
+
+    if (!locked) {
+        if (onset) {
+            locked = true;
+            beatIndex = 0;
+            lastBeatMs = now;
+            nextBeatMs = now + (unsigned long)periodMs;
+            unconfirmed = 0;
+            tick = true;
+        }
+        return;
+    }
+
+    while ((long)(now - nextBeatMs) >= 0) {
+        advance(nextBeatMs);
+        unconfirmed++;
+    }
+
+    if (onset) {
+        float window = periodMs * BEAT_CAPTURE_WINDOW;
+        unsigned long late = now - lastBeatMs;
+        unsigned long early = nextBeatMs - now;
+        if (late < window) {
+            // Onset just after a beat the flywheel counted: pull its phase halfway
+            lastBeatMs += late / 2;
+            nextBeatMs = lastBeatMs + (unsigned long)periodMs;
+            unconfirmed = 0;
+        } else if (early < window) {
+            // Onset slightly ahead of the prediction: take the beat now, half-corrected
+            advance(nextBeatMs - early / 2);
+            unconfirmed = 0;
+        }
+    }
+
+    if (unconfirmed > BEAT_MAX_UNCONFIRMED) {
+        locked = false;
+    }
+}
+
+uint32_t BeatGrid::beatsUntilPhrase(int phraseBars) const {
+    uint32_t phraseBeats = (uint32_t)phraseBars * BEATS_PER_BAR;
+    return phraseBeats - (beatIndex % phraseBeats);
+}
+
+float BeatGrid::getBeatPhase(unsigned long now) const {
+    if (!locked || periodMs <= 0) return 0.0f;
+    float phase = (now - lastBeatMs) / periodMs;
+    return phase < 0.0f ? 0.0f : (phase > 1.0f ? 1.0f : phase);
+}
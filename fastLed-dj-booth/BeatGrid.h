@@ -0,0 +1,43 @@
+// BeatGrid.h
+#pragma once
+
+#include <stdint.h>
+
+// Flywheel beat grid. Onsets from the beat detector pull the phase, the tempo
+// estimate sets the period, and in between the grid keeps counting on its own,
+// so beat/bar/phrase positions stay steady through fills and breakdowns.
+// Beat 0 is the first onset after locking; bars are counted from there.
+class BeatGrid {
+public:
+    BeatGrid();
+
+    void reset();
+    // Call once per analysis frame
+    void update(unsigned long now, bool onset, float bpm);
+
+    bool isLocked() const { return locked; }
+    // True on the frame the grid crossed a beat
+    bool isBeatTick() const { return tick; }
+    uint32_t getBeatIndex() const { return beatIndex; }
+    uint8_t getBeatInBar() const { return beatIndex % BEATS_PER_BAR; }
+    uint32_t getBar() const { return beatIndex / BEATS_PER_BAR; }
+    uint8_t getBarInPhrase(int phraseBars) const { return getBar() % phraseBars; }
+    // Beats left until the next phrase of `phraseBars` bars starts (1..phrase length)
+    uint32_t beatsUntilPhrase(int phraseBars) const;
+    // Progress through the current beat, 0.0 - 1.0
+    float getBeatPhase(unsigned long now) const;
+    float getPeriodMs() const { return periodMs; }
+
+    static constexpr int BEATS_PER_BAR = 4;
+
+private:
+    float periodMs;
+    unsigned long lastBeatMs;
+    unsigned long nextBeatMs;
+    uint32_t beatIndex;
+    int unconfirmed;
+    bool locked;
+    bool tick;
+
+    void advance(unsigned long beatMs);
+};
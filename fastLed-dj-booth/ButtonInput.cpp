@@ -0,0 +1,164 @@
+#include "ButtonInput.h"
+
+static const uint8_t buttonPins[] = {
+#define BUTTON_PIN(name, pin) pin,
+    BUTTON_TABLE(BUTTON_PIN)
+#undef BUTTON_PIN
+};
+
+// Samples a level must hold to count
+static const uint8_t DEBOUNCE_SAMPLES = (BUTTON_DEBOUNCE_MS * 1000 + BUTTON_SAMPLE_US - 1) / BUTTON_SAMPLE_US;
+
+ButtonInput::Tracker ButtonInput::trackers[BUTTON_COUNT];
+SpscQueue<ButtonEvent, BUTTON_QUEUE_SIZE> ButtonInput::events;
+std::atomic<uint32_t> ButtonInput::dropped{0};
+bool ButtonInput::queued = false;
+
+struct ButtonBinding {
+    ButtonId button;
+    Gesture gesture;
+    ButtonAction action;
+};
+
+static const ButtonBinding bindings[] = {
+#define BUTTON_BINDING(button, gesture, action) { ButtonId::button, Gesture::gesture, ButtonAction::action },
+    BUTTON_BINDINGS(BUTTON_BINDING)
+#undef BUTTON_BINDING
+};
+
+ButtonAction buttonAction(ButtonId button, Gesture gesture) {
+    for (const ButtonBinding& b : bindings) {
+        if (b.button == button && b.gesture == gesture) return b.action;
+    }
+    return ButtonAction::None;
+}
+
+const char* buttonName(ButtonId button) {
+    static const char* names[] = {
+#define BUTTON_NAME(name, pin) #name,
+        BUTTON_TABLE(BUTTON_NAME)
+#undef BUTTON_NAME
+    };
+    return names[(int)button];
+}
+
+const char* gestureName(Gesture gesture) {
+    static const char* names[] = { "press", "release", "click", "double", "long" };
+    return names[(int)gesture];
+}
+
+void IRAM_ATTR ButtonInput::emit(int button, Gesture gesture, uint32_t ms) {
+    if (!events.push(ButtonEvent{ (ButtonId)button, gesture, ms })) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queued = true;
+}
+
+void IRAM_ATTR ButtonInput::sample(int button, bool down, uint32_t ms) {
+    Tracker& t = trackers[button];
+    if (down == t.down) {
+        t.disagree = 0;
+    } else {
+        if (t.disagree == 0) t.edgeMs = ms;
+        if (++t.disagree >= DEBOUNCE_SAMPLES) {
+            t.down = down;
+            t.disagree = 0;
+            if (down) {
+                t.downMs = t.edgeMs;
+                t.longSent = false;
+                emit(button, Gesture::Press, t.downMs);
+                t.doubled = t.clickPending && t.downMs - t.upMs <= BUTTON_DOUBLE_MS;
+                t.clickPending = false;
+                if (t.doubled) emit(button, Gesture::Double, t.downMs);
+            } else {
+                t.upMs = t.edgeMs;
+                emit(button, Gesture::Release, t.upMs);
+                t.clickPending = !t.longSent && !t.doubled;
+            }
+        }
+    }
+
+    if (t.down && !t.longSent && !t.doubled && ms - t.downMs >= BUTTON_LONG_MS) {
+        t.longSent = true;
+        emit(button, Gesture::Long, t.downMs);
+    }
+    if (t.clickPending && ms - t.upMs > BUTTON_DOUBLE_MS) {
+        t.clickPending = false;
+        emit(button, Gesture::Click, t.upMs);
+    }
+}
+
+bool ButtonInput::next(ButtonEvent& event) {
+    return events.pop(event);
+}
+
+#ifdef ESP32
+
+static hw_timer_t* sampleTimer = nullptr;
+static TaskHandle_t waiter = nullptr;
+
+// Buttons pull the pin low
+static void IRAM_ATTR onSampleTimer() {
+    uint32_t ms = millis();
+    for (int i = 0; i < BUTTON_COUNT; i++) ButtonInput::sample(i, digitalRead(buttonPins[i]) == LOW, ms);
+    if (!ButtonInput::takeQueued()) return;
+    BaseType_t woken = pdFALSE;
+    if (waiter) vTaskNotifyGiveFromISR(waiter, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+bool ButtonInput::begin() {
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+        pinMode(buttonPins[i], INPUT_PULLUP);
+        // Start from the idle level so a button held at boot isn't a press
+        trackers[i].down = false;
+    }
+    waiter = xTaskGetCurrentTaskHandle();
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    sampleTimer = timerBegin(1000000);
+    if (!sampleTimer) return false;
+    timerAttachInterrupt(sampleTimer, onSampleTimer);
+    timerAlarm(sampleTimer, BUTTON_SAMPLE_US, true, 0);
+#else
+    sampleTimer = timerBegin(0, 80, true);
+    if (!sampleTimer) return false;
+    timerAttachInterrupt(sampleTimer, onSampleTimer, true);
+    timerAlarmWrite(sampleTimer, BUTTON_SAMPLE_US, true);
+    timerAlarmEnable(sampleTimer);
+#endif
+    Serial.printf("[Input] %d buttons sampled every %d us, %d ms debounce\n", BUTTON_COUNT, BUTTON_SAMPLE_US,
+                  BUTTON_DEBOUNCE_MS);
+    return true;
+}
+
+bool ButtonInput::wait(unsigned long ms) {
+    // Drop wake-ups for gestures already handled, then look again: one
+    // queued after this gives a fresh one
+    ulTaskNotifyTake(pdTRUE, 0);
+    if (!events.empty()) return true;
+    if (ms == 0) return false;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+    return !events.empty();
+}
+
+#else
+
+// No buttons on the host: sample() is fed by the caller
+bool ButtonInput::begin() {
+    return true;
+}
+
+bool ButtonInput::wait(unsigned long ms) {
+    if (!events.empty()) return true;
+    delay(ms);
+    return !events.empty();
+}
+
+#endif
+
+bool IRAM_ATTR ButtonInput::takeQueued() {
+    bool was = queued;
+    queued = false;
+    return was;
+}
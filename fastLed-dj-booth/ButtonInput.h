@@ -0,0 +1,89 @@
+// ButtonInput.h
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "SpscQueue.h"
+
+#define BUTTON_ID(name, pin) name,
+enum class ButtonId : uint8_t { BUTTON_TABLE(BUTTON_ID) };
+#undef BUTTON_ID
+
+#define BUTTON_ONE(name, pin) +1
+static const int BUTTON_COUNT = 0 BUTTON_TABLE(BUTTON_ONE);
+#undef BUTTON_ONE
+
+// Press and Release on the (debounced) edges. Click after a release once no
+// second press followed within BUTTON_DOUBLE_MS, Double on that second
+// press, Long once held for BUTTON_LONG_MS; a press gives at most one of them.
+enum class Gesture : uint8_t { Press, Release, Click, Double, Long };
+
+enum class ButtonAction : uint8_t {
+    None,
+    NextAnimation,
+    ToggleAutoSwitch,
+    FreezeFrame,
+    FollowTimeline,
+    StepBrightness,
+    TapTempo,
+};
+
+struct ButtonEvent {
+    ButtonId button;
+    Gesture gesture;
+    // The edge the gesture dates from: the press for Press, Double and Long,
+    // the release for Release and Click
+    uint32_t ms;
+};
+
+// The binding for a gesture (BUTTON_BINDINGS in config.h)
+ButtonAction buttonAction(ButtonId button, Gesture gesture);
+const char* buttonName(ButtonId button);
+const char* gestureName(Gesture gesture);
+
+// Interrupt-driven buttons. A hardware timer samples every button each
+// BUTTON_SAMPLE_US; the interrupt debounces the levels, turns edges into
+// gestures and queues them lock-free, so a press is timestamped and queued
+// within BUTTON_DEBOUNCE_MS whatever the loop is doing. HybridController
+// drains the queue (pollInput()); the loop's idle wait ends as soon as
+// anything arrives.
+class ButtonInput {
+public:
+    // Starts the timer; call from the task that will wait()
+    static bool begin();
+
+    // Consumer side: next queued gesture, oldest first
+    static bool next(ButtonEvent& event);
+    // Sleeps up to ms; returns true early when a gesture is queued
+    static bool wait(unsigned long ms);
+
+    // One raw sample of one button. This is the interrupt's work; on the
+    // host it is how presses are fed in.
+    static void sample(int button, bool down, uint32_t ms);
+
+    // Whether sample() queued anything since the last call; the interrupt
+    // wakes the waiting task only then
+    static bool takeQueued();
+    // Gestures lost to a full queue
+    static uint32_t getDropped() { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Tracker {
+        bool down;          // debounced level
+        uint8_t disagree;   // consecutive samples at the other level
+        bool longSent;
+        bool doubled;       // this press was the second of a Double
+        bool clickPending;  // released, waiting out BUTTON_DOUBLE_MS
+        uint32_t edgeMs;    // first sample at the other level
+        uint32_t downMs;
+        uint32_t upMs;
+    };
+
+    static void emit(int button, Gesture gesture, uint32_t ms);
+
+    static Tracker trackers[BUTTON_COUNT];
+    static SpscQueue<ButtonEvent, BUTTON_QUEUE_SIZE> events;
+    static std::atomic<uint32_t> dropped;
+    static bool queued;
+};
@@ -0,0 +1,53 @@
+// CountingTFT.h
+#pragma once
+
+#include <TFT_eSPI.h>
+
+// The display, counting SPI transactions. Every drawing primitive the
+// widgets end up in opens its own transaction and sets its own address
+// window (a drawRect is four, a line of text one per character), so a count
+// of the primitives that reach the panel is a count of transactions.
+// Drawing into a sprite never gets here; WidgetCanvas counts its own
+// pushes with countTransaction().
+class CountingTFT : public TFT_eSPI {
+public:
+    CountingTFT() : transactions(0) {}
+
+    void drawPixel(int32_t x, int32_t y, uint32_t color) override {
+        transactions++;
+        TFT_eSPI::drawPixel(x, y, color);
+    }
+    void drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size) override {
+        transactions++;
+        TFT_eSPI::drawChar(x, y, c, color, bg, size);
+    }
+    // The glyph overloads end up in the one above
+    using TFT_eSPI::drawChar;
+    void drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color) override {
+        transactions++;
+        TFT_eSPI::drawLine(xs, ys, xe, ye, color);
+    }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override {
+        transactions++;
+        TFT_eSPI::drawFastVLine(x, y, h, color);
+    }
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override {
+        transactions++;
+        TFT_eSPI::drawFastHLine(x, y, w, color);
+    }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override {
+        transactions++;
+        TFT_eSPI::fillRect(x, y, w, h, color);
+    }
+
+    void countTransaction() { transactions++; }
+    // Transactions since the last call
+    uint32_t takeTransactions() {
+        uint32_t count = transactions;
+        transactions = 0;
+        return count;
+    }
+
+private:
+    uint32_t transactions;
+};
@@ -0,0 +1,233 @@
+// CueTimeline.h
+// Pre-analyzed cue track: beat grid, section markers and animation cues for a
+// known track, generated offline by tools/cue_analyzer and followed on the
+// device by HybridController::followTimeline(). Plain C++ with no Arduino
+// dependencies so the tool can include it.
+//
+// File (little endian):
+//   header   magic "GGCT", version, nameCount, bpmX10 (u16), durationMs (u32),
+//            beatCount (u32), sectionCount (u16), cueCount (u16): 20 bytes
+//   names    nameCount x (length, chars): animations referenced by cues
+//   beats    beatCount varints, ms since the previous beat (the first since 0),
+//            numbered as CueBeatCounter counts them
+//   sections sectionCount x (varint beats since previous start, kind, energy)
+//   cues     cueCount x (varint beats since previous cue, name id, energy, section)
+//
+// Cues name their animation instead of indexing ANIMATION_TABLE so a timeline
+// survives table changes. A cue with CUE_NO_ANIMATION leaves the choice to the
+// device's selector, aimed at the cue's energy level.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "FeatureRecording.h"
+
+#define CUE_MAGIC "GGCT"
+#define CUE_VERSION 1
+#define CUE_HEADER_SIZE 20
+#define CUE_MAX_NAMES 16
+#define CUE_MAX_NAME_LENGTH 31
+#define CUE_MAX_SECTIONS 64
+#define CUE_MAX_CUES 128
+#define CUE_NO_ANIMATION 0xFF
+
+enum CueSectionKind : uint8_t {
+    CUE_SECTION_INTRO = 0,
+    CUE_SECTION_GROOVE,
+    CUE_SECTION_BREAKDOWN,
+    CUE_SECTION_BUILDUP,
+    CUE_SECTION_DROP,
+    CUE_SECTION_OUTRO,
+    CUE_SECTION_KIND_COUNT
+};
+
+inline const char* cueSectionName(uint8_t kind) {
+    static const char* names[] = { "Intro", "Groove", "Breakdown", "Build-up", "Drop", "Outro" };
+    return kind < CUE_SECTION_KIND_COUNT ? names[kind] : "?";
+}
+
+struct CueSectionMarker {
+    uint32_t startBeat;
+    uint8_t kind;
+    uint8_t energy;        // EnergyLevel: 0 low, 1 medium, 2 high
+};
+
+struct CueEvent {
+    uint32_t beat;
+    uint8_t name;          // index into CueTimeline::names, or CUE_NO_ANIMATION
+    uint8_t energy;
+    uint8_t section;
+};
+
+struct CueTimeline {
+    uint16_t bpmX10;
+    uint32_t durationMs;
+    uint32_t beatCount;
+    uint8_t nameCount;
+    char names[CUE_MAX_NAMES][CUE_MAX_NAME_LENGTH + 1];
+    uint16_t sectionCount;
+    CueSectionMarker sections[CUE_MAX_SECTIONS];
+    uint16_t cueCount;
+    CueEvent cues[CUE_MAX_CUES];
+};
+
+// Track beat position, counted the same way by the analyzer and the device so
+// timeline beats line up with the live grid: beat numbering follows the grid
+// from the first tick after it locks, or starts at 0 on the next downbeat when
+// armed while the grid is already running (mid-set). While the grid is lost
+// the counter keeps going at the track's own tempo.
+class CueBeatCounter {
+public:
+    CueBeatCounter() : waitForDownbeat(false), started(false), beat(0), beatMs(0) {}
+
+    void reset(bool startOnDownbeat) {
+        waitForDownbeat = startOnDownbeat;
+        started = false;
+        beat = 0;
+        beatMs = 0;
+    }
+
+    // Once per analysis frame; returns true while counting
+    bool update(unsigned long now, bool locked, bool tick, uint32_t gridIndex, uint8_t beatInBar,
+                unsigned long periodMs) {
+        if (!started) {
+            if (!locked || !tick || (waitForDownbeat && beatInBar != 0)) return false;
+            started = true;
+            beat = waitForDownbeat ? 0 : gridIndex;
+            beatMs = now;
+        } else if (locked) {
+            if (tick) {
+                beat++;
+                beatMs = now;
+            }
+        } else if (periodMs > 0) {
+            while (now - beatMs >= periodMs) {
+                beat++;
+                beatMs += periodMs;
+            }
+        }
+        return true;
+    }
+
+    bool isStarted() const { return started; }
+    uint32_t getBeat() const { return beat; }
+    unsigned long getBeatMs() const { return beatMs; }
+
+private:
+    bool waitForDownbeat;
+    bool started;
+    uint32_t beat;
+    unsigned long beatMs;
+};
+
+// Upper bound on the encoded size, for sizing the write buffer
+inline size_t cueTimelineMaxSize(const CueTimeline& t) {
+    return CUE_HEADER_SIZE + t.nameCount * (CUE_MAX_NAME_LENGTH + 1) + t.beatCount * 5 +
+           t.sectionCount * 7 + t.cueCount * 8;
+}
+
+// Encodes `t` and its beat times (beatCount entries, ascending ms) into `out`;
+// returns the bytes written
+inline size_t writeCueTimeline(const CueTimeline& t, const uint32_t* beatMs, uint8_t* out) {
+    size_t n = 0;
+    memcpy(out, CUE_MAGIC, 4); n += 4;
+    out[n++] = CUE_VERSION;
+    out[n++] = t.nameCount;
+    recordPut16(out + n, t.bpmX10); n += 2;
+    recordPut32(out + n, t.durationMs); n += 4;
+    recordPut32(out + n, t.beatCount); n += 4;
+    recordPut16(out + n, t.sectionCount); n += 2;
+    recordPut16(out + n, t.cueCount); n += 2;
+
+    for (int i = 0; i < t.nameCount; i++) {
+        size_t len = strlen(t.names[i]);
+        out[n++] = (uint8_t)len;
+        memcpy(out + n, t.names[i], len); n += len;
+    }
+
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < t.beatCount; i++) {
+        n += recordPutVarint(out + n, beatMs[i] - prev);
+        prev = beatMs[i];
+    }
+
+    prev = 0;
+    for (int i = 0; i < t.sectionCount; i++) {
+        n += recordPutVarint(out + n, t.sections[i].startBeat - prev);
+        out[n++] = t.sections[i].kind;
+        out[n++] = t.sections[i].energy;
+        prev = t.sections[i].startBeat;
+    }
+
+    prev = 0;
+    for (int i = 0; i < t.cueCount; i++) {
+        n += recordPutVarint(out + n, t.cues[i].beat - prev);
+        out[n++] = t.cues[i].name;
+        out[n++] = t.cues[i].energy;
+        out[n++] = t.cues[i].section;
+        prev = t.cues[i].beat;
+    }
+    return n;
+}
+
+// Decodes a whole file. Beat times are stored to `beatMs` when given (up to
+// maxBeats) and skipped otherwise; the device only needs sections and cues.
+inline bool parseCueTimeline(const uint8_t* in, size_t len, CueTimeline& t,
+                             uint32_t* beatMs = nullptr, size_t maxBeats = 0) {
+    if (len < CUE_HEADER_SIZE || memcmp(in, CUE_MAGIC, 4) != 0 || in[4] != CUE_VERSION) return false;
+    t.nameCount = in[5];
+    t.bpmX10 = recordGet16(in + 6);
+    t.durationMs = recordGet32(in + 8);
+    t.beatCount = recordGet32(in + 12);
+    t.sectionCount = recordGet16(in + 16);
+    t.cueCount = recordGet16(in + 18);
+    if (t.nameCount > CUE_MAX_NAMES || t.sectionCount > CUE_MAX_SECTIONS || t.cueCount > CUE_MAX_CUES) {
+        return false;
+    }
+
+    size_t n = CUE_HEADER_SIZE;
+    for (int i = 0; i < t.nameCount; i++) {
+        if (n >= len) return false;
+        size_t nameLen = in[n++];
+        if (nameLen > CUE_MAX_NAME_LENGTH || n + nameLen > len) return false;
+        memcpy(t.names[i], in + n, nameLen);
+        t.names[i][nameLen] = '\0';
+        n += nameLen;
+    }
+
+    uint32_t v;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < t.beatCount; i++) {
+        size_t used = recordGetVarint(in + n, len - n, v);
+        if (!used) return false;
+        n += used;
+        acc += v;
+        if (beatMs && i < maxBeats) beatMs[i] = acc;
+    }
+
+    acc = 0;
+    for (int i = 0; i < t.sectionCount; i++) {
+        size_t used = recordGetVarint(in + n, len - n, v);
+        if (!used || n + used + 2 > len) return false;
+        n += used;
+        acc += v;
+        t.sections[i].startBeat = acc;
+        t.sections[i].kind = in[n++];
+        t.sections[i].energy = in[n++];
+    }
+
+    acc = 0;
+    for (int i = 0; i < t.cueCount; i++) {
+        size_t used = recordGetVarint(in + n, len - n, v);
+        if (!used || n + used + 3 > len) return false;
+        n += used;
+        acc += v;
+        t.cues[i].beat = acc;
+        t.cues[i].name = in[n++];
+        t.cues[i].energy = in[n++];
+        t.cues[i].section = in[n++];
+        if (t.cues[i].name != CUE_NO_ANIMATION && t.cues[i].name >= t.nameCount) return false;
+    }
+    return true;
+}
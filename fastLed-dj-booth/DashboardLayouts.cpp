@@ -0,0 +1,86 @@
+#include "DashboardLayouts.h"
+#include "config.h"
+
+#define DASHBOARD_WIDGET_NAME(name, minWidth, minHeight) #name,
+static const char* const widgetNames[] = { DASHBOARD_WIDGET_TABLE(DASHBOARD_WIDGET_NAME) };
+#undef DASHBOARD_WIDGET_NAME
+
+#define DASHBOARD_WIDGET_SIZE(name, minWidth, minHeight) { minWidth, minHeight },
+static const uint8_t widgetMinSizes[][2] = { DASHBOARD_WIDGET_TABLE(DASHBOARD_WIDGET_SIZE) };
+#undef DASHBOARD_WIDGET_SIZE
+
+const char* dashboardWidgetName(DashboardWidget widget) {
+    return widgetNames[(int)widget];
+}
+
+void dashboardWidgetMinSize(DashboardWidget widget, int& width, int& height) {
+    width = widgetMinSizes[(int)widget][0];
+    height = widgetMinSizes[(int)widget][1];
+}
+
+typedef DashboardWidget W;
+
+// ILI9341 and friends, landscape: 8 x 8 cells of about 38 x 28
+static const LayoutCell large[] = {
+    { W::BassBar,    1, 5,    0 },
+    { W::MidBar,     1, 5,    0 },
+    { W::TrebleBar,  1, 5,    0 },
+    { W::PowerBar,   1, 5,    0 },
+    { W::Bpm,        4, 1,  250 },
+    { W::Loudness,   4, 1,  250 },
+    { W::Index,      4, 1,  100 },
+    { W::Total,      4, 1, 1000 },
+    { W::Mode,       4, 1,  100 },
+    { W::Waveform,   8, 2,    0 },
+    { W::KeepReason, 4, 1,  500 },
+    { W::Quality,    4, 1,  500 },
+};
+
+// TTGO T-Display, landscape: 8 x 6 cells of about 28 x 21
+static const LayoutCell landscape[] = {
+    { W::BassBar,    1, 4,    0 },
+    { W::MidBar,     1, 4,    0 },
+    { W::TrebleBar,  1, 4,    0 },
+    { W::PowerBar,   1, 4,    0 },
+    { W::Bpm,        4, 1,  250 },
+    { W::Loudness,   4, 1,  250 },
+    { W::Mode,       4, 1,  100 },
+    { W::Index,      4, 1,  100 },
+    { W::Waveform,   8, 1,    0 },
+    { W::Status,     8, 1,  500 },
+};
+
+// TTGO T-Display, portrait: 4 x 10 cells of about 32 x 22
+static const LayoutCell portrait[] = {
+    { W::BassBar,    1, 4,    0 },
+    { W::MidBar,     1, 4,    0 },
+    { W::TrebleBar,  1, 4,    0 },
+    { W::PowerBar,   1, 4,    0 },
+    { W::Bpm,        4, 1,  250 },
+    { W::Loudness,   4, 1,  250 },
+    { W::Waveform,   4, 2,    0 },
+    { W::Index,      4, 1,  100 },
+    { W::Status,     4, 1,  500 },
+};
+
+#define LAYOUT(name, width, height, cols, rows, cells) \
+    { name, width, height, cols, rows, cells, sizeof(cells) / sizeof(cells[0]) }
+
+// Largest first
+const DashboardLayout dashboardLayouts[] = {
+    LAYOUT("Large",     320, 240, 8, 8,  large),
+    LAYOUT("Landscape", 240, 135, 8, 6,  landscape),
+    LAYOUT("Portrait",  135, 240, 4, 10, portrait),
+};
+const int DASHBOARD_LAYOUT_COUNT = sizeof(dashboardLayouts) / sizeof(dashboardLayouts[0]);
+
+#undef LAYOUT
+
+const DashboardLayout& chooseDashboardLayout(int width, int height) {
+    if (DASHBOARD_LAYOUT >= 0 && DASHBOARD_LAYOUT < DASHBOARD_LAYOUT_COUNT) return dashboardLayouts[DASHBOARD_LAYOUT];
+    for (int i = 0; i < DASHBOARD_LAYOUT_COUNT; i++) {
+        if (dashboardLayouts[i].width <= width && dashboardLayouts[i].height <= height) return dashboardLayouts[i];
+    }
+    // Nothing fits: the smallest, with whatever the packer has to cull
+    return dashboardLayouts[DASHBOARD_LAYOUT_COUNT - 1];
+}
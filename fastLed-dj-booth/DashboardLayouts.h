@@ -0,0 +1,56 @@
+// DashboardLayouts.h
+#pragma once
+
+#include <stdint.h>
+
+// What the dashboard can show: X(name, smallest legible width, height)
+#define DASHBOARD_WIDGET_TABLE(X) \
+    X(BassBar,     20, 30) \
+    X(MidBar,      20, 30) \
+    X(TrebleBar,   20, 30) \
+    X(PowerBar,    20, 30) \
+    X(Bpm,         80, 20) \
+    X(Loudness,    80, 20) \
+    X(Waveform,   100, 20) \
+    X(Index,       80, 20) \
+    X(Total,       80, 20) \
+    X(Mode,        70, 20) \
+    X(KeepReason, 120, 18) \
+    X(Quality,    120, 18) \
+    X(Status,     120, 18)    /* quality reason while degraded, else keep reason */
+
+enum class DashboardWidget : uint8_t {
+#define DASHBOARD_WIDGET_ENUM(name, minWidth, minHeight) name,
+    DASHBOARD_WIDGET_TABLE(DASHBOARD_WIDGET_ENUM)
+#undef DASHBOARD_WIDGET_ENUM
+};
+
+const char* dashboardWidgetName(DashboardWidget widget);
+void dashboardWidgetMinSize(DashboardWidget widget, int& width, int& height);
+
+// One widget of a layout: grid columns and rows it spans, and the least time
+// between redraws (0: whenever it changed). Unchanged widgets never redraw.
+struct LayoutCell {
+    DashboardWidget widget;
+    uint8_t colSpan;
+    uint8_t rowSpan;
+    uint16_t refreshMs;
+};
+
+// A dashboard for one screen shape, packed by GridLayout: cells fill the grid
+// in reading order, each at the first free spot its span fits
+struct DashboardLayout {
+    const char* name;
+    uint16_t width;           // screen it was designed for
+    uint16_t height;
+    uint8_t cols;
+    uint8_t rows;
+    const LayoutCell* cells;
+    uint8_t count;
+};
+
+extern const DashboardLayout dashboardLayouts[];
+extern const int DASHBOARD_LAYOUT_COUNT;
+
+// DASHBOARD_LAYOUT if set, else the largest layout that fits the screen
+const DashboardLayout& chooseDashboardLayout(int width, int height);
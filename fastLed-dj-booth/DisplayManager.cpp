@@ -1,9 +1,14 @@
 #include "DisplayManager.h"
 #include "HybridController.h"
-#include "Config.h"
+#include "config.h"
+#include "FrameLog.h"
+#include "FrameArena.h"
+#include "FixedString.h"
+#include "QualityGovernor.h"
 #include "AcronymValueWidget.h"
 #include "WaveformWidget.h"
 #include "VerticalBarWidget.h"
+#include "ModeIndicatorWidget.h"
 #include <Arduino.h>
 
 // Cyberpunk theme colors
@@ -11,30 +16,30 @@
 #define COLOR_PINK   0xF81F
 #define COLOR_YELLOW 0xFFE0
 
-// Define custom WidgetColorTheme instances for color variety
-static WidgetColorTheme purpleTheme { TFT_PURPLE, TFT_WHITE, TFT_PINK, TFT_BLACK };
-static WidgetColorTheme pinkTheme   { TFT_PINK,   TFT_WHITE, TFT_YELLOW, TFT_BLACK };
-static WidgetColorTheme yellowTheme { TFT_YELLOW, TFT_BLACK, TFT_PINK,   TFT_BLACK };
-static WidgetColorTheme redTheme    { TFT_RED,    TFT_WHITE, TFT_YELLOW, TFT_BLACK };
-static WidgetColorTheme blueTheme   { TFT_BLUE,   TFT_WHITE, TFT_CYAN,   TFT_BLACK };
-static WidgetColorTheme orangeTheme { TFT_ORANGE, TFT_BLACK, TFT_YELLOW, TFT_BLACK };
-static WidgetColorTheme cyanTheme   { TFT_CYAN,   TFT_BLACK, TFT_WHITE,  TFT_BLACK };
-static WidgetColorTheme magentaTheme{ TFT_MAGENTA,TFT_WHITE, TFT_YELLOW, TFT_BLACK };
+// Define custom WidgetColorTheme instances for color variety (constexpr: kept in flash)
+static constexpr WidgetColorTheme purpleTheme { TFT_PURPLE, TFT_WHITE, TFT_PINK, TFT_BLACK };
+static constexpr WidgetColorTheme pinkTheme   { TFT_PINK,   TFT_WHITE, TFT_YELLOW, TFT_BLACK };
+static constexpr WidgetColorTheme yellowTheme { TFT_YELLOW, TFT_BLACK, TFT_PINK,   TFT_BLACK };
+static constexpr WidgetColorTheme redTheme    { TFT_RED,    TFT_WHITE, TFT_YELLOW, TFT_BLACK };
+static constexpr WidgetColorTheme blueTheme   { TFT_BLUE,   TFT_WHITE, TFT_CYAN,   TFT_BLACK };
+static constexpr WidgetColorTheme orangeTheme { TFT_ORANGE, TFT_BLACK, TFT_YELLOW, TFT_BLACK };
+static constexpr WidgetColorTheme cyanTheme   { TFT_CYAN,   TFT_BLACK, TFT_WHITE,  TFT_BLACK };
+static constexpr WidgetColorTheme magentaTheme{ TFT_MAGENTA,TFT_WHITE, TFT_YELLOW, TFT_BLACK };
 
 // ReasonTextWidget with required methods
 class ReasonTextWidget : public Widget {
-    String label;
-    String reason;
+    const char* label;
+    FixedString<48> reason;
     const WidgetColorTheme& theme;
 public:
-    ReasonTextWidget(const String& lbl, const String& reasonText, const WidgetColorTheme& themeRef = ThemeManager::get())
+    ReasonTextWidget(const char* lbl, const char* reasonText, const WidgetColorTheme& themeRef = ThemeManager::get())
         : label(lbl), reason(reasonText), theme(themeRef) {}
     void draw(TFT_eSPI& tft, int x, int y, int w, int h) override {
         tft.fillRect(x, y, w, h, theme.background);
         tft.setTextColor(theme.text, theme.background);
         tft.setTextSize(1);
         tft.setCursor(x, y);
-        tft.print(label + ": " + reason);
+        tft.printf("%s: %s", label, reason.c_str());
     }
     int getMinWidth() const override { return 120; }
     int getMinHeight() const override { return 18; }
@@ -42,8 +47,12 @@ public:
     int getTypeId() const override { return 5; }
 };
 
-DisplayManager::DisplayManager(TFT_eSPI &display)
-    : _tft(display), layout(display.width(), display.height()) {}
+DisplayManager::DisplayManager(CountingTFT &display)
+    : _tft(display), canvas(display) {}
+
+void DisplayManager::begin() {
+    canvas.begin();
+}
 
 void DisplayManager::showStartupScreen() {
     _tft.fillScreen(TFT_BLACK);
@@ -56,46 +65,158 @@ void DisplayManager::showStartupScreen() {
     _tft.print("Initializing...");
 }
 
-void DisplayManager::updateAudioVisualization(const AudioFeatures& features, HybridController* hybrid) {
-    Serial.println("[DisplayManager] Drawing new frame");
-    _tft.fillScreen(TFT_BLACK);
-    layout.clear();
+DashboardStatus DisplayManager::captureStatus(HybridController* hybrid) {
+    DashboardStatus status;
+    if (hybrid) {
+        status.hasController = true;
+        status.index = hybrid->getCurrentIndex();
+        status.count = hybrid->getAnimationCount();
+        status.autoSwitch = hybrid->isAutoSwitchEnabled();
+        status.keepReason = hybrid->getModeKeepReason();
+    }
+    status.qualityLevel = QualityGovernor::getLevel();
+    status.qualityReason = QualityGovernor::getReason();
+    status.waveformStep = QualityGovernor::waveformStep();
+    return status;
+}
+
+// FNV-1a over what a widget shows, so unchanged widgets can be skipped
+static uint32_t mixKey(uint32_t key, uint32_t value) {
+    for (int i = 0; i < 4; i++) key = (key ^ ((value >> (i * 8)) & 0xFF)) * 16777619u;
+    return key;
+}
+
+static uint32_t textKey(uint32_t key, const char* text) {
+    while (*text) key = (key ^ (uint8_t)*text++) * 16777619u;
+    return key;
+}
+
+// The widget for one cell, in the frame arena, and the key of its content;
+// null with key 0 for a widget with nothing to show
+Widget* DisplayManager::createWidget(DashboardWidget widget, const AudioFeatures& features,
+                                     const DashboardStatus& status, uint32_t& key) {
+    const uint32_t seed = 2166136261u;
+    bool beat = features.beatDetected;
+    switch (widget) {
+        case DashboardWidget::BassBar:
+            key = mixKey(mixKey(seed, (uint32_t)(features.bass * 1000)), beat);
+            return FrameArena::create<VerticalBarWidget>("BASS", features.bass, purpleTheme, true);
+        case DashboardWidget::MidBar:
+            key = mixKey(mixKey(seed, (uint32_t)(features.mid * 1000)), beat);
+            return FrameArena::create<VerticalBarWidget>("MID", features.mid, yellowTheme, true);
+        case DashboardWidget::TrebleBar:
+            key = mixKey(mixKey(seed, (uint32_t)(features.treble * 1000)), beat);
+            return FrameArena::create<VerticalBarWidget>("TREB", features.treble, pinkTheme, true);
+        case DashboardWidget::PowerBar:
+            key = mixKey(mixKey(seed, features.loudness), beat);
+            return FrameArena::create<VerticalBarWidget>("PWR", features.loudness / 100.0f, redTheme, true);
+        case DashboardWidget::Bpm:
+            key = mixKey(mixKey(seed, (uint32_t)features.bpm), beat);
+            return FrameArena::create<AcronymValueWidget>("BPM", static_cast<int>(features.bpm), beat ? pinkTheme : purpleTheme);
+        case DashboardWidget::Loudness:
+            key = mixKey(seed, features.loudness);
+            return FrameArena::create<AcronymValueWidget>("PWR", static_cast<int>(features.loudness), purpleTheme);
+        case DashboardWidget::Waveform:
+            if (!features.waveform) {
+                if (!status.playback) Serial.println("[DisplayManager] WARNING: Null waveform pointer in features!");
+                key = 0;
+                return nullptr;
+            }
+            // A new capture every drawing
+            key = mixKey(mixKey(seed, (uint32_t)millis()), beat);
+            return FrameArena::create<WaveformWidget>(features.waveform, NUM_SAMPLES, magentaTheme, beat,
+                                                      status.waveformStep);
+        default:
+            break;
+    }
 
-    Serial.printf("[DisplayManager] features: vol=%.3f, bass=%.3f, mid=%.3f, treb=%.3f, beat=%d, bpm=%.2f, loud=%d\n",
+    if (!status.hasController && widget != DashboardWidget::Quality) {
+        key = 0;
+        return nullptr;
+    }
+    bool degraded = status.qualityLevel > 0;
+    switch (widget) {
+        case DashboardWidget::Index:
+            key = mixKey(seed, status.index);
+            return FrameArena::create<AcronymValueWidget>("IDX", status.index + 1, yellowTheme);
+        case DashboardWidget::Total:
+            key = mixKey(seed, status.count);
+            return FrameArena::create<AcronymValueWidget>("TOT", status.count, pinkTheme);
+        case DashboardWidget::Mode:
+            key = mixKey(seed, status.autoSwitch);
+            return FrameArena::create<ModeIndicatorWidget>(status.autoSwitch, blueTheme);
+        case DashboardWidget::KeepReason:
+            key = textKey(seed, status.keepReason.c_str());
+            return FrameArena::create<ReasonTextWidget>("KEEP REASON", status.keepReason.c_str(), cyanTheme);
+        case DashboardWidget::Quality:
+            if (!degraded) {
+                key = 0;
+                return nullptr;
+            }
+            key = textKey(seed, status.qualityReason.c_str());
+            return FrameArena::create<ReasonTextWidget>("QUALITY", status.qualityReason.c_str(), orangeTheme);
+        case DashboardWidget::Status:
+            // The governor's reason while it has stepped down, which matters more
+            if (degraded) {
+                key = textKey(mixKey(seed, 1), status.qualityReason.c_str());
+                return FrameArena::create<ReasonTextWidget>("QUALITY", status.qualityReason.c_str(), orangeTheme);
+            }
+            key = textKey(seed, status.keepReason.c_str());
+            return FrameArena::create<ReasonTextWidget>("KEEP", status.keepReason.c_str(), cyanTheme);
+        default:
+            key = 0;
+            return nullptr;
+    }
+}
+
+void DisplayManager::updateAudioVisualization(const AudioFeatures& features, const DashboardStatus& status) {
+    FRAME_LOG("[DisplayManager] Drawing new frame\n");
+    // Only the drawing task uses the arena, so each drawing starts it afresh
+    FrameArena::reset();
+
+    // Packed on the first drawing, once the display has its rotation
+    int width = _tft.width(), height = _tft.height();
+    if (!layout.isPackedFor(width, height)) {
+        layout.pack(chooseDashboardLayout(width, height), width, height);
+        _tft.fillScreen(TFT_BLACK);
+    }
+
+    FRAME_LOG("[DisplayManager] features: vol=%.3f, bass=%.3f, mid=%.3f, treb=%.3f, beat=%d, bpm=%.2f, loud=%d\n",
         features.volume, features.bass, features.mid, features.treble, features.beatDetected, features.bpm, features.loudness);
 
-    const WidgetColorTheme& pulseTheme = features.beatDetected ? pinkTheme : purpleTheme;
-
-    layout.addWidget(std::unique_ptr<VerticalBarWidget>(new VerticalBarWidget("BASS", features.bass, purpleTheme, true)));
-    layout.addWidget(std::unique_ptr<VerticalBarWidget>(new VerticalBarWidget("MID", features.mid, yellowTheme, true)));
-    layout.addWidget(std::unique_ptr<VerticalBarWidget>(new VerticalBarWidget("TREB", features.treble, pinkTheme, true)));
-    layout.addWidget(std::unique_ptr<VerticalBarWidget>(new VerticalBarWidget("PWR", features.loudness / 100.0f, redTheme, true)));
-    layout.addWidget(std::unique_ptr<AcronymValueWidget>(new AcronymValueWidget("BPM", static_cast<int>(features.bpm), pulseTheme)));
-    layout.addWidget(std::unique_ptr<AcronymValueWidget>(new AcronymValueWidget("PWR", static_cast<int>(features.loudness), purpleTheme)));
-    
-    // Explicitly check the waveform pointer
-    Serial.printf("[DisplayManager] Waveform pointer: %p\n", features.waveform);
-    if (!features.waveform) {
-        Serial.println("[DisplayManager] WARNING: Null waveform pointer in features!");
-    } else {
-        try {
-            layout.addWidget(std::unique_ptr<WaveformWidget>(new WaveformWidget(features.waveform, NUM_SAMPLES, magentaTheme, features.beatDetected)));
-            Serial.println("[DisplayManager] Added waveform widget successfully");
-        } catch (const std::exception& e) {
-            Serial.printf("[DisplayManager] Exception creating waveform widget: %s\n", e.what());
-        } catch (...) {
-            Serial.println("[DisplayManager] Unknown exception creating waveform widget");
+    unsigned long now = millis();
+    widgetsDrawn = 0;
+    _tft.takeTransactions();
+    canvas.beginFrame();
+    for (size_t i = 0; i < layout.size(); i++) {
+        uint32_t key = 0;
+        Widget* widget = createWidget(layout.widgetAt(i), features, status, key);
+        if (!widget && key != 0) {
+            Serial.println("[DisplayManager] ERROR: Frame arena full, widget dropped");
+            continue;
+        }
+        if (layout.needsDraw(i, key, now)) {
+            layout.draw(canvas, i, widget, key, now);
+            widgetsDrawn++;
         }
+        // The widgets' arena memory is reused next drawing
+        if (widget) widget->~Widget();
     }
+    canvas.endFrame();
 
-    if (hybrid) {
-        layout.addWidget(std::unique_ptr<AcronymValueWidget>(new AcronymValueWidget("IDX", hybrid->getCurrentIndex() + 1, yellowTheme)));
-        layout.addWidget(std::unique_ptr<AcronymValueWidget>(new AcronymValueWidget("TOT", hybrid->getAnimationCount(), pinkTheme)));
-        layout.addWidget(std::unique_ptr<AcronymValueWidget>(new AcronymValueWidget(hybrid->isAutoSwitchEnabled() ? "AUTO" : "MAN", 1, blueTheme)));
-        layout.addWidget(std::unique_ptr<AcronymValueWidget>(new AcronymValueWidget("KEEP", 1, orangeTheme)));
-        layout.addWidget(std::unique_ptr<ReasonTextWidget>(new ReasonTextWidget("KEEP REASON", hybrid->getModeKeepReason(), cyanTheme)));
-    }
+    uint32_t count = _tft.takeTransactions();
+    drawings.fetch_add(1, std::memory_order_relaxed);
+    transactions.fetch_add(count, std::memory_order_relaxed);
+    if (count > peakTransactions.load(std::memory_order_relaxed)) peakTransactions.store(count, std::memory_order_relaxed);
+    FRAME_LOG("[DisplayManager] %u of %u widgets drawn, %u SPI transactions\n",
+              (unsigned)widgetsDrawn, (unsigned)layout.size(), (unsigned)count);
+}
 
-    // Draw all widgets in a vertical stack (no direct access to widgets)
-    layout.drawVerticalStack(_tft);
-}
\ No newline at end of file
+void DisplayManager::report() {
+    uint32_t n = drawings.exchange(0, std::memory_order_relaxed);
+    uint32_t total = transactions.exchange(0, std::memory_order_relaxed);
+    uint32_t peak = peakTransactions.exchange(0, std::memory_order_relaxed);
+    if (n == 0) return;
+    Serial.printf("[Display] %u drawings, %.1f SPI transactions each (peak %u), %s\n",
+                  (unsigned)n, (float)total / n, (unsigned)peak, canvas.isBatching() ? "batched" : "direct");
+}
@@ -2,18 +2,53 @@
 #pragma once
 
 #include <TFT_eSPI.h>
+#include <atomic>
+#include "CountingTFT.h"
 #include "GridLayout.h"
+#include "WidgetCanvas.h"
 #include "AudioProcessor.h"
 #include "HybridController.h" // <-- Add this include
+#include "FixedString.h"
+
+// Everything on the dashboard besides the audio features. Captured on the
+// render core so the TFT can be drawn from the output core without reaching
+// into HybridController or QualityGovernor while they change.
+struct DashboardStatus {
+    bool hasController = false;
+    int index = 0;
+    int count = 0;
+    bool autoSwitch = false;
+    FixedString<32> keepReason;
+    uint8_t qualityLevel = 0;
+    FixedString<48> qualityReason;
+    int waveformStep = 1;
+    bool playback = false;        // features from a recording, which has no waveform
+};
 
 class DisplayManager {
 private:
-    TFT_eSPI& _tft;
+    CountingTFT& _tft;
     GridLayout layout;
+    WidgetCanvas canvas;
+    size_t widgetsDrawn = 0;
+    // SPI transactions of the drawings since the last report
+    std::atomic<uint32_t> drawings{0};
+    std::atomic<uint32_t> transactions{0};
+    std::atomic<uint32_t> peakTransactions{0};
+
+    Widget* createWidget(DashboardWidget widget, const AudioFeatures& features, const DashboardStatus& status,
+                         uint32_t& key);
 
 public:
-    DisplayManager(TFT_eSPI& display); // Declare constructor only once
+    DisplayManager(CountingTFT& display); // Declare constructor only once
+    // After tft.init(): sets up the widget canvas
+    void begin();
     void showStartupScreen();
-    void updateAudioVisualization(const AudioFeatures& features, HybridController* hybrid);
+    static DashboardStatus captureStatus(HybridController* hybrid);
+    // Redraws the widgets of the dashboard layout whose content changed
+    void updateAudioVisualization(const AudioFeatures& features, const DashboardStatus& status);
+    size_t getWidgetsDrawn() const { return widgetsDrawn; }
+    // Prints SPI transactions per drawing since the last report
+    void report();
     void drawFFTWaterfall(const double* fft, int bins);
 };
\ No newline at end of file
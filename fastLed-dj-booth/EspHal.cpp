@@ -0,0 +1,49 @@
+#include "EspHal.h"
+#include "config.h"
+#include <Arduino.h>
+#include <FastLED.h>
+#include <driver/i2s.h>
+
+#define I2S_PORT I2S_NUM_0
+
+bool I2sAudioSource::begin() {
+    const i2s_config_t i2s_config = {
+        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
+        .sample_rate = SAMPLE_RATE,
+        .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
+        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+        .intr_alloc_flags = 0,
+        .dma_buf_count = 8,
+        .dma_buf_len = 64,
+        .use_apll = false,
+        .tx_desc_auto_clear = false,
+        .fixed_mclk = 0
+    };
+
+    const i2s_pin_config_t pin_config = {
+        .bck_io_num = I2S_SCK,
+        .ws_io_num = I2S_WS,
+        .data_out_num = -1,
+        .data_in_num = I2S_SD
+    };
+
+    if (i2s_driver_install(I2S_PORT, &i2s_config, 0, NULL) != ESP_OK) return false;
+    i2s_set_pin(I2S_PORT, &pin_config);
+    i2s_start(I2S_PORT);
+    return true;
+}
+
+int I2sAudioSource::read(int32_t* samples, int count) {
+    size_t bytesRead = 0;
+    i2s_read(I2S_PORT, (void*)samples, count * sizeof(int32_t), &bytesRead, portMAX_DELAY);
+    return bytesRead / sizeof(int32_t);
+}
+
+void FastLedSink::show(const CRGB* leds, int count, uint8_t brightness, uint8_t dither) {
+    // FastLED only reads the buffer
+    FastLED[0].setLeds(const_cast<CRGB*>(leds), count);
+    FastLED.setBrightness(brightness);
+    FastLED.setDither(dither);
+    FastLED.show();
+}
@@ -0,0 +1,17 @@
+// EspHal.h
+// The ESP32 side of Hal.h: the I2S microphone and FastLED's strip
+#pragma once
+
+#include "Hal.h"
+
+class I2sAudioSource : public AudioSource {
+public:
+    bool begin() override;
+    int read(int32_t* samples, int count) override;
+};
+
+// Shows any CRGB buffer on the strip registered with FastLED.addLeds()
+class FastLedSink : public LedSink {
+public:
+    void show(const CRGB* leds, int count, uint8_t brightness, uint8_t dither) override;
+};
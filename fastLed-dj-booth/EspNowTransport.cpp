@@ -0,0 +1,70 @@
+#include "EspNowTransport.h"
+#include "config.h"
+#include <WiFi.h>
+#include <esp_wifi.h>
+
+#define SYNC_QUEUE_DEPTH 16
+
+static const uint8_t broadcastAddress[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+QueueHandle_t EspNowTransport::queue = nullptr;
+volatile uint32_t EspNowTransport::dropped = 0;
+
+bool EspNowTransport::begin(uint8_t channel) {
+    if (!queue) queue = xQueueCreate(SYNC_QUEUE_DEPTH, sizeof(Datagram));
+    if (!queue) return false;
+
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+    esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    if (esp_now_init() != ESP_OK) {
+        Serial.println("[Sync] ESP-NOW init failed");
+        return false;
+    }
+
+    esp_now_peer_info_t peer;
+    memset(&peer, 0, sizeof(peer));
+    memcpy(peer.peer_addr, broadcastAddress, sizeof(broadcastAddress));
+    peer.channel = channel;
+    peer.encrypt = false;
+    if (esp_now_add_peer(&peer) != ESP_OK) {
+        Serial.println("[Sync] ESP-NOW broadcast peer failed");
+        return false;
+    }
+    esp_now_register_recv_cb(onReceive);
+    Serial.printf("[Sync] ESP-NOW on channel %u\n", channel);
+    return true;
+}
+
+bool EspNowTransport::send(const uint8_t* data, size_t len) {
+    return esp_now_send(broadcastAddress, data, len) == ESP_OK;
+}
+
+size_t EspNowTransport::receive(uint8_t* data, size_t capacity, unsigned long& arrivedMs) {
+    Datagram datagram;
+    if (!queue || xQueueReceive(queue, &datagram, 0) != pdTRUE) return 0;
+    size_t len = datagram.len < capacity ? datagram.len : capacity;
+    memcpy(data, datagram.data, len);
+    arrivedMs = datagram.arrivedMs;
+    return len;
+}
+
+// On the Wi-Fi task: never block it
+void EspNowTransport::enqueue(const uint8_t* data, int len) {
+    if (len <= 0 || len > SYNC_MAX_PACKET) return;
+    Datagram datagram;
+    datagram.arrivedMs = millis();
+    datagram.len = len;
+    memcpy(datagram.data, data, len);
+    if (xQueueSend(queue, &datagram, 0) != pdTRUE) dropped++;
+}
+
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+void EspNowTransport::onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
+    enqueue(data, len);
+}
+#else
+void EspNowTransport::onReceive(const uint8_t* mac, const uint8_t* data, int len) {
+    enqueue(data, len);
+}
+#endif
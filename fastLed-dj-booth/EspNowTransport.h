@@ -0,0 +1,35 @@
+// EspNowTransport.h
+#pragma once
+#include <Arduino.h>
+#include <esp_now.h>
+#include "SyncLink.h"
+
+// SyncTransport over ESP-NOW broadcast: no access point, a few ms from one
+// booth controller to the next. All nodes must share the Wi-Fi channel.
+// Datagrams arrive on the Wi-Fi task and wait in a small queue for receive().
+class EspNowTransport : public SyncTransport {
+public:
+    bool begin(uint8_t channel);
+
+    bool send(const uint8_t* data, size_t len) override;
+    size_t receive(uint8_t* data, size_t capacity, unsigned long& arrivedMs) override;
+
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    struct Datagram {
+        uint32_t arrivedMs;
+        uint8_t len;
+        uint8_t data[SYNC_MAX_PACKET];
+    };
+
+    static QueueHandle_t queue;
+    static volatile uint32_t dropped;
+
+    static void enqueue(const uint8_t* data, int len);
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    static void onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int len);
+#else
+    static void onReceive(const uint8_t* mac, const uint8_t* data, int len);
+#endif
+};
@@ -0,0 +1,91 @@
+#include "FeatureExtractor.h"
+#include "TuningParams.h"
+#include <math.h>
+
+FeatureExtractor::FeatureExtractor(int fftSize, double sampleRate) {
+    // Frequency band bin mapping
+    bassLimit = (int)(200.0 * fftSize / sampleRate);
+    midLimit  = (int)(2000.0 * fftSize / sampleRate);
+    trebleLimit = fftSize / 2;
+    // Band averages of broadband material grow with sqrt(N); keep other sizes
+    // on the scale the divisors expect (exactly 1 on the device)
+    bandScale = sqrt((double)FEATURE_REFERENCE_FFT / fftSize);
+    reset();
+}
+
+// Forget all smoothing/beat history so a fixed input always yields the same features
+void FeatureExtractor::reset() {
+    previousVolume = 0.0;
+    lastBeatTime = 0;
+    currentBPM = 0.0;
+    normalizedVolume = 0.0;
+    smoothedLoudness = 0.0;
+    for (int b = 0; b < GAIN_BAND_COUNT; b++) ungainedBands[b] = 0.0;
+    beatGrid.reset();
+    autoGain.reset();
+}
+
+double FeatureExtractor::measureVolume(double* samples, int count) {
+    double sumSquares = 0.0;
+    for (int i = 0; i < count; i++) {
+        if (samples[i] < -1.0) samples[i] = -1.0;
+        else if (samples[i] > 1.0) samples[i] = 1.0;
+        sumSquares += samples[i] * samples[i];
+    }
+    return sqrt(sumSquares / count);
+}
+
+void FeatureExtractor::process(double rawVolume, const double* magnitudes, unsigned long now, AudioFeatures& features) {
+    // Band levels on the divisors' scale, one pass over the spectrum
+    double bassSum = 0.0, midSum = 0.0, trebleSum = 0.0;
+
+    for (int i = 0; i < bassLimit; i++) bassSum += magnitudes[i];
+    for (int i = bassLimit; i < midLimit; i++) midSum += magnitudes[i];
+    for (int i = midLimit; i < trebleLimit; i++) trebleSum += magnitudes[i];
+
+    double bands[GAIN_BAND_COUNT];
+    bands[GAIN_BASS] = (bassSum / bassLimit) * bandScale / tuning.bassDivisor;
+    bands[GAIN_MID] = (midSum / (midLimit - bassLimit)) * bandScale / tuning.midDivisor;
+    bands[GAIN_TREBLE] = (trebleSum / (trebleLimit - midLimit)) * bandScale / tuning.trebleDivisor;
+
+    for (int b = 0; b < GAIN_BAND_COUNT; b++) ungainedBands[b] = bands[b];
+
+    // Gain, gate and per-band normalization (0.0 – 1.0)
+    double volume = autoGain.process(rawVolume, bands, now);
+    features.bass = bands[GAIN_BASS];
+    features.mid = bands[GAIN_MID];
+    features.treble = bands[GAIN_TREBLE];
+
+    normalizedVolume = tuning.gainSmoothing * normalizedVolume + (1 - tuning.gainSmoothing) * volume;
+    features.volume = normalizedVolume;
+
+    // Loudness: scale volume to 0–100
+    float rawLoudness = features.volume * 100.0f;
+    smoothedLoudness = 0.9f * smoothedLoudness + 0.1f * rawLoudness;
+    features.loudness = (int)(smoothedLoudness < 0 ? 0 : (smoothedLoudness > 100 ? 100 : smoothedLoudness));
+
+    // Beat detection, on the frame's own level: the smoothed volume moves by
+    // at most (1 - gainSmoothing) a frame, never past beatThreshold
+    double volumeChange = volume - previousVolume;
+    if (volumeChange > tuning.beatThreshold && (now - lastBeatTime) > (unsigned long)tuning.beatMinMs) {
+        features.beatDetected = true;
+        unsigned long beatInterval = now - lastBeatTime;
+        if (beatInterval > (unsigned long)tuning.beatMinMs && beatInterval < 2000) {
+            currentBPM = 60000.0 / beatInterval;
+        }
+        lastBeatTime = now;
+    } else {
+        features.beatDetected = false;
+    }
+    features.bpm = currentBPM;
+
+    beatGrid.update(now, features.beatDetected, currentBPM);
+    features.gridLocked = beatGrid.isLocked();
+    features.gridBeat = beatGrid.isBeatTick();
+    features.beatIndex = beatGrid.getBeatIndex();
+    features.beatInBar = beatGrid.getBeatInBar();
+    features.bar = beatGrid.getBar();
+    features.beatPhase = beatGrid.getBeatPhase(now);
+
+    previousVolume = volume;
+}
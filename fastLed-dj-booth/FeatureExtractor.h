@@ -0,0 +1,47 @@
+// FeatureExtractor.h
+#pragma once
+
+#include <stdint.h>
+#include "AudioFeatures.h"
+#include "BeatGrid.h"
+#include "AutoGain.h"
+
+// FFT size the band divisors in TuningParams were tuned at
+#define FEATURE_REFERENCE_FFT 512
+
+// The feature math behind AudioProcessor: gain and noise gate (AutoGain),
+// volume, loudness, onsets/BPM, the beat grid and band levels from one frame of samples and its magnitude spectrum.
+// Plain C++ so tools/cue_analyzer runs the same code over audio files, at any
+// FFT size. The FFT itself stays with the caller (arduinoFFT on the device).
+class FeatureExtractor {
+public:
+    FeatureExtractor(int fftSize, double sampleRate);
+
+    void reset();
+    // Clamps samples to -1..1 in place and returns their RMS
+    static double measureVolume(double* samples, int count);
+    // Fills everything but spectrum and waveform. `magnitudes` holds fftSize/2 bins.
+    void process(double rawVolume, const double* magnitudes, unsigned long now, AudioFeatures& features);
+
+    float getCurrentBPM() const { return currentBPM; }
+    float getNormalizedVolume() const { return normalizedVolume; }
+    const BeatGrid& getBeatGrid() const { return beatGrid; }
+    const GainState& getGainState() const { return autoGain.getState(); }
+    // The last frame's band levels before the gain, indexed by GAIN_BASS etc.
+    double getUngainedBand(int band) const { return ungainedBands[band]; }
+
+private:
+    int bassLimit;
+    int midLimit;
+    int trebleLimit;
+    double bandScale;
+
+    double previousVolume;
+    unsigned long lastBeatTime;
+    float currentBPM;
+    float normalizedVolume;
+    float smoothedLoudness;
+    double ungainedBands[GAIN_BAND_COUNT];
+    BeatGrid beatGrid;
+    AutoGain autoGain;
+};
@@ -0,0 +1,223 @@
+#include "FeatureRecorder.h"
+#include "FrameClock.h"
+#include "BeatGrid.h"
+#include <FastLED.h>
+
+static uint16_t unitToQ16(double v) {
+    return v <= 0.0 ? 0 : (v >= 1.0 ? 65535 : (uint16_t)(v * 65535.0 + 0.5));
+}
+
+RecordedFrame toRecordedFrame(const AudioFeatures& features, unsigned long now, uint16_t rngSeed) {
+    RecordedFrame f;
+    f.timeMs = now;
+    f.volume = unitToQ16(features.volume);
+    f.bass = unitToQ16(features.bass);
+    f.mid = unitToQ16(features.mid);
+    f.treble = unitToQ16(features.treble);
+    f.bpmX10 = (uint16_t)constrain(features.bpm * 10.0, 0.0, 65535.0);
+    f.loudness = constrain(features.loudness, 0, 255);
+    f.flags = (features.beatDetected ? RECORD_FLAG_BEAT : 0) |
+              (features.gridLocked ? RECORD_FLAG_GRID_LOCKED : 0) |
+              (features.gridBeat ? RECORD_FLAG_GRID_BEAT : 0);
+    f.beatPhase = (uint8_t)constrain(features.beatPhase * 255.0f, 0.0f, 255.0f);
+    f.beatIndex = features.beatIndex;
+    f.rngSeed = rngSeed;
+    return f;
+}
+
+// Spectrum and waveform are not recorded; playback leaves them empty
+void fromRecordedFrame(const RecordedFrame& frame, AudioFeatures& features) {
+    features.volume = frame.volume / 65535.0;
+    features.bass = frame.bass / 65535.0;
+    features.mid = frame.mid / 65535.0;
+    features.treble = frame.treble / 65535.0;
+    features.bpm = frame.bpmX10 / 10.0;
+    features.loudness = frame.loudness;
+    features.beatDetected = frame.flags & RECORD_FLAG_BEAT;
+    features.gridLocked = frame.flags & RECORD_FLAG_GRID_LOCKED;
+    features.gridBeat = frame.flags & RECORD_FLAG_GRID_BEAT;
+    features.beatPhase = frame.beatPhase / 255.0f;
+    features.beatIndex = frame.beatIndex;
+    features.beatInBar = frame.beatIndex % BeatGrid::BEATS_PER_BAR;
+    features.bar = frame.beatIndex / BeatGrid::BEATS_PER_BAR;
+    features.waveform = nullptr;
+}
+
+FeatureRecorder::FeatureRecorder()
+    : head(0), tail(0), recording(false), gapPending(false),
+      frames(0), droppedFrames(0), bytesWritten(0) {}
+
+bool FeatureRecorder::begin(const char* path) {
+    if (!LittleFS.begin(true)) {
+        Serial.println("[FeatureRecorder] LittleFS mount failed");
+        return false;
+    }
+    file = LittleFS.open(path, "w");
+    if (!file) {
+        Serial.printf("[FeatureRecorder] Cannot open %s\n", path);
+        return false;
+    }
+
+    RecordingHeader header;
+    memcpy(header.magic, RECORDING_MAGIC, 4);
+    header.version = RECORDING_VERSION;
+    header.keyframeInterval = RECORDING_KEYFRAME_INTERVAL;
+    header.rngSeed = random16_get_seed();
+    header.startMs = FrameClock::now();
+    header.reserved = 0;
+    file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+
+    head = tail = 0;
+    frames = droppedFrames = 0;
+    bytesWritten = sizeof(header);
+    gapPending = false;
+    encoder.forceKeyframe();
+    recording = true;
+    Serial.printf("[FeatureRecorder] Recording to %s\n", path);
+    return true;
+}
+
+void FeatureRecorder::end() {
+    if (!recording) return;
+    // Drain what is left; this one may take a while, but it is not in a show frame.
+    // A write that takes nothing (flash full, write error) won't take the rest either.
+    while (used() > 0) {
+        uint32_t before = bytesWritten;
+        service();
+        if (bytesWritten == before) break;
+    }
+    unsigned lost = used();
+    head = tail = 0;
+    file.close();
+    recording = false;
+    Serial.printf("[FeatureRecorder] %u frames, %u dropped, %u bytes, %u lost\n", frames, droppedFrames, bytesWritten,
+                  lost);
+}
+
+bool FeatureRecorder::push(const uint8_t* data, size_t len) {
+    if (RECORDER_BUFFER_SIZE - 1 - used() < len) return false;
+    for (size_t i = 0; i < len; i++) {
+        ring[head] = data[i];
+        head = (head + 1) % RECORDER_BUFFER_SIZE;
+    }
+    return true;
+}
+
+void FeatureRecorder::record(const AudioFeatures& features, uint16_t rngSeed) {
+    if (!recording) return;
+
+    uint8_t record[RECORDING_MAX_RECORD + 1];
+    size_t n = 0;
+    if (gapPending) {
+        // Resume after a gap with a keyframe so the reader resynchronizes
+        record[n++] = RECORD_GAP;
+        encoder.forceKeyframe();
+    }
+    // Encode into a copy first: a rejected frame must not advance the delta state
+    FeatureEncoder attempt = encoder;
+    n += attempt.encodeFrame(toRecordedFrame(features, FrameClock::now(), rngSeed), record + n);
+
+    if (push(record, n)) {
+        encoder = attempt;
+        gapPending = false;
+        frames++;
+    } else {
+        gapPending = true;
+        droppedFrames++;
+    }
+}
+
+void FeatureRecorder::recordSwitch(int from, int to, const char* reason) {
+    if (!recording || gapPending) return;
+    uint8_t record[RECORDING_MAX_RECORD];
+    size_t n = FeatureEncoder::encodeEvent(from, to, reason, record);
+    if (!push(record, n)) gapPending = true;
+}
+
+void FeatureRecorder::service() {
+    if (!recording) return;
+    size_t budget = RECORDER_FLUSH_BYTES;
+    while (budget > 0 && used() > 0) {
+        // Contiguous run up to the ring's end
+        size_t run = head >= tail ? head - tail : RECORDER_BUFFER_SIZE - tail;
+        if (run > budget) run = budget;
+        size_t written = file.write(ring + tail, run);
+        tail = (tail + written) % RECORDER_BUFFER_SIZE;
+        bytesWritten += written;
+        budget -= run;
+        if (written < run) break;
+    }
+}
+
+FeaturePlayer::FeaturePlayer() : length(0), playing(false), eventPending(false) {}
+
+bool FeaturePlayer::begin(const char* path) {
+    if (!LittleFS.begin(false)) {
+        Serial.println("[FeaturePlayer] LittleFS mount failed");
+        return false;
+    }
+    file = LittleFS.open(path, "r");
+    if (!file) {
+        Serial.printf("[FeaturePlayer] Cannot open %s\n", path);
+        return false;
+    }
+    if (file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, RECORDING_MAGIC, 4) != 0 || header.version != RECORDING_VERSION) {
+        Serial.printf("[FeaturePlayer] %s is not a feature recording\n", path);
+        file.close();
+        return false;
+    }
+
+    random16_set_seed(header.rngSeed);
+    decoder = FeatureDecoder();
+    length = 0;
+    eventPending = false;
+    playing = true;
+    Serial.printf("[FeaturePlayer] Playing %s\n", path);
+    return true;
+}
+
+void FeaturePlayer::end() {
+    if (!playing) return;
+    file.close();
+    playing = false;
+    FrameClock::release();
+}
+
+// False at end of file, and when a full buffer still doesn't hold a record
+bool FeaturePlayer::fill() {
+    if (length == sizeof(buffer)) return false;
+    size_t got = file.read(buffer + length, sizeof(buffer) - length);
+    length += got;
+    return got > 0;
+}
+
+bool FeaturePlayer::next(AudioFeatures& features) {
+    if (!playing) return false;
+
+    while (true) {
+        size_t consumed = 0;
+        RecordedFrame frame;
+        FeatureDecoder::Result result = decoder.decode(buffer, length, consumed, frame, event);
+        if (result == FeatureDecoder::NEED_MORE) {
+            if (!fill()) {
+                end();
+                return false;
+            }
+            continue;
+        }
+
+        memmove(buffer, buffer + consumed, length - consumed);
+        length -= consumed;
+
+        if (result == FeatureDecoder::EVENT) {
+            eventPending = true;
+        } else if (result == FeatureDecoder::FRAME) {
+            fromRecordedFrame(frame, features);
+            FrameClock::freeze(frame.timeMs);
+            random16_set_seed(frame.rngSeed);
+            return true;
+        }
+        // GAP and CORRUPT records are skipped until the next keyframe
+    }
+}
@@ -0,0 +1,82 @@
+// FeatureRecorder.h
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "AudioProcessor.h"
+#include "FeatureRecording.h"
+
+#define RECORDER_BUFFER_SIZE 4096
+// Bytes written to flash per loop; bounds the time a flush can take
+#define RECORDER_FLUSH_BYTES 512
+
+RecordedFrame toRecordedFrame(const AudioFeatures& features, unsigned long now, uint16_t rngSeed);
+void fromRecordedFrame(const RecordedFrame& frame, AudioFeatures& features);
+
+// Records the feature stream and switch decisions to LittleFS. record() only
+// encodes into a RAM ring buffer; service() writes at most RECORDER_FLUSH_BYTES
+// per call so the loop never waits on a large flash write. If the buffer
+// fills, frames are dropped and a GAP record marks the hole.
+class FeatureRecorder {
+public:
+    FeatureRecorder();
+
+    bool begin(const char* path);
+    void end();
+    bool isRecording() const { return recording; }
+
+    // `rngSeed`: random16_get_seed() before the frame was rendered
+    void record(const AudioFeatures& features, uint16_t rngSeed);
+    void recordSwitch(int from, int to, const char* reason);
+    void service();
+
+    uint32_t getFrames() const { return frames; }
+    uint32_t getDroppedFrames() const { return droppedFrames; }
+    uint32_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    File file;
+    FeatureEncoder encoder;
+    uint8_t ring[RECORDER_BUFFER_SIZE];
+    size_t head;
+    size_t tail;
+    bool recording;
+    bool gapPending;
+    uint32_t frames;
+    uint32_t droppedFrames;
+    uint32_t bytesWritten;
+
+    size_t used() const { return (head + RECORDER_BUFFER_SIZE - tail) % RECORDER_BUFFER_SIZE; }
+    bool push(const uint8_t* data, size_t len);
+};
+
+// Reads a recording back as AudioFeatures. The FrameClock is frozen to each
+// frame's recorded time and the FastLED RNG reseeded with the frame's seed,
+// so animations render exactly as they did in the recorded show even where
+// something else drew random numbers between frames.
+class FeaturePlayer {
+public:
+    FeaturePlayer();
+
+    bool begin(const char* path);
+    void end();
+    bool isPlaying() const { return playing; }
+
+    // Fills `features` with the next frame; false at end of file. Switch events
+    // recorded after the previous frame are reported through getEvent().
+    bool next(AudioFeatures& features);
+    bool hasEvent() const { return eventPending; }
+    const RecordedEvent& getEvent() { eventPending = false; return event; }
+
+private:
+    File file;
+    FeatureDecoder decoder;
+    RecordingHeader header;
+    uint8_t buffer[256];
+    size_t length;
+    bool playing;
+    bool eventPending;
+    RecordedEvent event;
+
+    bool fill();
+};
@@ -0,0 +1,249 @@
+// FeatureRecording.h
+// Compact recording format for the per-frame feature stream and controller
+// decisions. Plain C++ with no Arduino dependencies so tools/feature_inspect
+// can include it.
+//
+// File: 16-byte header, then records. Each record starts with a tag byte:
+//   KEY   full quantized frame, written every keyframeInterval frames and
+//         after any gap, so a reader can start from any keyframe
+//   DELTA zigzag varint differences from the previous frame (4-14 bytes typ.)
+//   EVENT an animation switch made by HybridController after the previous frame
+//   GAP   frames were dropped because the writer fell behind
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define RECORDING_MAGIC "GGFR"
+#define RECORDING_VERSION 2
+#define RECORDING_KEYFRAME_INTERVAL 64
+// Largest encoded record (an EVENT with a full-length reason)
+#define RECORDING_MAX_RECORD 72
+#define RECORDING_MAX_REASON 64
+
+enum RecordTag : uint8_t {
+    RECORD_KEY = 1,
+    RECORD_DELTA = 2,
+    RECORD_EVENT = 3,
+    RECORD_GAP = 4,
+};
+
+#define RECORD_FLAG_BEAT 0x01
+#define RECORD_FLAG_GRID_LOCKED 0x02
+#define RECORD_FLAG_GRID_BEAT 0x04
+
+struct __attribute__((packed)) RecordingHeader {
+    char magic[4];
+    uint8_t version;
+    uint8_t keyframeInterval;
+    uint16_t rngSeed;      // FastLED random16 seed at the start of recording
+    uint32_t startMs;
+    uint32_t reserved;
+};
+
+// Quantized features: 0-1 values as 16-bit fractions, BPM in tenths
+struct RecordedFrame {
+    uint32_t timeMs;
+    uint16_t volume;
+    uint16_t bass;
+    uint16_t mid;
+    uint16_t treble;
+    uint16_t bpmX10;
+    uint8_t loudness;
+    uint8_t flags;
+    uint8_t beatPhase;     // 0-255 over one beat
+    uint32_t beatIndex;
+    uint16_t rngSeed;      // FastLED random16 seed the frame was rendered from
+};
+
+struct RecordedEvent {
+    uint8_t from;
+    uint8_t to;
+    char reason[RECORDING_MAX_REASON + 1];
+};
+
+inline size_t recordPutVarint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns bytes consumed, 0 if the buffer ends mid-varint
+inline size_t recordGetVarint(const uint8_t* in, size_t len, uint32_t& v) {
+    v = 0;
+    for (size_t i = 0; i < len && i < 5; i++) {
+        v |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+inline uint32_t recordZigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t recordUnzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+inline void recordPut16(uint8_t* out, uint16_t v) { out[0] = v; out[1] = v >> 8; }
+inline void recordPut32(uint8_t* out, uint32_t v) { for (int i = 0; i < 4; i++) out[i] = v >> (8 * i); }
+inline uint16_t recordGet16(const uint8_t* in) { return in[0] | (in[1] << 8); }
+inline uint32_t recordGet32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+class FeatureEncoder {
+public:
+    FeatureEncoder() : prev(), sinceKey(0), havePrev(false) {}
+
+    // Next frame is written as a keyframe (after a gap or at start)
+    void forceKeyframe() { havePrev = false; }
+
+    size_t encodeFrame(const RecordedFrame& f, uint8_t* out) {
+        size_t n = 0;
+        if (!havePrev || sinceKey >= RECORDING_KEYFRAME_INTERVAL) {
+            out[n++] = RECORD_KEY;
+            recordPut32(out + n, f.timeMs); n += 4;
+            recordPut16(out + n, f.volume); n += 2;
+            recordPut16(out + n, f.bass); n += 2;
+            recordPut16(out + n, f.mid); n += 2;
+            recordPut16(out + n, f.treble); n += 2;
+            recordPut16(out + n, f.bpmX10); n += 2;
+            out[n++] = f.loudness;
+            out[n++] = f.flags;
+            out[n++] = f.beatPhase;
+            recordPut32(out + n, f.beatIndex); n += 4;
+            recordPut16(out + n, f.rngSeed); n += 2;
+            sinceKey = 0;
+        } else {
+            out[n++] = RECORD_DELTA;
+            n += recordPutVarint(out + n, f.timeMs - prev.timeMs);
+            n += recordPutVarint(out + n, recordZigzag((int32_t)f.volume - prev.volume));
+            n += recordPutVarint(out + n, recordZigzag((int32_t)f.bass - prev.bass));
+            n += recordPutVarint(out + n, recordZigzag((int32_t)f.mid - prev.mid));
+            n += recordPutVarint(out + n, recordZigzag((int32_t)f.treble - prev.treble));
+            n += recordPutVarint(out + n, recordZigzag((int32_t)f.bpmX10 - prev.bpmX10));
+            n += recordPutVarint(out + n, recordZigzag((int32_t)f.loudness - prev.loudness));
+            out[n++] = f.flags;
+            out[n++] = f.beatPhase;
+            n += recordPutVarint(out + n, recordZigzag((int32_t)(f.beatIndex - prev.beatIndex)));
+            // Successive seeds are unrelated, nothing to gain from a delta
+            recordPut16(out + n, f.rngSeed); n += 2;
+            sinceKey++;
+        }
+        prev = f;
+        havePrev = true;
+        return n;
+    }
+
+    static size_t encodeEvent(uint8_t from, uint8_t to, const char* reason, uint8_t* out) {
+        size_t len = reason ? strlen(reason) : 0;
+        if (len > RECORDING_MAX_REASON) len = RECORDING_MAX_REASON;
+        out[0] = RECORD_EVENT;
+        out[1] = from;
+        out[2] = to;
+        out[3] = (uint8_t)len;
+        memcpy(out + 4, reason, len);
+        return 4 + len;
+    }
+
+private:
+    RecordedFrame prev;
+    uint16_t sinceKey;
+    bool havePrev;
+};
+
+class FeatureDecoder {
+public:
+    enum Result { NEED_MORE, FRAME, EVENT, GAP, CORRUPT };
+
+    FeatureDecoder() : havePrev(false) {}
+
+    // Decodes one record from `in`; `consumed` is set for every result but NEED_MORE.
+    // DELTA records before the first KEY are skipped as CORRUPT.
+    Result decode(const uint8_t* in, size_t len, size_t& consumed, RecordedFrame& frame, RecordedEvent& event) {
+        if (len == 0) return NEED_MORE;
+        switch (in[0]) {
+        case RECORD_KEY: {
+            if (len < 24) return NEED_MORE;
+            prev.timeMs = recordGet32(in + 1);
+            prev.volume = recordGet16(in + 5);
+            prev.bass = recordGet16(in + 7);
+            prev.mid = recordGet16(in + 9);
+            prev.treble = recordGet16(in + 11);
+            prev.bpmX10 = recordGet16(in + 13);
+            prev.loudness = in[15];
+            prev.flags = in[16];
+            prev.beatPhase = in[17];
+            prev.beatIndex = recordGet32(in + 18);
+            prev.rngSeed = recordGet16(in + 22);
+            havePrev = true;
+            frame = prev;
+            consumed = 24;
+            return FRAME;
+        }
+        case RECORD_DELTA: {
+            uint32_t v[7];
+            size_t n = 1;
+            for (int i = 0; i < 7; i++) {
+                size_t used = recordGetVarint(in + n, len - n, v[i]);
+                if (!used) return len - n >= 5 ? CORRUPT : NEED_MORE;
+                n += used;
+            }
+            if (len < n + 2) return NEED_MORE;
+            uint8_t flags = in[n++];
+            uint8_t phase = in[n++];
+            uint32_t dBeat;
+            size_t used = recordGetVarint(in + n, len - n, dBeat);
+            if (!used) return len - n >= 5 ? CORRUPT : NEED_MORE;
+            n += used;
+            if (len < n + 2) return NEED_MORE;
+            uint16_t seed = recordGet16(in + n);
+            n += 2;
+            consumed = n;
+            if (!havePrev) return CORRUPT;
+
+            prev.timeMs += v[0];
+            prev.volume += recordUnzigzag(v[1]);
+            prev.bass += recordUnzigzag(v[2]);
+            prev.mid += recordUnzigzag(v[3]);
+            prev.treble += recordUnzigzag(v[4]);
+            prev.bpmX10 += recordUnzigzag(v[5]);
+            prev.loudness += recordUnzigzag(v[6]);
+            prev.flags = flags;
+            prev.beatPhase = phase;
+            prev.beatIndex += recordUnzigzag(dBeat);
+            prev.rngSeed = seed;
+            frame = prev;
+            return FRAME;
+        }
+        case RECORD_EVENT: {
+            if (len < 4) return NEED_MORE;
+            // The encoder never writes a longer reason; a reader waiting for one would stall
+            if (in[3] > RECORDING_MAX_REASON) {
+                consumed = 1;
+                return CORRUPT;
+            }
+            if (len < 4u + in[3]) return NEED_MORE;
+            event.from = in[1];
+            event.to = in[2];
+            memcpy(event.reason, in + 4, in[3]);
+            event.reason[in[3]] = '\0';
+            consumed = 4 + in[3];
+            return EVENT;
+        }
+        case RECORD_GAP:
+            havePrev = false;
+            consumed = 1;
+            return GAP;
+        default:
+            consumed = 1;
+            return CORRUPT;
+        }
+    }
+
+private:
+    RecordedFrame prev;
+    bool havePrev;
+};
@@ -0,0 +1,43 @@
+// FixedString.h
+#pragma once
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// Inline, fixed-capacity text for the per-frame paths (reasons, labels) that
+// used Arduino String. Never touches the heap; longer text is truncated.
+template<size_t N>
+class FixedString {
+public:
+    FixedString() { text[0] = '\0'; }
+    FixedString(const char* s) { assign(s); }
+
+    FixedString& operator=(const char* s) {
+        assign(s);
+        return *this;
+    }
+
+    void assign(const char* s) {
+        snprintf(text, N, "%s", s ? s : "");
+    }
+
+    void append(const char* s) {
+        size_t len = length();
+        snprintf(text + len, N - len, "%s", s ? s : "");
+    }
+
+    void format(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(text, N, fmt, args);
+        va_end(args);
+    }
+
+    const char* c_str() const { return text; }
+    size_t length() const { return strlen(text); }
+    bool empty() const { return text[0] == '\0'; }
+    static constexpr size_t capacity() { return N - 1; }
+
+private:
+    char text[N];
+};
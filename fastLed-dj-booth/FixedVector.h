@@ -0,0 +1,38 @@
+// FixedVector.h
+#pragma once
+#include <stddef.h>
+
+// std::vector-like list with inline storage for the per-frame paths. Never
+// touches the heap; push_back() refuses (returns false) once full.
+template<typename T, size_t N>
+class FixedVector {
+public:
+    bool push_back(const T& value) {
+        if (count >= N) return false;
+        items[count++] = value;
+        return true;
+    }
+
+    // Shrinks to n elements, e.g. after std::remove_if()
+    void resize(size_t n) {
+        if (n < count) count = n;
+    }
+
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    static constexpr size_t capacity() { return N; }
+
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    T items[N];
+    size_t count = 0;
+};
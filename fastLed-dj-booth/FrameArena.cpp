@@ -0,0 +1,6 @@
+#include "FrameArena.h"
+
+alignas(8) uint8_t FrameArena::buffer[FRAME_ARENA_BYTES];
+size_t FrameArena::used = 0;
+size_t FrameArena::peak = 0;
+uint32_t FrameArena::overflows = 0;
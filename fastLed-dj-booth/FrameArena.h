@@ -0,0 +1,51 @@
+// FrameArena.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+#include "config.h"
+
+// Bump allocator for objects that only live for one frame (the display's
+// widgets). reset() at the start of every drawing hands the whole buffer back
+// at once, so steady-state frames make no heap allocations. When the buffer is
+// exhausted create() returns nullptr and the miss is counted for the heap
+// report; raise FRAME_ARENA_BYTES if that ever happens.
+//
+// Nothing is destroyed by reset(): owners must run destructors themselves
+// before the frame ends (DisplayManager::updateAudioVisualization() does this
+// for the widgets). Only the task that draws the dashboard may use it.
+class FrameArena {
+public:
+    static void reset() {
+        used = 0;
+    }
+
+    static void* allocate(size_t size, size_t align) {
+        size_t start = (used + align - 1) & ~(align - 1);
+        if (start + size > FRAME_ARENA_BYTES) {
+            overflows++;
+            return nullptr;
+        }
+        used = start + size;
+        if (used > peak) peak = used;
+        return buffer + start;
+    }
+
+    template<typename T, typename... Args>
+    static T* create(Args&&... args) {
+        void* p = allocate(sizeof(T), alignof(T));
+        return p ? new (p) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    static size_t getUsed() { return used; }
+    static size_t getPeak() { return peak; }
+    static size_t getCapacity() { return FRAME_ARENA_BYTES; }
+    static uint32_t getOverflows() { return overflows; }
+
+private:
+    alignas(8) static uint8_t buffer[FRAME_ARENA_BYTES];
+    static size_t used;
+    static size_t peak;
+    static uint32_t overflows;
+};
@@ -0,0 +1,4 @@
+#include "FrameClock.h"
+
+bool FrameClock::frozen = false;
+unsigned long FrameClock::frozenMs = 0;
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+
+// Time source shared by audio analysis and animations. Normally forwards to
+// millis(); the golden-frame self test freezes it to scripted values so that
+// every run of an animation sees exactly the same clock.
+class FrameClock {
+public:
+    static unsigned long now() {
+        return frozen ? frozenMs : millis();
+    }
+
+    static void freeze(unsigned long ms) {
+        frozen = true;
+        frozenMs = ms;
+    }
+
+    static void advance(unsigned long ms) {
+        frozenMs += ms;
+    }
+
+    static void release() {
+        frozen = false;
+    }
+
+    static bool isFrozen() {
+        return frozen;
+    }
+
+private:
+    static bool frozen;
+    static unsigned long frozenMs;
+};
@@ -0,0 +1,12 @@
+// FrameLog.h
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Per-frame text logging. Compiled out when FRAME_DEBUG is false, which is the
+// case while the binary telemetry stream owns the serial port.
+#if FRAME_DEBUG
+#define FRAME_LOG(...) Serial.printf(__VA_ARGS__)
+#else
+#define FRAME_LOG(...) do {} while (0)
+#endif
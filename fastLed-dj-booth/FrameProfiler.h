@@ -0,0 +1,100 @@
+// FrameProfiler.h
+#pragma once
+
+#include <Arduino.h>
+#include "TelemetryProtocol.h"
+
+// Stages of the main loop, in the order they run
+enum class FrameStage : uint8_t { Capture, Analyze, Update, Display, Show, Idle };
+
+// Lightweight per-frame stage timer: mark() charges the time since the previous
+// mark to the given stage.
+//
+// With the dual-core pipeline the Display and Show stages run on the output
+// core, alongside the next frame's render; setParallel() charges them there.
+// A frame's work is then the longer of the two cores' shares, and the window
+// totals show how much the overlap gains over running the same stages back
+// to back.
+class FrameProfiler {
+public:
+    void beginFrame() {
+        frame++;
+        frameStart = lastMark = micros();
+        parallelMask = 0;
+        for (int i = 0; i < TELEMETRY_STAGE_COUNT; i++) stageUs[i] = 0;
+    }
+
+    void mark(FrameStage stage) {
+        unsigned long now = micros();
+        stageUs[(int)stage] += now - lastMark;
+        lastMark = now;
+    }
+
+    // A stage that ran on the other core, finishing during this frame
+    void setParallel(FrameStage stage, uint32_t us) {
+        stageUs[(int)stage] = us;
+        parallelMask |= 1 << (int)stage;
+    }
+
+    // After the last mark(); adds the frame to the window totals
+    void endFrame() {
+        uint32_t serial = getSerialUs();
+        uint32_t parallel = getParallelUs();
+        windowFrames++;
+        windowSerialUs += serial;
+        windowParallelUs += parallel;
+        windowWorkUs += serial > parallel ? serial : parallel;
+    }
+
+    uint32_t get(FrameStage stage) const { return stageUs[(int)stage]; }
+    uint32_t getTotal() const { return lastMark - frameStart; }
+    uint32_t getFrame() const { return frame; }
+
+    // Busy time on this core, and on the other one
+    uint32_t getSerialUs() const { return sumStages(false); }
+    uint32_t getParallelUs() const { return sumStages(true); }
+    // What bounds the frame rate: the busier of the two cores
+    uint32_t getWorkUs() const {
+        uint32_t serial = getSerialUs();
+        uint32_t parallel = getParallelUs();
+        return serial > parallel ? serial : parallel;
+    }
+
+    // Averages over the frames since resetWindow()
+    uint32_t getWindowFrames() const { return windowFrames; }
+    float getWindowSerialMs() const { return windowFrames ? windowSerialUs / 1000.0f / windowFrames : 0; }
+    float getWindowParallelMs() const { return windowFrames ? windowParallelUs / 1000.0f / windowFrames : 0; }
+    // Serial time over pipelined time for the same stages (1.0 = no overlap)
+    float getOverlapGain() const {
+        return windowWorkUs ? (float)(windowSerialUs + windowParallelUs) / windowWorkUs : 1.0f;
+    }
+    void resetWindow() {
+        windowFrames = 0;
+        windowSerialUs = windowParallelUs = windowWorkUs = 0;
+    }
+
+    static const char* name(FrameStage stage) {
+        static const char* names[] = { "capture", "analyze", "update", "display", "show", "idle" };
+        return names[(int)stage];
+    }
+
+private:
+    uint32_t sumStages(bool parallel) const {
+        uint32_t sum = 0;
+        for (int i = 0; i < TELEMETRY_STAGE_COUNT; i++) {
+            if (i == (int)FrameStage::Idle) continue;
+            if (((parallelMask >> i) & 1) == parallel) sum += stageUs[i];
+        }
+        return sum;
+    }
+
+    uint32_t frame = 0;
+    unsigned long frameStart = 0;
+    unsigned long lastMark = 0;
+    uint32_t stageUs[TELEMETRY_STAGE_COUNT] = {0};
+    uint8_t parallelMask = 0;
+    uint32_t windowFrames = 0;
+    uint64_t windowSerialUs = 0;
+    uint64_t windowParallelUs = 0;
+    uint64_t windowWorkUs = 0;
+};
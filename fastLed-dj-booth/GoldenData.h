@@ -0,0 +1,122 @@
+// GoldenData.h
+// Reference frames for GoldenFrames.cpp. Regenerate by building with
+// GOLDEN_SELFTEST and GOLDEN_CAPTURE enabled and pasting the serial output here
+// (or booth_host --golden, in a host build with GOLDEN_CAPTURE), less the log lines.
+#pragma once
+
+#include "GoldenFrames.h"
+
+#define GOLDEN_DATA_AVAILABLE 1
+
+const GoldenLedCheckpoint goldenLedCheckpoints[] = {
+    { 0, 8, {{100,3,172},{161,3,106},{217,46,12},{223,104,5},{222,9,32},{187,50,72},{93,3,130},{22,38,188},{11,203,41},{112,164,3},{205,165,3},{191,46,33}} },
+    { 0, 16, {{140,2,46},{175,12,3},{152,36,2},{158,31,2},{174,4,12},{148,22,71},{36,2,152},{2,100,89},{34,167,6},{122,109,2},{126,66,2},{133,53,2}} },
+    { 0, 24, {{38,2,27},{13,5,0},{13,5,0},{17,2,0},{50,14,3},{12,0,59},{0,40,27},{0,22,2},{58,60,2},{12,8,0},{12,7,0},{12,8,0}} },
+    { 0, 32, {{98,24,34},{0,0,0},{0,9,41},{0,0,0},{0,0,0},{48,5,0},{39,0,8},{28,43,78},{1,0,1},{0,0,0},{20,40,0},{0,14,37}} },
+    { 0, 40, {{35,33,6},{36,26,6},{42,14,6},{41,6,16},{20,6,37},{6,20,36},{6,46,10},{21,43,6},{34,37,6},{30,39,6},{12,47,6},{6,36,20}} },
+    { 0, 48, {{144,138,3},{155,82,5},{201,12,61},{113,3,109},{63,21,194},{29,150,98},{21,209,8},{112,196,3},{66,189,3},{9,206,14},{42,125,111},{33,9,182}} },
+    { 1, 8, {{0,0,0},{33,0,0},{215,18,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 1, 16, {{0,0,0},{51,0,0},{230,91,4},{105,87,43},{123,0,0},{64,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 1, 24, {{200,118,44},{255,140,0},{79,7,0},{141,8,0},{141,0,0},{253,72,0},{73,0,0},{64,0,0},{10,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 1, 32, {{197,125,33},{255,179,51},{255,236,32},{255,110,0},{255,173,0},{88,0,0},{75,0,0},{153,0,0},{202,0,0},{5,0,0},{5,0,0},{0,0,0}} },
+    { 1, 40, {{191,89,13},{255,145,100},{255,79,50},{255,213,16},{255,163,17},{255,124,0},{255,44,0},{197,24,0},{4,0,0},{2,0,0},{88,0,0},{51,0,0}} },
+    { 1, 48, {{255,255,124},{255,133,12},{255,133,0},{255,147,0},{255,222,8},{255,52,0},{255,216,0},{255,114,0},{249,36,0},{252,18,0},{96,0,0},{0,0,0}} },
+    { 2, 8, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{30,65,0},{38,83,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 2, 16, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{28,36,16},{54,51,16},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 2, 24, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{67,0,17},{79,0,20},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 2, 32, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{49,54,0},{63,76,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 2, 40, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{19,52,0},{22,52,48},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 2, 48, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{64,16,7},{81,20,7},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 3, 8, {{137,32,0},{53,26,0},{13,9,0},{1,1,0},{0,1,0},{0,8,0},{0,40,6},{0,89,39},{0,94,123},{0,31,214},{16,0,175},{23,0,75}} },
+    { 3, 16, {{1,0,0},{6,6,0},{23,40,0},{20,127,0},{0,204,16},{0,188,56},{0,106,78},{0,25,67},{0,0,25},{0,0,2},{0,0,1},{3,0,2}} },
+    { 3, 24, {{153,129,0},{136,172,0},{46,151,0},{1,79,2},{0,17,3},{0,1,0},{0,0,1},{0,0,7},{6,0,37},{38,0,86},{98,0,115},{150,0,95}} },
+    { 3, 32, {{11,12,0},{0,1,0},{0,1,0},{0,7,1},{0,31,18},{0,44,88},{2,12,204},{32,0,212},{53,0,134},{41,0,54},{16,0,11},{2,0,0}} },
+    { 3, 40, {{21,174,0},{0,179,26},{0,219,99},{0,168,166},{0,65,210},{10,0,151},{37,0,138},{38,0,66},{82,0,72},{75,0,33},{158,0,29},{172,4,3}} },
+    { 3, 48, {{0,161,9},{0,62,15},{0,12,7},{0,0,1},{0,0,1},{1,0,6},{16,0,31},{64,0,64},{140,0,76},{196,0,48},{182,0,8},{89,9,0}} },
+    { 4, 8, {{18,11,0},{14,19,0},{1,25,0},{0,21,5},{0,8,18},{1,0,24},{8,0,18},{16,0,9},{24,0,2},{23,2,0},{19,9,0},{17,18,0}} },
+    { 4, 16, {{14,19,0},{1,25,0},{0,21,5},{0,8,18},{1,0,24},{8,0,18},{16,0,9},{24,0,2},{23,2,0},{19,9,0},{17,18,0},{4,24,0}} },
+    { 4, 24, {{0,2,0},{0,1,0},{0,0,1},{0,0,1},{0,0,0},{1,0,0},{2,0,0},{1,0,0},{1,0,0},{0,1,0},{0,2,0},{0,1,0}} },
+    { 4, 32, {{0,18,7},{0,4,21},{3,0,23},{10,0,16},{18,0,7},{25,0,1},{22,4,0},{19,11,0},{14,19,0},{1,25,0},{0,21,5},{0,8,18}} },
+    { 4, 40, {{0,5,51},{12,0,47},{28,0,30},{44,0,14},{56,1,1},{44,14,0},{40,30,0},{25,47,0},{1,55,2},{0,40,18},{0,11,47},{7,0,50}} },
+    { 4, 48, {{0,0,1},{0,0,0},{1,0,0},{2,0,0},{1,0,0},{1,0,0},{0,1,0},{0,2,0},{0,0,0},{0,0,1},{0,0,1},{0,0,0}} },
+    { 5, 8, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 5, 16, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 5, 24, {{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 5, 32, {{12,25,63},{33,34,0},{53,56,47},{87,0,14},{8,0,43},{0,39,62},{50,18,33},{51,0,0},{27,0,24},{80,35,2},{91,0,62},{0,35,16}} },
+    { 5, 40, {{51,43,58},{38,0,64},{50,5,46},{50,76,26},{34,70,3},{34,22,0},{47,3,0},{45,61,46},{31,53,33},{18,85,54},{34,72,11},{84,63,112}} },
+    { 5, 48, {{16,62,77},{65,77,36},{8,31,62},{48,16,37},{18,77,15},{72,32,12},{42,52,7},{15,0,36},{0,42,9},{78,15,9},{0,50,0},{52,6,42}} },
+    { 6, 8, {{49,86,65},{98,178,131},{150,236,182},{218,238,207},{255,230,214},{255,230,232},{255,230,238},{255,230,218},{231,235,207},{163,242,191},{107,189,140},{65,117,88}} },
+    { 6, 16, {{84,144,81},{188,230,141},{212,230,179},{214,230,202},{244,230,236},{252,230,255},{252,230,255},{249,230,244},{218,230,206},{212,230,186},{199,230,148},{115,190,106}} },
+    { 6, 24, {{142,150,81},{230,227,136},{230,250,171},{230,255,193},{230,255,208},{230,255,230},{230,255,237},{230,255,212},{230,255,195},{230,253,178},{230,231,142},{188,195,106}} },
+    { 6, 32, {{150,136,109},{248,207,206},{255,218,230},{255,213,230},{255,202,230},{255,214,234},{255,222,239},{255,199,230},{255,211,230},{255,217,230},{252,210,216},{197,176,145}} },
+    { 6, 40, {{168,116,99},{244,206,203},{239,221,253},{231,224,255},{230,243,255},{230,255,255},{230,255,255},{230,248,255},{230,226,255},{237,221,255},{243,210,219},{217,155,132}} },
+    { 6, 48, {{105,176,75},{170,255,135},{224,255,126},{255,255,121},{255,254,121},{255,243,121},{255,238,121},{255,254,121},{255,255,121},{236,255,123},{178,255,136},{137,227,100}} },
+    { 7, 8, {{107,34,5},{60,18,3},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 7, 16, {{95,73,5},{66,47,3},{67,50,3},{34,27,2},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 7, 24, {{61,51,3},{64,54,3},{66,56,3},{95,82,5},{58,50,3},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 7, 32, {{47,119,5},{36,78,3},{35,67,2},{37,84,3},{46,116,5},{35,81,3},{21,55,2},{0,0,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 7, 40, {{5,132,13},{3,93,7},{5,129,13},{4,87,6},{2,49,1},{5,129,12},{3,95,8},{5,129,12},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 7, 48, {{3,74,29},{5,102,39},{3,73,27},{5,103,41},{3,72,25},{2,68,21},{3,73,27},{3,74,27},{5,102,39},{3,56,22},{0,0,0},{0,0,0}} },
+    { 8, 8, {{0,0,232},{0,0,234},{0,0,234},{0,0,232},{0,47,1},{0,48,0},{0,48,0},{0,47,0},{17,0,0},{17,0,0},{17,0,0},{17,0,0}} },
+    { 8, 16, {{0,0,212},{0,0,214},{0,0,214},{0,0,212},{0,116,1},{0,117,0},{0,117,0},{0,116,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 8, 24, {{0,0,194},{0,0,196},{0,0,196},{0,1,194},{0,212,1},{0,214,0},{0,214,0},{0,212,0},{5,1,0},{5,0,0},{5,0,0},{5,0,0}} },
+    { 8, 32, {{0,0,177},{0,0,179},{0,0,179},{0,0,177},{0,6,1},{0,6,0},{0,6,0},{0,6,0},{16,0,0},{16,0,0},{16,0,0},{16,0,0}} },
+    { 8, 40, {{0,0,161},{0,0,162},{0,0,162},{0,0,161},{0,39,1},{0,40,0},{0,40,0},{0,39,0},{0,0,0},{0,0,0},{0,0,0},{0,0,0}} },
+    { 8, 48, {{0,0,145},{0,0,146},{0,0,146},{0,0,145},{0,102,1},{0,103,0},{0,103,0},{0,102,0},{4,0,0},{4,0,0},{4,0,0},{4,0,0}} },
+    { 9, 8, {{16,66,0},{21,102,0},{26,129,0},{29,158,0},{34,191,0},{48,229,46},{102,241,48},{33,200,0},{27,168,0},{20,141,0},{14,115,0},{10,92,0}} },
+    { 9, 16, {{0,27,51},{0,36,81},{0,40,103},{0,45,129},{40,55,168},{0,59,186},{0,70,202},{24,53,183},{0,41,139},{0,33,117},{0,26,96},{0,18,78}} },
+    { 9, 24, {{11,1,51},{19,0,81},{26,0,104},{32,0,128},{40,1,155},{79,33,187},{57,0,200},{40,0,161},{77,6,136},{27,0,109},{26,49,90},{15,0,67}} },
+    { 9, 32, {{57,0,21},{90,0,27},{113,0,30},{139,0,34},{169,0,39},{215,60,53},{214,0,52},{177,0,37},{149,0,30},{124,0,25},{103,0,18},{83,0,13}} },
+    { 9, 40, {{104,31,12},{97,46,1},{117,59,0},{138,73,0},{159,90,0},{181,110,0},{196,137,0},{158,98,0},{133,85,0},{112,72,0},{93,61,0},{76,52,0}} },
+    { 9, 48, {{31,50,0},{51,114,18},{61,100,0},{75,123,0},{91,150,0},{109,178,0},{134,195,0},{95,155,0},{111,131,13},{63,106,0},{50,85,0},{59,106,47}} },
+    { 10, 8, {{209,166,159},{196,186,181},{175,123,120},{222,218,209},{228,223,169},{229,196,92},{233,233,149},{227,233,152},{188,233,95},{99,233,92},{173,233,189},{108,148,89}} },
+    { 10, 16, {{232,222,203},{221,186,117},{206,201,135},{181,173,159},{159,96,74},{191,163,99},{171,167,90},{210,233,175},{193,233,196},{137,233,179},{117,233,214},{196,233,233}} },
+    { 10, 24, {{233,233,182},{233,233,103},{209,201,145},{209,183,151},{215,214,105},{196,192,136},{181,189,144},{167,173,143},{139,142,90},{138,228,175},{171,233,229},{173,233,233}} },
+    { 10, 32, {{233,206,137},{233,233,168},{233,233,115},{233,233,151},{233,233,142},{228,233,150},{157,118,66},{171,155,135},{129,203,123},{174,206,198},{174,199,192},{150,204,188}} },
+    { 10, 40, {{186,173,138},{212,198,128},{233,229,66},{233,233,59},{233,233,178},{233,233,150},{192,233,179},{102,165,45},{107,230,195},{150,215,207},{147,202,189},{161,189,194}} },
+    { 10, 48, {{206,203,140},{191,179,159},{178,165,127},{200,205,173},{204,230,158},{167,210,81},{149,233,148},{136,233,166},{123,233,226},{98,233,233},{140,231,233},{142,205,224}} },
+    { 11, 8, {{8,229,22},{1,115,140},{35,2,219},{127,1,128},{219,1,35},{198,58,1},{163,151,1},{36,230,7},{1,162,92},{14,19,222},{98,1,157},{191,1,64}} },
+    { 11, 16, {{119,1,136},{212,1,42},{205,50,1},{166,143,1},{45,229,4},{1,174,81},{10,26,219},{90,1,165},{183,1,72},{227,24,4},{172,114,1},{96,207,1}} },
+    { 11, 24, {{169,138,1},{54,226,3},{1,181,73},{8,32,215},{85,1,170},{178,1,77},{229,21,5},{173,109,1},{105,202,1},{1,215,39},{1,75,180},{55,1,199}} },
+    { 11, 32, {{5,42,209},{77,1,178},{170,1,85},{231,16,8},{175,101,1},{118,194,1},{3,221,33},{1,91,164},{47,1,207},{140,1,115},{227,4,24},{189,71,1}} },
+    { 11, 40, {{232,13,10},{177,95,1},{126,188,1},{5,224,28},{1,101,154},{42,1,212},{135,1,120},{224,2,28},{192,66,1},{157,159,1},{26,232,10},{1,151,104}} },
+    { 11, 48, {{8,229,22},{1,115,140},{35,2,219},{127,1,128},{219,1,35},{198,58,1},{163,151,1},{36,230,7},{1,162,92},{14,19,222},{98,1,157},{191,1,64}} },
+    { 12, 8, {{51,0,134},{61,0,67},{51,0,23},{30,0,3},{10,0,0},{2,0,0},{1,0,0},{0,1,0},{0,3,0},{0,10,2},{0,20,16},{0,11,66}} },
+    { 12, 16, {{0,0,0},{0,0,2},{1,0,8},{11,0,19},{39,0,28},{95,0,25},{169,4,4},{177,47,0},{166,104,0},{155,148,0},{68,165,0},{2,137,6}} },
+    { 12, 24, {{54,194,0},{0,226,20},{0,169,71},{0,70,135},{6,3,142},{22,0,72},{21,0,27},{12,0,6},{4,0,0},{1,0,0},{1,0,0},{1,0,0}} },
+    { 12, 32, {{16,7,0},{4,3,0},{0,1,0},{0,1,0},{0,1,0},{0,2,2},{0,2,18},{7,0,43},{34,0,64},{87,0,69},{159,0,49},{228,3,9}} },
+    { 12, 40, {{38,0,7},{85,4,1},{111,36,0},{136,91,0},{150,157,0},{68,213,0},{1,206,15},{0,125,49},{0,43,73},{2,1,61},{6,0,22},{3,0,5}} },
+    { 12, 48, {{51,0,134},{61,0,67},{51,0,23},{30,0,3},{10,0,0},{2,0,0},{1,0,0},{0,1,0},{0,3,0},{0,10,2},{0,20,16},{0,11,66}} },
+    { 13, 8, {{60,22,0},{55,44,0},{32,65,0},{1,75,5},{0,53,28},{0,13,67},{14,0,67},{35,0,46},{57,0,24},{76,0,4},{64,17,0},{55,39,0}} },
+    { 13, 16, {{105,100,0},{40,143,0},{0,141,21},{0,87,76},{4,12,146},{40,0,122},{83,0,80},{125,0,37},{152,7,2},{118,47,0},{109,90,0},{61,132,0}} },
+    { 13, 24, {{31,50,0},{2,62,2},{0,47,18},{0,16,49},{8,0,57},{26,0,40},{43,0,22},{60,0,5},{54,10,0},{45,28,0},{37,46,0},{7,62,0}} },
+    { 13, 32, {{14,105,1},{0,90,23},{0,45,68},{7,1,103},{36,0,77},{66,0,47},{96,0,17},{102,11,0},{78,40,0},{72,71,0},{25,100,0},{0,97,15}} },
+    { 13, 40, {{0,176,68},{0,67,178},{30,0,214},{94,0,150},{158,0,86},{220,0,23},{203,40,0},{164,104,0},{142,168,0},{30,227,2},{0,193,50},{0,97,147}} },
+    { 13, 48, {{0,38,42},{2,3,74},{22,0,59},{44,0,37},{65,0,15},{75,5,0},{57,26,0},{54,47,0},{25,69,0},{0,73,7},{0,47,33},{0,9,71}} },
+};
+const GoldenAudioCheckpoint goldenAudioCheckpoints[] = {
+    { 0, 40, 800, 800, 3, 0, 1 },
+    { 1, 45, 68, 349, 66, 0, 0 },
+    { 2, 50, 71, 353, 9, 0, 0 },
+    { 3, 55, 74, 360, 63, 0, 0 },
+    { 4, 59, 75, 365, 2, 0, 0 },
+    { 5, 96, 814, 806, 65, 120, 1 },
+    { 6, 97, 70, 351, 9, 120, 0 },
+    { 7, 100, 72, 357, 62, 120, 0 },
+    { 8, 101, 75, 363, 5, 120, 0 },
+    { 9, 104, 76, 367, 62, 120, 0 },
+    { 10, 139, 815, 807, 8, 120, 1 },
+    { 11, 139, 70, 351, 62, 120, 0 },
+    { 12, 138, 72, 358, 7, 120, 0 },
+    { 13, 138, 75, 363, 62, 120, 0 },
+    { 14, 137, 76, 368, 5, 120, 0 },
+    { 15, 171, 815, 807, 63, 120, 1 },
+    { 16, 168, 70, 352, 9, 120, 0 },
+    { 17, 166, 72, 358, 64, 120, 0 },
+    { 18, 164, 75, 363, 2, 120, 0 },
+    { 19, 162, 76, 368, 64, 120, 0 },
+    { 20, 195, 815, 807, 10, 120, 1 },
+    { 21, 191, 70, 354, 65, 120, 0 },
+    { 22, 187, 72, 358, 3, 120, 0 },
+    { 23, 184, 75, 364, 63, 120, 0 },
+};
@@ -0,0 +1,242 @@
+#include "GoldenFrames.h"
+#include "GoldenData.h"
+#include "Animations.h"
+#include "FrameClock.h"
+#include "Modulation.h"
+#include "PaletteManager.h"
+#include "TuningParams.h"
+#include "config.h"
+
+#define GOLDEN_RNG_SEED 1337
+#define GOLDEN_CLOCK_START 10000
+
+alignas(4) static CRGB goldenLeds[NUM_LEDS];
+static int goldenFailures = 0;
+
+// Scripted features: 120 BPM beat (every 5th frame at 100ms), a slow volume swell
+// and band levels that sweep through the thresholds the animations react to.
+static AudioFeatures scriptedFeatures(int frame) {
+    AudioFeatures f = {};
+    bool beat = (frame % 5) == 0;
+    int swell = frame % 24;
+    if (swell > 12) swell = 24 - swell;
+
+    f.volume = 0.1 + swell * 0.03 + (beat ? 0.15 : 0.0);
+    f.bass = ((frame * 37) % 100) / 100.0;
+    f.mid = ((frame * 53 + 20) % 100) / 100.0;
+    f.treble = ((frame * 29 + 50) % 100) / 300.0;
+    f.beatDetected = beat;
+    f.bpm = 120.0;
+    f.loudness = (int)(f.volume * 100);
+    return f;
+}
+
+// Synthesized PCM for one analysis frame: kick-enveloped 86 Hz, steady 1 kHz,
+// and a 6 kHz hat on odd frames. Phase continues across frames.
+static void synthesizeAudio(int frame, int32_t* out) {
+    static double phase[3];
+    if (frame == 0) phase[0] = phase[1] = phase[2] = 0.0;
+
+    const double freqs[3] = { 86.0, 1000.0, 6000.0 };
+    double amps[3] = { 0.05, 0.08, (frame & 1) ? 0.06 : 0.0 };
+    if (frame % 5 == 0) amps[0] = 0.6;
+
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        double s = 0.0;
+        for (int k = 0; k < 3; k++) {
+            s += amps[k] * sin(phase[k]);
+            phase[k] += 2.0 * PI * freqs[k] / SAMPLE_RATE;
+        }
+        out[i] = (int32_t)(constrain(s, -1.0, 1.0) * 8388607.0);
+    }
+}
+
+static void reduceFrame(const CRGB* leds, int numLeds, uint8_t out[GOLDEN_SEGMENTS][3]) {
+    int perSegment = numLeds / GOLDEN_SEGMENTS;
+    for (int s = 0; s < GOLDEN_SEGMENTS; s++) {
+        uint32_t sum[3] = { 0, 0, 0 };
+        for (int i = 0; i < perSegment; i++) {
+            const CRGB& c = leds[s * perSegment + i];
+            sum[0] += c.r;
+            sum[1] += c.g;
+            sum[2] += c.b;
+        }
+        for (int ch = 0; ch < 3; ch++) {
+            out[s][ch] = perSegment > 0 ? sum[ch] / perSegment : 0;
+        }
+    }
+}
+
+static uint16_t quantize(double v) {
+    return (uint16_t)constrain(v * 1000.0 + 0.5, 0.0, 65535.0);
+}
+
+#if GOLDEN_CAPTURE
+static void captureLedCheckpoint(const GoldenLedCheckpoint& cp) {
+    Serial.printf("    { %d, %d, {", cp.animation, cp.frame);
+    for (int s = 0; s < GOLDEN_SEGMENTS; s++) {
+        Serial.printf("{%d,%d,%d}%s", cp.segments[s][0], cp.segments[s][1], cp.segments[s][2],
+                      s < GOLDEN_SEGMENTS - 1 ? "," : "");
+    }
+    Serial.println("} },");
+}
+#endif
+
+static void verifyLedCheckpoint(const GoldenLedCheckpoint& cp, int index) {
+#if GOLDEN_DATA_AVAILABLE
+    const int count = sizeof(goldenLedCheckpoints) / sizeof(goldenLedCheckpoints[0]);
+    if (index >= count) {
+        Serial.printf("[Golden] %s frame %d: no reference (table has %d entries)\n",
+                      animations[cp.animation].name, cp.frame, count);
+        goldenFailures++;
+        return;
+    }
+    const GoldenLedCheckpoint& ref = goldenLedCheckpoints[index];
+    if (ref.animation != cp.animation || ref.frame != cp.frame) {
+        Serial.printf("[Golden] %s frame %d: table out of order, recapture\n",
+                      animations[cp.animation].name, cp.frame);
+        goldenFailures++;
+        return;
+    }
+    for (int s = 0; s < GOLDEN_SEGMENTS; s++) {
+        for (int ch = 0; ch < 3; ch++) {
+            int diff = abs((int)cp.segments[s][ch] - (int)ref.segments[s][ch]);
+            if (diff > GOLDEN_LED_TOLERANCE) {
+                Serial.printf("[Golden] %s frame %d seg %d: got (%d,%d,%d) want (%d,%d,%d)\n",
+                              animations[cp.animation].name, cp.frame, s,
+                              cp.segments[s][0], cp.segments[s][1], cp.segments[s][2],
+                              ref.segments[s][0], ref.segments[s][1], ref.segments[s][2]);
+                goldenFailures++;
+                return;
+            }
+        }
+    }
+#endif
+}
+
+static void verifyAudioCheckpoint(const GoldenAudioCheckpoint& cp) {
+#if GOLDEN_DATA_AVAILABLE
+    const int count = sizeof(goldenAudioCheckpoints) / sizeof(goldenAudioCheckpoints[0]);
+    if (cp.frame >= count) {
+        Serial.printf("[Golden] audio frame %d: no reference (table has %d entries)\n", cp.frame, count);
+        goldenFailures++;
+        return;
+    }
+    const GoldenAudioCheckpoint& ref = goldenAudioCheckpoints[cp.frame];
+    bool ok = abs((int)cp.volume - (int)ref.volume) <= GOLDEN_AUDIO_TOLERANCE &&
+              abs((int)cp.bass - (int)ref.bass) <= GOLDEN_AUDIO_TOLERANCE &&
+              abs((int)cp.mid - (int)ref.mid) <= GOLDEN_AUDIO_TOLERANCE &&
+              abs((int)cp.treble - (int)ref.treble) <= GOLDEN_AUDIO_TOLERANCE &&
+              abs((int)cp.bpm - (int)ref.bpm) <= 1 &&
+              cp.beatDetected == ref.beatDetected;
+    if (!ok) {
+        Serial.printf("[Golden] audio frame %d: got v=%d b=%d m=%d t=%d bpm=%d beat=%d, "
+                      "want v=%d b=%d m=%d t=%d bpm=%d beat=%d\n",
+                      cp.frame, cp.volume, cp.bass, cp.mid, cp.treble, cp.bpm, cp.beatDetected,
+                      ref.volume, ref.bass, ref.mid, ref.treble, ref.bpm, ref.beatDetected);
+        goldenFailures++;
+    }
+#endif
+}
+
+static void runAnimationGoldens() {
+    int index = 0;
+#if GOLDEN_CAPTURE
+    Serial.println("const GoldenLedCheckpoint goldenLedCheckpoints[] = {");
+#endif
+    for (int a = 0; a < ANIMATION_COUNT; a++) {
+        fill_solid(goldenLeds, NUM_LEDS, CRGB::Black);
+        random16_set_seed(GOLDEN_RNG_SEED);
+        FrameClock::freeze(GOLDEN_CLOCK_START);
+        Modulation::reset();
+
+        for (int frame = 1; frame <= GOLDEN_FRAMES_PER_ANIMATION; frame++) {
+            AudioFeatures features = scriptedFeatures(frame);
+            Modulation::update(features);
+            animations[a].function(goldenLeds, NUM_LEDS, features);
+            FrameClock::advance(GOLDEN_FRAME_MS);
+
+            if (frame % GOLDEN_CHECKPOINT_EVERY != 0) continue;
+
+            GoldenLedCheckpoint cp;
+            cp.animation = a;
+            cp.frame = frame;
+            reduceFrame(goldenLeds, NUM_LEDS, cp.segments);
+#if GOLDEN_CAPTURE
+            captureLedCheckpoint(cp);
+#else
+            verifyLedCheckpoint(cp, index);
+#endif
+            index++;
+        }
+    }
+#if GOLDEN_CAPTURE
+    Serial.println("};");
+#endif
+}
+
+static void runAudioGoldens(AudioProcessor& audio) {
+    static int32_t pcm[NUM_SAMPLES];
+    audio.reset();
+    FrameClock::freeze(GOLDEN_CLOCK_START);
+
+#if GOLDEN_CAPTURE
+    Serial.println("const GoldenAudioCheckpoint goldenAudioCheckpoints[] = {");
+#endif
+    for (int frame = 0; frame < GOLDEN_AUDIO_FRAMES; frame++) {
+        synthesizeAudio(frame, pcm);
+        audio.loadSamples(pcm, NUM_SAMPLES);
+        AudioFeatures f = audio.analyzeAudio();
+        FrameClock::advance(GOLDEN_FRAME_MS);
+
+        GoldenAudioCheckpoint cp;
+        cp.frame = frame;
+        cp.volume = quantize(f.volume);
+        cp.bass = quantize(f.bass);
+        cp.mid = quantize(f.mid);
+        cp.treble = quantize(f.treble);
+        cp.bpm = (uint16_t)(f.bpm + 0.5);
+        cp.beatDetected = f.beatDetected;
+#if GOLDEN_CAPTURE
+        Serial.printf("    { %d, %d, %d, %d, %d, %d, %d },\n", cp.frame, cp.volume, cp.bass,
+                      cp.mid, cp.treble, cp.bpm, cp.beatDetected);
+#else
+        verifyAudioCheckpoint(cp);
+#endif
+    }
+#if GOLDEN_CAPTURE
+    Serial.println("};");
+#endif
+
+    // Leave the live analyzer the way setup() expects to find it
+    audio.reset();
+}
+
+bool runGoldenSelfTest(AudioProcessor& audio) {
+    goldenFailures = 0;
+    uint16_t liveSeed = random16_get_seed();
+
+#if GOLDEN_CAPTURE
+    Serial.println("// GoldenData.h");
+    Serial.println("// Reference frames for GoldenFrames.cpp. Regenerate by building with");
+    Serial.println("// GOLDEN_SELFTEST and GOLDEN_CAPTURE enabled and pasting the serial output here");
+    Serial.println("// (or booth_host --golden, in a host build with GOLDEN_CAPTURE), less the log lines.");
+    Serial.println("#pragma once\n\n#include \"GoldenFrames.h\"\n\n#define GOLDEN_DATA_AVAILABLE 1\n");
+#elif !GOLDEN_DATA_AVAILABLE
+    Serial.println("[Golden] No reference data; build with GOLDEN_CAPTURE to record it");
+#endif
+
+    // References are rendered with the rainbow palette
+    PaletteManager::set(PALETTE_rainbow);
+    runAnimationGoldens();
+    runAudioGoldens(audio);
+    PaletteManager::set(tuning.palette);
+
+    FrameClock::release();
+    random16_set_seed(liveSeed);
+
+#if !GOLDEN_CAPTURE && GOLDEN_DATA_AVAILABLE
+    Serial.printf("[Golden] %s (%d mismatches)\n", goldenFailures ? "FAILED" : "PASSED", goldenFailures);
+#endif
+    return goldenFailures == 0;
+}
@@ -0,0 +1,49 @@
+// GoldenFrames.h
+#pragma once
+
+#include <Arduino.h>
+#include "AudioProcessor.h"
+#include "config.h"
+
+// Golden-frame regression harness.
+//
+// Every animation is driven with a scripted AudioFeatures sequence and a
+// frozen FrameClock, with FastLED's random8/random16 seeded before each run.
+// At fixed checkpoints the LED buffer is reduced to GOLDEN_SEGMENTS averaged
+// colors and compared against the table in GoldenData.h. The audio analyzer
+// is fed synthesized PCM and its features are compared the same way.
+//
+// With GOLDEN_CAPTURE enabled the harness prints a fresh GoldenData.h over
+// serial instead of comparing; paste it over the old one after an intended
+// visual change.
+
+#define GOLDEN_SEGMENTS 12
+#define GOLDEN_FRAMES_PER_ANIMATION 48
+#define GOLDEN_CHECKPOINT_EVERY 8
+#define GOLDEN_AUDIO_FRAMES 24
+#define GOLDEN_FRAME_MS 100
+
+// Allowed per-channel deviation of a segment color (0-255)
+#define GOLDEN_LED_TOLERANCE 4
+// Allowed deviation of 0-1 audio features, in 1/1000 units
+#define GOLDEN_AUDIO_TOLERANCE 10
+
+struct GoldenLedCheckpoint {
+    uint8_t animation;
+    uint8_t frame;
+    uint8_t segments[GOLDEN_SEGMENTS][3];
+};
+
+// Feature values quantized to 1/1000 so the table stays integral
+struct GoldenAudioCheckpoint {
+    uint8_t frame;
+    uint16_t volume;
+    uint16_t bass;
+    uint16_t mid;
+    uint16_t treble;
+    uint16_t bpm;
+    uint8_t beatDetected;
+};
+
+// Returns true when every checkpoint is within tolerance (always true in capture mode)
+bool runGoldenSelfTest(AudioProcessor& audio);
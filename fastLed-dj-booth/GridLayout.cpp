@@ -0,0 +1,79 @@
+#include "GridLayout.h"
+#include "WidgetCanvas.h"
+#include <Arduino.h>
+
+// Grid line `index` of `cells` across `extent` pixels, gaps included
+static int gridLine(int index, int cells, int extent) {
+    return index * (extent + GridLayout::MARGIN) / cells;
+}
+
+void GridLayout::pack(const DashboardLayout& chosen, int w, int h) {
+    layout = &chosen;
+    width = w;
+    height = h;
+    count = 0;
+    culled = 0;
+
+    // One bit per grid cell taken
+    uint16_t taken[16] = { 0 };
+    int cols = chosen.cols > 16 ? 16 : chosen.cols;
+    int rows = chosen.rows > 16 ? 16 : chosen.rows;
+
+    for (int c = 0; c < chosen.count; c++) {
+        const LayoutCell& spec = chosen.cells[c];
+        int spanCols = spec.colSpan < 1 ? 1 : spec.colSpan;
+        int spanRows = spec.rowSpan < 1 ? 1 : spec.rowSpan;
+        uint16_t mask = spanCols >= 16 ? 0xFFFF : (uint16_t)((1u << spanCols) - 1);
+
+        // First fit in reading order
+        int at = -1;
+        for (int row = 0; at < 0 && row + spanRows <= rows; row++) {
+            for (int col = 0; col + spanCols <= cols; col++) {
+                bool free = true;
+                for (int r = row; free && r < row + spanRows; r++) free = (taken[r] & (mask << col)) == 0;
+                if (free) {
+                    at = row * cols + col;
+                    break;
+                }
+            }
+        }
+
+        int minWidth, minHeight;
+        dashboardWidgetMinSize(spec.widget, minWidth, minHeight);
+        WidgetRect rect = { 0, 0, 0, 0 };
+        if (at >= 0) {
+            int col = at % cols, row = at / cols;
+            rect.x = gridLine(col, cols, w);
+            rect.y = gridLine(row, rows, h);
+            rect.w = gridLine(col + spanCols, cols, w) - MARGIN - rect.x;
+            rect.h = gridLine(row + spanRows, rows, h) - MARGIN - rect.y;
+        }
+        if (at < 0 || rect.w < minWidth || rect.h < minHeight || count == MAX_CELLS) {
+            Serial.printf("[GridLayout] %s culled (%s)\n", dashboardWidgetName(spec.widget),
+                          at < 0 ? "no room" : (count == MAX_CELLS ? "too many cells" : "too small"));
+            culled++;
+            continue;
+        }
+        int col = at % cols, row = at / cols;
+        for (int r = row; r < row + spanRows; r++) taken[r] |= mask << col;
+
+        PlacedCell& cell = cells[count++];
+        cell.widget = spec.widget;
+        cell.refreshMs = spec.refreshMs;
+        cell.rect = rect;
+        cell.key = 0;
+        cell.drawnAt = 0;
+        cell.drawn = false;
+    }
+    Serial.printf("[GridLayout] %s on %dx%d: %u widgets placed, %u culled\n",
+                  chosen.name, w, h, (unsigned)count, (unsigned)culled);
+}
+
+void GridLayout::draw(WidgetCanvas& canvas, size_t i, Widget* widget, uint32_t key, unsigned long now) {
+    PlacedCell& cell = cells[i];
+    if (widget) canvas.draw(*widget, cell.rect);
+    else canvas.clear(cell.rect, TFT_BLACK);
+    cell.key = key;
+    cell.drawnAt = now;
+    cell.drawn = true;
+}
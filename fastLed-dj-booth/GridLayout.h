@@ -1,95 +1,66 @@
 // GridLayout.h
 #pragma once
 
-#include <vector>
-#include <memory>
 #include <TFT_eSPI.h>
 #include "Widget.h" // Include the header file where Widget is defined
-#include "AcronymValueWidget.h"
-#include "VerticalBarWidget.h"
-#include "WaveformWidget.h"
-#include "ModeIndicatorWidget.h"
+#include "DashboardLayouts.h"
 
-class GridLayout {
-private:
-    int _width, _height;
-    static constexpr size_t MAX_WIDGETS = 16;
-    std::vector<std::unique_ptr<Widget>> widgets;
+struct WidgetRect {
+    int16_t x, y, w, h;
+};
 
+class WidgetCanvas;
+
+// Places a DashboardLayout on the screen once, when the layout is chosen.
+// Each cell takes the first free spot of the layout's grid, in reading
+// order, that its span fits; grid pitch comes from the real screen size. A
+// cell with no room left, or whose rectangle comes out smaller than its
+// widget needs, is culled: never built, never drawn. Placed cells remember
+// what they last drew, so a drawing only touches those that changed.
+class GridLayout {
 public:
-    GridLayout(int screenWidth, int screenHeight) : _width(screenWidth), _height(screenHeight) {}
+    static constexpr size_t MAX_CELLS = 16;
+    static constexpr int MARGIN = 2;
 
-    void clear() {
-        widgets.clear();
-    }
+    GridLayout() : layout(nullptr), width(0), height(0), count(0), culled(0) {}
 
-    void addWidget(std::unique_ptr<Widget> widget) {
-        if (widgets.size() < MAX_WIDGETS) {
-            widgets.push_back(std::move(widget));
-        }
-    }
+    void pack(const DashboardLayout& layout, int width, int height);
+    bool isPackedFor(int w, int h) const { return layout && width == w && height == h; }
+    const DashboardLayout* getLayout() const { return layout; }
 
-    void draw(TFT_eSPI& tft) {
-        int x = 0, y = 0;
-        int rowHeight = 0;
-        const int margin = 2;
-        for (size_t i = 0; i < widgets.size(); ++i) {
-            Widget* widget = widgets[i].get();
+    size_t size() const { return count; }
+    size_t getCulled() const { return culled; }
+    DashboardWidget widgetAt(size_t i) const { return cells[i].widget; }
+    const WidgetRect& rectAt(size_t i) const { return cells[i].rect; }
 
-            // verify widgey, log error 
-            if (!widget) {
-                Serial.printf("[GridLayout] ERROR: Widget %zu is null!\n", i);
-                continue;
-            }
-            int w = widget->getMinWidth();
-            int h = widget->getMinHeight();
-            if (x + w > _width) {
-                x = 0;
-                y += rowHeight + margin;
-                rowHeight = 0;
-                // debugging info
-                Serial.printf("[GridLayout] Moving to next row at (%d, %d)\n", x, y);
-            }
-            // debugging info
-            Serial.printf("[GridLayout] Drawing widget %zu at (%d, %d) with size (%d, %d)\n", i, x, y, w, h);
-           
-            widget->draw(tft, x, y, w, h);
-            x += w + margin;
-            if (h > rowHeight) rowHeight = h;
-            // add debugging info
-            Serial.printf("[GridLayout] Widget %zu drawn at (%d, %d) with size (%d, %d)\n", i, x, y, w, h);
-        }
+    // Whether cell i should draw content `key` now: never drawn, or the key
+    // changed and its refresh interval has passed
+    bool needsDraw(size_t i, uint32_t key, unsigned long now) const {
+        const PlacedCell& cell = cells[i];
+        return !cell.drawn || (key != cell.key && now - cell.drawnAt >= cell.refreshMs);
     }
 
-    void drawVerticalStack(TFT_eSPI& tft) {
-        int y = 0;
-        int widgetWidth = _width;
-        const int margin = 2;
-        for (size_t i = 0; i < widgets.size(); ++i) {
-            Widget* widget = widgets[i].get();
-            if (widget) {
-                int widgetHeight = widget->getMinHeight();
-                uint16_t bgColor = TFT_BLACK;
-                // Use getTypeId() and static_cast (no dynamic_cast, no RTTI)
-                switch (widget->getTypeId()) {
-                    case 1: // VerticalBarWidget
-                    case 2: // AcronymValueWidget
-                    case 3: // WaveformWidget
-                    case 4: // ModeIndicatorWidget
-                        bgColor = widget->getTheme().background;
-                        break;
-                    default:
-                        bgColor = TFT_BLACK;
-                        break;
-                }
-                if (widgetWidth > 0 && widgetHeight > 0) {
-                    tft.fillRect(0, y, widgetWidth, widgetHeight, bgColor);
-                    widget->draw(tft, 0, y, widgetWidth, widgetHeight);
-                    y += widgetHeight + margin;
-                } else {
-                    Serial.printf("[GridLayout] Skipping widget %zu due to invalid size (%d,%d)\n", i, widgetWidth, widgetHeight);
-                }
-            }
-        }
+    // Draws `widget` in cell i, or clears the cell if there is none
+    void draw(WidgetCanvas& canvas, size_t i, Widget* widget, uint32_t key, unsigned long now);
+
+    // Every cell draws again next time (after the screen was cleared)
+    void invalidate() {
+        for (size_t i = 0; i < count; i++) cells[i].drawn = false;
     }
+
+private:
+    struct PlacedCell {
+        DashboardWidget widget;
+        uint16_t refreshMs;
+        WidgetRect rect;
+        uint32_t key;
+        unsigned long drawnAt;
+        bool drawn;
+    };
+
+    const DashboardLayout* layout;
+    int width, height;
+    PlacedCell cells[MAX_CELLS];
+    size_t count;
+    size_t culled;
 };
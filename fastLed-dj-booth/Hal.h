@@ -0,0 +1,31 @@
+// Hal.h
+// What the show needs from the board, kept narrow so the analysis,
+// controller, animation and layout code also builds on Linux (see host/).
+//
+// Audio in and LEDs out go through the interfaces below: EspHal.h has the
+// ESP32 implementations, host/HostHal.h the Linux ones. The clock, random
+// numbers and the display surface are the APIs the code already uses --
+// millis()/micros(), FastLED's random8()/random16() and TFT_eSPI's drawing
+// calls -- which host/shim implements for Linux with the same results.
+#pragma once
+
+#include <stdint.h>
+
+struct CRGB;
+
+// Microphone or line input: NUM_SAMPLES-sized blocks of 24-bit PCM held in
+// 32-bit words, the I2S layout AudioProcessor::loadSamples() takes
+class AudioSource {
+public:
+    virtual ~AudioSource() {}
+    virtual bool begin() = 0;
+    // Blocks until up to `count` samples are in; samples read
+    virtual int read(int32_t* samples, int count) = 0;
+};
+
+// The strip
+class LedSink {
+public:
+    virtual ~LedSink() {}
+    virtual void show(const CRGB* leds, int count, uint8_t brightness, uint8_t dither) = 0;
+};
@@ -1,35 +1,37 @@
 #include "HybridController.h"
-#include "Config.h"
+#include "FrameClock.h"
+#include "TuningParams.h"
+#include "config.h"
 
 
-void HybridController::debugLog(const String& message) {
+void HybridController::debugLog(const char* message) {
 #if MODE_DEBUG
     Serial.printf("%s | Index: %d, Count: %d, Vol: %.3f, BuildUp: %d, Drop: %d, Debounce: %d, Reason: %s\n",
-                  message.c_str(), currentIndex, animationCount, avgVolume, buildUp, drop, debounceCounter,
+                  message, currentIndex, animationCount, avgVolume,
+                  selector.isBuildUp(), selector.isDrop(), debounceCounter,
                   autoSwitchEnabled ? modeSwapReason.c_str() : modeKeepReason.c_str());
 #endif
 }
 
 HybridController::HybridController()
-    : currentIndex(0), animationCount(0), lastSwitch(0),
-      avgVolume(0), volumePos(0), smoothedVolume(0), debounceCounter(0),
-      buildUp(false), drop(false) {
-    memset(volumeHistory, 0, sizeof(volumeHistory));
+    : animations(nullptr), currentIndex(0), animationCount(0), lastSwitch(0),
+      avgVolume(0), smoothedVolume(0), debounceCounter(0),
+      lastBeatIndex(0), lastSwitchBeat(0), switchPending(false), switchOnNextBar(false),
+      switchAtBeat(0),
+      pendingIndex(-1), preparedIndex(-1) {
     debugLog("HybridController initialized");
 }
 
-void HybridController::addAnimation(HybridAnimation animation, const String& name) {
-    if (animationCount < HYBRID_ANIM_COUNT) {
-        animations[animationCount] = animation;
-        names[animationCount] = name;
-        animationCount++;
-        Serial.print("Added animation: ");
-        debugLog(name);
-    }
+// The table is referenced, not copied; it lives in flash for the program's lifetime
+void HybridController::setAnimations(const AnimationEntry* table, int count) {
+    animations = table;
+    animationCount = count;
+    currentIndex = 0;
+    debugLog("Animations set");
 }
 
-String HybridController::getCurrentName() {
-    return names[currentIndex];
+const char* HybridController::getCurrentName() {
+    return animationCount > 0 ? animations[currentIndex].name : "";
 }
 
 int HybridController::getCurrentIndex() {
@@ -45,31 +47,19 @@ float HybridController::getAverageVolume() {
 }
 
 bool HybridController::getBuildUpFlag() {
-    return buildUp;
+    return selector.isBuildUp();
 }
 
 bool HybridController::getDropFlag() {
-    return drop;
-}
-
-String HybridController::getModeSwapReason() const {
-    return modeSwapReason;
+    return selector.isDrop();
 }
 
-String HybridController::getModeKeepReason() const {
-    return modeKeepReason;
+const char* HybridController::getModeSwapReason() const {
+    return modeSwapReason.c_str();
 }
 
-bool HybridController::isBuildUp() {
-    float delta = volumeHistory[(volumePos + 9) % 10] - volumeHistory[(volumePos + 5) % 10];
-    buildUp = delta > 0.1;
-    return buildUp;
-}
-
-bool HybridController::isDrop() {
-    float delta = volumeHistory[(volumePos + 9) % 10] - volumeHistory[(volumePos + 5) % 10];
-    drop = delta < -0.15;
-    return drop;
+const char* HybridController::getModeKeepReason() const {
+    return modeKeepReason.c_str();
 }
 
 bool HybridController::shouldSwitch(const AudioFeatures& features) {
@@ -79,13 +69,18 @@ bool HybridController::shouldSwitch(const AudioFeatures& features) {
     }
 
     // Tempo-aware min switch time
-    unsigned long now = millis();
-    float bpm = features.bpm > 0 ? features.bpm : 120;
-    const unsigned long ABS_MIN = 6000;
-    unsigned long beatDuration = 1000 * (60.0 / bpm) * 8;
-    unsigned long requiredDelay = max(ABS_MIN, beatDuration);
-
-    bool enoughTimePassed = (now - lastSwitch) > requiredDelay;
+    unsigned long now = FrameClock::now();
+    const unsigned long ABS_MIN = tuning.minSwitchMs;
+    bool enoughTimePassed;
+    if (features.gridLocked) {
+        // Count real beats instead of estimating them from a jittery BPM
+        enoughTimePassed = (now - lastSwitch) > ABS_MIN && features.beatIndex - lastSwitchBeat >= (uint32_t)tuning.minSwitchBeats;
+    } else {
+        // TempoTracker has already folded a tapped tempo into features.bpm
+        float bpm = features.bpm > 0 ? features.bpm : 120;
+        unsigned long beatDuration = 1000 * (60.0 / bpm) * tuning.minSwitchBeats;
+        enoughTimePassed = (now - lastSwitch) > max(ABS_MIN, beatDuration);
+    }
 
     if (features.beatDetected) {
         debounceCounter++;
@@ -94,17 +89,22 @@ bool HybridController::shouldSwitch(const AudioFeatures& features) {
         modeKeepReason = "No beat";
     }
 
-    bool beatStable = debounceCounter >= 3;
+    bool beatStable = features.gridLocked || debounceCounter >= 3;
 
-    if (isBuildUp()) {
+    if (selector.isBuildUp()) {
         debounceCounter = 0;
         modeKeepReason = "Build-up detected";
         return false;
     }
 
-    if (isDrop() && (now - lastSwitch) < 10000) {
+    // A drop is the best moment to change the look, unless we only just did
+    if (selector.isDrop()) {
+        if ((now - lastSwitch) > ABS_MIN / 2) {
+            modeSwapReason = "Drop";
+            return true;
+        }
         debounceCounter = 0;
-        modeKeepReason = "Recent drop";
+        modeKeepReason = "Recent switch";
         return false;
     }
 
@@ -129,16 +129,233 @@ void HybridController::switchAnimation() {
     if (!autoSwitchEnabled) {
         // In manual mode, move to the next animation in sequence
         newIndex = (currentIndex + 1) % animationCount;
+        modeSwapReason = "Manual";
     } else {
-        // In automatic mode, pick a random animation
-        newIndex = random(animationCount);
+        // In automatic mode, pick the animation that best fits the music
+        newIndex = selector.pick(animations, animationCount, currentIndex);
+        modeSwapReason = selector.getLastReason();
     }
 
-    // Update the current animation
-    currentIndex = newIndex;
-    lastSwitch = millis();
+    activate(newIndex);
+}
+
+void HybridController::pollInput() {
+    ButtonEvent event;
+    while (ButtonInput::next(event)) handleButton(event);
+}
+
+// A long or double press starts with presses that already did the button's
+// Press action; that is taken back before the gesture's own
+void HybridController::unpress(const ButtonEvent& event) {
+    int presses = event.gesture == Gesture::Double ? 2 : 1;
+    switch (buttonAction(event.button, Gesture::Press)) {
+        case ButtonAction::TapTempo:
+            tapTempo.untap(presses);
+            break;
+        case ButtonAction::NextAnimation:
+            if (presses > pressedCount) presses = pressedCount;
+            if (presses == 0) break;
+            showAnimation(pressedFrom[presses - 1], "Manual");
+            pressedCount = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+void HybridController::handleButton(const ButtonEvent& event) {
+    ButtonAction action = buttonAction(event.button, event.gesture);
+    if (action != ButtonAction::None && (event.gesture == Gesture::Long || event.gesture == Gesture::Double)) {
+        unpress(event);
+    }
+    // A Click ends the gesture: its presses stay
+    if (event.gesture == Gesture::Click && buttonAction(event.button, Gesture::Press) == ButtonAction::NextAnimation) {
+        pressedCount = 0;
+    }
+    switch (action) {
+        case ButtonAction::None:
+            return;
+        case ButtonAction::NextAnimation:
+            pressedFrom[1] = pressedFrom[0];
+            pressedFrom[0] = currentIndex;
+            if (pressedCount < 2) pressedCount++;
+            switchAnimation();
+            break;
+        case ButtonAction::ToggleAutoSwitch:
+            setAutoSwitchEnabled(!autoSwitchEnabled);
+            break;
+        case ButtonAction::FreezeFrame:
+            frozen = !frozen;
+            break;
+        case ButtonAction::FollowTimeline:
+            if (lastTimeline && lastTimeline->beatCount > 0) followTimeline(lastTimeline);
+            break;
+        case ButtonAction::StepBrightness: {
+            // Down through the levels, then back to full
+            static const uint8_t levels[] = { 255, 128, 64, 32 };
+            int next = levels[0];
+            for (uint8_t level : levels) {
+                if (level < tuning.brightness) {
+                    next = level;
+                    break;
+                }
+            }
+            tuning.brightness = next;
+            break;
+        }
+        case ButtonAction::TapTempo:
+            if (!tapTempo.tap(event.ms)) return;
+            Serial.printf("[Input] Tapped %.1f BPM\n", tapTempo.getBpm(event.ms));
+            return;
+    }
+    Serial.printf("[Input] %s %s: auto %s, %s, brightness %d%s\n", buttonName(event.button),
+                  gestureName(event.gesture), autoSwitchEnabled ? "on" : "off", getCurrentName(),
+                  (int)tuning.brightness, frozen ? ", frozen" : "");
+}
+
+void HybridController::activate(int index) {
+    int previous = currentIndex;
+    currentIndex = index;
+    lastSwitch = FrameClock::now();
+    lastSwitchBeat = lastBeatIndex;
     debounceCounter = 0;
+    switchPending = false;
+    pendingIndex = -1;
     debugLog("Switched animation");
+    if (switchListener) switchListener(previous, index, modeSwapReason.c_str());
+}
+
+void HybridController::setSwitchListener(SwitchListener listener) {
+    switchListener = listener;
+}
+
+void HybridController::setExternalControl(bool enabled) {
+    externalControl = enabled;
+    switchPending = false;
+    pendingIndex = -1;
+    modeKeepReason = enabled ? "External control" : "Init";
+}
+
+bool HybridController::isExternalControl() const {
+    return externalControl;
+}
+
+void HybridController::showAnimation(int index, const char* reason) {
+    if (index < 0 || index >= animationCount || index == currentIndex) return;
+    modeSwapReason = reason;
+    activate(index);
+}
+
+void HybridController::followTimeline(const CueTimeline* track) {
+    for (int i = 0; i < track->nameCount; i++) {
+        timelineAnimations[i] = -1;
+        for (int a = 0; a < animationCount; a++) {
+            if (strcmp(animations[a].name, track->names[i]) == 0) {
+                timelineAnimations[i] = a;
+                break;
+            }
+        }
+        if (timelineAnimations[i] < 0) {
+            Serial.printf("[Cue] Unknown animation \"%s\", the selector will pick\n", track->names[i]);
+        }
+    }
+
+    setExternalControl(true);
+    timeline = track;
+    lastTimeline = track;
+    timelineBeats.reset(lastGridLocked);
+    nextCue = 0;
+    modeKeepReason = "Cue: waiting for beat";
+    debugLog("Timeline armed");
+}
+
+void HybridController::stopTimeline() {
+    if (!timeline) return;
+    timeline = nullptr;
+    setExternalControl(false);
+    debugLog("Timeline stopped");
+}
+
+bool HybridController::isFollowingTimeline() const {
+    return timeline != nullptr;
+}
+
+bool HybridController::advanceTimeline(const AudioFeatures& features) {
+    unsigned long periodMs = timeline->bpmX10 > 0 ? 600000UL / timeline->bpmX10 : 0;
+    if (!timelineBeats.update(FrameClock::now(), features.gridLocked, features.gridBeat,
+                              features.beatIndex, features.beatInBar, periodMs)) {
+        return false;
+    }
+
+    uint32_t beat = timelineBeats.getBeat();
+    if (beat >= timeline->beatCount) {
+        Serial.println("[Cue] Track finished, back to automatic switching");
+        stopTimeline();
+        return false;
+    }
+
+    int before = currentIndex;
+    while (nextCue < timeline->cueCount && timeline->cues[nextCue].beat <= beat) {
+        const CueEvent& cue = timeline->cues[nextCue++];
+        int index = cue.name != CUE_NO_ANIMATION ? timelineAnimations[cue.name] : -1;
+        if (index < 0) {
+            EnergyLevel energy = (EnergyLevel)min((int)cue.energy, (int)EnergyLevel::High);
+            index = selector.pickForEnergy(animations, animationCount, currentIndex, energy);
+        }
+        uint8_t kind = cue.section < timeline->sectionCount ? timeline->sections[cue.section].kind : CUE_SECTION_KIND_COUNT;
+        snprintf(cueReason, sizeof(cueReason), "Cue: %s", cueSectionName(kind));
+        showAnimation(index, cueReason);
+    }
+    modeKeepReason = "Following cue track";
+    return currentIndex != before;
+}
+
+// Drops move on the next downbeat; everything else waits for the phrase boundary
+void HybridController::schedulePhraseSwitch(const AudioFeatures& features, bool onNextBar) {
+    uint32_t unitBeats = (onNextBar ? 1 : tuning.phraseBars) * BeatGrid::BEATS_PER_BAR;
+    switchAtBeat = features.beatIndex + (unitBeats - features.beatIndex % unitBeats);
+    switchPending = true;
+    switchOnNextBar = onNextBar;
+    pendingIndex = -1;
+    modeKeepReason = onNextBar ? "Drop, next bar" : "Waiting for phrase";
+    debugLog("Switch scheduled");
+}
+
+bool HybridController::advancePendingSwitch(const AudioFeatures& features) {
+    if (!autoSwitchEnabled) {
+        switchPending = false;
+        pendingIndex = -1;
+        return false;
+    }
+
+    // Grid lost: there is no boundary to wait for any more
+    uint32_t beatsLeft = 0;
+    if (features.gridLocked && switchAtBeat > features.beatIndex) {
+        beatsLeft = switchAtBeat - features.beatIndex;
+    }
+
+    if (pendingIndex < 0 && beatsLeft <= (uint32_t)tuning.lookaheadBeats) {
+        pendingIndex = selector.pick(animations, animationCount, currentIndex);
+        modeSwapReason = selector.getLastReason();
+    }
+
+    if (beatsLeft == 0) {
+        activate(pendingIndex);
+        return true;
+    }
+    return false;
+}
+
+// The grid locked again and counts its beats afresh, from 0 after a relock.
+// Beats counted on the old count mean nothing on the new one: the last
+// switch is put as many beats back as the time since it makes at this
+// tempo, and a pending switch waits for the new count's boundary.
+void HybridController::relock(const AudioFeatures& features) {
+    float bpm = features.bpm > 0 ? features.bpm : 120;
+    uint32_t beatsSince = (uint32_t)((FrameClock::now() - lastSwitch) * bpm / 60000.0f);
+    // Wraps below 0 after a relock, and beatIndex - lastSwitchBeat still comes out right
+    lastSwitchBeat = features.beatIndex - beatsSince;
+    if (switchPending) schedulePhraseSwitch(features, switchOnNextBar);
 }
 
 bool HybridController::isAutoSwitchEnabled() const {
@@ -153,28 +370,116 @@ void HybridController::setAutoSwitchEnabled(bool enabled) {
 }
 
 
-void HybridController::update(CRGB* leds, int numLeds, const AudioFeatures& features) {
-    debugLog("Update called");
-
+// Per-frame bookkeeping and switch decision; returns true if the animation changed
+bool HybridController::step(const AudioFeatures& features) {
     // Low-pass smoothing of volume
-    const float alpha = 0.2;
+    const float alpha = tuning.volumeAlpha;
     smoothedVolume = alpha * features.volume + (1.0f - alpha) * smoothedVolume;
 
     // Update rolling history
-    volumeHistory[volumePos] = smoothedVolume;
-    volumePos = (volumePos + 1) % 10;
+    volumeWindow.push(smoothedVolume);
+    avgVolume = volumeWindow.mean();
+
+    selector.observe(features);
+    if (features.gridLocked && (!lastGridLocked || features.beatIndex < lastBeatIndex)) relock(features);
+    lastBeatIndex = features.beatIndex;
+    lastGridLocked = features.gridLocked;
+
+    if (timeline) {
+        return advanceTimeline(features);
+    }
+
+    if (externalControl) {
+        return false;
+    }
 
-    avgVolume = 0;
-    for (int i = 0; i < 10; i++) {
-        avgVolume += volumeHistory[i];
+    if (switchPending) {
+        return advancePendingSwitch(features);
     }
-    avgVolume /= 10.0;
 
     if (shouldSwitch(features)) {
-        switchAnimation();
+        if (!features.gridLocked || animationCount <= 1) {
+            switchAnimation();
+            return true;
+        }
+        schedulePhraseSwitch(features, selector.isDrop());
+        return advancePendingSwitch(features);
     }
+    return false;
+}
+
+void HybridController::update(CRGB* leds, int numLeds, const AudioFeatures& features) {
+    debugLog("Update called");
+    if (frozen) return;
+
+    bool switched = step(features);
 
     if (animationCount > 0) {
-        animations[currentIndex](leds, numLeds, features);
+        // Continue from the warmed-up frame instead of starting the new effect cold
+        if (switched && preparedIndex == currentIndex && numLeds <= NUM_LEDS) {
+            memcpy(leds, prepared, sizeof(CRGB) * numLeds);
+        }
+        if (switched) preparedIndex = -1;
+        animations[currentIndex].function(leds, numLeds, features);
+    }
+
+    if (switchPending && pendingIndex >= 0 && numLeds <= NUM_LEDS) {
+        if (preparedIndex != pendingIndex) {
+            fill_solid(prepared, NUM_LEDS, CRGB::Black);
+            preparedIndex = pendingIndex;
+        }
+        animations[pendingIndex].function(prepared, numLeds, features);
+    }
+}
+
+struct SimArray {
+    const AudioFeatures* frames;
+    int count;
+    int pos;
+};
+
+static bool nextSimFrame(AudioFeatures& features, void* context) {
+    SimArray* array = static_cast<SimArray*>(context);
+    if (array->pos >= array->count) return false;
+    features = array->frames[array->pos++];
+    return true;
+}
+
+void HybridController::simulate(const AudioFeatures* frames, int count, unsigned long frameMs) {
+    SimArray array = { frames, count, 0 };
+    simulate(nextSimFrame, &array, frameMs);
+}
+
+void HybridController::simulate(FeatureSource source, void* context, unsigned long frameMs) {
+    static uint16_t framesShown[ANIMATION_COUNT];
+    static AudioFeatures frame;
+    memset(framesShown, 0, sizeof(framesShown));
+    int switches = 0;
+    int count = 0;
+
+    if (frameMs > 0) FrameClock::freeze(0);
+    lastSwitch = FrameClock::now();
+    Serial.printf("[Sim] Starting on %s\n", getCurrentName());
+
+    while (source(frame, context)) {
+        int before = currentIndex;
+        count++;
+        if (step(frame)) {
+            unsigned long t = FrameClock::now();
+            Serial.printf("[Sim] %lu.%03lus %s -> %s | %s | energy=%.2f trend=%+.3f bpm=%.0f%s%s\n",
+                          t / 1000, t % 1000, animations[before].name, getCurrentName(),
+                          modeSwapReason.c_str(), selector.getEnergy(), selector.getEnergyTrend(),
+                          frame.bpm, selector.isBuildUp() ? " build-up" : "",
+                          selector.isDrop() ? " drop" : "");
+            switches++;
+        }
+        if (currentIndex < ANIMATION_COUNT) framesShown[currentIndex]++;
+        if (frameMs > 0) FrameClock::advance(frameMs);
+    }
+    FrameClock::release();
+
+    Serial.printf("[Sim] %d frames, %d switches\n", count, switches);
+    for (int i = 0; i < animationCount && i < ANIMATION_COUNT; i++) {
+        if (framesShown[i]) Serial.printf("[Sim]   %-26s %u frames\n", animations[i].name, framesShown[i]);
     }
 }
@@ -5,24 +5,57 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include "AudioProcessor.h"
-#include "Config.h"
+#include "Animations.h"
+#include "AnimationSelector.h"
+#include "RollingStats.h"
+#include "CueTimeline.h"
+#include "FixedString.h"
+#include "ButtonInput.h"
+#include "TapTempo.h"
+#include "config.h"
 
-class AudioFeatures;
-
-typedef void (*HybridAnimation)(CRGB*, int, const AudioFeatures&);
+// Called whenever the current animation changes
+typedef void (*SwitchListener)(int from, int to, const char* reason);
+// Supplies frames to simulate(); returns false when the sequence ends
+typedef bool (*FeatureSource)(AudioFeatures& features, void* context);
 
 class HybridController {
 public:
     HybridController();
-    void addAnimation(HybridAnimation animation, const String& name);
+    void setAnimations(const AnimationEntry* table, int count);
     void update(CRGB* leds, int numLeds, const AudioFeatures& features);
+    // Run the switching logic over a feature sequence without rendering and
+    // print each decision. Use a dedicated instance; it consumes the state.
+    // With frameMs = 0 the source is expected to drive FrameClock itself.
+    void simulate(const AudioFeatures* frames, int count, unsigned long frameMs);
+    void simulate(FeatureSource source, void* context, unsigned long frameMs);
+
+    void setSwitchListener(SwitchListener listener);
+    // External control: automatic decisions are suspended and the animation is
+    // chosen by showAnimation() (playback, timelines, a sync leader)
+    void setExternalControl(bool enabled);
+    bool isExternalControl() const;
+    void showAnimation(int index, const char* reason);
+    // Timeline mode: fire the cues of a pre-analyzed track (CueTimeline.h) as
+    // the live grid reaches their beats. Automatic switching resumes at the
+    // end of the track. The timeline must outlive the call.
+    void followTimeline(const CueTimeline* timeline);
+    void stopTimeline();
+    bool isFollowingTimeline() const;
     void switchAnimation();
+    // Acts on the gestures ButtonInput has queued (BUTTON_BINDINGS)
+    void pollInput();
+    void handleButton(const ButtonEvent& event);
+    // Freeze frame: update() leaves the strip as it is
+    bool isFrozen() const { return frozen; }
+    // The taps, as a tempo source for TempoTracker
+    TapTempo& getTapTempo() { return tapTempo; }
     void enableAutoSwitching();
     void disableAutoSwitching();
-    void debugLog(const String& message);
+    void debugLog(const char* message);
 
     // Accessors
-    String getCurrentName();
+    const char* getCurrentName();
     int getCurrentIndex();
     int getAnimationCount();
     float getAverageVolume();
@@ -32,31 +65,63 @@ public:
     void setAutoSwitchEnabled(bool enabled); // Setter for autoSwitchEnabled
 
     // Debug/Display reasons
-    String getModeSwapReason() const;
-    String getModeKeepReason() const;
+    const char* getModeSwapReason() const;
+    const char* getModeKeepReason() const;
 
 private:
-    HybridAnimation animations[HYBRID_ANIM_COUNT];
-    String names[HYBRID_ANIM_COUNT];
+    const AnimationEntry* animations;
     int currentIndex;
     int animationCount;
     unsigned long lastSwitch;
 
-    float volumeHistory[10];
-    int volumePos;
+    RollingWindow<10> volumeWindow;
     float avgVolume;
     float smoothedVolume;
     int debounceCounter;
-    bool buildUp;
-    bool drop;
     bool autoSwitchEnabled = true; // Move to private
+    bool externalControl = false;
+    SwitchListener switchListener = nullptr;
+    AnimationSelector selector;
+
+    // Phrase-aligned switching: the switch is scheduled for a grid beat, the
+    // next animation is picked tuning.lookaheadBeats ahead and rendered into
+    // `prepared` until the boundary so its state is warm when it takes over.
+    uint32_t lastBeatIndex;
+    uint32_t lastSwitchBeat;
+    bool switchPending;
+    bool switchOnNextBar;
+    uint32_t switchAtBeat;
+    int pendingIndex;
+    int preparedIndex;
+    alignas(4) CRGB prepared[NUM_LEDS];
+
+    bool frozen = false;
+    TapTempo tapTempo;
+    // The animations before the latest NextAnimation presses, newest first,
+    // for the Long or Double those presses turn out to start
+    int pressedFrom[2];
+    int pressedCount = 0;
+    // The last timeline followed, for the FollowTimeline button
+    const CueTimeline* lastTimeline = nullptr;
+
+    const CueTimeline* timeline = nullptr;
+    int timelineAnimations[CUE_MAX_NAMES];  // cue name id -> animation index, -1 unknown
+    CueBeatCounter timelineBeats;
+    bool lastGridLocked = false;
+    int nextCue = 0;
+    char cueReason[32];
 
-    bool isBuildUp();
-    bool isDrop();
+    bool step(const AudioFeatures& features);
     bool shouldSwitch(const AudioFeatures& features);
+    void schedulePhraseSwitch(const AudioFeatures& features, bool onNextBar);
+    bool advancePendingSwitch(const AudioFeatures& features);
+    void relock(const AudioFeatures& features);
+    void activate(int index);
+    void unpress(const ButtonEvent& event);
+    bool advanceTimeline(const AudioFeatures& features);
 
-    String modeSwapReason = "Init";
-    String modeKeepReason = "Init";
+    FixedString<32> modeSwapReason = "Init";
+    FixedString<32> modeKeepReason = "Init";
 };
 
 #endif
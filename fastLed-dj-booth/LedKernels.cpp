@@ -0,0 +1,145 @@
+#include "LedKernels.h"
+#include <string.h>
+
+static inline uint8_t scaleByte(uint8_t v, uint16_t scaleFixed) {
+    return (uint8_t)((v * scaleFixed) >> 8);
+}
+
+// Written so compilers recognize a saturating add (paddusb / uqadd)
+static inline uint8_t addByte(uint8_t a, uint8_t b) {
+    uint8_t sum = a + b;
+    return sum < a ? 255 : sum;
+}
+
+#if LED_KERNELS_SWAR
+static inline bool aligned4(const void* p) {
+    return ((uintptr_t)p & 3) == 0;
+}
+
+static inline uint32_t loadWord(const uint8_t* p) {
+    uint32_t w;
+    memcpy(&w, __builtin_assume_aligned(p, 4), 4);
+    return w;
+}
+
+static inline void storeWord(uint8_t* p, uint32_t w) {
+    memcpy(__builtin_assume_aligned(p, 4), &w, 4);
+}
+
+// Bytes 0 and 2 and bytes 1 and 3 are scaled as two 16-bit lanes each;
+// v * 256 still fits a lane, so no carries cross bytes
+static inline uint32_t scaleWord(uint32_t w, uint32_t scaleFixed) {
+    uint32_t even = ((w & 0x00FF00FF) * scaleFixed >> 8) & 0x00FF00FF;
+    uint32_t odd = (((w >> 8) & 0x00FF00FF) * scaleFixed) & 0xFF00FF00;
+    return even | odd;
+}
+
+// Per-byte saturating add: add the low 7 bits, fix up bit 7, then saturate
+// the bytes that carried out
+static inline uint32_t addWord(uint32_t a, uint32_t b) {
+    uint32_t sum = ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+    uint32_t carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+    return sum | ((carry >> 7) * 0xFF);
+}
+#endif
+
+void ledScale(uint8_t* bytes, size_t count, uint8_t scale) {
+    uint16_t scaleFixed = scale + 1;
+    size_t i = 0;
+#if LED_KERNELS_SWAR
+    for (; i < count && !aligned4(bytes + i); i++) bytes[i] = scaleByte(bytes[i], scaleFixed);
+    for (; i + 4 <= count; i += 4) storeWord(bytes + i, scaleWord(loadWord(bytes + i), scaleFixed));
+#endif
+    for (; i < count; i++) bytes[i] = scaleByte(bytes[i], scaleFixed);
+}
+
+void ledAdd(uint8_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+#if LED_KERNELS_SWAR
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 3) == 0) {
+        for (; i < count && !aligned4(dst + i); i++) dst[i] = addByte(dst[i], src[i]);
+        for (; i + 4 <= count; i += 4) storeWord(dst + i, addWord(loadWord(dst + i), loadWord(src + i)));
+    }
+#endif
+    for (; i < count; i++) dst[i] = addByte(dst[i], src[i]);
+}
+
+void ledBlend(uint8_t* dst, const uint8_t* src, size_t count, uint8_t amount) {
+    if (amount == 0) return;
+    if (amount == 255) {
+        memcpy(dst, src, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint16_t partial = (dst[i] << 8) | src[i];
+        partial += src[i] * amount;
+        partial -= dst[i] * amount;
+        dst[i] = partial >> 8;
+    }
+}
+
+void ledAddColor(uint8_t* bytes, size_t pixels, uint8_t r, uint8_t g, uint8_t b) {
+    size_t i = 0;
+#if LED_KERNELS_SWAR
+    if (aligned4(bytes)) {
+        // Three words cover four pixels: rgbr gbrg brgb
+        uint8_t pattern[12] = { r, g, b, r, g, b, r, g, b, r, g, b };
+        uint32_t w[3];
+        memcpy(w, pattern, sizeof(w));
+        for (; i + 4 <= pixels; i += 4) {
+            uint8_t* p = bytes + i * 3;
+            storeWord(p, addWord(loadWord(p), w[0]));
+            storeWord(p + 4, addWord(loadWord(p + 4), w[1]));
+            storeWord(p + 8, addWord(loadWord(p + 8), w[2]));
+        }
+    }
+#endif
+    for (; i < pixels; i++) {
+        uint8_t* p = bytes + i * 3;
+        p[0] = addByte(p[0], r);
+        p[1] = addByte(p[1], g);
+        p[2] = addByte(p[2], b);
+    }
+}
+
+// blur1d() gives every pixel `keep` of itself plus `seep` of each neighbour,
+// added with saturation. With qadd8 the order of the additions doesn't
+// matter, so the neighbours are staged as shifted copies and the whole
+// thing becomes scale and add passes over aligned buffers.
+void ledBlur(uint8_t* bytes, size_t pixels, uint8_t amount, uint8_t* scratch) {
+    if (pixels == 0) return;
+    size_t count = pixels * 3;
+    uint8_t keep = 255 - amount;
+    uint8_t seep = amount >> 1;
+    uint8_t* left = scratch;            // left[j] = bytes[j - 3]
+    uint8_t* right = scratch + count;   // right[j] = bytes[j + 3]
+
+    memset(left, 0, 3);
+    memcpy(left + 3, bytes, count - 3);
+    memcpy(right, bytes + 3, count - 3);
+    memset(right + count - 3, 0, 3);
+
+    ledScale(left, count * 2, seep);
+    ledAdd(left, right, count);
+    ledScale(bytes, count, keep);
+    ledAdd(bytes, left, count);
+}
+
+uint16_t ledRandomGate(uint8_t* mask, size_t count, uint16_t threshold, uint16_t seed) {
+    for (size_t i = 0; i < count; i++) {
+        seed = (uint16_t)(seed * 2053 + 13849);
+        uint8_t r = (uint8_t)((seed & 0xFF) + (seed >> 8));
+        mask[i] = r < threshold ? 0xFF : 0;
+    }
+    return seed;
+}
+
+void ledSetWhere(uint8_t* bytes, const uint8_t* mask, size_t pixels, uint8_t r, uint8_t g, uint8_t b) {
+    for (size_t i = 0; i < pixels; i++) {
+        uint8_t m = mask[i];
+        uint8_t* p = bytes + i * 3;
+        p[0] = (p[0] & ~m) | (r & m);
+        p[1] = (p[1] & ~m) | (g & m);
+        p[2] = (p[2] & ~m) | (b & m);
+    }
+}
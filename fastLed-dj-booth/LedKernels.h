@@ -0,0 +1,51 @@
+// LedKernels.h
+// Whole-buffer versions of the FastLED operations the animations run every
+// frame, on CRGB arrays viewed as bytes (r,g,b,r,g,b,...). Each operation is
+// per channel, so they can run several channels at a time regardless of
+// pixel boundaries. Results match FastLED bit for bit (FASTLED_SCALE8_FIXED
+// scale8, qadd8, blur1d, random8).
+//
+// The plain loops are left to the compiler to vectorize (SSE/NEON at -O3).
+// With LED_KERNELS_FORCE_SWAR they run four channels per 32-bit word
+// instead, on buffers that are 4-byte aligned; the bench has that slower
+// than the pixel-at-a-time code, so no build turns it on by default. Plain
+// C++; tools/led_kernel_bench compares both against FastLED-style code.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(LED_KERNELS_FORCE_SWAR)
+#define LED_KERNELS_SWAR 1
+#else
+#define LED_KERNELS_SWAR 0
+#endif
+
+// nscale8(): every channel scaled by scale/256 (scale 255 keeps the value)
+void ledScale(uint8_t* bytes, size_t count, uint8_t scale);
+
+// fadeToBlackBy()
+inline void ledFade(uint8_t* bytes, size_t count, uint8_t fadeBy) {
+    ledScale(bytes, count, 255 - fadeBy);
+}
+
+// dst += src with qadd8 per channel (CRGB +=)
+void ledAdd(uint8_t* dst, const uint8_t* src, size_t count);
+
+// nblend(): dst moves `amount`/255 of the way to src (FASTLED_BLEND_FIXED
+// blend8); per byte only
+void ledBlend(uint8_t* dst, const uint8_t* src, size_t count, uint8_t amount);
+
+// Adds one colour to `pixels` pixels (leds[i] += color for all i)
+void ledAddColor(uint8_t* bytes, size_t pixels, uint8_t r, uint8_t g, uint8_t b);
+
+// blur1d() over `pixels` pixels. `scratch` holds 6 * pixels bytes and
+// should be 4-byte aligned.
+void ledBlur(uint8_t* bytes, size_t pixels, uint8_t amount, uint8_t* scratch);
+
+// mask[i] = 0xFF where random8() < threshold, drawing `count` values from
+// FastLED's random8() sequence starting at `seed`; returns the new seed.
+uint16_t ledRandomGate(uint8_t* mask, size_t count, uint16_t threshold, uint16_t seed);
+
+// Sets the pixels whose mask byte is non-zero to one colour
+void ledSetWhere(uint8_t* bytes, const uint8_t* mask, size_t pixels, uint8_t r, uint8_t g, uint8_t b);
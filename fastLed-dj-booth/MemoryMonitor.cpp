@@ -0,0 +1,224 @@
+#include "MemoryMonitor.h"
+#include <atomic>
+#include <stdio.h>
+
+#if defined(ESP32)
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include "config.h"
+#else
+#include <malloc.h>
+#endif
+
+MemoryMonitor::WatchedTask MemoryMonitor::tasks[MEMORY_MAX_TASKS];
+int MemoryMonitor::taskCount = 0;
+uint32_t MemoryMonitor::frameStartAllocs = 0;
+uint32_t MemoryMonitor::frameStartFrees = 0;
+uint32_t MemoryMonitor::frameStartFree = 0;
+uint32_t MemoryMonitor::peakAllocs = 0;
+uint32_t MemoryMonitor::peakFrees = 0;
+int32_t MemoryMonitor::peakGrowth = 0;
+uint32_t MemoryMonitor::frames = 0;
+uint32_t MemoryMonitor::lastFrameAllocs = 0;
+unsigned long MemoryMonitor::lastReport = 0;
+
+static std::atomic<uint32_t> allocCount(0);
+static std::atomic<uint32_t> freeCount(0);
+static bool hooksSeen = false;
+
+void MemoryMonitor::countAlloc() {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryMonitor::countFree() {
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --- Platform ------------------------------------------------------------------
+
+#if defined(ESP32)
+
+#if MEMORY_ALLOC_HOOKS
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    (void)ptr;
+    (void)size;
+    (void)caps;
+    MemoryMonitor::countAlloc();
+}
+
+extern "C" void esp_heap_trace_free_hook(void* ptr) {
+    (void)ptr;
+    MemoryMonitor::countFree();
+}
+#endif
+
+static uint32_t freeHeap() {
+    return heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+}
+
+static void heapInfo(MemoryStats& stats) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_INTERNAL);
+    stats.freeBytes = info.total_free_bytes;
+    stats.minFreeBytes = info.minimum_free_bytes;
+    stats.largestFreeBlock = info.largest_free_block;
+}
+
+uint32_t MemoryMonitor::getStackFree(int i) {
+    // ESP-IDF reports the high-water mark in bytes
+    return uxTaskGetStackHighWaterMark((TaskHandle_t)tasks[i].handle);
+}
+
+#else
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+// Interpose glibc's allocator so host builds count every allocation
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    MemoryMonitor::countAlloc();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    MemoryMonitor::countAlloc();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    MemoryMonitor::countAlloc();
+    if (ptr) MemoryMonitor::countFree();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr) MemoryMonitor::countFree();
+    __libc_free(ptr);
+}
+}
+#define HOST_ALLOC_HOOKS 1
+#elif defined(__SANITIZE_ADDRESS__)
+// AddressSanitizer owns malloc; it calls these hooks instead
+extern "C" int __sanitizer_install_malloc_and_free_hooks(void (*mallocHook)(const volatile void*, size_t),
+                                                         void (*freeHook)(const volatile void*));
+
+static void sanitizerMallocHook(const volatile void* ptr, size_t size) {
+    (void)ptr;
+    (void)size;
+    MemoryMonitor::countAlloc();
+}
+
+static void sanitizerFreeHook(const volatile void* ptr) {
+    if (ptr) MemoryMonitor::countFree();
+}
+#define HOST_ALLOC_HOOKS 1
+#define HOST_SANITIZER_HOOKS 1
+#endif
+
+static uint32_t hostMinFree = UINT32_MAX;
+
+static uint32_t freeHeap() {
+    struct mallinfo2 info = mallinfo2();
+    return (uint32_t)info.fordblks;
+}
+
+static void heapInfo(MemoryStats& stats) {
+    // glibc grows the heap on demand; "free" is what it holds but isn't using
+    stats.freeBytes = freeHeap();
+    if (stats.freeBytes && stats.freeBytes < hostMinFree) hostMinFree = stats.freeBytes;
+    stats.minFreeBytes = hostMinFree == UINT32_MAX ? 0 : hostMinFree;
+    stats.largestFreeBlock = 0;
+}
+
+uint32_t MemoryMonitor::getStackFree(int i) {
+    (void)i;
+    return 0;
+}
+
+#endif
+
+// --- Frames and reports ------------------------------------------------------------
+
+void MemoryMonitor::begin(const char* taskName) {
+#if defined(ESP32)
+    hooksSeen = MEMORY_ALLOC_HOOKS;
+    watchTask(xTaskGetCurrentTaskHandle(), taskName);
+#else
+    (void)taskName;
+#if defined(HOST_SANITIZER_HOOKS)
+    if (!hooksSeen) __sanitizer_install_malloc_and_free_hooks(sanitizerMallocHook, sanitizerFreeHook);
+#endif
+#if defined(HOST_ALLOC_HOOKS)
+    hooksSeen = true;
+#endif
+#endif
+}
+
+bool MemoryMonitor::watchTask(void* task, const char* name) {
+    if (!task || taskCount >= MEMORY_MAX_TASKS) return false;
+    tasks[taskCount].handle = task;
+    tasks[taskCount].name = name;
+    taskCount++;
+    return true;
+}
+
+void MemoryMonitor::beginFrame() {
+    frameStartAllocs = allocCount.load(std::memory_order_relaxed);
+    frameStartFrees = freeCount.load(std::memory_order_relaxed);
+    frameStartFree = freeHeap();
+}
+
+void MemoryMonitor::endFrame() {
+    uint32_t allocs = allocCount.load(std::memory_order_relaxed) - frameStartAllocs;
+    uint32_t frees = freeCount.load(std::memory_order_relaxed) - frameStartFrees;
+    int32_t growth = (int32_t)(frameStartFree - freeHeap());
+    lastFrameAllocs = allocs;
+    if (allocs > peakAllocs) peakAllocs = allocs;
+    if (frees > peakFrees) peakFrees = frees;
+    if (frames == 0 || growth > peakGrowth) peakGrowth = growth;
+    frames++;
+}
+
+MemoryStats MemoryMonitor::sample() {
+    MemoryStats stats;
+    heapInfo(stats);
+    stats.fragmentation = (stats.freeBytes && stats.largestFreeBlock)
+        ? (uint8_t)(100 - (uint64_t)stats.largestFreeBlock * 100 / stats.freeBytes) : 0;
+    stats.allocsPerFrame = peakAllocs;
+    stats.freesPerFrame = peakFrees;
+    stats.netBytesPerFrame = peakGrowth;
+    stats.totalAllocs = allocCount.load(std::memory_order_relaxed);
+    stats.frames = frames;
+    stats.hooks = hooksSeen;
+    return stats;
+}
+
+MemoryStats MemoryMonitor::report() {
+    MemoryStats stats = sample();
+    peakAllocs = 0;
+    peakFrees = 0;
+    peakGrowth = 0;
+    frames = 0;
+    return stats;
+}
+
+size_t MemoryMonitor::format(const MemoryStats& stats, char* out, size_t len) {
+    int n = snprintf(out, len, "free %u, low %u, largest %u, frag %u%%, per frame: ",
+                     (unsigned)stats.freeBytes, (unsigned)stats.minFreeBytes,
+                     (unsigned)stats.largestFreeBlock, (unsigned)stats.fragmentation);
+    if (n < 0 || (size_t)n >= len) return len ? len - 1 : 0;
+    if (stats.hooks) {
+        n += snprintf(out + n, len - n, "%u allocs %u frees, ",
+                      (unsigned)stats.allocsPerFrame, (unsigned)stats.freesPerFrame);
+        if ((size_t)n >= len) return len - 1;
+    }
+    n += snprintf(out + n, len - n, "heap %+d B", (int)stats.netBytesPerFrame);
+    for (int i = 0; i < taskCount && (size_t)n < len; i++) {
+        n += snprintf(out + n, len - n, " | %s stack %u free", tasks[i].name, (unsigned)getStackFree(i));
+    }
+    return (size_t)n < len ? n : len - 1;
+}
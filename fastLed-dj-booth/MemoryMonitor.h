@@ -0,0 +1,87 @@
+// MemoryMonitor.h
+// Heap and stack instrumentation for long-running shows: free heap and its
+// low-water mark, largest free block and fragmentation, stack headroom of
+// the watched tasks, and allocations per frame.
+//
+// Allocations are counted by allocator hooks. On the ESP32 those need
+// CONFIG_HEAP_USE_HOOKS in the sdkconfig (ESP-IDF 5.1+) and MEMORY_ALLOC_HOOKS
+// in config.h; without them only the net heap change per frame is known. On
+// the host, malloc/free are interposed (glibc), or under AddressSanitizer
+// counted by its allocator hooks, so tools/memory_sim and booth_host see every
+// allocation the same pipeline makes.
+//
+// Plain C++ interface; the platform parts live in MemoryMonitor.cpp.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MEMORY_MAX_TASKS 4
+
+struct MemoryStats {
+    uint32_t freeBytes;
+    uint32_t minFreeBytes;        // lowest free heap since boot
+    uint32_t largestFreeBlock;    // 0 where the platform can't tell
+    uint8_t fragmentation;        // percent of free heap outside the largest block
+    uint32_t allocsPerFrame;      // most in one frame since the last report
+    uint32_t freesPerFrame;
+    int32_t netBytesPerFrame;     // largest heap growth in one frame since the last report
+    uint32_t totalAllocs;
+    uint32_t frames;              // frames since the last report
+    bool hooks;                   // allocation counts are available
+};
+
+class MemoryMonitor {
+public:
+    // Starts watching the calling task's stack (the Arduino loop task)
+    static void begin(const char* taskName = "loop");
+    // `task` is a FreeRTOS TaskHandle_t
+    static bool watchTask(void* task, const char* name);
+
+    static void beginFrame();
+    static void endFrame();
+
+    // Current heap state plus the per-frame peaks since the last report();
+    // report() also starts a new window
+    static MemoryStats sample();
+    static MemoryStats report();
+    // True once every intervalMs; for scheduling report()
+    static bool reportDue(unsigned long now, unsigned long intervalMs) {
+        if (now - lastReport < intervalMs) return false;
+        lastReport = now;
+        return true;
+    }
+
+    // Allocations between the last beginFrame() and endFrame()
+    static uint32_t getLastFrameAllocs() { return lastFrameAllocs; }
+
+    static int getTaskCount() { return taskCount; }
+    static const char* getTaskName(int i) { return tasks[i].name; }
+    // Bytes of stack that have never been used
+    static uint32_t getStackFree(int i);
+
+    // One-line summary of `stats` and the watched stacks
+    static size_t format(const MemoryStats& stats, char* out, size_t len);
+
+    // Called by the allocator hooks
+    static void countAlloc();
+    static void countFree();
+
+private:
+    struct WatchedTask {
+        void* handle;
+        const char* name;
+    };
+
+    static WatchedTask tasks[MEMORY_MAX_TASKS];
+    static int taskCount;
+    static uint32_t frameStartAllocs;
+    static uint32_t frameStartFrees;
+    static uint32_t frameStartFree;
+    static uint32_t peakAllocs;
+    static uint32_t peakFrees;
+    static int32_t peakGrowth;
+    static uint32_t frames;
+    static uint32_t lastFrameAllocs;
+    static unsigned long lastReport;
+};
@@ -0,0 +1,87 @@
+#include "MidiClock.h"
+
+#ifdef ESP32
+#include <Arduino.h>
+
+static MidiClock* receiver = nullptr;
+
+// Runs in the UART's event task, a byte time or two after the bytes came in,
+// however busy the loop is
+static void onMidiReceive() {
+    uint32_t ms = millis();
+    while (Serial2.available()) receiver->feed(Serial2.read(), ms);
+}
+
+bool MidiClock::begin() {
+    receiver = this;
+    Serial2.begin(31250, SERIAL_8N1, MIDI_RX_PIN, -1);
+    // Hand each byte over as soon as the line goes quiet after it
+    Serial2.setRxTimeout(1);
+    Serial2.onReceive(onMidiReceive);
+    return true;
+}
+#else
+bool MidiClock::begin() {
+    return false;
+}
+#endif
+
+void MidiClock::feed(uint8_t byte, uint32_t ms) {
+    if (byte != CLOCK && byte != START && byte != CONTINUE && byte != STOP) return;
+    Message message = { ms, byte };
+    if (!queue.push(message)) dropped = dropped + 1;
+}
+
+void MidiClock::drain() {
+    Message message;
+    while (queue.pop(message)) {
+        switch (message.status) {
+            case CLOCK:
+                clock(message.ms);
+                break;
+            case START:
+                // The next Clock is the first beat
+                startPending = true;
+                playing = true;
+                break;
+            case CONTINUE:
+                playing = true;
+                break;
+            case STOP:
+                playing = false;
+                break;
+        }
+    }
+}
+
+void MidiClock::clock(uint32_t ms) {
+    if (clocks.size() > 0 && ms - lastClockMs > CLOCK_TIMEOUT_MS) {
+        clocks.reset();
+        aligned = false;
+    }
+    tickCount++;
+    if (startPending) {
+        beatTick = tickCount;
+        aligned = true;
+        startPending = false;
+    }
+    clocks.add(tickCount, ms);
+    lastClockMs = ms;
+}
+
+bool MidiClock::estimate(uint32_t now, TempoEstimate& out) {
+    drain();
+    if (clocks.size() < CLOCKS_PER_BEAT / 2 || now - lastClockMs > CLOCK_TIMEOUT_MS) return false;
+    if (!clocks.isFitted() && !clocks.fit()) return false;
+    float msPerClock = clocks.getMsPerIndex();
+    if (msPerClock <= 0) return false;
+    float bpm = 60000.0f / (CLOCKS_PER_BEAT * msPerClock);
+    if (bpm < 30 || bpm > 300) return false;
+
+    out.bpm = bpm;
+    out.confidence = (float)clocks.size() / CLOCK_FIT;
+    out.phaseConfidence = aligned && playing ? out.confidence : 0.0f;
+    // The newest Clock that was a beat, where the line puts it
+    out.beatMs = clocks.timeOf(tickCount - (tickCount - beatTick) % CLOCKS_PER_BEAT);
+    return true;
+}
@@ -0,0 +1,62 @@
+// MidiClock.h
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+#include "SpscQueue.h"
+#include "TempoSource.h"
+
+// MIDI beat clock from a mixer, CDJ or drum machine on MIDI_RX_PIN: 24 Clock
+// bytes a beat, plus Start, Continue and Stop. Bytes are timed as they come
+// in, in the UART's receive task, and reach the loop through a queue. The
+// tempo is a line fitted through the last CLOCK_FIT clock times, so
+// the jitter of one byte is spread over two beats instead of landing on one
+// interval. The beat itself is only known after a Start, whose first Clock
+// is a beat, as is every 24th after it; without one the clock gives a
+// tempo only.
+class MidiClock : public TempoSource {
+public:
+    // Opens the MIDI UART; false where there is none (the host)
+    bool begin();
+    // Producer side: a byte off the wire and when it arrived. Anything but
+    // the clock's realtime messages is ignored.
+    void feed(uint8_t byte, uint32_t ms);
+
+    const char* name() const override { return "MIDI"; }
+    bool estimate(uint32_t now, TempoEstimate& out) override;
+
+    // Between a Start or Continue and a Stop
+    bool isPlaying() const { return playing; }
+    uint32_t getDropped() const { return dropped; }
+
+    static const uint8_t CLOCK = 0xF8;
+    static const uint8_t START = 0xFA;
+    static const uint8_t CONTINUE = 0xFB;
+    static const uint8_t STOP = 0xFC;
+    static const int CLOCKS_PER_BEAT = 24;
+
+private:
+    static const int CLOCK_FIT = 2 * CLOCKS_PER_BEAT;
+    // A gap this long means the clock went away; it starts over when it's back
+    static const uint32_t CLOCK_TIMEOUT_MS = 500;
+
+    struct Message {
+        uint32_t ms;
+        uint8_t status;
+    };
+
+    void drain();
+    void clock(uint32_t ms);
+
+    SpscQueue<Message, 64> queue;
+    volatile uint32_t dropped = 0;
+
+    // Loop side
+    BeatFit<CLOCK_FIT> clocks;
+    uint32_t tickCount = 0;
+    uint32_t lastClockMs = 0;
+    uint32_t beatTick = 0;     // a Clock that was a beat
+    bool aligned = false;      // beatTick is known
+    bool startPending = false;
+    bool playing = false;
+};
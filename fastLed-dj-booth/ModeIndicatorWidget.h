@@ -14,7 +14,7 @@ public:
 
     void draw(TFT_eSPI& tft, int x, int y, int width, int height) override {
         uint16_t fillColor = isAuto ? theme.primary : theme.accent;
-        String modeText = isAuto ? "AUTO" : "MANUAL";
+        const char* modeText = isAuto ? "AUTO" : "MANUAL";
 
         tft.fillRoundRect(x, y, width, height, 4, fillColor);
         tft.setTextColor(theme.text, fillColor);
@@ -0,0 +1,98 @@
+#include "Modulation.h"
+#include "FrameClock.h"
+#include "PaletteTables.h"
+
+// Free-running tempo before any has been detected, and the range accepted
+#define MOD_DEFAULT_BPM 120
+#define MOD_MIN_BPM 30
+#define MOD_MAX_BPM 250
+#define MOD_BEATS_PER_PHRASE 32
+
+uint32_t Modulation::position = 0;
+uint32_t Modulation::lastOnsetPosition = 0xFFFF0000;  // already decayed
+unsigned long Modulation::lastUpdate = 0;
+uint16_t Modulation::bpmQ8 = MOD_DEFAULT_BPM << 8;
+bool Modulation::locked = false;
+bool Modulation::started = false;
+uint16_t Modulation::phases[MOD_RATE_COUNT];
+uint8_t Modulation::lfoValues[MOD_RATE_COUNT][MOD_SHAPE_COUNT];
+uint8_t Modulation::envelopes[MOD_ENVELOPE_COUNT];
+uint8_t Modulation::triggers = 0;
+
+#define MOD_RATE_SHIFT(name, shift) shift,
+static const int8_t rateShifts[MOD_RATE_COUNT] = { MOD_RATE_TABLE(MOD_RATE_SHIFT) };
+#undef MOD_RATE_SHIFT
+
+// The rate's 16-bit phase from the 16.16 beat position
+static inline uint16_t ratePhase(uint32_t position, int8_t shift) {
+    return (uint16_t)(shift < 0 ? position << -shift : position >> shift);
+}
+
+// 255 at the start of a cycle, falling off quadratically to 0 at its end
+static inline uint8_t decay(uint16_t phase) {
+    uint16_t r = 255 - (phase >> 8);
+    return (r * (r + 1)) >> 8;
+}
+
+void Modulation::reset() {
+    position = 0;
+    lastOnsetPosition = 0xFFFF0000;
+    lastUpdate = 0;
+    bpmQ8 = MOD_DEFAULT_BPM << 8;
+    locked = false;
+    started = false;
+    triggers = 0;
+}
+
+void Modulation::update(const AudioFeatures& features) {
+    unsigned long now = FrameClock::now();
+    uint32_t previous = position;
+
+    if (features.bpm >= MOD_MIN_BPM && features.bpm <= MOD_MAX_BPM) {
+        bpmQ8 = (uint16_t)(features.bpm * 256.0);
+    }
+    locked = features.gridLocked;
+    if (locked) {
+        float phase = features.beatPhase < 0.0f ? 0.0f : (features.beatPhase > 1.0f ? 1.0f : features.beatPhase);
+        // Rounded, so a frame that lands on a subdivision is in it and not just before
+        uint32_t fraction = (uint32_t)(phase * 65536.0f + 0.5f);
+        position = (features.beatIndex << 16) | (fraction > 0xFFFF ? 0xFFFF : fraction);
+    } else if (started) {
+        // beats = ms * bpm / 60000, in 16.16 with the tempo in 8.8
+        uint32_t dt = now - lastUpdate;
+        position += (uint32_t)(((uint64_t)dt * bpmQ8 << 8) / 60000);
+    }
+
+    bool onset = features.beatDetected;
+    bool beat, bar, phrase;
+    if (locked) {
+        beat = features.gridBeat;
+        bar = beat && features.beatInBar == 0;
+        phrase = beat && features.beatIndex % MOD_BEATS_PER_PHRASE == 0;
+    } else {
+        beat = onset;
+        bar = started && (position >> 18) != (previous >> 18);
+        phrase = started && (position >> 21) != (previous >> 21);
+    }
+    triggers = (beat << (int)ModTrigger::Beat) | (bar << (int)ModTrigger::Bar) |
+               (phrase << (int)ModTrigger::Phrase) | (onset << (int)ModTrigger::Onset);
+    if (onset) lastOnsetPosition = position;
+    lastUpdate = now;
+    started = true;
+
+    for (int r = 0; r < MOD_RATE_COUNT; r++) {
+        uint16_t phase = ratePhase(position, rateShifts[r]);
+        uint8_t p = phase >> 8;
+        phases[r] = phase;
+        lfoValues[r][(int)ModShape::Sine] = sine8(p);
+        lfoValues[r][(int)ModShape::Triangle] = (p & 0x80 ? 255 - p : p) << 1;
+        lfoValues[r][(int)ModShape::RampUp] = p;
+        lfoValues[r][(int)ModShape::RampDown] = 255 - p;
+        lfoValues[r][(int)ModShape::Square] = p & 0x80 ? 0 : 255;
+    }
+
+    uint32_t sinceOnset = position - lastOnsetPosition;
+    envelopes[(int)ModEnvelope::Beat] = decay(phases[(int)ModRate::Beat]);
+    envelopes[(int)ModEnvelope::Bar] = decay(phases[(int)ModRate::Bar]);
+    envelopes[(int)ModEnvelope::Onset] = sinceOnset < 0x10000 ? decay(sinceOnset) : 0;
+}
@@ -0,0 +1,78 @@
+// Modulation.h
+#pragma once
+
+#include <stdint.h>
+#include "AudioFeatures.h"
+
+// LFO rates, as beats per cycle: X(name, log2 of beats per cycle)
+#define MOD_RATE_TABLE(X) \
+    X(Beat4x,   -2) \
+    X(Beat2x,   -1) \
+    X(Beat,      0) \
+    X(TwoBeats,  1) \
+    X(Bar,       2) \
+    X(TwoBars,   3) \
+    X(Phrase,    5)
+
+enum class ModRate : uint8_t {
+#define MOD_RATE_ENUM(name, shift) name,
+    MOD_RATE_TABLE(MOD_RATE_ENUM)
+#undef MOD_RATE_ENUM
+};
+
+#define MOD_RATE_COUNT_ONE(...) + 1
+constexpr int MOD_RATE_COUNT = 0 MOD_RATE_TABLE(MOD_RATE_COUNT_ONE);
+#undef MOD_RATE_COUNT_ONE
+
+enum class ModShape : uint8_t { Sine, Triangle, RampUp, RampDown, Square };
+constexpr int MOD_SHAPE_COUNT = 5;
+
+// Envelopes that restart at 255 and decay to 0: over each grid beat, each
+// bar, and over one beat period from each detected onset
+enum class ModEnvelope : uint8_t { Beat, Bar, Onset };
+constexpr int MOD_ENVELOPE_COUNT = 3;
+
+// True for one frame: a beat (grid tick while locked, onset otherwise), the
+// first beat of a bar, of an 8-bar phrase, and every detected onset
+enum class ModTrigger : uint8_t { Beat, Bar, Phrase, Onset };
+
+// Shared, tempo-locked time base for the animations. update() runs once per
+// frame: it advances a 16.16 fixed-point beat position (the beat grid's while
+// it is locked, otherwise free-running at the detected tempo) and fills small
+// tables of LFO values, envelopes and triggers from it. Animations only read
+// those, so a per-pixel loop costs one table lookup instead of a clock query,
+// and everything moves with the music rather than with millis().
+class Modulation {
+public:
+    // Once per frame, before the animations render
+    static void update(const AudioFeatures& features);
+    // Back to beat 0 at 120 BPM, e.g. before a scripted run
+    static void reset();
+
+    // 0-255 value of an LFO this frame
+    static uint8_t lfo(ModRate rate, ModShape shape = ModShape::Sine) {
+        return lfoValues[(int)rate][(int)shape];
+    }
+    // Progress through the rate's cycle, for offsetting per-pixel waves
+    static uint8_t phase8(ModRate rate) { return phases[(int)rate] >> 8; }
+    static uint16_t phase16(ModRate rate) { return phases[(int)rate]; }
+
+    static uint8_t envelope(ModEnvelope env) { return envelopes[(int)env]; }
+    static bool trigger(ModTrigger t) { return triggers & (1 << (int)t); }
+
+    // Position in beats, 16.16 fixed point
+    static uint32_t getPosition() { return position; }
+    static bool isLocked() { return locked; }
+
+private:
+    static uint32_t position;
+    static uint32_t lastOnsetPosition;
+    static unsigned long lastUpdate;
+    static uint16_t bpmQ8;
+    static bool locked;
+    static bool started;
+    static uint16_t phases[MOD_RATE_COUNT];
+    static uint8_t lfoValues[MOD_RATE_COUNT][MOD_SHAPE_COUNT];
+    static uint8_t envelopes[MOD_ENVELOPE_COUNT];
+    static uint8_t triggers;
+};
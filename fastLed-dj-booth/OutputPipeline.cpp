@@ -0,0 +1,108 @@
+#include "OutputPipeline.h"
+#include "MemoryMonitor.h"
+#include <string.h>
+
+OutputPipeline::OutputPipeline(DisplayManager& display, LedSink& strip)
+    : display(display), strip(strip) {}
+
+bool OutputPipeline::begin() {
+    TaskHandle_t led = nullptr;
+    TaskHandle_t dash = nullptr;
+    xTaskCreatePinnedToCore(ledTaskMain, "leds", PIPELINE_LED_STACK, this, 3, &led, PIPELINE_OUTPUT_CORE);
+    xTaskCreatePinnedToCore(displayTaskMain, "display", PIPELINE_DISPLAY_STACK, this, 2, &dash, PIPELINE_OUTPUT_CORE);
+    if (!led || !dash) {
+        Serial.println("[Pipeline] Couldn't start the output tasks");
+        return false;
+    }
+    ledTask = led;
+    displayTask = dash;
+    MemoryMonitor::watchTask(led, "leds");
+    MemoryMonitor::watchTask(dash, "display");
+    Serial.printf("[Pipeline] Output on core %d, render on core %d\n", PIPELINE_OUTPUT_CORE, xPortGetCoreID());
+    return true;
+}
+
+void OutputPipeline::publishLeds(const CRGB* leds, uint8_t brightness, uint8_t dither) {
+    LedFrame& frame = ledFrames.back();
+    memcpy(frame.pixels, leds, sizeof(frame.pixels));
+    frame.brightness = brightness;
+    frame.dither = dither;
+    if (ledFrames.publish()) replacedLeds++;
+    xTaskNotifyGive((TaskHandle_t)ledTask);
+}
+
+void OutputPipeline::publishDashboard(const AudioFeatures& features, const DashboardStatus& status) {
+    DashboardFrame& frame = dashboards.back();
+    frame.features = features;
+    if (features.waveform) {
+        memcpy(frame.waveform, features.waveform, sizeof(frame.waveform));
+        frame.features.waveform = frame.waveform;
+    }
+    frame.status = status;
+    if (dashboards.publish()) replacedDashboards++;
+    xTaskNotifyGive((TaskHandle_t)displayTask);
+}
+
+void OutputPipeline::chargeTo(FrameProfiler& profiler) {
+    // A stage that finished nothing this frame costs nothing this frame
+    uint32_t shown = shownFrames.load(std::memory_order_acquire);
+    uint32_t drawn = drawnFrames.load(std::memory_order_acquire);
+    profiler.setParallel(FrameStage::Show, shown != chargedShown ? showUs.load(std::memory_order_relaxed) : 0);
+    profiler.setParallel(FrameStage::Display, drawn != chargedDrawn ? displayUs.load(std::memory_order_relaxed) : 0);
+    chargedShown = shown;
+    chargedDrawn = drawn;
+}
+
+void OutputPipeline::report(FrameProfiler& profiler, unsigned long now) {
+    uint32_t shown = shownFrames.load(std::memory_order_relaxed);
+    uint32_t drawn = drawnFrames.load(std::memory_order_relaxed);
+    float seconds = (now - lastReport) / 1000.0f;
+    if (lastReport && seconds > 0) {
+        Serial.printf("[Pipeline] render %.1f ms, output %.1f ms | LEDs %.1f fps, %u replaced | TFT %.1f fps, %u replaced | overlap gain %.2fx\n",
+                      profiler.getWindowSerialMs(), profiler.getWindowParallelMs(),
+                      (shown - reportedShown) / seconds, (unsigned)replacedLeds,
+                      (drawn - reportedDrawn) / seconds, (unsigned)replacedDashboards,
+                      profiler.getOverlapGain());
+    }
+    lastReport = now;
+    reportedShown = shown;
+    reportedDrawn = drawn;
+    replacedLeds = replacedDashboards = 0;
+    profiler.resetWindow();
+}
+
+// --- Output core ---------------------------------------------------------------
+
+void OutputPipeline::ledTaskMain(void* self) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        static_cast<OutputPipeline*>(self)->showLeds();
+    }
+}
+
+void OutputPipeline::displayTaskMain(void* self) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        static_cast<OutputPipeline*>(self)->drawDashboard();
+        // TFT pushes are busy-waits; let the core's idle task feed the watchdog
+        vTaskDelay(1);
+    }
+}
+
+void OutputPipeline::showLeds() {
+    if (!ledFrames.acquire()) return;
+    LedFrame& frame = ledFrames.front();
+    unsigned long start = micros();
+    strip.show(frame.pixels, NUM_LEDS, frame.brightness, frame.dither);
+    showUs.store(micros() - start, std::memory_order_relaxed);
+    shownFrames.fetch_add(1, std::memory_order_release);
+}
+
+void OutputPipeline::drawDashboard() {
+    if (!dashboards.acquire()) return;
+    DashboardFrame& frame = dashboards.front();
+    unsigned long start = micros();
+    display.updateAudioVisualization(frame.features, frame.status);
+    displayUs.store(micros() - start, std::memory_order_relaxed);
+    drawnFrames.fetch_add(1, std::memory_order_release);
+}
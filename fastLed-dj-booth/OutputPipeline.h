@@ -0,0 +1,79 @@
+// OutputPipeline.h
+#pragma once
+#include <Arduino.h>
+#include <FastLED.h>
+#include <atomic>
+#include "config.h"
+#include "AudioFeatures.h"
+#include "DisplayManager.h"
+#include "FrameProfiler.h"
+#include "Hal.h"
+#include "TripleBuffer.h"
+
+// One LED frame as handed to the output core
+struct LedFrame {
+    alignas(4) CRGB pixels[NUM_LEDS];
+    uint8_t brightness;
+    uint8_t dither;
+};
+
+// One dashboard drawing; features.waveform points at the copy here
+struct DashboardFrame {
+    AudioFeatures features;
+    int16_t waveform[NUM_SAMPLES];
+    DashboardStatus status;
+};
+
+// Dual-core frame pipeline. The Arduino loop renders frame N+1 into its own
+// CRGB array on one core while frame N goes out on the other: a task there
+// shows the strip, and a second, lower-priority one draws the TFT, so a
+// slow dashboard never holds up the strip. Frames cross over through
+// TripleBuffers, copied out of the render buffer so the animations keep
+// their trails; the render core never blocks, and a frame the output side
+// hasn't got to yet is replaced by the newer one and counted.
+//
+// The output tasks time their work and chargeTo() hands it to the render
+// core's FrameProfiler as parallel stages, which is where the pipeline's
+// gain over the serial loop is measured.
+class OutputPipeline {
+public:
+    OutputPipeline(DisplayManager& display, LedSink& strip);
+
+    // After FastLED.addLeds() and the display's setup; false if the tasks
+    // couldn't be started
+    bool begin();
+
+    void publishLeds(const CRGB* leds, uint8_t brightness, uint8_t dither);
+    void publishDashboard(const AudioFeatures& features, const DashboardStatus& status);
+
+    // Output work finished since the last call, as the Show and Display stages
+    void chargeTo(FrameProfiler& profiler);
+
+    // Prints the window's render and output times, frame rates and overlap gain
+    void report(FrameProfiler& profiler, unsigned long now);
+
+private:
+    DisplayManager& display;
+    LedSink& strip;
+    TripleBuffer<LedFrame> ledFrames;
+    TripleBuffer<DashboardFrame> dashboards;
+    void* ledTask = nullptr;
+    void* displayTask = nullptr;
+
+    std::atomic<uint32_t> showUs{0};
+    std::atomic<uint32_t> displayUs{0};
+    std::atomic<uint32_t> shownFrames{0};
+    std::atomic<uint32_t> drawnFrames{0};
+    uint32_t chargedShown = 0;
+    uint32_t chargedDrawn = 0;
+    uint32_t reportedShown = 0;
+    uint32_t reportedDrawn = 0;
+    uint32_t replacedLeds = 0;
+    uint32_t replacedDashboards = 0;
+    unsigned long lastReport = 0;
+
+    static void ledTaskMain(void* self);
+    static void displayTaskMain(void* self);
+    void showLeds();
+    void drawDashboard();
+};
@@ -0,0 +1,38 @@
+#include "PaletteManager.h"
+#include "FrameClock.h"
+#include "TuningParams.h"
+
+const PaletteData* PaletteManager::from = paletteTable[PALETTE_rainbow];
+const PaletteData* PaletteManager::to = paletteTable[PALETTE_rainbow];
+uint8_t PaletteManager::blendAmount = 0;
+uint8_t PaletteManager::current = PALETTE_rainbow;
+unsigned long PaletteManager::blendStart = 0;
+
+void PaletteManager::set(uint8_t palette) {
+    if (palette >= PALETTE_COUNT) return;
+    current = palette;
+    from = to = paletteTable[palette];
+    blendAmount = 0;
+}
+
+void PaletteManager::update() {
+    unsigned long now = FrameClock::now();
+    uint8_t wanted = tuning.palette;
+    if (wanted != current && wanted < PALETTE_COUNT) {
+        // Retargeted mid-blend: carry on from whichever palette dominates
+        if (blendAmount >= 128) from = to;
+        to = paletteTable[wanted];
+        current = wanted;
+        blendAmount = 0;
+        blendStart = now;
+    }
+
+    if (from == to) return;
+    unsigned long elapsed = now - blendStart;
+    if (elapsed >= (unsigned long)tuning.paletteBlendMs) {
+        from = to;
+        blendAmount = 0;
+    } else {
+        blendAmount = max(1UL, elapsed * 255 / tuning.paletteBlendMs);
+    }
+}
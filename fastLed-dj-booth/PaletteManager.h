@@ -0,0 +1,48 @@
+// PaletteManager.h
+#pragma once
+
+#include <FastLED.h>
+#include "PaletteTables.h"
+
+// The palette the animations draw from. Colours are read straight from the
+// flash tables in PaletteTables; changing tuning.palette cross-fades to the
+// new one over tuning.paletteBlendMs.
+class PaletteManager {
+public:
+    // Once per frame, before the animations render
+    static void update();
+    // Switch at once, without a blend
+    static void set(uint8_t palette);
+    static uint8_t getCurrent() { return current; }
+
+    // Palette colour at `index`, dimmed and washed out the way CHSV(index, sat, value)
+    // treats a hue. With the rainbow palette this is the CHSV colour.
+    static CRGB color(uint8_t index, uint8_t value = 255, uint8_t sat = 255) {
+        const PaletteColor& a = from->colors[index];
+        CRGB c(a.r, a.g, a.b);
+        if (blendAmount) {
+            const PaletteColor& b = to->colors[index];
+            c = blend(c, CRGB(b.r, b.g, b.b), blendAmount);
+        }
+        if (sat != 255) {
+            uint8_t desat = scale8_video(255 - sat, 255 - sat);
+            c.nscale8(255 - desat);
+            c += CRGB(desat, desat, desat);
+        }
+        if (value != 255) c.nscale8(dim8_video(value));
+        return c;
+    }
+
+    // HeatColor(temperature)
+    static CRGB heat(uint8_t temperature) {
+        const PaletteColor& h = heatTable.colors[temperature];
+        return CRGB(h.r, h.g, h.b);
+    }
+
+private:
+    static const PaletteData* from;
+    static const PaletteData* to;
+    static uint8_t blendAmount;
+    static uint8_t current;
+    static unsigned long blendStart;
+};
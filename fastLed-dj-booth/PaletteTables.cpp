@@ -0,0 +1,164 @@
+#include "PaletteTables.h"
+#include <stddef.h>
+
+// Everything here is evaluated by the compiler; the tables end up in flash
+// (.rodata) and cost no RAM or start-up time.
+
+namespace {
+
+template<size_t... I> struct Indices {};
+template<size_t N, size_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+template<size_t... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+typedef MakeIndices<256>::type AllIndices;
+
+// FastLED's scale8 / scale8_video (FASTLED_SCALE8_FIXED)
+constexpr uint8_t scale8(unsigned i, unsigned scale) {
+    return (uint8_t)((i * (1 + scale)) >> 8);
+}
+constexpr uint8_t scale8Video(unsigned i, unsigned scale) {
+    return (uint8_t)(((i * scale) >> 8) + ((i && scale) ? 1 : 0));
+}
+
+constexpr PaletteColor rgb(unsigned r, unsigned g, unsigned b) {
+    return PaletteColor{ (uint8_t)r, (uint8_t)g, (uint8_t)b };
+}
+
+// --- Rainbow: hsv2rgb_rainbow() at full saturation and value -----------------
+
+constexpr PaletteColor rainbowSection(unsigned section, unsigned third, unsigned twoThirds) {
+    return section == 0 ? rgb(255 - third, third, 0) :
+           section == 1 ? rgb(171, 85 + third, 0) :
+           section == 2 ? rgb(171 - twoThirds, 170 + third, 0) :
+           section == 3 ? rgb(0, 255 - third, third) :
+           section == 4 ? rgb(0, 171 - twoThirds, 85 + twoThirds) :
+           section == 5 ? rgb(third, 0, 255 - third) :
+           section == 6 ? rgb(85 + third, 0, 171 - third) :
+                          rgb(170 + third, 0, 85 - third);
+}
+
+constexpr PaletteColor rainbowAt(unsigned hue) {
+    return rainbowSection(hue >> 5, scale8((hue & 0x1F) << 3, 85), scale8((hue & 0x1F) << 3, 170));
+}
+
+// --- Gradients: linear between stops, like DEFINE_GRADIENT_PALETTE -----------
+
+struct GradientStop {
+    uint8_t pos;
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+constexpr uint8_t lerpChannel(int a, int b, int num, int den) {
+    return (uint8_t)(den == 0 ? b : a + (b - a) * num / den);
+}
+
+constexpr PaletteColor between(const GradientStop& a, const GradientStop& b, unsigned i) {
+    return rgb(lerpChannel(a.r, b.r, i - a.pos, b.pos - a.pos),
+               lerpChannel(a.g, b.g, i - a.pos, b.pos - a.pos),
+               lerpChannel(a.b, b.b, i - a.pos, b.pos - a.pos));
+}
+
+// Stops must start at 0 and end at 255
+constexpr PaletteColor gradientAt(const GradientStop* stops, size_t k, unsigned i) {
+    return i <= stops[k + 1].pos ? between(stops[k], stops[k + 1], i) : gradientAt(stops, k + 1, i);
+}
+
+// --- HeatColor() ---------------------------------------------------------------
+
+constexpr PaletteColor heatRamp(unsigned t192, unsigned ramp) {
+    return (t192 & 0x80) ? rgb(255, 255, ramp) :
+           (t192 & 0x40) ? rgb(255, ramp, 0) :
+                           rgb(ramp, 0, 0);
+}
+
+constexpr PaletteColor heatAt(unsigned temperature) {
+    return heatRamp(scale8Video(temperature, 191), (scale8Video(temperature, 191) & 0x3F) << 2);
+}
+
+// --- sin8() (sin8_C's piecewise linear approximation) -------------------------
+
+constexpr uint8_t sineSlope[8] = { 0, 49, 49, 41, 90, 27, 117, 10 };
+
+constexpr uint8_t sineFromOffset(unsigned theta, unsigned offset) {
+    return (uint8_t)(128 + ((theta & 0x80) ? -1 : 1) *
+        (int8_t)(uint8_t)(((sineSlope[(offset >> 4) * 2 + 1] *
+                            ((offset & 0x0F) + ((theta & 0x40) ? 1 : 0))) >> 4) +
+                          sineSlope[(offset >> 4) * 2]));
+}
+
+constexpr uint8_t sineAt(unsigned theta) {
+    return sineFromOffset(theta, ((theta & 0x40) ? 255 - theta : theta) & 0x3F);
+}
+
+// --- Table builders ------------------------------------------------------------
+
+template<size_t... I>
+constexpr PaletteData buildRainbow(Indices<I...>) { return PaletteData{ { rainbowAt(I)... } }; }
+
+template<size_t... I>
+constexpr PaletteData buildGradient(const GradientStop* stops, Indices<I...>) {
+    return PaletteData{ { gradientAt(stops, 0, I)... } };
+}
+
+template<size_t... I>
+constexpr PaletteData buildHeat(Indices<I...>) { return PaletteData{ { heatAt(I)... } }; }
+
+template<size_t... I>
+constexpr ByteTable buildSine(Indices<I...>) { return ByteTable{ { sineAt(I)... } }; }
+
+// Gradients wrap around (last stop = first) so animations that scroll the
+// index don't show a seam; lava is the exception, it runs cold to hot
+constexpr GradientStop lavaStops[] = {
+    {   0,   0,   0,   0 }, {  46,  18,   0,   0 }, {  96, 113,   0,   0 },
+    { 140, 255,   0,   0 }, { 184, 255,  96,   0 }, { 224, 255, 200,   0 }, { 255, 255, 255, 255 },
+};
+constexpr GradientStop oceanStops[] = {
+    {   0,   0,   0,  40 }, {  64,   0,  40, 160 }, { 128,   0, 140, 200 },
+    { 192,  40, 220, 200 }, { 255,   0,   0,  40 },
+};
+constexpr GradientStop forestStops[] = {
+    {   0,   0,  40,   0 }, {  80,  20, 140,  10 }, { 140, 120, 180,   0 },
+    { 200,  20,  90,  40 }, { 255,   0,  40,   0 },
+};
+constexpr GradientStop cyberStops[] = {
+    {   0, 120,   0, 255 }, {  64, 255,   0, 160 }, { 128,   0, 255, 255 },
+    { 192, 255, 255,   0 }, { 255, 120,   0, 255 },
+};
+constexpr GradientStop sunsetStops[] = {
+    {   0, 120,   0,   0 }, {  40, 200,  40,   0 }, {  96, 255, 160,   0 },
+    { 150, 200,   0,  80 }, { 210,  60,   0, 120 }, { 255, 120,   0,   0 },
+};
+constexpr GradientStop iceStops[] = {
+    {   0,   0,   0,  60 }, {  96,   0,  80, 255 }, { 176, 140, 220, 255 },
+    { 224, 255, 255, 255 }, { 255,   0,   0,  60 },
+};
+
+constexpr PaletteData rainbowPalette = buildRainbow(AllIndices());
+constexpr PaletteData lavaPalette = buildGradient(lavaStops, AllIndices());
+constexpr PaletteData oceanPalette = buildGradient(oceanStops, AllIndices());
+constexpr PaletteData forestPalette = buildGradient(forestStops, AllIndices());
+constexpr PaletteData cyberPalette = buildGradient(cyberStops, AllIndices());
+constexpr PaletteData sunsetPalette = buildGradient(sunsetStops, AllIndices());
+constexpr PaletteData icePalette = buildGradient(iceStops, AllIndices());
+
+} // namespace
+
+constexpr PaletteData heatTable = buildHeat(AllIndices());
+constexpr ByteTable sineTable = buildSine(AllIndices());
+
+const PaletteData* const paletteTable[PALETTE_COUNT] = {
+#define PALETTE_ENTRY(id, name) &id##Palette,
+    PALETTE_TABLE(PALETTE_ENTRY)
+#undef PALETTE_ENTRY
+};
+
+const char* const paletteNames[PALETTE_COUNT] = {
+#define PALETTE_NAME(id, name) name,
+    PALETTE_TABLE(PALETTE_NAME)
+#undef PALETTE_NAME
+};
+
+static_assert(sizeof(PaletteData) == 768, "palette entries must pack to 3 bytes");
+static_assert(rainbowPalette.colors[160].b == 255 && heatTable.colors[255].b == 252 &&
+              sineTable.values[64] == 255, "tables must match FastLED's CHSV, HeatColor and sin8");
@@ -0,0 +1,52 @@
+// PaletteTables.h
+// 256-entry colour tables and wave lookups, computed at compile time in
+// PaletteTables.cpp and stored in flash. Plain C++ so the tuning table (and
+// the host tools that include it) can see PALETTE_COUNT.
+#pragma once
+
+#include <stdint.h>
+
+struct PaletteColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+struct PaletteData {
+    PaletteColor colors[256];
+};
+
+struct ByteTable {
+    uint8_t values[256];
+};
+
+// Selectable LED palettes, in tuning.palette order. Rainbow reproduces
+// FastLED's CHSV rainbow so animations look as they did with HSV.
+//  X(id,       name)
+#define PALETTE_TABLE(X) \
+    X(rainbow,  "Rainbow")  \
+    X(lava,     "Lava")     \
+    X(ocean,    "Ocean")    \
+    X(forest,   "Forest")   \
+    X(cyber,    "Cyber")    \
+    X(sunset,   "Sunset")   \
+    X(ice,      "Ice")
+
+enum PaletteId : uint8_t {
+#define PALETTE_ENUM(id, name) PALETTE_##id,
+    PALETTE_TABLE(PALETTE_ENUM)
+#undef PALETTE_ENUM
+    PALETTE_COUNT
+};
+
+extern const PaletteData* const paletteTable[PALETTE_COUNT];
+extern const char* const paletteNames[PALETTE_COUNT];
+
+// HeatColor() for every temperature
+extern const PaletteData heatTable;
+// sin8() for every angle
+extern const ByteTable sineTable;
+
+inline uint8_t sine8(uint8_t theta) {
+    return sineTable.values[theta];
+}
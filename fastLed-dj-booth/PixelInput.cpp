@@ -0,0 +1,216 @@
+#include "PixelInput.h"
+#include "LedKernels.h"
+#include <math.h>
+#include <string.h>
+
+// Arrival smoothing: weight of each new frame, and how far off the schedule a
+// frame may land before the schedule restarts from it
+#define PIXEL_SMOOTHING 0.125f
+#define PIXEL_RESYNC_MS 250
+// Delay behind the smoothed arrivals, in mean deviations of the interval
+#define PIXEL_JITTER_FACTOR 2.0f
+
+PixelInput::PixelInput(PixelTransport& transport, uint16_t firstUniverse)
+    : transport(transport), firstUniverse(firstUniverse), filling(-1), shown(-1),
+      streaming(false), lastPacketAt(0), endedAt(0), lastSyncAt(0), synced(false), lastSequence(0), sequenced(false),
+      scheduled(false), lastArrival(0), expectedMs(0.0f), intervalMs(0.0f), jitterMs(0.0f) {
+    for (Slot& slot : slots) {
+        memset(slot.pixels, 0, sizeof(slot.pixels));
+        slot.universes = 0;
+        slot.playoutMs = 0;
+        slot.state = SlotState::Free;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool PixelInput::isStreaming(unsigned long now) const {
+    return streaming && now - lastPacketAt < PIXEL_TIMEOUT_MS;
+}
+
+void PixelInput::poll(unsigned long now) {
+    uint8_t header[E131_HEADER_LENGTH];
+    size_t len;
+    while ((len = transport.peek(header, sizeof(header))) > 0) {
+        DmxHeader dmx;
+        bool e131 = isE131(header, len);
+        size_t headerLen = e131 ? E131_HEADER_LENGTH : ARTNET_HEADER_LENGTH;
+        if (!(e131 ? parseE131(header, len, dmx) : parseArtNet(header, len, dmx))) {
+            stats.badPackets++;
+            transport.take(header, headerLen, nullptr, 0);
+            continue;
+        }
+        if (dmx.kind == PixelPacket::Sync) {
+            transport.take(header, headerLen, nullptr, 0);
+            synced = true;
+            lastSyncAt = now;
+            if (filling >= 0) commit(now);
+            continue;
+        }
+
+        size_t dataLen = 0;
+        uint8_t* data = destination(dmx, now, dataLen);
+        transport.take(header, headerLen, data, dataLen);
+        if (!data) continue;
+
+        streaming = true;
+        lastPacketAt = now;
+        if (dmx.terminated) {
+            endStream(now);
+            continue;
+        }
+        Slot& slot = slots[filling];
+        slot.universes |= 1u << (dmx.universe - firstUniverse);
+        // Desks that send ArtSync stop doing so when they go back to unsynced
+        if (synced && now - lastSyncAt > PIXEL_TIMEOUT_MS) synced = false;
+        if (!synced && slot.universes == ALL_UNIVERSES) commit(now);
+    }
+}
+
+// Where the channel data of this packet goes, starting a frame if needed;
+// null if it isn't for this strip
+uint8_t* PixelInput::destination(const DmxHeader& header, unsigned long now, size_t& len) {
+    if (header.universe < firstUniverse || header.universe >= firstUniverse + PIXEL_UNIVERSES) return nullptr;
+    int universe = header.universe - firstUniverse;
+
+    if (!isStreaming(now)) {
+        // A new stream: nothing carries over from the last one but its last frame
+        if (filling >= 0) slots[filling].state = SlotState::Free;
+        filling = -1;
+        scheduled = false;
+        // and the desk may have restarted its sequence numbers
+        sequenced = false;
+    }
+
+    if (universe == 0 && header.sequence != 0) {
+        // Sequence numbers run 1-255 on Art-Net, 0-255 on E1.31. A packet from
+        // behind the last one was overtaken on the way: showing it would step
+        // back a frame.
+        uint8_t gap = header.sequence - lastSequence;
+        if (lastSequence == 255 && header.sequence == 1) gap = 1;
+        if (sequenced && (gap == 0 || gap >= 128)) {
+            stats.skipped++;
+            return nullptr;
+        }
+        if (sequenced && gap > 1) stats.lostPackets += gap - 1;
+        lastSequence = header.sequence;
+        sequenced = true;
+    }
+
+    // A universe already in the frame being filled starts the next frame;
+    // the one before goes out with what it has
+    if (filling >= 0 && (slots[filling].universes & (1u << universe))) commit(lastPacketAt);
+    if (filling < 0) filling = startFrame();
+
+    size_t offset = universe * DMX_PIXELS * 3;
+    size_t room = FRAME_BYTES - offset;
+    if (room > DMX_PIXELS * 3) room = DMX_PIXELS * 3;
+    len = header.length < room ? header.length : room;
+    return slots[filling].pixels + offset;
+}
+
+// A slot for the next frame: a free one, or else the oldest frame still
+// waiting, which is dropped. Never the one on show.
+int PixelInput::startFrame() {
+    int oldest = -1;
+    for (int i = 0; i < PIXEL_JITTER_SLOTS; i++) {
+        if (slots[i].state == SlotState::Free) {
+            oldest = i;
+            break;
+        }
+        if (slots[i].state == SlotState::Ready &&
+            (oldest < 0 || (long)(slots[i].playoutMs - slots[oldest].playoutMs) < 0)) {
+            oldest = i;
+        }
+    }
+    if (slots[oldest].state == SlotState::Ready) stats.skipped++;
+    slots[oldest].state = SlotState::Filling;
+    slots[oldest].universes = 0;
+    return oldest;
+}
+
+void PixelInput::commit(unsigned long now) {
+    Slot& slot = slots[filling];
+    filling = -1;
+    stats.frames++;
+
+    // Smooth the arrivals into a steady schedule: each frame is expected one
+    // interval after the last, pulled a little towards when it really came
+    if (scheduled) {
+        float interval = (float)(now - lastArrival);
+        intervalMs = intervalMs > 0.0f ? intervalMs + (interval - intervalMs) * PIXEL_SMOOTHING : interval;
+        jitterMs += (fabsf(interval - intervalMs) - jitterMs) * PIXEL_SMOOTHING;
+        expectedMs += intervalMs;
+        expectedMs += ((float)now - expectedMs) * PIXEL_SMOOTHING;
+        if (fabsf((float)now - expectedMs) > PIXEL_RESYNC_MS) expectedMs = (float)now;
+    } else {
+        expectedMs = (float)now;
+        intervalMs = 0.0f;
+        jitterMs = 0.0f;
+        scheduled = true;
+    }
+    lastArrival = now;
+
+    float delay = jitterMs * PIXEL_JITTER_FACTOR;
+    if (delay > PIXEL_JITTER_MAX_MS) delay = PIXEL_JITTER_MAX_MS;
+    stats.delayMs = (uint16_t)delay;
+    stats.intervalMs = (uint16_t)intervalMs;
+    slot.playoutMs = (unsigned long)(expectedMs + delay + 0.5f);
+    if ((long)(now - slot.playoutMs) > 0) {
+        slot.playoutMs = now;
+        stats.late++;
+    }
+    slot.state = SlotState::Ready;
+}
+
+void PixelInput::endStream(unsigned long now) {
+    streaming = false;
+    sequenced = false;
+    endedAt = now;
+}
+
+const uint8_t* PixelInput::playout(unsigned long now) {
+    if (!isStreaming(now)) {
+        if (streaming) endStream(lastPacketAt + PIXEL_TIMEOUT_MS);
+        // Frames that never got their turn go; the one on show stays for fadeOut()
+        for (Slot& slot : slots) {
+            if (slot.state == SlotState::Ready || slot.state == SlotState::Filling) slot.state = SlotState::Free;
+        }
+        filling = -1;
+        return nullptr;
+    }
+
+    // The newest frame that is due; any due before it were overtaken
+    int due = -1;
+    for (int i = 0; i < PIXEL_JITTER_SLOTS; i++) {
+        if (slots[i].state != SlotState::Ready || (long)(now - slots[i].playoutMs) < 0) continue;
+        if (due < 0) {
+            due = i;
+        } else if ((long)(slots[i].playoutMs - slots[due].playoutMs) >= 0) {
+            slots[due].state = SlotState::Free;
+            stats.skipped++;
+            due = i;
+        } else {
+            slots[i].state = SlotState::Free;
+            stats.skipped++;
+        }
+    }
+    if (due >= 0) {
+        if (shown >= 0) slots[shown].state = SlotState::Free;
+        slots[due].state = SlotState::Shown;
+        shown = due;
+        stats.shown++;
+    }
+    return shown >= 0 ? slots[shown].pixels : nullptr;
+}
+
+void PixelInput::fadeOut(uint8_t* leds, unsigned long now) {
+    if (shown < 0 || isStreaming(now)) return;
+    unsigned long elapsed = now - endedAt;
+    if (elapsed >= PIXEL_FADE_MS) {
+        slots[shown].state = SlotState::Free;
+        shown = -1;
+        return;
+    }
+    uint8_t amount = 255 - elapsed * 255 / PIXEL_FADE_MS;
+    ledBlend(leds, slots[shown].pixels, FRAME_BYTES, amount);
+}
@@ -0,0 +1,106 @@
+// PixelInput.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "PixelProtocol.h"
+
+// Universes the strip spans, from PIXEL_INPUT_UNIVERSE on
+#define PIXEL_UNIVERSES ((NUM_LEDS + DMX_PIXELS - 1) / DMX_PIXELS)
+static_assert(PIXEL_UNIVERSES <= 32, "PixelInput tracks universes in a 32-bit mask");
+static_assert(PIXEL_JITTER_SLOTS >= 3, "PixelInput needs a slot on show, one filling and one waiting");
+
+// Datagrams carrying pixel packets. The header is looked at in place before
+// the packet is taken, so its channel data can be read straight to where it
+// belongs: UdpPixelTransport does both with one recvmsg().
+class PixelTransport {
+public:
+    virtual ~PixelTransport() {}
+    // The start of the next datagram without taking it, without blocking;
+    // bytes copied, or 0 if there is none
+    virtual size_t peek(uint8_t* header, size_t len) = 0;
+    // Takes the datagram: `headerLen` bytes into `header`, the `dataLen`
+    // after them into `data` (which may be null), the rest dropped. Bytes
+    // written to `data`.
+    virtual size_t take(uint8_t* header, size_t headerLen, uint8_t* data, size_t dataLen) = 0;
+};
+
+struct PixelStats {
+    uint32_t frames;        // assembled
+    uint32_t shown;
+    uint32_t skipped;       // overtaken by a newer frame before their turn
+    uint32_t late;          // arrived after their playout time
+    uint32_t lostPackets;   // gaps in the first universe's sequence (dropped
+                            // or overtaken on the way)
+    uint32_t badPackets;
+    uint16_t delayMs;       // current jitter-buffer delay
+    uint16_t intervalMs;    // the sender's frame interval
+};
+
+// Pixel stream input from a lighting desk (Art-Net or E1.31). Channel data
+// goes from the socket straight into one of a few frame slots; the playout
+// side hands the due slot to the output as is. Frames are played on a
+// steady schedule smoothed from their arrival times, a jitter-sized delay
+// behind, so uneven Wi-Fi delivery doesn't show as uneven motion.
+//
+// A frame is complete once every universe of the strip has arrived, or, if
+// the desk sends ArtSync, on the sync. When the stream stops (no packets
+// for PIXEL_TIMEOUT_MS, or an E1.31 stream-terminated flag) the last frame
+// is held until then and fades into the animations over PIXEL_FADE_MS.
+class PixelInput {
+public:
+    PixelInput(PixelTransport& transport, uint16_t firstUniverse);
+
+    // Once per frame: files whatever has arrived
+    void poll(unsigned long now);
+    // The frame to show at `now` (NUM_LEDS RGB triples, 4-byte aligned): the
+    // newest one due, or the last again; null while there is no stream
+    const uint8_t* playout(unsigned long now);
+    // Without a stream, blends the last streamed frame over the animations'
+    // `leds` while it fades out
+    void fadeOut(uint8_t* leds, unsigned long now);
+
+    bool isStreaming(unsigned long now) const;
+    const PixelStats& getStats() const { return stats; }
+
+private:
+    static const int FRAME_BYTES = NUM_LEDS * 3;
+    static const uint32_t ALL_UNIVERSES = PIXEL_UNIVERSES == 32 ? 0xFFFFFFFF : (1u << PIXEL_UNIVERSES) - 1;
+
+    enum class SlotState : uint8_t { Free, Filling, Ready, Shown };
+    struct Slot {
+        alignas(4) uint8_t pixels[FRAME_BYTES];
+        uint32_t universes;       // received so far
+        unsigned long playoutMs;
+        SlotState state;
+    };
+
+    PixelTransport& transport;
+    uint16_t firstUniverse;
+    Slot slots[PIXEL_JITTER_SLOTS];
+    int filling;
+    int shown;
+
+    bool streaming;
+    unsigned long lastPacketAt;
+    unsigned long endedAt;
+    unsigned long lastSyncAt;
+    bool synced;
+    uint8_t lastSequence;
+    bool sequenced;
+
+    // Playout schedule
+    bool scheduled;
+    unsigned long lastArrival;
+    float expectedMs;         // smoothed arrival of the latest frame
+    float intervalMs;
+    float jitterMs;
+
+    PixelStats stats;
+
+    uint8_t* destination(const DmxHeader& header, unsigned long now, size_t& len);
+    int startFrame();
+    void commit(unsigned long now);
+    void endStream(unsigned long now);
+};
@@ -0,0 +1,87 @@
+// PixelProtocol.h
+// The two DMX-over-UDP protocols lighting desks send pixel data with:
+// Art-Net (ArtDmx, ArtSync) and sACN / E1.31. Only what PixelInput needs to
+// find the universe, sequence and channel data of a packet. Plain C++ so
+// tools/pixel_gen can build packets with the same definitions.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define ARTNET_PORT 6454
+#define E131_PORT 5568
+
+#define DMX_CHANNELS 512
+// Whole RGB pixels in a universe (170 * 3 = 510 channels)
+#define DMX_PIXELS 170
+
+// Art-Net: "Art-Net\0", opcode (little-endian), protocol version 14 (big-endian)
+#define ARTNET_HEADER_LENGTH 18
+#define ARTNET_OP_DMX 0x5000
+#define ARTNET_OP_SYNC 0x5200
+#define ARTNET_VERSION 14
+
+// E1.31: root, framing and DMP layers before the channel data
+#define E131_HEADER_LENGTH 126
+#define E131_ROOT_VECTOR 0x00000004
+#define E131_FRAMING_VECTOR 0x00000002
+#define E131_DMP_VECTOR 0x02
+
+enum class PixelPacket : uint8_t { None, Dmx, Sync };
+
+struct DmxHeader {
+    PixelPacket kind;
+    uint16_t universe;
+    uint8_t sequence;      // 0 = the sender doesn't number packets (Art-Net)
+    uint16_t length;       // channel data bytes that follow the header
+    bool terminated;       // E1.31 sender is stopping this universe
+};
+
+static const uint8_t ARTNET_ID[8] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+static const uint8_t E131_ID[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+
+inline uint16_t readBe16(const uint8_t* p) { return (uint16_t)(p[0] << 8 | p[1]); }
+inline uint32_t readBe32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Art-Net packet from its first ARTNET_HEADER_LENGTH bytes
+inline bool parseArtNet(const uint8_t* p, size_t len, DmxHeader& header) {
+    if (len < 12 || memcmp(p, ARTNET_ID, sizeof(ARTNET_ID)) != 0) return false;
+    uint16_t op = (uint16_t)(p[8] | p[9] << 8);
+    if (readBe16(p + 10) < ARTNET_VERSION) return false;
+    if (op == ARTNET_OP_SYNC) {
+        header.kind = PixelPacket::Sync;
+        header.length = 0;
+        header.terminated = false;
+        return true;
+    }
+    if (op != ARTNET_OP_DMX || len < ARTNET_HEADER_LENGTH) return false;
+    header.kind = PixelPacket::Dmx;
+    header.sequence = p[12];
+    header.universe = (uint16_t)((p[15] & 0x7F) << 8 | p[14]);
+    header.length = readBe16(p + 16);
+    header.terminated = false;
+    return header.length <= DMX_CHANNELS;
+}
+
+// Is this the start of an E1.31 packet (first 16 bytes)?
+inline bool isE131(const uint8_t* p, size_t len) {
+    return len >= 16 && readBe16(p) == 0x0010 && memcmp(p + 4, E131_ID, sizeof(E131_ID)) == 0;
+}
+
+// E1.31 data packet from its first E131_HEADER_LENGTH bytes
+inline bool parseE131(const uint8_t* p, size_t len, DmxHeader& header) {
+    if (len < E131_HEADER_LENGTH || !isE131(p, len)) return false;
+    if (readBe32(p + 18) != E131_ROOT_VECTOR || readBe32(p + 40) != E131_FRAMING_VECTOR) return false;
+    if (p[117] != E131_DMP_VECTOR || p[125] != 0) return false;  // start code 0: dimmer data
+    uint16_t count = readBe16(p + 123);  // includes the start code
+    if (count < 1 || count > DMX_CHANNELS + 1) return false;
+    header.kind = PixelPacket::Dmx;
+    header.sequence = p[111];
+    header.universe = readBe16(p + 113);
+    header.length = count - 1;
+    header.terminated = p[112] & 0x40;
+    return true;
+}
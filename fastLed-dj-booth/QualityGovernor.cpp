@@ -0,0 +1,111 @@
+#include "QualityGovernor.h"
+#include "TuningParams.h"
+#include "FrameLog.h"
+
+// Frames over budget before stepping down, frames with headroom before
+// stepping up (doubled each time a step up fails), frames to let the
+// average settle after a change
+#define QUALITY_DOWN_FRAMES 8
+#define QUALITY_UP_FRAMES 50
+#define QUALITY_UP_FRAMES_MAX 800
+#define QUALITY_COOLDOWN_FRAMES 16
+// Step up only when the frame fits in this share of the budget
+#define QUALITY_HEADROOM 0.6f
+
+struct QualityLevel {
+    uint8_t displayEvery;
+    uint8_t waveformStep;
+    bool dither;
+    bool blur;
+    const char* label;
+};
+
+static const QualityLevel levels[] = {
+#define QUALITY_ENTRY(every, step, dither, blur, label) { every, step, dither, blur, label },
+    QUALITY_TABLE(QUALITY_ENTRY)
+#undef QUALITY_ENTRY
+};
+static const uint8_t LEVEL_COUNT = sizeof(levels) / sizeof(levels[0]);
+
+uint8_t QualityGovernor::level = 0;
+float QualityGovernor::averageMs = 0;
+uint16_t QualityGovernor::overFrames = 0;
+uint16_t QualityGovernor::underFrames = 0;
+uint16_t QualityGovernor::cooldown = 0;
+uint32_t QualityGovernor::frames = 0;
+uint32_t QualityGovernor::lastStepUp = 0;
+uint16_t QualityGovernor::upDelay[] = {
+#define QUALITY_UP_DELAY(every, step, dither, blur, label) QUALITY_UP_FRAMES,
+    QUALITY_TABLE(QUALITY_UP_DELAY)
+#undef QUALITY_UP_DELAY
+};
+FixedString<48> QualityGovernor::reason = "Full";
+
+void QualityGovernor::reset() {
+    level = 0;
+    averageMs = 0;
+    overFrames = underFrames = cooldown = 0;
+    lastStepUp = 0;
+    for (int i = 0; i < LEVEL_COUNT; i++) upDelay[i] = QUALITY_UP_FRAMES;
+    reason = levels[0].label;
+}
+
+void QualityGovernor::setLevel(uint8_t newLevel, const char* why, float budgetMs) {
+    if (newLevel > level && lastStepUp && frames - lastStepUp < 2 * QUALITY_UP_FRAMES) {
+        // The level just restored could not hold; wait longer next time
+        upDelay[level] = min(upDelay[level] * 2, QUALITY_UP_FRAMES_MAX);
+    }
+    if (newLevel < level) lastStepUp = frames;
+    level = newLevel;
+    overFrames = underFrames = 0;
+    cooldown = QUALITY_COOLDOWN_FRAMES;
+    reason.format("%s (%s %.0f/%.0fms)", levels[level].label, why, averageMs, budgetMs);
+    FRAME_LOG("[Quality] Level %d: %s\n", level, reason.c_str());
+}
+
+void QualityGovernor::update(const FrameProfiler& profiler) {
+    frames++;
+
+    float budgetMs = tuning.frameBudgetMs;
+    if (budgetMs <= 0) {
+        if (level != 0) reset();
+        return;
+    }
+
+    float workMs = profiler.getWorkUs() / 1000.0f;
+    averageMs = averageMs ? averageMs * 0.875f + workMs * 0.125f : workMs;
+    if (cooldown) {
+        cooldown--;
+        return;
+    }
+
+    if (averageMs > budgetMs) {
+        underFrames = 0;
+        if (++overFrames >= QUALITY_DOWN_FRAMES && level < LEVEL_COUNT - 1) {
+            setLevel(level + 1, "over", budgetMs);
+        }
+    } else if (averageMs < budgetMs * QUALITY_HEADROOM) {
+        overFrames = 0;
+        if (level > 0 && ++underFrames >= upDelay[level - 1]) {
+            setLevel(level - 1, "headroom", budgetMs);
+        }
+    } else {
+        overFrames = underFrames = 0;
+    }
+}
+
+bool QualityGovernor::drawDisplay(uint32_t frame) {
+    return frame % levels[level].displayEvery == 0;
+}
+
+int QualityGovernor::waveformStep() {
+    return levels[level].waveformStep;
+}
+
+bool QualityGovernor::ditherEnabled() {
+    return levels[level].dither;
+}
+
+bool QualityGovernor::blurEnabled() {
+    return levels[level].blur;
+}
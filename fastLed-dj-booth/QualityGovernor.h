@@ -0,0 +1,48 @@
+// QualityGovernor.h
+#pragma once
+#include <Arduino.h>
+#include "FrameProfiler.h"
+#include "FixedString.h"
+
+// Quality levels, best first. Each step gives up the costliest work that
+// matters least on the night: TFT redraws (and waveform detail), then
+// dithering, then the animations' blur passes.
+//  X(displayEvery, waveformStep, dither, blur, label)
+#define QUALITY_TABLE(X) \
+    X(1, 1, true,  true,  "Full")                  \
+    X(2, 2, true,  true,  "Display 1/2")           \
+    X(4, 4, false, true,  "Display 1/4, no dither") \
+    X(8, 8, false, false, "Display 1/8, no blur")
+
+// Holds each frame's work (every stage but the end-of-loop delay, on the
+// busier core when the pipeline is on; see FrameProfiler::getWorkUs()) inside
+// tuning.frameBudgetMs by stepping down through QUALITY_TABLE while it runs
+// over, and back up once there has been headroom for a while. Returning to
+// a level that had to be abandoned soon after takes longer each time, so the
+// governor settles instead of flapping. Its reason is shown on the TFT.
+class QualityGovernor {
+public:
+    // Once per frame, after the Idle stage has been marked
+    static void update(const FrameProfiler& profiler);
+    static void reset();
+
+    static uint8_t getLevel() { return level; }
+    static bool drawDisplay(uint32_t frame);
+    static int waveformStep();
+    static bool ditherEnabled();
+    static bool blurEnabled();
+    static const char* getReason() { return reason.c_str(); }
+
+private:
+    static uint8_t level;
+    static float averageMs;
+    static uint16_t overFrames;
+    static uint16_t underFrames;
+    static uint16_t cooldown;
+    static uint32_t frames;
+    static uint32_t lastStepUp;
+    static uint16_t upDelay[];
+    static FixedString<48> reason;
+
+    static void setLevel(uint8_t newLevel, const char* why, float budgetMs);
+};
@@ -0,0 +1,77 @@
+// RollingStats.h
+#pragma once
+
+#include <math.h>
+
+// Incremental statistics used by the controller and the gain stage. Every
+// update is O(1); nothing rescans a history array.
+
+// Exponential moving average; alpha ~ 1 / (time constant in frames)
+struct Ema {
+    float value = 0.0f;
+    float alpha;
+
+    explicit Ema(float a) : alpha(a) {}
+
+    float update(float x) {
+        value += alpha * (x - value);
+        return value;
+    }
+};
+
+// Running peak that follows rises instantly and decays slowly
+struct PeakTracker {
+    float value = 0.0f;
+    float release;
+
+    explicit PeakTracker(float r) : release(r) {}
+
+    float update(float x) {
+        value = x > value ? x : value * release;
+        return value;
+    }
+};
+
+// Follower with separate rise and fall time constants, for frames of any length
+struct Envelope {
+    float value = 0.0f;
+    float attackMs;
+    float releaseMs;
+
+    Envelope(float attack, float release) : attackMs(attack), releaseMs(release) {}
+
+    float update(float x, float dtMs) {
+        float tau = x > value ? attackMs : releaseMs;
+        value += (x - value) * (tau > 0.0f ? 1.0f - expf(-dtMs / tau) : 1.0f);
+        return value;
+    }
+};
+
+// Fixed window with a running sum; the sum is rebuilt once per wrap to stop float drift
+template <int N>
+class RollingWindow {
+public:
+    RollingWindow() : pos(0), sum(0.0f) {
+        for (int i = 0; i < N; i++) samples[i] = 0.0f;
+    }
+
+    void push(float x) {
+        sum += x - samples[pos];
+        samples[pos] = x;
+        pos = (pos + 1) % N;
+        if (pos == 0) {
+            sum = 0.0f;
+            for (int i = 0; i < N; i++) sum += samples[i];
+        }
+    }
+
+    float mean() const { return sum / N; }
+    float newest() const { return samples[(pos + N - 1) % N]; }
+    // Value pushed `age` updates ago (0 = newest)
+    float at(int age) const { return samples[(pos + N - 1 - age) % N]; }
+
+private:
+    float samples[N];
+    int pos;
+    float sum;
+};
@@ -0,0 +1,92 @@
+#include "SpatialMap.h"
+#include <Arduino.h>
+#include <string.h>
+
+struct SegmentSpec {
+    int first;
+    int count;
+    SegmentShape shape;
+    int ring;
+};
+
+#define SPATIAL_SEGMENT(first, count, shape, ring) { first, count, SegmentShape::shape, ring },
+static const SegmentSpec segments[] = { LED_SEGMENT_TABLE(SPATIAL_SEGMENT) };
+#undef SPATIAL_SEGMENT
+static const int SEGMENT_COUNT = sizeof(segments) / sizeof(segments[0]);
+
+SpatialMap::PixelGeometry SpatialMap::geometry[NUM_LEDS];
+uint16_t SpatialMap::ringStart[SPATIAL_MAX_RINGS + 1];
+// Every pixel once, plus the second listing of each Line's middle
+static const int RING_PIXEL_CAPACITY = NUM_LEDS + SEGMENT_COUNT;
+uint16_t SpatialMap::ringPixels[RING_PIXEL_CAPACITY];
+int SpatialMap::rings = 0;
+
+// Calls visit(pixel, ring) for every listing in ring order within each
+// segment: a Line from its middle outward, left then right
+template <typename Visit>
+static void forEachListing(Visit visit) {
+    for (const SegmentSpec& s : segments) {
+        if (s.shape == SegmentShape::Ring) {
+            for (int i = s.first; i < s.first + s.count; i++) visit(i, s.ring);
+            continue;
+        }
+        int middle = s.first + s.count / 2;
+        for (int d = 0; d <= s.count / 2; d++) {
+            if (middle - d >= s.first) visit(middle - d, s.ring + d);
+            if (middle + d < s.first + s.count) visit(middle + d, s.ring + d);
+        }
+    }
+}
+
+void SpatialMap::build() {
+    memset(geometry, 0, sizeof(geometry));
+    memset(ringStart, 0, sizeof(ringStart));
+    rings = 0;
+
+    // Overlapping segments list pixels more than once; listings past the
+    // capacity of ringPixels are dropped, the same ones in both passes
+    int dropped = 0, overflow = 0, listed = 0;
+    forEachListing([&](int i, int r) {
+        if (i < 0 || i >= NUM_LEDS || r >= SPATIAL_MAX_RINGS) {
+            dropped++;
+            return;
+        }
+        if (listed == RING_PIXEL_CAPACITY) {
+            overflow++;
+            return;
+        }
+        listed++;
+        if (r + 1 > rings) rings = r + 1;
+        ringStart[r + 1]++;
+    });
+    for (int r = 0; r < rings; r++) ringStart[r + 1] += ringStart[r];
+
+    uint16_t fill[SPATIAL_MAX_RINGS];
+    memcpy(fill, ringStart, sizeof(fill));
+    listed = 0;
+    forEachListing([&](int i, int r) {
+        if (i < 0 || i >= NUM_LEDS || r >= SPATIAL_MAX_RINGS || listed == RING_PIXEL_CAPACITY) return;
+        listed++;
+        ringPixels[fill[r]++] = i;
+        geometry[i].ring = r;
+    });
+
+    for (const SegmentSpec& s : segments) {
+        int middle = s.first + s.count / 2;
+        for (int i = s.first; i < s.first + s.count && i < NUM_LEDS; i++) {
+            if (i < 0) continue;
+            int along = i - s.first;
+            PixelGeometry& g = geometry[i];
+            g.distance = rings > 1 ? g.ring * 255 / (rings - 1) : 0;
+            g.position = s.count > 1 ? along * 255 / (s.count - 1) : 0;
+            if (s.shape == SegmentShape::Ring) g.angle = along * 256 / s.count;
+            else g.angle = i < middle ? 128 : 0;
+        }
+    }
+
+    Serial.printf("[SpatialMap] %d segments, %d rings\n", SEGMENT_COUNT, rings);
+    if (dropped) Serial.printf("[SpatialMap] %d pixels outside the strip or past ring %d left out\n",
+                               dropped, SPATIAL_MAX_RINGS - 1);
+    if (overflow) Serial.printf("[SpatialMap] Segments overlap: %d pixel listings past %d left out\n",
+                                overflow, RING_PIXEL_CAPACITY);
+}
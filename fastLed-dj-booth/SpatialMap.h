@@ -0,0 +1,60 @@
+// SpatialMap.h
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+
+enum class SegmentShape : uint8_t { Line, Ring };
+
+// Rings the map can hold; pixels of segments reaching further are left out
+#define SPATIAL_MAX_RINGS NUM_LEDS
+
+// Pixels of one ring, for range-for
+struct RingSpan {
+    const uint16_t* first;
+    const uint16_t* last;
+    const uint16_t* begin() const { return first; }
+    const uint16_t* end() const { return last; }
+    int size() const { return last - first; }
+};
+
+// Where each pixel sits in the installation (LED_SEGMENT_TABLE in config.h),
+// worked out once at boot instead of by every radial effect every frame.
+// Pixels are grouped into rings, centre outward: a Line's ring is its
+// distance from the middle of the line, a Ring segment is one ring. Each
+// ring keeps the list of its pixels, so an effect that lights ring r only
+// touches those. A Line's middle pixel is listed twice in its first ring,
+// once for each half mirrored from it, which is how the effects always
+// treated it.
+class SpatialMap {
+public:
+    // Once at boot, before anything renders
+    static void build();
+
+    static int ringCount() { return rings; }
+    static RingSpan ring(int r) {
+        if (r < 0 || r >= rings) return { ringPixels, ringPixels };
+        return { ringPixels + ringStart[r], ringPixels + ringStart[r + 1] };
+    }
+
+    // Per pixel: its ring; its ring scaled so the outermost is 255; its
+    // direction from the centre (around a Ring, or 0 and 128 for the halves
+    // of a Line); and how far along its segment it is, 0-255
+    static uint16_t ringOf(int i) { return geometry[i].ring; }
+    static uint8_t distance8(int i) { return geometry[i].distance; }
+    static uint8_t angle8(int i) { return geometry[i].angle; }
+    static uint8_t position8(int i) { return geometry[i].position; }
+
+private:
+    struct PixelGeometry {
+        uint16_t ring;
+        uint8_t distance;
+        uint8_t angle;
+        uint8_t position;
+    };
+
+    static PixelGeometry geometry[NUM_LEDS];
+    static uint16_t ringStart[SPATIAL_MAX_RINGS + 1];
+    static uint16_t ringPixels[];
+    static int rings;
+};
@@ -0,0 +1,41 @@
+// SpscQueue.h
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free queue between one producer and one consumer, e.g. an interrupt
+// and the loop. N must be a power of two; it holds N - 1 items. push() never
+// waits: with the queue full the item is dropped and push() says so.
+template<typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T& item) {
+        uint32_t head = headIndex.load(std::memory_order_relaxed);
+        uint32_t next = (head + 1) & (N - 1);
+        if (next == tailIndex.load(std::memory_order_acquire)) return false;
+        slots[head] = item;
+        headIndex.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+        uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail == headIndex.load(std::memory_order_acquire)) return false;
+        item = slots[tail];
+        tailIndex.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tailIndex.load(std::memory_order_acquire) == headIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> headIndex{0};
+    std::atomic<uint32_t> tailIndex{0};
+};
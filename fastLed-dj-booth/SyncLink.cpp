@@ -0,0 +1,238 @@
+#include "SyncLink.h"
+#include "BeatGrid.h"
+#include <string.h>
+
+// A follower goes back to its own audio after this long without a frame
+#define SYNC_TIMEOUT_MS 1000
+// Clock pings: quickly until there are a few samples, then now and then
+#define SYNC_FAST_PING_MS 100
+#define SYNC_PING_MS 1000
+#define SYNC_FAST_PING_SAMPLES 4
+
+static size_t buildPacket(uint8_t* out, uint8_t type, uint8_t group, uint8_t node, uint16_t seq,
+                          uint32_t ms, const void* payload, size_t len) {
+    SyncHeader header;
+    header.magic = SYNC_MAGIC;
+    header.version = SYNC_VERSION;
+    header.type = type;
+    header.group = group;
+    header.node = node;
+    header.seq = seq;
+    header.leaderMs = ms;
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), payload, len);
+    return sizeof(header) + len;
+}
+
+// Header of a packet for this group whose payload is `payloadLen` bytes
+static bool parsePacket(const uint8_t* packet, size_t len, uint8_t group, SyncHeader& header, size_t payloadLen) {
+    if (len != sizeof(SyncHeader) + payloadLen) return false;
+    memcpy(&header, packet, sizeof(header));
+    return header.magic == SYNC_MAGIC && header.version == SYNC_VERSION && header.group == group;
+}
+
+static uint8_t packetType(const uint8_t* packet, size_t len) {
+    return len >= sizeof(SyncHeader) ? packet[offsetof(SyncHeader, type)] : 0;
+}
+
+// --- Leader ----------------------------------------------------------------------
+
+SyncLeader::SyncLeader(SyncTransport& transport, uint8_t group)
+    : transport(transport), group(group), seq(0), sent(0) {}
+
+bool SyncLeader::send(uint8_t type, const void* payload, size_t len, unsigned long now) {
+    uint8_t packet[SYNC_MAX_PACKET];
+    size_t n = buildPacket(packet, type, group, 0, seq++, now, payload, len);
+    if (!transport.send(packet, n)) return false;
+    sent++;
+    return true;
+}
+
+void SyncLeader::update(const AudioFeatures& features, int animation, unsigned long now) {
+    // Answer pings first, so the time they wait here stays short
+    uint8_t packet[SYNC_MAX_PACKET];
+    size_t len;
+    unsigned long arrivedMs;
+    while ((len = transport.receive(packet, sizeof(packet), arrivedMs)) > 0) {
+        SyncHeader header;
+        if (packetType(packet, len) != SYNC_PING || !parsePacket(packet, len, group, header, sizeof(SyncPing))) continue;
+        SyncPing ping;
+        memcpy(&ping, packet + sizeof(header), sizeof(ping));
+        SyncPong pong;
+        pong.follower = header.node;
+        pong.pingSentMs = ping.sentMs;
+        pong.receivedMs = arrivedMs;
+        send(SYNC_PONG, &pong, sizeof(pong), now);
+    }
+
+    SyncFeatures msg;
+    msg.volume = syncUnit(features.volume);
+    msg.bass = syncUnit(features.bass);
+    msg.mid = syncUnit(features.mid);
+    msg.treble = syncUnit(features.treble);
+    msg.bpmX10 = (uint16_t)(features.bpm * 10.0 + 0.5);
+    msg.loudness = features.loudness < 0 ? 0 : (features.loudness > 255 ? 255 : features.loudness);
+    msg.flags = (features.beatDetected ? SYNC_FLAG_BEAT : 0) |
+                (features.gridLocked ? SYNC_FLAG_GRID_LOCKED : 0) |
+                (features.gridBeat ? SYNC_FLAG_GRID_BEAT : 0);
+    msg.beatIndex = features.beatIndex;
+    msg.beatPhase = syncUnit(features.beatPhase);
+    msg.periodMs = features.bpm > 1.0 ? (uint16_t)(60000.0 / features.bpm + 0.5) : 0;
+    msg.animation = (uint8_t)animation;
+    send(SYNC_FEATURES, &msg, sizeof(msg), now);
+}
+
+void SyncLeader::sendSwitch(int from, int to, const char* reason, unsigned long now) {
+    SyncSwitch msg;
+    msg.from = (uint8_t)from;
+    msg.to = (uint8_t)to;
+    msg.atMs = now;
+    memset(msg.reason, 0, sizeof(msg.reason));
+    if (reason) strncpy(msg.reason, reason, sizeof(msg.reason) - 1);
+    send(SYNC_SWITCH, &msg, sizeof(msg), now);
+}
+
+// --- Follower --------------------------------------------------------------------
+
+SyncFollower::SyncFollower(SyncTransport& transport, uint8_t group, uint8_t node)
+    : transport(transport), group(group), node(node), pingSeq(0),
+      frameLeaderMs(0), lastFrameAt(0), haveFrame(false), frameOnset(false),
+      lastSeq(0), haveSeq(false), lastBeatIndex(0), lastSwitchTo(-1), switchAtMs(0),
+      lastPing(0), sampleCount(0), nextSample(0) {
+    memset(&frame, 0, sizeof(frame));
+    switchReason[0] = '\0';
+    memset(&stats, 0, sizeof(stats));
+}
+
+void SyncFollower::poll(unsigned long now) {
+    uint8_t packet[SYNC_MAX_PACKET];
+    size_t len;
+    unsigned long arrivedMs;
+    while ((len = transport.receive(packet, sizeof(packet), arrivedMs)) > 0) handle(packet, len, arrivedMs);
+
+    unsigned long interval = sampleCount < SYNC_FAST_PING_SAMPLES ? SYNC_FAST_PING_MS : SYNC_PING_MS;
+    if (pingSeq == 0 || now - lastPing >= interval) {
+        SyncPing ping;
+        ping.sentMs = now;
+        size_t n = buildPacket(packet, SYNC_PING, group, node, pingSeq++, now, &ping, sizeof(ping));
+        transport.send(packet, n);
+        lastPing = now;
+    }
+}
+
+void SyncFollower::handle(const uint8_t* packet, size_t len, unsigned long arrivedMs) {
+    SyncHeader header;
+    if (len < sizeof(header)) return;
+    memcpy(&header, packet, sizeof(header));
+    if (header.magic != SYNC_MAGIC || header.version != SYNC_VERSION || header.group != group) return;
+    if (header.node != 0) return;  // another follower's ping
+
+    // The leader numbers every packet it sends
+    if (haveSeq) {
+        uint16_t gap = header.seq - lastSeq;
+        if (gap == 0 || gap >= 0x8000) return;  // duplicate or reordered
+        stats.lost += gap - 1;
+    }
+    lastSeq = header.seq;
+    haveSeq = true;
+
+    const uint8_t* payload = packet + sizeof(header);
+    size_t payloadLen = len - sizeof(header);
+    if (header.type == SYNC_FEATURES && payloadLen == sizeof(SyncFeatures)) {
+        memcpy(&frame, payload, sizeof(frame));
+        frameLeaderMs = header.leaderMs;
+        lastFrameAt = arrivedMs;
+        haveFrame = true;
+        if (frame.flags & SYNC_FLAG_BEAT) frameOnset = true;
+        stats.received++;
+    } else if (header.type == SYNC_SWITCH && payloadLen == sizeof(SyncSwitch)) {
+        SyncSwitch msg;
+        memcpy(&msg, payload, sizeof(msg));
+        lastSwitchTo = msg.to;
+        switchAtMs = msg.atMs;
+        memcpy(switchReason, msg.reason, SYNC_REASON_LENGTH);
+        switchReason[SYNC_REASON_LENGTH] = '\0';
+    } else if (header.type == SYNC_PONG && payloadLen == sizeof(SyncPong)) {
+        SyncPong pong;
+        memcpy(&pong, payload, sizeof(pong));
+        if (pong.follower != node) return;
+        // t1 ping sent, t2 leader received, t3 pong sent, t4 pong received
+        int32_t out = (int32_t)(pong.receivedMs - pong.pingSentMs);
+        int32_t back = (int32_t)(header.leaderMs - (uint32_t)arrivedMs);
+        int32_t roundTrip = (int32_t)((uint32_t)arrivedMs - pong.pingSentMs) - (int32_t)(header.leaderMs - pong.receivedMs);
+        addOffsetSample((out + back) / 2, roundTrip < 0 ? 0 : roundTrip);
+    }
+}
+
+void SyncFollower::addOffsetSample(int32_t offsetMs, uint32_t delayMs) {
+    samples[nextSample].offsetMs = offsetMs;
+    samples[nextSample].delayMs = delayMs;
+    nextSample = (nextSample + 1) % OFFSET_SAMPLES;
+    if (sampleCount < OFFSET_SAMPLES) sampleCount++;
+
+    // The quickest round trip had the least room for asymmetry
+    const OffsetSample* best = &samples[0];
+    for (int i = 1; i < sampleCount; i++) {
+        if (samples[i].delayMs < best->delayMs) best = &samples[i];
+    }
+    stats.offsetMs = best->offsetMs;
+    stats.delayMs = best->delayMs;
+    stats.hasOffset = true;
+}
+
+bool SyncFollower::apply(AudioFeatures& features, unsigned long now) {
+    if (!haveFrame || !stats.hasOffset || now - lastFrameAt > SYNC_TIMEOUT_MS) return false;
+
+    features.volume = syncUnitToFloat(frame.volume);
+    features.bass = syncUnitToFloat(frame.bass);
+    features.mid = syncUnitToFloat(frame.mid);
+    features.treble = syncUnitToFloat(frame.treble);
+    features.bpm = frame.bpmX10 / 10.0;
+    features.loudness = frame.loudness;
+    features.beatDetected = frameOnset;
+    frameOnset = false;
+
+    // Carry the grid from when the leader sent the frame to now, on its clock
+    features.gridLocked = frame.flags & SYNC_FLAG_GRID_LOCKED;
+    uint32_t beatIndex = frame.beatIndex;
+    float phase = syncUnitToFloat(frame.beatPhase);
+    int32_t age = (int32_t)(leaderTime(now) - frameLeaderMs);
+    if (features.gridLocked && frame.periodMs && age > 0) {
+        phase += (float)age / frame.periodMs;
+        uint32_t whole = (uint32_t)phase;
+        beatIndex += whole;
+        phase -= whole;
+    }
+    // Never step back over a beat already ticked (a late frame after an early
+    // guess); a bigger jump is the leader's grid starting over
+    if (features.gridLocked && (int32_t)(lastBeatIndex - beatIndex) == 1) {
+        beatIndex = lastBeatIndex;
+        phase = 0.0f;
+    }
+    features.gridBeat = features.gridLocked && beatIndex != lastBeatIndex;
+    lastBeatIndex = beatIndex;
+    features.beatIndex = beatIndex;
+    features.beatPhase = phase;
+    features.beatInBar = beatIndex % BeatGrid::BEATS_PER_BAR;
+    features.bar = beatIndex / BeatGrid::BEATS_PER_BAR;
+    return true;
+}
+
+bool SyncFollower::pendingSwitch(int current, int& to, const char*& reason, unsigned long now) {
+    if (!haveFrame) return false;
+    // A switch event newer than the last frame is ahead of the frames' animation
+    bool eventAhead = lastSwitchTo >= 0 && (int32_t)(switchAtMs - frameLeaderMs) >= 0;
+    int target = eventAhead ? lastSwitchTo : frame.animation;
+    if (target == current) return false;
+
+    to = target;
+    if (target == lastSwitchTo) {
+        reason = switchReason;
+        int32_t late = (int32_t)(leaderTime(now) - switchAtMs);
+        if (late > (int32_t)stats.switchLateMs) stats.switchLateMs = late;
+    } else {
+        reason = "Leader";
+    }
+    stats.switches++;
+    return true;
+}
@@ -0,0 +1,110 @@
+// SyncLink.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "AudioFeatures.h"
+#include "SyncProtocol.h"
+
+// Carries sync datagrams between nodes: ESP-NOW broadcast on the booth
+// (EspNowTransport.h), loopback UDP in tools/sync_sim. Delivery is best
+// effort; the protocol repeats state every frame instead of retrying.
+class SyncTransport {
+public:
+    virtual ~SyncTransport() {}
+    // To every other node; false if it couldn't be queued
+    virtual bool send(const uint8_t* data, size_t len) = 0;
+    // Next datagram without blocking; its length, or 0 if there is none.
+    // `arrivedMs` is the receiver's clock when it came in, so time spent
+    // queued before receive() doesn't count as link delay.
+    virtual size_t receive(uint8_t* data, size_t capacity, unsigned long& arrivedMs) = 0;
+};
+
+// Leader side of leader/follower sync: broadcasts its features, beat phase
+// and animation every frame and each animation switch as it happens, and
+// answers the followers' clock pings. Plain C++; times are the caller's ms.
+class SyncLeader {
+public:
+    SyncLeader(SyncTransport& transport, uint8_t group);
+
+    // Once per frame, after the analysis
+    void update(const AudioFeatures& features, int animation, unsigned long now);
+    void sendSwitch(int from, int to, const char* reason, unsigned long now);
+
+    uint32_t getSent() const { return sent; }
+
+private:
+    SyncTransport& transport;
+    uint8_t group;
+    uint16_t seq;
+    uint32_t sent;
+
+    bool send(uint8_t type, const void* payload, size_t len, unsigned long now);
+};
+
+struct SyncStats {
+    uint32_t received;       // feature frames
+    uint32_t lost;           // leader packets missing or out of order
+    uint32_t switches;       // switch events followed
+    uint32_t switchLateMs;   // worst delay from the leader's switch to ours
+    int32_t offsetMs;        // leader clock minus ours
+    uint32_t delayMs;        // round trip of the ping the offset came from
+    bool hasOffset;
+};
+
+// Follower side: takes the leader's frames off the transport, estimates the
+// leader's clock from ping round trips (NTP-style, keeping the sample with
+// the shortest round trip of the last few), and hands the animations the
+// leader's features with the beat phase carried forward to this node's now,
+// so beats land together despite the link's delay.
+class SyncFollower {
+public:
+    SyncFollower(SyncTransport& transport, uint8_t group, uint8_t node);
+
+    // Once per frame, before apply(): drains the transport and pings
+    void poll(unsigned long now);
+    // Replaces the shared fields of `features` (levels, tempo, beat and grid)
+    // with the leader's at `now`; false, leaving them alone, while no leader
+    // has been heard for SYNC_TIMEOUT_MS or the clock offset isn't known yet
+    bool apply(AudioFeatures& features, unsigned long now);
+    // The leader's animation, if it differs from `current`; `reason` is the
+    // leader's when this follows a switch event
+    bool pendingSwitch(int current, int& to, const char*& reason, unsigned long now);
+
+    unsigned long leaderTime(unsigned long now) const { return now + stats.offsetMs; }
+    const SyncStats& getStats() const { return stats; }
+
+private:
+    static const int OFFSET_SAMPLES = 8;
+    struct OffsetSample {
+        int32_t offsetMs;
+        uint32_t delayMs;
+    };
+
+    SyncTransport& transport;
+    uint8_t group;
+    uint8_t node;
+    uint16_t pingSeq;
+
+    SyncFeatures frame;
+    uint32_t frameLeaderMs;
+    unsigned long lastFrameAt;
+    bool haveFrame;
+    bool frameOnset;         // frame's onset not yet handed to apply()
+    uint16_t lastSeq;
+    bool haveSeq;
+    uint32_t lastBeatIndex;
+
+    int lastSwitchTo;
+    char switchReason[SYNC_REASON_LENGTH + 1];
+    uint32_t switchAtMs;
+
+    unsigned long lastPing;
+    OffsetSample samples[OFFSET_SAMPLES];
+    int sampleCount;
+    int nextSample;
+    SyncStats stats;
+
+    void handle(const uint8_t* packet, size_t len, unsigned long arrivedMs);
+    void addOffsetSample(int32_t offsetMs, uint32_t delayMs);
+};
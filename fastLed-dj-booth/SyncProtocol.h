@@ -0,0 +1,80 @@
+// SyncProtocol.h
+// Wire format between booth controllers in leader/follower sync (see
+// SyncLink.h). Plain C++ with no Arduino dependencies so tools/sync_sim can
+// include it as-is. One packet per datagram; all fields little-endian.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SYNC_MAGIC 0x5347   // "GS"
+#define SYNC_VERSION 1
+#define SYNC_MAX_PACKET 64
+
+enum SyncType : uint8_t {
+    SYNC_FEATURES = 1,   // leader, every frame
+    SYNC_SWITCH = 2,     // leader, when its animation changes
+    SYNC_PING = 3,       // follower, for the clock offset
+    SYNC_PONG = 4,       // leader's answer
+};
+
+// Bits in SyncFeatures::flags
+#define SYNC_FLAG_BEAT 0x01
+#define SYNC_FLAG_GRID_LOCKED 0x02
+#define SYNC_FLAG_GRID_BEAT 0x04
+
+struct __attribute__((packed)) SyncHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t type;
+    uint8_t group;        // booths sharing a channel ignore each other's groups
+    uint8_t node;         // sender; 0 = leader
+    uint16_t seq;
+    uint32_t leaderMs;    // sender's clock when sent (the follower's for pings)
+};
+
+// 0.0 - 1.0 values are sent as unsigned 16-bit fractions
+struct __attribute__((packed)) SyncFeatures {
+    uint16_t volume;
+    uint16_t bass;
+    uint16_t mid;
+    uint16_t treble;
+    uint16_t bpmX10;
+    uint8_t loudness;
+    uint8_t flags;
+    uint32_t beatIndex;
+    uint16_t beatPhase;   // progress through the beat at leaderMs
+    uint16_t periodMs;    // grid beat period, for extrapolating the phase
+    uint8_t animation;    // the leader's current animation, every frame, so a
+                          // follower that lost a SYNC_SWITCH still converges
+};
+
+#define SYNC_REASON_LENGTH 24
+
+struct __attribute__((packed)) SyncSwitch {
+    uint8_t from;
+    uint8_t to;
+    uint32_t atMs;        // leader's clock when it switched
+    char reason[SYNC_REASON_LENGTH];
+};
+
+struct __attribute__((packed)) SyncPing {
+    uint32_t sentMs;      // follower's clock
+};
+
+struct __attribute__((packed)) SyncPong {
+    uint8_t follower;
+    uint32_t pingSentMs;  // echoed
+    uint32_t receivedMs;  // leader's clock when the ping arrived
+};
+
+static_assert(sizeof(SyncHeader) + sizeof(SyncSwitch) <= SYNC_MAX_PACKET, "SyncSwitch too large");
+static_assert(sizeof(SyncHeader) + sizeof(SyncFeatures) <= SYNC_MAX_PACKET, "SyncFeatures too large");
+
+inline uint16_t syncUnit(double v) {
+    return v <= 0.0 ? 0 : (v >= 1.0 ? 65535 : (uint16_t)(v * 65535.0 + 0.5));
+}
+
+inline float syncUnitToFloat(uint16_t v) {
+    return v / 65535.0f;
+}
@@ -0,0 +1,108 @@
+// TapTempo.h
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include "config.h"
+#include "TempoSource.h"
+
+// Tempo from taps on a button, timed by the button interrupt. Four taps in
+// a steady rhythm set the tempo and later ones refine it, averaged over the
+// last TAP_WINDOW intervals. A gap outside TAP_TEMPO_MIN/MAX_BPM, or an
+// interval a fifth away from the average, starts over from that tap.
+//
+// As a tempo source the tapped tempo is trusted half as much after
+// TAP_TRUST_BEATS, soon hardly at all, and not at all after TAP_TEMPO_HOLD_MS,
+// so the audio takes over again once it is back. The beat of the last tap
+// only holds for TAP_PHASE_BEATS, as the smallest error in the tempo soon
+// moves it.
+class TapTempo : public TempoSource {
+public:
+    // True when the tap set or refined the tempo
+    bool tap(uint32_t ms) {
+        for (int i = TAP_UNDO - 1; i > 0; i--) undo[i] = undo[i - 1];
+        undo[0] = taps;
+        if (undoCount < TAP_UNDO) undoCount++;
+
+        uint32_t interval = ms - taps.lastTapMs;
+        taps.lastTapMs = ms;
+        if (!taps.started || interval < 60000 / TAP_TEMPO_MAX_BPM || interval > 60000 / TAP_TEMPO_MIN_BPM) {
+            taps.started = true;
+            restart();
+            return false;
+        }
+        if (taps.count > 0 && fabsf(interval - averageMs()) > averageMs() * 0.2f) {
+            restart();
+        }
+        taps.intervals[taps.next] = interval;
+        taps.next = (taps.next + 1) % TAP_WINDOW;
+        if (taps.count < TAP_WINDOW) taps.count++;
+        if (taps.count < 3) return false;
+        taps.bpm = 60000.0f / averageMs();
+        taps.tempoMs = ms;
+        return true;
+    }
+
+    // Takes back the last taps (up to TAP_UNDO), for presses that turned
+    // out to be the start of another gesture
+    void untap(int count) {
+        for (; count > 0 && undoCount > 0; count--) {
+            taps = undo[0];
+            for (int i = 0; i < TAP_UNDO - 1; i++) undo[i] = undo[i + 1];
+            undoCount--;
+        }
+    }
+
+    // 0 until set, and again TAP_TEMPO_HOLD_MS after the last tap that set it
+    float getBpm(uint32_t now) const {
+        return taps.bpm > 0 && now - taps.tempoMs < TAP_TEMPO_HOLD_MS ? taps.bpm : 0;
+    }
+    // The latest tap that counted: a beat
+    uint32_t getLastTapMs() const { return taps.tempoMs; }
+
+    const char* name() const override { return "Tap"; }
+
+    bool estimate(uint32_t now, TempoEstimate& out) override {
+        float tapped = getBpm(now);
+        if (tapped <= 0) return false;
+        float beats = (now - taps.tempoMs) * tapped / 60000.0f;
+        out.bpm = tapped;
+        float age = beats / TAP_TRUST_BEATS;
+        out.confidence = 1.0f / (1.0f + age * age);
+        out.phaseConfidence = beats < TAP_PHASE_BEATS ? (1.0f - beats / TAP_PHASE_BEATS) * out.confidence : 0.0f;
+        out.beatMs = taps.tempoMs;
+        return true;
+    }
+
+private:
+    static const int TAP_WINDOW = 8;
+    static const int TAP_TRUST_BEATS = 16;
+    static const int TAP_PHASE_BEATS = 16;
+    // A double press is two
+    static const int TAP_UNDO = 2;
+
+    struct Taps {
+        bool started = false;
+        uint32_t lastTapMs = 0;
+        uint32_t intervals[TAP_WINDOW];
+        int count = 0;
+        int next = 0;
+        float bpm = 0;
+        uint32_t tempoMs = 0;
+    };
+
+    void restart() {
+        taps.count = 0;
+        taps.next = 0;
+    }
+
+    float averageMs() const {
+        uint32_t sum = 0;
+        for (int i = 0; i < taps.count; i++) sum += taps.intervals[i];
+        return taps.count ? (float)sum / taps.count : 0;
+    }
+
+    Taps taps;
+    Taps undo[TAP_UNDO];
+    int undoCount = 0;
+};
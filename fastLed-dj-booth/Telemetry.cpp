@@ -0,0 +1,108 @@
+#include "Telemetry.h"
+#include "FrameClock.h"
+
+Telemetry::Telemetry(HardwareSerial& port)
+    : port(port), seq(0), sent(0), dropped(0) {}
+
+bool Telemetry::send(uint8_t type, const void* payload, size_t len) {
+    if (len > TELEMETRY_MAX_PAYLOAD) return false;
+
+    packet[0] = type;
+    packet[1] = seq++;
+    memcpy(packet + 2, payload, len);
+    uint16_t crc = telemetryCrc16(packet, len + 2);
+    packet[len + 2] = crc & 0xFF;
+    packet[len + 3] = crc >> 8;
+
+    // Leading delimiter too, so stray text on the port costs at most its own frame
+    frame[0] = 0;
+    size_t frameLen = 1 + cobsEncode(packet, len + 4, frame + 1);
+    if (port.availableForWrite() < (int)frameLen) {
+        dropped++;
+        return false;
+    }
+    port.write(frame, frameLen);
+    sent++;
+    return true;
+}
+
+void Telemetry::sendFeatures(const AudioFeatures& features, int animation, bool buildUp, bool drop) {
+    TelemetryFeatures msg;
+    msg.timeMs = FrameClock::now();
+    msg.volume = telemetryUnit(features.volume);
+    msg.bass = telemetryUnit(features.bass);
+    msg.mid = telemetryUnit(features.mid);
+    msg.treble = telemetryUnit(features.treble);
+    msg.bpmX10 = (uint16_t)constrain(features.bpm * 10.0, 0.0, 65535.0);
+    msg.loudness = constrain(features.loudness, 0, 255);
+    msg.flags = (features.beatDetected ? TELEMETRY_FLAG_BEAT : 0) |
+                (features.gridLocked ? TELEMETRY_FLAG_GRID_LOCKED : 0) |
+                (features.gridBeat ? TELEMETRY_FLAG_GRID_BEAT : 0) |
+                (buildUp ? TELEMETRY_FLAG_BUILD_UP : 0) |
+                (drop ? TELEMETRY_FLAG_DROP : 0);
+    msg.beatIndex = features.beatIndex;
+    msg.animation = animation;
+    send(TELEMETRY_FEATURES, &msg, sizeof(msg));
+}
+
+void Telemetry::sendTimings(const FrameProfiler& profiler) {
+    TelemetryTimings msg;
+    msg.frame = profiler.getFrame();
+    for (int i = 0; i < TELEMETRY_STAGE_COUNT; i++) {
+        msg.stageUs[i] = profiler.get((FrameStage)i);
+    }
+    send(TELEMETRY_TIMINGS, &msg, sizeof(msg));
+}
+
+void Telemetry::sendLeds(const CRGB* leds, int numLeds, int decimation) {
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    TelemetryLedFrame* header = reinterpret_cast<TelemetryLedFrame*>(payload);
+    const int maxCount = (TELEMETRY_MAX_PAYLOAD - sizeof(TelemetryLedFrame)) / 3;
+
+    if (decimation < 1) decimation = 1;
+    // Coarsen further if the strip would not fit in one packet
+    while ((numLeds + decimation - 1) / decimation > maxCount) decimation++;
+
+    int count = (numLeds + decimation - 1) / decimation;
+    uint8_t* rgb = payload + sizeof(TelemetryLedFrame);
+    for (int i = 0; i < count; i++) {
+        uint32_t sum[3] = { 0, 0, 0 };
+        int n = 0;
+        for (int j = i * decimation; j < numLeds && j < (i + 1) * decimation; j++, n++) {
+            sum[0] += leds[j].r;
+            sum[1] += leds[j].g;
+            sum[2] += leds[j].b;
+        }
+        for (int ch = 0; ch < 3; ch++) rgb[i * 3 + ch] = n ? sum[ch] / n : 0;
+    }
+    header->decimation = decimation;
+    header->count = count;
+    send(TELEMETRY_LED_FRAME, payload, sizeof(TelemetryLedFrame) + count * 3);
+}
+
+void Telemetry::sendMemory(const MemoryStats& stats) {
+    TelemetryMemory msg;
+    msg.freeBytes = stats.freeBytes;
+    msg.minFreeBytes = stats.minFreeBytes;
+    msg.largestFreeBlock = stats.largestFreeBlock;
+    msg.fragmentation = stats.fragmentation;
+    msg.flags = stats.hooks ? TELEMETRY_MEMORY_HOOKS : 0;
+    msg.allocsPerFrame = min(stats.allocsPerFrame, (uint32_t)65535);
+    msg.freesPerFrame = min(stats.freesPerFrame, (uint32_t)65535);
+    msg.netBytesPerFrame = stats.netBytesPerFrame;
+    for (int i = 0; i < TELEMETRY_MEMORY_TASKS; i++) {
+        msg.stackFree[i] = i < MemoryMonitor::getTaskCount()
+            ? min(MemoryMonitor::getStackFree(i), (uint32_t)65534) : 0xFFFF;
+    }
+    send(TELEMETRY_MEMORY, &msg, sizeof(msg));
+}
+
+void Telemetry::sendGain(const GainState& state) {
+    TelemetryGain msg;
+    msg.gain = telemetryCentibels(state.gain);
+    msg.level = telemetryCentibels(state.level);
+    msg.noiseFloor = telemetryCentibels(state.noiseFloor);
+    for (int b = 0; b < GAIN_BAND_COUNT; b++) msg.bandGain[b] = telemetryCentibels(state.bandGain[b]);
+    msg.flags = state.gated ? TELEMETRY_GAIN_GATED : 0;
+    send(TELEMETRY_GAIN, &msg, sizeof(msg));
+}
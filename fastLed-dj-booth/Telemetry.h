@@ -0,0 +1,37 @@
+// Telemetry.h
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "AudioProcessor.h"
+#include "FrameProfiler.h"
+#include "MemoryMonitor.h"
+#include "TelemetryProtocol.h"
+
+// Streams features, stage timings, gain state and decimated LED frames as framed binary
+// packets (see TelemetryProtocol.h; decode with tools/telemetry_decode).
+// Packets that would not fit in the serial TX buffer are dropped rather than
+// stalling the loop.
+class Telemetry {
+public:
+    explicit Telemetry(HardwareSerial& port);
+
+    void sendFeatures(const AudioFeatures& features, int animation, bool buildUp, bool drop);
+    void sendTimings(const FrameProfiler& profiler);
+    void sendLeds(const CRGB* leds, int numLeds, int decimation);
+    void sendMemory(const MemoryStats& stats);
+    void sendGain(const GainState& state);
+
+    uint32_t getSent() const { return sent; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    HardwareSerial& port;
+    uint8_t seq;
+    uint32_t sent;
+    uint32_t dropped;
+    uint8_t packet[TELEMETRY_MAX_PACKET];
+    uint8_t frame[TELEMETRY_MAX_FRAME + 1];
+
+    bool send(uint8_t type, const void* payload, size_t len);
+};
@@ -0,0 +1,160 @@
+// TelemetryProtocol.h
+// Wire format of the binary telemetry stream. Plain C++ with no Arduino
+// dependencies so the host tools in tools/ can include it as-is.
+//
+// Packet: [type u8][seq u8][payload...][crc16 u16 LE], COBS-encoded and
+// terminated by a 0x00 byte. A receiver that joins mid-stream or loses bytes
+// resynchronizes at the next 0x00. All fields are little-endian.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#define TELEMETRY_MAX_PAYLOAD 240
+#define TELEMETRY_MAX_PACKET (TELEMETRY_MAX_PAYLOAD + 4)
+// COBS adds one byte per 254 plus the delimiter
+#define TELEMETRY_MAX_FRAME (TELEMETRY_MAX_PACKET + TELEMETRY_MAX_PACKET / 254 + 2)
+
+enum TelemetryType : uint8_t {
+    TELEMETRY_FEATURES = 1,
+    TELEMETRY_TIMINGS = 2,
+    TELEMETRY_LED_FRAME = 3,
+    TELEMETRY_MEMORY = 4,
+    TELEMETRY_GAIN = 5,
+};
+
+// Bits in TelemetryFeatures::flags
+#define TELEMETRY_FLAG_BEAT 0x01
+#define TELEMETRY_FLAG_GRID_LOCKED 0x02
+#define TELEMETRY_FLAG_GRID_BEAT 0x04
+#define TELEMETRY_FLAG_BUILD_UP 0x08
+#define TELEMETRY_FLAG_DROP 0x10
+
+// 0.0 - 1.0 values are sent as unsigned 16-bit fractions
+inline uint16_t telemetryUnit(double v) {
+    return v <= 0.0 ? 0 : (v >= 1.0 ? 65535 : (uint16_t)(v * 65535.0 + 0.5));
+}
+
+inline float telemetryUnitToFloat(uint16_t v) {
+    return v / 65535.0f;
+}
+
+// Gains and levels are sent in hundredths of a dB, floored at -120 dB
+inline int16_t telemetryCentibels(float v) {
+    return v <= 1e-6f ? -12000 : (int16_t)(2000.0f * log10f(v) + (v >= 1.0f ? 0.5f : -0.5f));
+}
+
+struct __attribute__((packed)) TelemetryFeatures {
+    uint32_t timeMs;
+    uint16_t volume;
+    uint16_t bass;
+    uint16_t mid;
+    uint16_t treble;
+    uint16_t bpmX10;
+    uint8_t loudness;
+    uint8_t flags;
+    uint32_t beatIndex;
+    uint8_t animation;
+};
+
+#define TELEMETRY_STAGE_COUNT 6
+
+// Microseconds spent in each loop stage; see FrameStage for the order
+struct __attribute__((packed)) TelemetryTimings {
+    uint32_t frame;
+    uint32_t stageUs[TELEMETRY_STAGE_COUNT];
+};
+
+// Followed by `count` RGB triplets, each the average of `decimation` LEDs
+struct __attribute__((packed)) TelemetryLedFrame {
+    uint8_t decimation;
+    uint8_t count;
+};
+
+#define TELEMETRY_MEMORY_TASKS 4
+// Bits in TelemetryMemory::flags
+#define TELEMETRY_MEMORY_HOOKS 0x01
+
+// Heap state, and per-frame peaks since the previous packet (see MemoryMonitor.h)
+struct __attribute__((packed)) TelemetryMemory {
+    uint32_t freeBytes;
+    uint32_t minFreeBytes;
+    uint32_t largestFreeBlock;
+    uint8_t fragmentation;
+    uint8_t flags;
+    uint16_t allocsPerFrame;
+    uint16_t freesPerFrame;
+    int32_t netBytesPerFrame;
+    // Unused stack bytes of each watched task in watch order (loop first); 0xFFFF = none
+    uint16_t stackFree[TELEMETRY_MEMORY_TASKS];
+};
+
+// Bits in TelemetryGain::flags
+#define TELEMETRY_GAIN_GATED 0x01
+
+// Gain stage state each frame (see AutoGain.h); all in centibels
+struct __attribute__((packed)) TelemetryGain {
+    int16_t gain;
+    int16_t level;        // dBFS of the RMS above the floor
+    int16_t noiseFloor;   // dBFS
+    int16_t bandGain[3];  // bass, mid, treble
+    uint8_t flags;
+};
+
+// CRC-16/CCITT-FALSE
+inline uint16_t telemetryCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Encodes `len` bytes and appends the 0x00 delimiter; returns the frame length
+inline size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t codePos = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codePos] = code;
+            codePos = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[codePos] = code;
+                codePos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[codePos] = code;
+    out[o++] = 0;
+    return o;
+}
+
+// Decodes one frame without its delimiter; returns the decoded length or 0 if malformed
+inline size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) return 0;
+        for (uint8_t k = 1; k < code; k++) out[o++] = in[i++];
+        if (code != 0xFF && i < len) out[o++] = 0;
+    }
+    return o;
+}
+
+// Checks the CRC of a decoded packet; on success returns the payload length
+inline int telemetryCheckPacket(const uint8_t* packet, size_t len) {
+    if (len < 4) return -1;
+    uint16_t crc = packet[len - 2] | (packet[len - 1] << 8);
+    if (telemetryCrc16(packet, len - 2) != crc) return -1;
+    return (int)(len - 4);
+}
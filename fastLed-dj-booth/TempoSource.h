@@ -0,0 +1,105 @@
+// TempoSource.h
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// What one source knows about the tempo at a given moment
+struct TempoEstimate {
+    float bpm = 0;
+    // 0 - 1: how far the tempo can be trusted, and the beat below
+    float confidence = 0;
+    float phaseConfidence = 0;
+    // A moment a beat fell on (only meaningful with phaseConfidence > 0)
+    uint32_t beatMs = 0;
+};
+
+// Anything with an opinion about the tempo: the audio beat detector, taps
+// on the tap button, a MIDI clock. TempoTracker weighs them against each
+// other by confidence, which each source lowers as what it knows gets old.
+class TempoSource {
+public:
+    virtual ~TempoSource() {}
+    virtual const char* name() const = 0;
+    // False when the source has nothing to say at `now`
+    virtual bool estimate(uint32_t now, TempoEstimate& out) = 0;
+};
+
+// Straight line through the last N points of (beat or clock number, time)
+// by least squares, for sources that count beats: its slope is the period,
+// and it puts each beat where its neighbours say it belongs, evening out
+// the jitter of single ones. Times are held relative to the newest point, so
+// millis() wrapping doesn't matter.
+template <int N>
+class BeatFit {
+public:
+    void reset() {
+        count = 0;
+        next = 0;
+        fitted = false;
+    }
+
+    void add(uint32_t index, uint32_t ms) {
+        indices[next] = index;
+        times[next] = ms;
+        next = (next + 1) % N;
+        if (count < N) count++;
+        newestIndex = index;
+        newestMs = ms;
+        fitted = false;
+    }
+
+    // Fits the points so far; false with fewer than three
+    bool fit() {
+        if (count < 3) return false;
+        float meanX = 0, meanY = 0;
+        for (int i = 0; i < count; i++) {
+            meanX += x(i);
+            meanY += y(i);
+        }
+        meanX /= count;
+        meanY /= count;
+        float sxy = 0, sxx = 0;
+        for (int i = 0; i < count; i++) {
+            sxy += (x(i) - meanX) * (y(i) - meanY);
+            sxx += (x(i) - meanX) * (x(i) - meanX);
+        }
+        if (sxx <= 0) return false;
+        slope = sxy / sxx;
+        atNewest = meanY - slope * meanX;
+        float squares = 0;
+        for (int i = 0; i < count; i++) {
+            float residual = y(i) - (atNewest + slope * x(i));
+            squares += residual * residual;
+        }
+        residualMs = sqrtf(squares / count);
+        fitted = true;
+        return true;
+    }
+
+    int size() const { return count; }
+    bool isFitted() const { return fitted; }
+    uint32_t getNewestIndex() const { return newestIndex; }
+    // From the last fit, until the next add()
+    float getMsPerIndex() const { return slope; }
+    float getResidualMs() const { return residualMs; }
+    // Where the fitted line puts point `index`
+    uint32_t timeOf(uint32_t index) const {
+        return newestMs + (int32_t)lroundf(atNewest + slope * (float)(int32_t)(index - newestIndex));
+    }
+
+private:
+    float x(int i) const { return (float)(int32_t)(indices[i] - newestIndex); }
+    float y(int i) const { return (float)(int32_t)(times[i] - newestMs); }
+
+    uint32_t indices[N];
+    uint32_t times[N];
+    int count = 0;
+    int next = 0;
+    uint32_t newestIndex = 0;
+    uint32_t newestMs = 0;
+    bool fitted = false;
+    float slope = 0;
+    float atNewest = 0;
+    float residualMs = 0;
+};
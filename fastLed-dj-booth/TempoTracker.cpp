@@ -0,0 +1,352 @@
+#include "TempoTracker.h"
+#include "BeatGrid.h"
+#include <math.h>
+
+// How quickly the beat clock's phase and period follow the sources
+#define TEMPO_PHASE_TAU_MS 500.0f
+#define TEMPO_PERIOD_TAU_MS 2000.0f
+// Period correction per beat of phase error, relative to the phase correction
+#define TEMPO_PLL_FREQ_GAIN 0.1f
+// A fully trusted source this far from the clock's tempo resets it
+#define TEMPO_SNAP_PERCENT 8.0f
+#define TEMPO_TRUSTED 0.9f
+// The audio's say fades over this long once onsets stop for a bar
+#define TEMPO_AUDIO_FADE_MS 4000.0f
+// Onsets within this fraction of a period of a beat (plus half a frame) count
+#define AUDIO_CAPTURE 0.15f
+#define AUDIO_CAPTURE_START 0.2f
+// Starting over after this many onsets in a row off the beat, or a gap this long
+#define AUDIO_MAX_MISSES 6
+#define AUDIO_MAX_GAP_BEATS 8
+// or when the onsets' spacing puts the tempo this far off (a whole frame or
+// two at 125 ms frames)
+#define AUDIO_ELSEWHERE 0.15f
+#define AUDIO_SCATTER 0.7f
+// Tempo guesses from the recent onsets: the search step, how well they have
+// to fit, and how much better one has to be than a longer one
+#define AUDIO_GUESS_STEP 0.01f
+#define AUDIO_GUESS_STEPS 128
+#define AUDIO_GUESS_FIT 0.5f
+#define AUDIO_GUESS_TIE 0.1f
+// With no source at all the clock runs on for this long
+#define TEMPO_FREEWHEEL_MS 8000.0f
+
+static const float TWO_PI_F = 6.2831853f;
+
+// Confidence as a weight: one source trusted fully outweighs any number of
+// doubtful ones
+static float weight(float confidence) {
+    if (confidence > 0.99f) confidence = 0.99f;
+    return confidence > 0 ? confidence / (1.0f - confidence) : 0.0f;
+}
+
+static float wrapPhase(float phase) {
+    return phase - floorf(phase);
+}
+
+// From `current` to `target` the short way round, -0.5 - 0.5 beats
+static float phaseError(float target, float current) {
+    float error = target - current;
+    return error - floorf(error + 0.5f);
+}
+
+// Frames blur an onset by half a frame either way; until there are enough
+// onsets for a good line its period may be some way out too. Never so wide
+// that onsets half a beat out count.
+float AudioTempo::captureMs() const {
+    float window = frameMs / 2 + (onsets.size() < AUDIO_FIT / 2 ? AUDIO_CAPTURE_START : AUDIO_CAPTURE) * periodMs;
+    return window < periodMs * 0.4f ? window : periodMs * 0.4f;
+}
+
+float AudioTempo::captureMs(float period) const {
+    float window = frameMs / 2 + AUDIO_CAPTURE * period;
+    return window < period * 0.4f ? window : period * 0.4f;
+}
+
+// How well the recent onsets line up on beats of this period: their beat
+// phases averaged as unit vectors, 1 when all agree. Frames blur the phases,
+// so this tolerates a frame's worth of scatter where a gap-by-gap match
+// would not.
+float AudioTempo::spacingFit(float period) const {
+    float sinSum = 0, cosSum = 0;
+    for (int i = 0; i < recentCount; i++) {
+        float beats = (float)(int32_t)(recent[i] - recent[0]) / period;
+        sinSum += sinf(TWO_PI_F * beats);
+        cosSum += cosf(TWO_PI_F * beats);
+    }
+    return recentCount ? sqrtf(sinSum * sinSum + cosSum * cosSum) / recentCount : 0.0f;
+}
+
+// The period the recent onsets fit best, searched in AUDIO_GUESS_STEP steps
+// over the tap tempo range and then refined; of two that fit about as well
+// the longer (half of it fits just as well, with nothing on every other
+// beat). 0 if none stands out.
+float AudioTempo::guessPeriod() const {
+    if (recentCount < 3) return 0;
+    float best = 0, bestFit = 0;
+    float fits[AUDIO_GUESS_STEPS];
+    float periods[AUDIO_GUESS_STEPS];
+    int steps = 0;
+    for (float period = 60000.0f / TAP_TEMPO_MAX_BPM; period <= 60000.0f / TAP_TEMPO_MIN_BPM && steps < AUDIO_GUESS_STEPS;
+         period *= 1.0f + AUDIO_GUESS_STEP) {
+        periods[steps] = period;
+        fits[steps] = spacingFit(period);
+        if (fits[steps] > bestFit) bestFit = fits[steps];
+        steps++;
+    }
+    if (bestFit < AUDIO_GUESS_FIT) return 0;
+    // The longest peak nearly as good as the best
+    for (int i = steps - 1; i >= 0; i--) {
+        bool peak = (i == 0 || fits[i] >= fits[i - 1]) && (i == steps - 1 || fits[i] >= fits[i + 1]);
+        if (peak && fits[i] >= bestFit - AUDIO_GUESS_TIE) {
+            best = periods[i];
+            break;
+        }
+    }
+    // Then to a tenth of a step
+    float fine = best, fineFit = spacingFit(best);
+    for (int k = -9; k <= 9; k++) {
+        float period = best * (1.0f + k * AUDIO_GUESS_STEP / 10);
+        float fit = spacingFit(period);
+        if (fit > fineFit) {
+            fine = period;
+            fineFit = fit;
+        }
+    }
+    return fine;
+}
+
+// The recent onsets' spacing fits another tempo clearly better
+bool AudioTempo::elsewhere() const {
+    if (recentCount < AUDIO_RECENT) return false;
+    float guess = guessPeriod();
+    if (guess <= 0 || fabsf(guess / periodMs - 1.0f) <= AUDIO_ELSEWHERE) return false;
+    // Beats fit half their period as well as their own, so a longer period
+    // that fits about as well is the one to be on
+    float margin = fabsf(guess / periodMs - 2.0f) < 2.0f * AUDIO_ELSEWHERE ? -AUDIO_GUESS_TIE : AUDIO_GUESS_TIE;
+    return spacingFit(guess) > spacingFit(periodMs) + margin;
+}
+
+void AudioTempo::restart(uint32_t onsetMs) {
+    onsets.reset();
+    misses = 0;
+    float guess = guessPeriod();
+    if (guess <= 0) return;
+    // No better than chance until onsets keep landing
+    hits = 2.0f * captureMs(guess) / guess;
+    // Gaps between onsets are whole frames, so the guess is only as good as a
+    // frame; the recent onsets that agree with it start the line off instead
+    periodMs = guess;
+    float windowMs = captureMs(guess);
+    int oldest = recentCount < AUDIO_RECENT ? 0 : recentNext;
+    bool added = false;
+    int32_t last = 0;
+    for (int i = 0; i < recentCount; i++) {
+        uint32_t ms = recent[(oldest + i) % AUDIO_RECENT];
+        float beats = (float)(int32_t)(ms - onsetMs) / guess;
+        int32_t index = (int32_t)lroundf(beats);
+        if (fabsf(beats - index) * guess >= windowMs || (added && index == last)) continue;
+        onsets.add((uint32_t)index, ms);
+        added = true;
+        last = index;
+    }
+    beat = 0;
+    if (onsets.fit()) {
+        float fitted = onsets.getMsPerIndex();
+        if (fitted > guess * 0.8f && fitted < guess * 1.25f) periodMs = fitted;
+    }
+    beatMs = onsets.isFitted() ? onsets.timeOf(beat) : onsetMs;
+}
+
+void AudioTempo::observe(const AudioFeatures& features, uint32_t now) {
+    frameMs = now - lastFrameMs < 1000 ? now - lastFrameMs : 0;
+    lastFrameMs = now;
+    if (!features.beatDetected) return;
+    // Seen at the end of the frame it fell in, half a frame after it on average
+    uint32_t onsetMs = now - frameMs / 2;
+    recent[recentNext] = onsetMs;
+    recentNext = (recentNext + 1) % AUDIO_RECENT;
+    if (recentCount < AUDIO_RECENT) recentCount++;
+    if (onsets.size() == 0) {
+        restart(onsetMs);
+        return;
+    }
+
+    float beats = (float)(int32_t)(onsetMs - beatMs) / periodMs;
+    int32_t ahead = (int32_t)lroundf(beats);
+    float offMs = fabsf(beats - ahead) * periodMs;
+    float windowMs = captureMs();
+    if (ahead == 0 && offMs < windowMs) return;  // the same beat again
+    if (ahead >= 1 && ahead <= AUDIO_MAX_GAP_BEATS && offMs < windowMs) {
+        beat += ahead;
+        onsets.add(beat, onsetMs);
+        if (onsets.fit()) {
+            float fitted = onsets.getMsPerIndex();
+            if (fitted > 60000.0f / TAP_TEMPO_MAX_BPM / 2 && fitted < 60000.0f / TAP_TEMPO_MIN_BPM * 2) periodMs = fitted;
+        }
+        beatMs = onsets.isFitted() ? onsets.timeOf(beat) : onsetMs;
+        hits += 0.1f * (1.0f - hits);
+        misses = 0;
+        // Onsets on every other beat fit half the period as well
+        if (elsewhere()) restart(onsetMs);
+        return;
+    }
+    hits -= 0.1f * hits;
+    // Off the beat for a while, not landing on it any more often than random
+    // onsets would, the counted ones scattered all over, or the onsets'
+    // spacing says the tempo is another one
+    bool lost = ++misses >= AUDIO_MAX_MISSES || hits < 2.0f * captureMs(periodMs) / periodMs ||
+                onsets.getResidualMs() > AUDIO_SCATTER * captureMs() || elsewhere();
+    if (lost || ahead > AUDIO_MAX_GAP_BEATS) restart(onsetMs);
+}
+
+bool AudioTempo::estimate(uint32_t now, TempoEstimate& out) {
+    if (onsets.size() < 4) return false;
+    float silent = (float)(now - beatMs) - 4 * periodMs;
+    float fade = silent > 0 ? 1.0f - silent / TEMPO_AUDIO_FADE_MS : 1.0f;
+    // Random onsets land on some beat now and then; count what's better than that
+    float chance = 2.0f * captureMs(periodMs) / periodMs;
+    float landing = chance < 1.0f ? (hits - chance) / (1.0f - chance) : 0.0f;
+    landing *= landing;
+    float scatter = 1.0f - onsets.getResidualMs() / (AUDIO_SCATTER * captureMs());
+    if (fade <= 0 || hits <= chance || scatter <= 0) return false;
+    float confidence = 0.7f * fade * landing * scatter;
+    if (onsets.size() < AUDIO_FIT / 2) confidence *= (float)onsets.size() / (AUDIO_FIT / 2);
+    out.bpm = 60000.0f / periodMs;
+    out.confidence = confidence;
+    out.phaseConfidence = confidence;
+    out.beatMs = beatMs;
+    return true;
+}
+
+TempoTracker::TempoTracker()
+    : sourceCount(0), running(false), periodMs(500.0f), beat(0), phase(0), confidence(0), beatConfidence(0), lastMs(0), leader(nullptr) {
+    sources[sourceCount++] = &audio;
+}
+
+bool TempoTracker::addSource(TempoSource& source) {
+    if (sourceCount > TEMPO_MAX_SOURCES) return false;
+    sources[sourceCount++] = &source;
+    return true;
+}
+
+// Moves the clock by a number of beats, counting the ones it crosses
+void TempoTracker::advance(float beats) {
+    phase += beats;
+    while (phase >= 1.0f) {
+        phase -= 1.0f;
+        beat++;
+    }
+    while (phase < 0.0f) {
+        phase += 1.0f;
+        beat--;
+    }
+}
+
+bool TempoTracker::isBefore(uint32_t otherBeat, float otherPhase) const {
+    int32_t beats = (int32_t)(beat - otherBeat);
+    return beats < 0 || (beats == 0 && phase < otherPhase);
+}
+
+void TempoTracker::update(AudioFeatures& features, uint32_t now) {
+    audio.observe(features, now);
+    float dt = running ? (float)(now - lastMs) : 0.0f;
+    lastMs = now;
+    uint32_t lastBeat = beat;
+    float lastPhase = phase;
+    if (running) advance(dt / periodMs);
+
+    TempoEstimate estimates[TEMPO_MAX_SOURCES + 1];
+    bool heard[TEMPO_MAX_SOURCES + 1];
+    int lead = -1;
+    for (int i = 0; i < sourceCount; i++) {
+        TempoEstimate& e = estimates[i];
+        heard[i] = sources[i]->estimate(now, e) && e.bpm > 0 && e.confidence > 0;
+        if (heard[i] && (lead < 0 || e.confidence > estimates[lead].confidence)) lead = i;
+    }
+
+    // What the clock was last told still counts, less and less
+    float held = running ? confidence - dt / TEMPO_FREEWHEEL_MS : 0.0f;
+    if (held < 0) held = 0;
+    float heldBeat = running ? beatConfidence - dt / TEMPO_FREEWHEEL_MS : 0.0f;
+    if (heldBeat < 0) heldBeat = 0;
+
+    if (lead < 0) {
+        // Nothing to follow: keep counting
+        leader = nullptr;
+        confidence = held;
+        beatConfidence = heldBeat;
+        if (confidence <= 0) running = false;
+    } else {
+        const TempoEstimate& top = estimates[lead];
+        // The clock's own tempo and beat resist sources less sure than it was,
+        // but not one that's trusted
+        float own = top.confidence >= TEMPO_TRUSTED ? 0.0f : weight(held);
+        float bpmSum = own * 60000.0f / periodMs, bpmWeight = own;
+        float phaseSin = 0, phaseCos = 0, phaseWeight = 0, topPhase = 0;
+        for (int i = 0; i < sourceCount; i++) {
+            if (!heard[i]) continue;
+            TempoEstimate& e = estimates[i];
+            while (e.bpm > top.bpm * 1.4142f) e.bpm /= 2;
+            while (e.bpm < top.bpm * 0.7071f) e.bpm *= 2;
+            float w = weight(e.confidence);
+            bpmSum += w * e.bpm;
+            bpmWeight += w;
+            if (e.phaseConfidence <= 0) continue;
+            if (e.phaseConfidence > topPhase) topPhase = e.phaseConfidence;
+            // Where the source puts the beat now, from its own tempo
+            float beats = (float)(int32_t)(now - e.beatMs) * e.bpm / 60000.0f;
+            w = weight(e.phaseConfidence);
+            phaseSin += w * sinf(TWO_PI_F * beats);
+            phaseCos += w * cosf(TWO_PI_F * beats);
+            phaseWeight += w;
+        }
+
+        float target = 60000.0f * bpmWeight / bpmSum;
+        // A source sure of a different tempo, or surer than the clock is
+        bool overruled = top.confidence >= TEMPO_TRUSTED || top.confidence > held;
+        bool snap = !running || (overruled && fabsf(target - periodMs) > periodMs * TEMPO_SNAP_PERCENT / 100.0f);
+        if (snap) periodMs = target;
+        else periodMs += (target - periodMs) * (1.0f - expf(-dt / TEMPO_PERIOD_TAU_MS));
+
+        if (phaseWeight > 0) {
+            float sourcePhase = wrapPhase(atan2f(phaseSin, phaseCos) / TWO_PI_F);
+            float error = phaseError(sourcePhase, phase);
+            // The count never goes back: a clock ahead of the sources waits
+            // for them, and one put on a beat behind where it was goes on to
+            // the next
+            if (snap || (top.phaseConfidence >= TEMPO_TRUSTED && fabsf(error) > 0.25f)) {
+                advance(error);
+                if (isBefore(lastBeat, lastPhase)) advance(1.0f);
+            } else {
+                // Only what the clock was told of the beat holds it back
+                float ownBeat = top.confidence >= TEMPO_TRUSTED ? 0.0f : weight(heldBeat) + 0.5f * own;
+                float pull = (1.0f - expf(-dt / TEMPO_PHASE_TAU_MS)) * phaseWeight / (phaseWeight + ownBeat);
+                advance(error * pull);
+                if (isBefore(lastBeat, lastPhase)) {
+                    beat = lastBeat;
+                    phase = lastPhase;
+                }
+                // Behind the sources: the period is too long
+                periodMs *= 1.0f - TEMPO_PLL_FREQ_GAIN * error * pull;
+            }
+        }
+        running = true;
+        confidence = top.confidence > held ? top.confidence : held;
+        beatConfidence = topPhase > heldBeat ? topPhase : heldBeat;
+        leader = sources[lead]->name();
+    }
+
+    features.gridLocked = running;
+    features.gridBeat = running && beat != lastBeat;
+    features.beatIndex = beat;
+    features.beatInBar = beat % BeatGrid::BEATS_PER_BAR;
+    features.bar = beat / BeatGrid::BEATS_PER_BAR;
+    if (!running) {
+        features.tempoConfidence = 0;
+        return;
+    }
+    features.bpm = 60000.0f / periodMs;
+    features.beatPhase = phase;
+    features.tempoConfidence = confidence;
+}
@@ -0,0 +1,98 @@
+// TempoTracker.h
+#pragma once
+
+#include <stdint.h>
+#include "AudioFeatures.h"
+#include "config.h"
+#include "TempoSource.h"
+
+// The beat detector as a tempo source. Its BPM comes from one onset
+// interval at a time, quantised to frames, so instead the onsets are
+// numbered by the beat they fall on (counting the ones it missed) and a line
+// through the last AUDIO_FIT of them gives the period and the beat. Onsets
+// far off the line don't count; the more of them, and the further the
+// counted ones scatter, the less the source is trusted. It fades out over
+// TEMPO_AUDIO_FADE_MS once onsets stop landing on the beat (the mic drowned
+// out, a breakdown), and when they come back somewhere else starts over at
+// the period that best fits the spacing of the last few onsets.
+class AudioTempo : public TempoSource {
+public:
+    // Once per frame with the detector's features
+    void observe(const AudioFeatures& features, uint32_t now);
+
+    const char* name() const override { return "Audio"; }
+    bool estimate(uint32_t now, TempoEstimate& out) override;
+
+private:
+    static const int AUDIO_FIT = 16;
+    static const int AUDIO_RECENT = 8;
+
+    float captureMs() const;
+    float captureMs(float period) const;
+    float spacingFit(float period) const;
+    float guessPeriod() const;
+    bool elsewhere() const;
+    void restart(uint32_t onsetMs);
+
+    BeatFit<AUDIO_FIT> onsets;
+    uint32_t recent[AUDIO_RECENT];  // every onset, counted or not
+    int recentCount = 0;
+    int recentNext = 0;
+    uint32_t beat = 0;          // the newest counted onset's
+    uint32_t beatMs = 0;        // and where the line puts it
+    float periodMs = 0;
+    float hits = 0;             // share of recent onsets that counted
+    int misses = 0;             // in a row
+    uint32_t lastFrameMs = 0;
+    uint32_t frameMs = 0;
+};
+
+// Tempo and beat phase from every source at once, so the show keeps its
+// tempo when one of them goes away. Each frame the sources' tempos are
+// averaged, weighted by confidence and folded onto the most confident
+// source's octave (a detector on half time doesn't drag the tempo down).
+// Their beats steer a phase-locked loop: a beat clock that runs on its own
+// between frames, whose phase is pulled towards the sources' beats over
+// TEMPO_PHASE_TAU_MS and whose period follows the averaged tempo over
+// TEMPO_PERIOD_TAU_MS, nudged by the phase error so it settles on the
+// source's tempo exactly. A source trusted fully that disagrees by more
+// than TEMPO_SNAP_PERCENT (a new track on the MIDI clock) is taken at once.
+// With every source quiet the clock keeps going at its last tempo while its
+// confidence runs down. The clock counts its own beats, which only ever go
+// forward, so they can stand in for the beat grid's.
+class TempoTracker {
+public:
+    TempoTracker();
+
+    // Besides the audio, which is always there; up to TEMPO_MAX_SOURCES.
+    // The source must outlive the tracker.
+    bool addSource(TempoSource& source);
+    // Once per frame after analysis: the beat grid's fields (gridLocked,
+    // gridBeat, beatIndex, beatInBar, bar) become the clock's, locked while
+    // it runs; bpm and beatPhase too, and tempoConfidence how sure it is.
+    // bpm and beatPhase are left as they are until a source has spoken.
+    void update(AudioFeatures& features, uint32_t now);
+
+    bool isRunning() const { return running; }
+    float getBpm() const { return running ? 60000.0f / periodMs : 0.0f; }
+    float getConfidence() const { return confidence; }
+    // The most confident source at the last update, or null
+    const char* getLeader() const { return leader; }
+
+private:
+    void advance(float beats);
+    bool isBefore(uint32_t otherBeat, float otherPhase) const;
+
+    AudioTempo audio;
+    TempoSource* sources[TEMPO_MAX_SOURCES + 1];
+    int sourceCount;
+
+    bool running;
+    float periodMs;
+    uint32_t beat;             // beats counted since the first update
+    float phase;               // through the current beat, 0 - 1
+    float confidence;
+    float beatConfidence;      // in the beat itself, from sources that gave one
+    uint32_t lastMs;
+    const char* leader;
+};
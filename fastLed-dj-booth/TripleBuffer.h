@@ -0,0 +1,42 @@
+// TripleBuffer.h
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free handoff of whole frames from one writer task to one reader task.
+// The writer fills back() and publish()es it; the reader acquire()s the
+// newest published frame and reads front() for as long as it likes. The
+// third slot sits between them, so neither side ever waits for the other: a
+// frame the reader hasn't taken yet is simply replaced by a newer one.
+template<typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& back() { return slots[backIndex]; }
+
+    // True if this replaced a frame the reader never took
+    bool publish() {
+        uint8_t previous = shared.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+        backIndex = previous & INDEX;
+        return previous & FRESH;
+    }
+
+    // Reader side: false if nothing new has been published since the last call
+    bool acquire() {
+        if (!(shared.load(std::memory_order_acquire) & FRESH)) return false;
+        uint8_t previous = shared.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & INDEX;
+        return true;
+    }
+
+    T& front() { return slots[frontIndex]; }
+
+private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t FRESH = 0x04;
+
+    T slots[3];
+    uint8_t backIndex = 0;
+    uint8_t frontIndex = 1;
+    std::atomic<uint8_t> shared{2};
+};
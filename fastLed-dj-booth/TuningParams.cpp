@@ -0,0 +1,189 @@
+#include "TuningParams.h"
+#include <Arduino.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef ESP32
+#include <Preferences.h>
+#define TUNING_NAMESPACE "tuning"
+#else
+#include <stdio.h>
+#define TUNING_FILE "tuning.bin"
+#endif
+
+TuningParams tuning;
+
+const TuningDef tuningDefs[] = {
+#define TUNING_DEF(type, name, def, lo, hi, help) \
+    { #name, TuningType::type, (uint16_t)offsetof(TuningParams, name), (float)(def), (float)(lo), (float)(hi), help },
+    TUNING_TABLE(TUNING_DEF)
+#undef TUNING_DEF
+};
+
+const int TUNING_COUNT = sizeof(tuningDefs) / sizeof(tuningDefs[0]);
+
+// Stored blobs carry a hash of the names and types so a reflash that changes the
+// table does not load values into the wrong fields
+struct TuningBlob {
+    uint32_t layout;
+    TuningParams values;
+};
+
+static uint32_t tuningLayoutHash() {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < TUNING_COUNT; i++) {
+        for (const char* c = tuningDefs[i].name; *c; c++) {
+            h = (h ^ (uint8_t)*c) * 16777619u;
+        }
+        h = (h ^ (uint8_t)tuningDefs[i].type) * 16777619u;
+    }
+    return h;
+}
+
+const TuningDef* findTuning(const char* name) {
+    for (int i = 0; i < TUNING_COUNT; i++) {
+        if (strcmp(tuningDefs[i].name, name) == 0) return &tuningDefs[i];
+    }
+    return nullptr;
+}
+
+float getTuning(const TuningDef& def) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&tuning) + def.offset;
+    if (def.type == TuningType::Float) return *reinterpret_cast<const float*>(base);
+    return (float)*reinterpret_cast<const int32_t*>(base);
+}
+
+float setTuning(const TuningDef& def, float value) {
+    value = constrain(value, def.min, def.max);
+    uint8_t* base = reinterpret_cast<uint8_t*>(&tuning) + def.offset;
+    if (def.type == TuningType::Float) {
+        *reinterpret_cast<float*>(base) = value;
+    } else {
+        *reinterpret_cast<int32_t*>(base) = (int32_t)lroundf(value);
+    }
+    return getTuning(def);
+}
+
+void resetTuning() {
+    tuning = TuningParams();
+}
+
+static void applyBlob(const TuningBlob& blob) {
+    tuning = blob.values;
+    // Re-clamp in case the ranges were tightened since the values were saved
+    for (int i = 0; i < TUNING_COUNT; i++) {
+        setTuning(tuningDefs[i], getTuning(tuningDefs[i]));
+    }
+}
+
+#ifdef ESP32
+
+bool loadTuning() {
+    Preferences prefs;
+    if (!prefs.begin(TUNING_NAMESPACE, true)) return false;
+    TuningBlob blob;
+    bool ok = prefs.getBytesLength("blob") == sizeof(blob) &&
+              prefs.getBytes("blob", &blob, sizeof(blob)) == sizeof(blob) &&
+              blob.layout == tuningLayoutHash();
+    prefs.end();
+    if (ok) applyBlob(blob);
+    return ok;
+}
+
+bool saveTuning() {
+    Preferences prefs;
+    if (!prefs.begin(TUNING_NAMESPACE, false)) return false;
+    TuningBlob blob;
+    blob.layout = tuningLayoutHash();
+    blob.values = tuning;
+    bool ok = prefs.putBytes("blob", &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    return ok;
+}
+
+#else
+
+bool loadTuning() {
+    FILE* f = fopen(TUNING_FILE, "rb");
+    if (!f) return false;
+    TuningBlob blob;
+    bool ok = fread(&blob, sizeof(blob), 1, f) == 1 && blob.layout == tuningLayoutHash();
+    fclose(f);
+    if (ok) applyBlob(blob);
+    return ok;
+}
+
+bool saveTuning() {
+    FILE* f = fopen(TUNING_FILE, "wb");
+    if (!f) return false;
+    TuningBlob blob;
+    blob.layout = tuningLayoutHash();
+    blob.values = tuning;
+    bool ok = fwrite(&blob, sizeof(blob), 1, f) == 1;
+    fclose(f);
+    return ok;
+}
+
+#endif
+
+static void printTuning(const TuningDef& def) {
+    if (def.type == TuningType::Float) {
+        Serial.printf("%-16s %10.4f  [%g..%g] %s\n", def.name, getTuning(def), def.min, def.max, def.help);
+    } else {
+        Serial.printf("%-16s %10d  [%g..%g] %s\n", def.name, (int)getTuning(def), def.min, def.max, def.help);
+    }
+}
+
+static void handleTuningCommand(char* line) {
+    char* cmd = strtok(line, " \t");
+    char* name = strtok(nullptr, " \t");
+    char* value = strtok(nullptr, " \t");
+    if (!cmd) return;
+
+    if (strcmp(cmd, "list") == 0) {
+        for (int i = 0; i < TUNING_COUNT; i++) printTuning(tuningDefs[i]);
+    } else if (strcmp(cmd, "get") == 0 || strcmp(cmd, "set") == 0) {
+        const TuningDef* def = name ? findTuning(name) : nullptr;
+        if (!def) {
+            Serial.printf("[Tuning] Unknown parameter: %s\n", name ? name : "");
+            return;
+        }
+        if (strcmp(cmd, "set") == 0) {
+            if (!value) {
+                Serial.println("[Tuning] Usage: set <name> <value>");
+                return;
+            }
+            setTuning(*def, atof(value));
+        }
+        printTuning(*def);
+    } else if (strcmp(cmd, "save") == 0) {
+        Serial.println(saveTuning() ? "[Tuning] Saved" : "[Tuning] Save failed");
+    } else if (strcmp(cmd, "load") == 0) {
+        Serial.println(loadTuning() ? "[Tuning] Loaded" : "[Tuning] Nothing stored");
+    } else if (strcmp(cmd, "defaults") == 0) {
+        resetTuning();
+        Serial.println("[Tuning] Defaults restored (not saved)");
+    } else {
+        Serial.println("[Tuning] Commands: list | get <name> | set <name> <value> | save | load | defaults");
+    }
+}
+
+// Non-blocking: consumes whatever bytes are waiting and acts on complete lines
+void pollTuningConsole() {
+    static char line[64];
+    static int len = 0;
+
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c < 0) break;
+        if (c == '\n' || c == '\r') {
+            if (len > 0) {
+                line[len] = '\0';
+                handleTuningCommand(line);
+                len = 0;
+            }
+        } else if (len < (int)sizeof(line) - 1) {
+            line[len++] = (char)c;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+// TuningParams.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "PaletteTables.h"
+
+// Venue-tunable parameters. Every subsystem reads the flat `tuning` struct
+// directly; the table below generates the struct, its defaults and the
+// registry used by the serial console and persistence.
+//
+//  X(type,  name,             default,                min,   max,   help)
+#define TUNING_TABLE(X) \
+    X(Float, beatThreshold,    0.05f,                  0.005f, 0.5f,  "Volume rise that counts as a beat") \
+    X(Int,   beatMinMs,        250,                    100,   1000,  "Minimum time between beats (ms)") \
+    X(Float, bassDivisor,      100.0f,                 1.0f,  1000.0f, "Bass band scale to 0-1") \
+    X(Float, midDivisor,       80.0f,                  1.0f,  1000.0f, "Mid band scale to 0-1") \
+    X(Float, trebleDivisor,    50.0f,                  1.0f,  1000.0f, "Treble band scale to 0-1") \
+    X(Float, gainSmoothing,    0.95f,                  0.0f,  0.999f, "Volume smoothing factor") \
+    X(Int,   agcEnabled,       1,                      0,     1,     "Automatic gain control and noise gate (0 = fixed divisors)") \
+    X(Float, agcTarget,        0.8f,                   0.1f,  1.0f,  "Level recent peaks are scaled to") \
+    X(Float, agcAttackMs,      50.0f,                  0.0f,  5000.0f, "Gain envelope rise time (ms)") \
+    X(Float, agcReleaseMs,     4000.0f,                10.0f, 60000.0f, "Gain envelope fall time (ms)") \
+    X(Float, agcMaxGain,       40.0f,                  1.0f,  1000.0f, "Most the gain control boosts by") \
+    X(Float, noiseGateRatio,   2.0f,                   1.0f,  20.0f, "Gate opens at this multiple of the noise floor (1 = off)") \
+    X(Float, noiseFloorRiseMs, 20000.0f,               1000.0f, 300000.0f, "Noise floor estimate rise time (ms)") \
+    X(Float, volumeAlpha,      0.2f,                   0.01f, 1.0f,  "Controller volume low-pass") \
+    X(Int,   minSwitchMs,      6000,                   1000,  60000, "Minimum time between auto switches (ms)") \
+    X(Int,   minSwitchBeats,   8,                      1,     128,   "Minimum beats between auto switches") \
+    X(Int,   phraseBars,       SWITCH_PHRASE_BARS,     1,     32,    "Bars per phrase for switch alignment") \
+    X(Int,   lookaheadBeats,   SWITCH_LOOKAHEAD_BEATS, 0,     16,    "Beats of warm-up before a switch") \
+    X(Int,   brightness,       128,                    0,     255,   "LED brightness") \
+    X(Int,   palette,          PALETTE_rainbow,        0,     PALETTE_COUNT - 1, "LED palette (PaletteTables.h)") \
+    X(Int,   paletteBlendMs,   2000,                   0,     10000, "Palette cross-fade time (ms)") \
+    X(Int,   frameDelayMs,     100,                    0,     1000,  "Delay at the end of each loop (ms)") \
+    X(Int,   frameBudgetMs,    40,                     0,     1000,  "Work per frame the quality governor holds to (ms, 0 = off)")
+
+#define TUNING_CTYPE_Float float
+#define TUNING_CTYPE_Int int32_t
+
+struct TuningParams {
+#define TUNING_FIELD(type, name, def, lo, hi, help) TUNING_CTYPE_##type name = def;
+    TUNING_TABLE(TUNING_FIELD)
+#undef TUNING_FIELD
+};
+
+enum class TuningType : uint8_t { Float, Int };
+
+struct TuningDef {
+    const char* name;
+    TuningType type;
+    uint16_t offset;
+    float def;
+    float min;
+    float max;
+    const char* help;
+};
+
+extern TuningParams tuning;
+extern const TuningDef tuningDefs[];
+extern const int TUNING_COUNT;
+
+const TuningDef* findTuning(const char* name);
+float getTuning(const TuningDef& def);
+// Clamps to the parameter's range; returns the value actually stored
+float setTuning(const TuningDef& def, float value);
+void resetTuning();
+
+// Persistence: NVS on the ESP32, a file in the working directory on the host.
+// A stored blob from a different parameter layout is ignored.
+bool loadTuning();
+bool saveTuning();
+
+// Serial console: list | get <name> | set <name> <value> | save | load | defaults
+void pollTuningConsole();
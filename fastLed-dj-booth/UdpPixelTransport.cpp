@@ -0,0 +1,54 @@
+#include "UdpPixelTransport.h"
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+UdpPixelTransport::UdpPixelTransport() : fd(-1) {}
+
+UdpPixelTransport::~UdpPixelTransport() {
+    if (fd >= 0) close(fd);
+}
+
+bool UdpPixelTransport::begin(uint16_t port) {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return false;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+size_t UdpPixelTransport::peek(uint8_t* header, size_t len) {
+    if (fd < 0) return 0;
+    ssize_t n;
+    // An empty datagram would stall the queue: take it, and any behind it
+    while ((n = recv(fd, header, len, MSG_PEEK | MSG_DONTWAIT)) == 0) {
+        recv(fd, header, 0, MSG_DONTWAIT);
+    }
+    return n > 0 ? n : 0;
+}
+
+size_t UdpPixelTransport::take(uint8_t* header, size_t headerLen, uint8_t* data, size_t dataLen) {
+    iovec parts[2];
+    parts[0].iov_base = header;
+    parts[0].iov_len = headerLen;
+    parts[1].iov_base = data;
+    parts[1].iov_len = data ? dataLen : 0;
+
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = parts;
+    message.msg_iovlen = data ? 2 : 1;
+    ssize_t n = recvmsg(fd, &message, MSG_DONTWAIT);
+    return n > (ssize_t)headerLen ? n - headerLen : 0;
+}
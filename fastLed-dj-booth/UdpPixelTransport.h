@@ -0,0 +1,26 @@
+// UdpPixelTransport.h
+#pragma once
+
+#include <stdint.h>
+#include "PixelInput.h"
+
+// PixelTransport on a non-blocking UDP socket. Plain BSD sockets, which lwIP
+// provides on the ESP32, so tools/pixel_gen runs the same code on Linux. The
+// channel data lands in PixelInput's frame slot straight from the network
+// stack: one MSG_PEEK for the header, one recvmsg() that scatters the
+// datagram over header and slot. (WiFiUDP would stage each packet in two
+// heap buffers first.)
+class UdpPixelTransport : public PixelTransport {
+public:
+    UdpPixelTransport();
+    ~UdpPixelTransport();
+
+    // Listens on `port` on every interface
+    bool begin(uint16_t port);
+
+    size_t peek(uint8_t* header, size_t len) override;
+    size_t take(uint8_t* header, size_t headerLen, uint8_t* data, size_t dataLen) override;
+
+private:
+    int fd;
+};
@@ -2,21 +2,22 @@
 #include "Widget.h"
 #include "WidgetColorTheme.h"
 #include "ThemeManager.h"
+#include "FrameLog.h"
 
 class VerticalBarWidget : public Widget {
 private:
-    String label;
+    const char* label;
     float value; // Expected to be between 0.0 and 1.0
     const WidgetColorTheme& theme;
     bool beatPulse;
 
 public:
-    VerticalBarWidget(const String& lbl, float val, const WidgetColorTheme& themeRef = ThemeManager::get(), bool pulse = false)
+    VerticalBarWidget(const char* lbl, float val, const WidgetColorTheme& themeRef = ThemeManager::get(), bool pulse = false)
         : label(lbl), value(val), theme(themeRef), beatPulse(pulse) {}
 
     void draw(TFT_eSPI& tft, int x, int y, int width, int height) override {
-        Serial.printf("[VerticalBarWidget] draw: %s=%.2f at (%d,%d,%d,%d)\n", 
-                     label.c_str(), value, x, y, width, height);
+        FRAME_LOG("[VerticalBarWidget] draw: %s=%.2f at (%d,%d,%d,%d)\n", 
+                     label, value, x, y, width, height);
 
         // Safety checks
         if (width <= 2 || height <= 2) {
@@ -38,39 +39,16 @@ public:
             tft.fillRect(x + 1, barY, width - 2, barHeight, barCol);
         }
 
-        // --- Fixed Sprite Handling ---
-        TFT_eSprite sprite(&tft); // Stack-allocated
-        
-        // Validate dimensions before creating sprite
-        if (width <= 0 || height <= 0) {
-            Serial.println("[ERROR] Invalid dimensions for sprite");
-            return;
-        }
-
-        // Create sprite with original orientation dimensions
-        if (!sprite.createSprite(width, height)) {
-            Serial.println("[ERROR] Failed to create sprite");
-            return;
+        // Label down the middle, one letter under the other, over the bar.
+        // Plain characters rather than a rotated sprite: no read-back from
+        // the panel, and it draws the same into a WidgetCanvas band.
+        int letters = strlen(label);
+        int letterX = x + (width - 5) / 2;
+        int letterY = y + (height - letters * 8) / 2;
+        for (int i = 0; i < letters; i++) {
+            // Same colour for background: drawn transparent
+            tft.drawChar(letterX, letterY + i * 8, label[i], theme.text, theme.text, 1);
         }
-
-        try {
-            // Draw label in original orientation
-            sprite.fillSprite(theme.background);
-            sprite.setTextColor(theme.text, theme.background);
-            sprite.setTextDatum(MC_DATUM);
-            sprite.setTextSize(1);
-            
-            // Center in original dimensions
-            sprite.drawString(label, width/2, height/2);
-
-            // Single rotation operation with position
-            sprite.pushRotated(270, theme.background);
-        } 
-        catch (...) {
-            Serial.println("[ERROR] Sprite operation failed");
-        }
-
-        // Automatic cleanup - no delete needed for stack sprite
     }
 
     int getMinWidth() const override { return 20; }
@@ -2,6 +2,7 @@
 #include "Widget.h"
 #include "WidgetColorTheme.h"
 #include "ThemeManager.h"
+#include "FrameLog.h"
 
 class WaveformWidget : public Widget {
 private:
@@ -9,13 +10,14 @@ private:
     int samples;
     const WidgetColorTheme& theme;
     bool beatPulse;
+    int step;   // pixel columns per drawn segment
 
 public:
-    WaveformWidget(const int16_t* wf, int samp, const WidgetColorTheme& themeRef = ThemeManager::get(), bool pulseOnBeat = false)
-        : waveform(wf), samples(samp), theme(themeRef), beatPulse(pulseOnBeat) {}
+    WaveformWidget(const int16_t* wf, int samp, const WidgetColorTheme& themeRef = ThemeManager::get(), bool pulseOnBeat = false, int columnStep = 1)
+        : waveform(wf), samples(samp), theme(themeRef), beatPulse(pulseOnBeat), step(columnStep < 1 ? 1 : columnStep) {}
 
     void draw(TFT_eSPI& tft, int x, int y, int width, int height) override {
-        Serial.printf("[WaveformWidget] draw: samples=%d, ptr=%p at (%d,%d,%d,%d)\n", samples, (void*)waveform, x, y, width, height);
+        FRAME_LOG("[WaveformWidget] draw: samples=%d, ptr=%p at (%d,%d,%d,%d)\n", samples, (void*)waveform, x, y, width, height);
 
         // More aggressive validation
         if (!waveform) {
@@ -26,30 +28,35 @@ public:
             Serial.println("[WaveformWidget] ERROR: Invalid sample count!");
             return;
         }
-        // Check if pointer seems valid (basic validity test)
+#ifdef ESP32
+        // Check if pointer seems valid (basic validity test: ESP32 data RAM)
         if ((uintptr_t)waveform < 0x3FF00000 || (uintptr_t)waveform >= 0x40000000) {
             Serial.printf("[WaveformWidget] ERROR: Suspicious waveform pointer value: %p\n", waveform);
             return;
         }
+#endif
 
         int baseY = y + height / 2;
         uint16_t fillColor = theme.primary;
         uint16_t lineColor = theme.accent;
 
-        // Optional outline
-        tft.drawRect(x - 1, y - 1, width + 2, height + 2, theme.secondary);
+        tft.fillRect(x, y, width, height, theme.background);
+        // Outline inside the widget's rectangle, which is all a canvas band has
+        tft.drawRect(x, y, width, height, theme.secondary);
 
-        for (int i = 0; i < width - 1; ++i) {
+        for (int i = 0; i < width - 1; i += step) {
+            int next = min(i + step, width - 1);
             int idx1 = map(i, 0, width - 1, 0, samples - 1);
-            int idx2 = map(i + 1, 0, width - 1, 0, samples - 1);
+            int idx2 = map(next, 0, width - 1, 0, samples - 1);
 
             int s1 = map(waveform[idx1], -32768, 32767, -height / 2, height / 2);
             int s2 = map(waveform[idx2], -32768, 32767, -height / 2, height / 2);
 
             // Fill under waveform
-            tft.drawLine(x + i, baseY + s1, x + i, baseY, fillColor);
+            if (step == 1) tft.drawLine(x + i, baseY + s1, x + i, baseY, fillColor);
+            else tft.fillRect(x + i, min(baseY, baseY + s1), next - i, abs(s1) + 1, fillColor);
             // Draw waveform line
-            tft.drawLine(x + i, baseY + s1, x + i + 1, baseY + s2, lineColor);
+            tft.drawLine(x + i, baseY + s1, x + next, baseY + s2, lineColor);
         }
     }
 
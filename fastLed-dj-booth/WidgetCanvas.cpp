@@ -0,0 +1,80 @@
+#include "WidgetCanvas.h"
+#include "FrameLog.h"
+
+WidgetCanvas::WidgetCanvas(CountingTFT& tft)
+    : tft(tft), first(&tft), second(&tft), bandCount(0), next(0), batching(false), dma(false), writing(false) {}
+
+bool WidgetCanvas::begin() {
+#if WIDGET_BATCHING
+    // Two bands only pay off when one can be drawn while the other goes out
+    bandCount = WIDGET_DMA ? 2 : 1;
+    if (!first.allocate(WIDGET_BAND_PIXELS) || (bandCount == 2 && !second.allocate(WIDGET_BAND_PIXELS))) {
+        Serial.printf("[WidgetCanvas] No memory for a %d pixel band, drawing direct\n", WIDGET_BAND_PIXELS);
+        first.deleteSprite();
+        return false;
+    }
+    // Sprites keep their pixels in the panel's byte order already
+    tft.setSwapBytes(false);
+#if WIDGET_DMA
+    dma = tft.initDMA();
+    if (!dma) Serial.println("[WidgetCanvas] No DMA, pushing bands blocking");
+#endif
+    batching = true;
+    Serial.printf("[WidgetCanvas] Batching widgets in %d x %d pixel bands%s\n", bandCount, WIDGET_BAND_PIXELS,
+                  dma ? " over DMA" : "");
+#endif
+    return batching;
+}
+
+void WidgetCanvas::beginFrame() {
+    if (!batching) return;
+    // One transaction held across the drawing; the pushes inside it only
+    // set their window
+    tft.startWrite();
+    writing = true;
+}
+
+void WidgetCanvas::endFrame() {
+    if (!writing) return;
+    if (dma) tft.dmaWait();
+    tft.endWrite();
+    writing = false;
+}
+
+void WidgetCanvas::draw(Widget& widget, const WidgetRect& r) {
+    int rows = WIDGET_BAND_PIXELS / r.w;
+    if (!batching || rows < 1) {
+        if (dma) tft.dmaWait();
+        widget.draw(tft, r.x, r.y, r.w, r.h);
+        return;
+    }
+    if (rows > r.h) rows = r.h;
+    for (int top = 0; top < r.h; top += rows) {
+        int h = r.h - top < rows ? r.h - top : rows;
+        BandSprite& band = next ? second : first;
+        next = (next + 1) % bandCount;
+        band.reshape(r.w, h);
+        band.fillSprite(TFT_BLACK);
+        // The widget draws at its full size; the band clips it to these rows
+        widget.draw(band, 0, -top, r.w, r.h);
+        push(band, r.x, r.y + top, r.w, h);
+    }
+}
+
+void WidgetCanvas::clear(const WidgetRect& r, uint16_t color) {
+    if (dma) tft.dmaWait();
+    tft.fillRect(r.x, r.y, r.w, r.h, color);
+}
+
+void WidgetCanvas::push(BandSprite& band, int x, int y, int w, int h) {
+    FRAME_LOG("[WidgetCanvas] push %dx%d at (%d,%d)\n", w, h, x, y);
+    tft.countTransaction();
+#if WIDGET_DMA
+    if (dma) {
+        // Waits for the push before, which used the other band
+        tft.pushImageDMA(x, y, w, h, band.pixels());
+        return;
+    }
+#endif
+    tft.pushImage(x, y, w, h, band.pixels());
+}
@@ -0,0 +1,72 @@
+// WidgetCanvas.h
+#pragma once
+
+#include <TFT_eSPI.h>
+#include "config.h"
+#include "CountingTFT.h"
+#include "Widget.h"
+#include "GridLayout.h"
+
+// A sprite whose pixel buffer is allocated once and reshaped to each
+// widget's size, so widgets of different sizes share one buffer without
+// reallocating it every drawing. Sets the same fields createSprite() does
+// (TFT_eSPI 2.x).
+class BandSprite : public TFT_eSprite {
+public:
+    explicit BandSprite(TFT_eSPI* tft) : TFT_eSprite(tft), capacity(0) {}
+
+    bool allocate(int32_t pixels) {
+        setColorDepth(16);
+        if (!createSprite(pixels, 1)) return false;
+        capacity = pixels;
+        return true;
+    }
+    bool reshape(int32_t w, int32_t h) {
+        if (w < 1 || h < 1 || w * h > capacity) return false;
+        _iwidth = _dwidth = _bitwidth = w;
+        _iheight = _dheight = h;
+        _sx = _sy = 0;
+        _sw = w;
+        _sh = h;
+        setViewport(0, 0, w, h);
+        return true;
+    }
+    // RGB565 in the panel's byte order, rows of the current width
+    uint16_t* pixels() { return (uint16_t*)getPointer(); }
+
+private:
+    int32_t capacity;
+};
+
+// Draws widgets off screen and sends each to the panel in one go. A widget
+// draws into a band sprite at its own size (a tall one in horizontal bands
+// of WIDGET_BAND_PIXELS), and each band goes out as one address window and
+// one pixel push; with WIDGET_DMA the push runs while the next band is
+// drawn into the other sprite. Without the band memory, or with
+// WIDGET_BATCHING off, widgets draw straight to the panel as before.
+class WidgetCanvas {
+public:
+    explicit WidgetCanvas(CountingTFT& tft);
+
+    // Once, after tft.init(); false if it fell back to direct drawing
+    bool begin();
+    bool isBatching() const { return batching; }
+
+    // Around the widgets of one drawing
+    void beginFrame();
+    void endFrame();
+
+    void draw(Widget& widget, const WidgetRect& r);
+    void clear(const WidgetRect& r, uint16_t color);
+
+private:
+    CountingTFT& tft;
+    BandSprite first, second;
+    int bandCount;
+    int next;
+    bool batching;
+    bool dma;
+    bool writing;
+
+    void push(BandSprite& band, int x, int y, int w, int h);
+};
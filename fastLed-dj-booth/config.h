@@ -1,12 +1,105 @@
-// Config.h
+// config.h
 #ifndef CONFIG_H
 #define CONFIG_H
 
 #define AUDIO_DEBUG true
 #define MODE_DEBUG false
 
+// Binary telemetry over Serial (see Telemetry.h). Per-frame text logs are
+// compiled out while it is on since both would share the port.
+#define TELEMETRY_ENABLED false
+// Send every Nth LED frame averaged over groups of this many LEDs (0 = no LED frames)
+#define TELEMETRY_LED_DECIMATION 4
+#define TELEMETRY_LED_EVERY 4
+#define FRAME_DEBUG (!TELEMETRY_ENABLED)
+
+// Feature recording and playback on LittleFS (see FeatureRecorder.h)
+#define RECORD_FEATURES false
+#define PLAYBACK_FEATURES false
+// During playback, replay the recorded switch decisions instead of deciding live
+#define PLAYBACK_FOLLOW_DECISIONS true
+// Run HybridController::simulate() over the recording at boot and print its decisions
+#define SIMULATE_RECORDING false
+#define RECORDING_PATH "/show.ggfr"
+
+// Follow a pre-analyzed cue track from LittleFS (see CueTimeline.h and
+// tools/cue_analyzer). Long-press the mode button at the start of the track
+// to re-arm it.
+#define CUE_TIMELINE_ENABLED false
+#define CUE_TIMELINE_PATH "/track.ggct"
+
+// Golden-frame regression self test at boot (see GoldenFrames.h)
+#define GOLDEN_SELFTEST false
+#define GOLDEN_CAPTURE false
+
+// Dashboard layout: index into dashboardLayouts (DashboardLayouts.cpp), or -1
+// for the largest that fits the screen
+#define DASHBOARD_LAYOUT -1
+// Draw each widget off screen and push it to the panel in one go (see
+// WidgetCanvas.h); the band is RGB565, 2 bytes a pixel, two of them with DMA
+#define WIDGET_BATCHING true
+#define WIDGET_BAND_PIXELS 6144
+#define WIDGET_DMA true
+// Per-frame scratch for display widgets (see FrameArena.h)
+#define FRAME_ARENA_BYTES 2048
+// Memory report (see MemoryMonitor.h) this often, as text or, with telemetry
+// on, as a TELEMETRY_MEMORY packet (0 = never)
+#define HEAP_REPORT_INTERVAL_MS 10000
+// Count allocations per frame; needs CONFIG_HEAP_USE_HOOKS=y in the sdkconfig
+#define MEMORY_ALLOC_HOOKS false
+
+// Whole-strip fades and blurs through LedKernels.h rather than FastLED's
+// own. tools/led_kernel_bench has the kernels no faster than FastLED without
+// a vectorizing compiler, so the device keeps FastLED's.
+#define LED_KERNEL_FADES false
+
+// Render on the loop's core while LEDs and TFT go out from the other one
+// (see OutputPipeline.h); false runs every stage in the loop, one after another
+#define DUAL_CORE_PIPELINE true
+#define PIPELINE_OUTPUT_CORE 0
+#define PIPELINE_LED_STACK 3072
+#define PIPELINE_DISPLAY_STACK 6144
+
+// Several booth controllers on one show (see SyncLink.h): a leader broadcasts
+// its features, beat phase and animation switches over ESP-NOW and followers
+// render from them, falling back to their own audio when it goes quiet
+#define SYNC_OFF 0
+#define SYNC_LEADER 1
+#define SYNC_FOLLOWER 2
+#define SYNC_MODE SYNC_OFF
+// Booths sharing a channel only listen to their own group
+#define SYNC_GROUP 1
+// Followers only, unique within the group (1-254)
+#define SYNC_NODE_ID 1
+// Wi-Fi channel; the same on every node (and the access point's, with
+// PIXEL_INPUT_ENABLED)
+#define SYNC_CHANNEL 1
+
+// Lighting desk drives the strip over Art-Net or E1.31 (see PixelInput.h);
+// the animations take over again when its stream stops
+#define PIXEL_INPUT_ENABLED false
+#define PIXEL_WIFI_SSID "booth-lighting"
+#define PIXEL_WIFI_PASSWORD ""
+// 6454 for Art-Net, 5568 for E1.31 (unicast)
+#define PIXEL_INPUT_PORT 6454
+// Universe of the first pixel; the strip takes 170 pixels per universe
+#define PIXEL_INPUT_UNIVERSE 0
+// Frames the jitter buffer holds (3 or more), and the most it may delay them
+#define PIXEL_JITTER_SLOTS 4
+#define PIXEL_JITTER_MAX_MS 60
+// Stream considered stopped after this long without a packet; the last frame
+// then fades into the animations over PIXEL_FADE_MS
+#define PIXEL_TIMEOUT_MS 1000
+#define PIXEL_FADE_MS 1000
+
 
 #define NUM_LEDS 60
+// How the pixels are laid out, for effects that radiate (see SpatialMap.h).
+// Each segment is a Line, mirrored from its middle, or one closed Ring;
+// rings count outward from `ring`, the first ring of the segment.
+//  X(first, count, shape, ring)
+#define LED_SEGMENT_TABLE(X) \
+    X(0, NUM_LEDS, Line, 0)
 #define NUM_SAMPLES 512
 #define SAMPLE_RATE 44100
 
@@ -15,8 +108,54 @@
 #define I2S_SCK 27
 #define LED_PIN 25
 #define BTN_PIN 0
+#define BTN_AUTO_PIN 35
 #define BACKLIGHT_PIN 4
-// Synchronize this count with the number of animations defined in the animations[] array in Animations.h will fail build if mismatching
-#define HYBRID_ANIM_COUNT 14
+
+// Buttons are sampled by a timer interrupt every BUTTON_SAMPLE_US and
+// debounced there, so a press is queued within BUTTON_DEBOUNCE_MS of the
+// edge however long the frame takes
+//  X(name, pin)
+#define BUTTON_TABLE(X) \
+    X(Mode, BTN_PIN)    \
+    X(Auto, BTN_AUTO_PIN)
+#define BUTTON_SAMPLE_US 1000
+#define BUTTON_DEBOUNCE_MS 5
+// Held this long: Long; released and pressed again within
+// BUTTON_DOUBLE_MS: Double instead of Click
+#define BUTTON_LONG_MS 600
+#define BUTTON_DOUBLE_MS 300
+#define BUTTON_QUEUE_SIZE 16
+// What each gesture does. Press comes on the way down, before a Long or
+// Double can be told from a Click (which waits BUTTON_DOUBLE_MS after the
+// release), so the main actions go on Press and act at once: a Long or
+// Double takes back what its presses did (the taps, or the switches) before
+// doing its own. Every press of the Auto button taps, as taps want the press
+// edge, so toggling auto-switching is a hold; it fires as the hold passes
+// BUTTON_LONG_MS, without waiting for the release.
+//  X(button, gesture, action)
+#define BUTTON_BINDINGS(X)                \
+    X(Mode, Press,  NextAnimation)        \
+    X(Mode, Long,   FreezeFrame)          \
+    X(Mode, Double, FollowTimeline)       \
+    X(Auto, Press,  TapTempo)             \
+    X(Auto, Long,   ToggleAutoSwitch)     \
+    X(Auto, Double, StepBrightness)
+// Taps between these tempos count; a tapped tempo has a say in the show's
+// tempo (see TempoTracker.h) for this long, less and less as it ages
+#define TAP_TEMPO_MIN_BPM 60
+#define TAP_TEMPO_MAX_BPM 200
+#define TAP_TEMPO_HOLD_MS 120000
+// MIDI beat clock from the mixer or a drum machine as another tempo source
+// (see MidiClock.h): MIDI in through an opto-isolator to MIDI_RX_PIN
+#define MIDI_CLOCK_ENABLED false
+#define MIDI_RX_PIN 33
+// Tempo sources TempoTracker takes besides the audio
+#define TEMPO_MAX_SOURCES 3
+
+// Defaults for tuning.phraseBars / tuning.lookaheadBeats (see TuningParams.h)
+// Auto-switches land on the start of a phrase of this many bars (8, 16 or 32)
+#define SWITCH_PHRASE_BARS 8
+// Beats before the boundary at which the next animation is chosen and warmed up
+#define SWITCH_LOOKAHEAD_BEATS 4
 
 #endif
@@ -1,35 +1,101 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include <TFT_eSPI.h>
-#include <Button2.h>
-#include "Config.h"
+#include "config.h"
 #include "AudioProcessor.h"
 #include "Animations.h"
+#include "ButtonInput.h"
 #include "DisplayManager.h"
+#include "EspHal.h"
 #include "HybridController.h"
+#include "GoldenFrames.h"
+#include "TuningParams.h"
+#include "FrameProfiler.h"
+#include "Telemetry.h"
+#include "FeatureRecorder.h"
+#include "PaletteManager.h"
+#include "FrameLog.h"
+#include "MemoryMonitor.h"
+#include "QualityGovernor.h"
+#include "OutputPipeline.h"
+#include "Modulation.h"
+#include "SpatialMap.h"
+#include "SyncLink.h"
+#include "FrameClock.h"
+#include "TempoTracker.h"
+#include "MidiClock.h"
+#if SYNC_MODE != SYNC_OFF
+#include "EspNowTransport.h"
+#endif
+#if PIXEL_INPUT_ENABLED
+#include <WiFi.h>
+#include "UdpPixelTransport.h"
+#endif
  
 
 // Hardware
-CRGB leds[NUM_LEDS];
-TFT_eSPI tft = TFT_eSPI();
-Button2 nextModeBtn(BTN_PIN);
-Button2 autoModeBtn(35);
-AudioProcessor audioProcessor;
+alignas(4) CRGB leds[NUM_LEDS];
+CountingTFT tft;
+I2sAudioSource micInput;
+FastLedSink ledSink;
+AudioProcessor audioProcessor(micInput);
 DisplayManager displayManager(tft);
 HybridController hybridController;
+TempoTracker tempoTracker;
+#if MIDI_CLOCK_ENABLED
+MidiClock midiClock;
+#endif
+FrameProfiler profiler;
+#if TELEMETRY_ENABLED
+Telemetry telemetry(Serial);
+#endif
+#if RECORD_FEATURES
+FeatureRecorder recorder;
+#endif
+#if PLAYBACK_FEATURES
+FeaturePlayer player;
+#endif
+#if CUE_TIMELINE_ENABLED
+CueTimeline cueTimeline;
+#endif
+#if DUAL_CORE_PIPELINE
+OutputPipeline pipeline(displayManager, ledSink);
+#endif
+bool pipelineRunning = false;
+#if SYNC_MODE != SYNC_OFF
+EspNowTransport syncTransport;
+#endif
+#if SYNC_MODE == SYNC_LEADER
+SyncLeader syncLeader(syncTransport, SYNC_GROUP);
+#elif SYNC_MODE == SYNC_FOLLOWER
+SyncFollower syncFollower(syncTransport, SYNC_GROUP, SYNC_NODE_ID);
+#endif
+#if PIXEL_INPUT_ENABLED
+UdpPixelTransport pixelTransport;
+PixelInput pixelInput(pixelTransport, PIXEL_INPUT_UNIVERSE);
+#endif
+
+// loop.cpp
+void reportHeapUsage();
 
 void setup() {
     Serial.begin(115200);
     Serial.println("=== SETUP BEGIN ===");
+    MemoryMonitor::begin();
+
+    // Venue tuning saved at soundcheck, if any
+    Serial.println(loadTuning() ? "Tuning loaded" : "Tuning defaults");
 
     // Initialize LEDs
     FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);
-    FastLED.setBrightness(128);
+    FastLED.setBrightness(tuning.brightness);
+    SpatialMap::build();
     Serial.println("LEDs initialized");
 
     // Initialize Display
     tft.init();
     tft.setRotation(1);
+    displayManager.begin();
     pinMode(BACKLIGHT_PIN, OUTPUT);
     digitalWrite(BACKLIGHT_PIN, HIGH);
     displayManager.showStartupScreen();
@@ -40,66 +106,332 @@ void setup() {
     audioProcessor.begin();
     Serial.println("AudioProcessor initialized");
 
+#if GOLDEN_SELFTEST
+    runGoldenSelfTest(audioProcessor);
+#endif
+
     // Register Animations
     registerAnimations();
     Serial.println("Animations registered");
 
     // Initialize Buttons
-    setupButtons();
-    Serial.println("Buttons initialized");
+    Serial.println(ButtonInput::begin() ? "Buttons initialized" : "Button timer failed, no buttons");
+
+    // Tempo sources besides the audio
+    tempoTracker.addSource(hybridController.getTapTempo());
+#if MIDI_CLOCK_ENABLED
+    tempoTracker.addSource(midiClock);
+    Serial.println(midiClock.begin() ? "[Tempo] MIDI clock on Serial2" : "[Tempo] MIDI UART failed, no clock");
+#endif
+
+#if SIMULATE_RECORDING
+    runRecordingSimulation();
+#endif
+#if RECORD_FEATURES
+    recorder.begin(RECORDING_PATH);
+#endif
+#if RECORD_FEATURES || SYNC_MODE == SYNC_LEADER
+    hybridController.setSwitchListener(onAnimationSwitch);
+#endif
+#if SYNC_MODE != SYNC_OFF
+    if (syncTransport.begin(SYNC_CHANNEL)) {
+        Serial.printf("[Sync] %s, group %d, channel %d\n",
+                      SYNC_MODE == SYNC_LEADER ? "Leader" : "Follower", SYNC_GROUP, SYNC_CHANNEL);
+    } else {
+        Serial.println("[Sync] ESP-NOW init failed, running standalone");
+    }
+#endif
+#if PIXEL_INPUT_ENABLED
+    // Joins in the background; the socket listens from now on
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(PIXEL_WIFI_SSID, PIXEL_WIFI_PASSWORD);
+    if (pixelTransport.begin(PIXEL_INPUT_PORT)) {
+        Serial.printf("[Pixels] Listening on %s port %d, universe %d\n", PIXEL_WIFI_SSID, PIXEL_INPUT_PORT, PIXEL_INPUT_UNIVERSE);
+    } else {
+        Serial.println("[Pixels] Socket failed, animations only");
+    }
+#endif
+#if PLAYBACK_FEATURES
+    if (player.begin(RECORDING_PATH)) {
+        hybridController.setExternalControl(PLAYBACK_FOLLOW_DECISIONS);
+    }
+#endif
+#if CUE_TIMELINE_ENABLED
+    if (loadCueTimeline(CUE_TIMELINE_PATH, cueTimeline)) {
+        hybridController.followTimeline(&cueTimeline);
+    }
+#endif
+#if DUAL_CORE_PIPELINE
+    // Last: from here on only the output core touches the strip and the TFT
+    pipelineRunning = pipeline.begin();
+#endif
     Serial.println("=== SETUP END ===");
 }
 
 void registerAnimations() {
-  for (size_t i = 0; i < HYBRID_ANIM_COUNT; i++) {
-    hybridController.addAnimation(animations[i].function, animations[i].name);
+  hybridController.setAnimations(animations, ANIMATION_COUNT);
 
-    // Debug print for verification
+  // Debug print for verification
+  for (int i = 0; i < ANIMATION_COUNT; i++) {
     Serial.printf("Registered animation: %s\n", animations[i].name);
   }
 }
 
-void setupButtons() {
-    nextModeBtn.setPressedHandler([](Button2 &btn) {
-        hybridController.switchAnimation();
-    });
+#if CUE_TIMELINE_ENABLED
+bool loadCueTimeline(const char* path, CueTimeline& timeline) {
+    if (!LittleFS.begin(false)) {
+        Serial.println("[Cue] LittleFS mount failed");
+        return false;
+    }
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        Serial.printf("[Cue] %s not found\n", path);
+        return false;
+    }
+
+    size_t size = file.size();
+    uint8_t* data = (uint8_t*)malloc(size);
+    bool ok = data && file.read(data, size) == size && parseCueTimeline(data, size, timeline);
+    free(data);
+    file.close();
+    if (!ok) {
+        Serial.printf("[Cue] %s is not a valid cue track\n", path);
+        timeline.beatCount = 0;
+        return false;
+    }
+    Serial.printf("[Cue] %s: %lu beats at %.1f BPM, %u sections, %u cues\n", path,
+                  (unsigned long)timeline.beatCount, timeline.bpmX10 / 10.0f,
+                  timeline.sectionCount, timeline.cueCount);
+    return true;
+}
+#endif
+
+#if SIMULATE_RECORDING
+void runRecordingSimulation() {
+    static HybridController simController;
+    static FeaturePlayer simPlayer;
+    if (!simPlayer.begin(RECORDING_PATH)) return;
+    simController.setAnimations(animations, ANIMATION_COUNT);
+    simController.simulate([](AudioFeatures& features, void* context) {
+        return static_cast<FeaturePlayer*>(context)->next(features);
+    }, &simPlayer, 0);
+}
+#endif
+
+// Every animation change, whoever made it
+void onAnimationSwitch(int from, int to, const char* reason) {
+#if RECORD_FEATURES
+    recorder.recordSwitch(from, to, reason);
+#endif
+#if SYNC_MODE == SYNC_LEADER
+    syncLeader.sendSwitch(from, to, reason, millis());
+#endif
+}
 
-    autoModeBtn.setPressedHandler([](Button2 &btn) {
-        hybridController.setAutoSwitchEnabled(!hybridController.isAutoSwitchEnabled());
-    });
+#if SYNC_MODE == SYNC_FOLLOWER
+// Take the leader's features and animation while it is heard; local audio and
+// decisions otherwise
+void followLeader(AudioFeatures& features) {
+    static bool following = false;
+    unsigned long now = millis();
+    syncFollower.poll(now);
+    bool heard = syncFollower.apply(features, now);
+    if (heard != following) {
+        Serial.println(heard ? "[Sync] Following leader" : "[Sync] Leader lost, back to local audio");
+        hybridController.setExternalControl(heard);
+        following = heard;
+    }
+    int to;
+    const char* reason;
+    if (heard && syncFollower.pendingSwitch(hybridController.getCurrentIndex(), to, reason, now)) {
+        hybridController.showAnimation(to, reason);
+    }
+}
+
+void reportSync() {
+    const SyncStats& stats = syncFollower.getStats();
+    Serial.printf("[Sync] offset %+ld ms (rtt %lu), %lu frames, %lu lost, %lu dropped, %lu switches, worst %lu ms late\n",
+                  (long)stats.offsetMs, (unsigned long)stats.delayMs, (unsigned long)stats.received,
+                  (unsigned long)stats.lost, (unsigned long)syncTransport.getDropped(),
+                  (unsigned long)stats.switches, (unsigned long)stats.switchLateMs);
+}
+#endif
+
+void reportTempo() {
+    if (!tempoTracker.isRunning()) {
+        Serial.println("[Tempo] No tempo yet");
+        return;
+    }
+    const char* leader = tempoTracker.getLeader();
+    Serial.printf("[Tempo] %.1f BPM from %s, confidence %.2f\n", tempoTracker.getBpm(),
+                  leader ? leader : "nothing (running on)", tempoTracker.getConfidence());
+#if MIDI_CLOCK_ENABLED
+    if (midiClock.getDropped()) Serial.printf("[Tempo] %lu MIDI bytes dropped\n", (unsigned long)midiClock.getDropped());
+#endif
+}
+
+#if PIXEL_INPUT_ENABLED
+void reportPixelInput() {
+    const PixelStats& stats = pixelInput.getStats();
+    Serial.printf("[Pixels] %s, %lu frames, %lu shown, %lu skipped, %lu late, %lu lost, %lu bad, every %u ms, delay %u ms\n",
+                  pixelInput.isStreaming(millis()) ? "streaming" : "idle",
+                  (unsigned long)stats.frames, (unsigned long)stats.shown, (unsigned long)stats.skipped,
+                  (unsigned long)stats.late, (unsigned long)stats.lostPackets, (unsigned long)stats.badPackets,
+                  stats.intervalMs, stats.delayMs);
+}
+#endif
+
+// Next frame from the recording, applying recorded decisions; false when live
+bool nextPlaybackFrame(AudioFeatures& features) {
+#if PLAYBACK_FEATURES
+    if (!player.isPlaying()) return false;
+    if (!player.next(features)) {
+        Serial.println("Playback finished, back to live audio");
+        hybridController.setExternalControl(false);
+        return false;
+    }
+    if (player.hasEvent()) {
+        const RecordedEvent& event = player.getEvent();
+        if (hybridController.isExternalControl()) hybridController.showAnimation(event.to, event.reason);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+// The controller's state for the dashboard, and whether it is showing a recording
+DashboardStatus dashboardStatus() {
+    DashboardStatus status = DisplayManager::captureStatus(&hybridController);
+#if PLAYBACK_FEATURES
+    status.playback = player.isPlaying();
+#endif
+    return status;
 }
 
 void loop() {
-    Serial.println("=== LOOP BEGIN ===");
-    nextModeBtn.loop();
-    autoModeBtn.loop();
+    profiler.beginFrame();
+    MemoryMonitor::beginFrame();
+    FRAME_LOG("=== LOOP BEGIN ===\n");
+    hybridController.pollInput();
+    pollTuningConsole();
 
-    // Audio input
-    Serial.println("Capturing audio...");
-    audioProcessor.captureAudio();
-    Serial.println("Analyzing audio...");
-    AudioFeatures features = audioProcessor.analyzeAudio();
+    // Audio input, or the recorded show during playback
+    static AudioFeatures features;
+    if (!nextPlaybackFrame(features)) {
+        FRAME_LOG("Capturing audio...\n");
+        audioProcessor.captureAudio();
+        profiler.mark(FrameStage::Capture);
+        FRAME_LOG("Analyzing audio...\n");
+        features = audioProcessor.analyzeAudio();
+        // Taps and the MIDI clock weigh in on the detector's tempo and beat
+        tempoTracker.update(features, FrameClock::now());
+    }
+#if RECORD_FEATURES
+    // Where the animations' random numbers start this frame, for playback
+    uint16_t frameSeed = random16_get_seed();
+#endif
+#if SYNC_MODE == SYNC_FOLLOWER
+    followLeader(features);
+#endif
+    profiler.mark(FrameStage::Analyze);
 
-    Serial.printf("AudioFeatures: vol=%.3f, bass=%.3f, mid=%.3f, treb=%.3f, beat=%d, bpm=%.2f, loud=%d\n",
+    FRAME_LOG("AudioFeatures: vol=%.3f, bass=%.3f, mid=%.3f, treb=%.3f, beat=%d, bpm=%.2f, loud=%d\n",
         features.volume, features.bass, features.mid, features.treble, features.beatDetected, features.bpm, features.loudness);
 
     // Check waveform pointer
-    Serial.printf("Waveform ptr: %p\n", (void*)features.waveform);
+    FRAME_LOG("Waveform ptr: %p\n", (void*)features.waveform);
 
     // Update HybridController
-    Serial.println("Updating HybridController...");
-    hybridController.update(leds, NUM_LEDS, features);
+    FRAME_LOG("Updating HybridController...\n");
+    PaletteManager::update();
+    Modulation::update(features);
+    // What goes out: the animations' buffer, or the desk's frame while it streams
+    const CRGB* shown = leds;
+#if PIXEL_INPUT_ENABLED
+    pixelInput.poll(millis());
+    const uint8_t* streamed = pixelInput.playout(millis());
+    if (streamed) {
+        shown = reinterpret_cast<const CRGB*>(streamed);
+    } else
+#endif
+    {
+        hybridController.update(leds, NUM_LEDS, features);
+#if PIXEL_INPUT_ENABLED
+        pixelInput.fadeOut((uint8_t*)leds, millis());
+#endif
+    }
+#if SYNC_MODE == SYNC_LEADER
+    syncLeader.update(features, hybridController.getCurrentIndex(), millis());
+#endif
+#if RECORD_FEATURES
+    recorder.record(features, frameSeed);
+#endif
+    profiler.mark(FrameStage::Update);
 
-    // Update the Display
-    Serial.println("Updating DisplayManager...");
-    displayManager.updateAudioVisualization(features, &hybridController);
+    bool drawDisplay = QualityGovernor::drawDisplay(profiler.getFrame());
+    uint8_t dither = QualityGovernor::ditherEnabled() ? BINARY_DITHER : DISABLE_DITHER;
+#if DUAL_CORE_PIPELINE
+    if (pipelineRunning) {
+        // Hand the frame to the output core; the handoff counts as rendering
+        FRAME_LOG("Publishing frame...\n");
+        if (drawDisplay) pipeline.publishDashboard(features, dashboardStatus());
+        pipeline.publishLeds(shown, tuning.brightness, dither);
+        profiler.mark(FrameStage::Update);
+        pipeline.chargeTo(profiler);
+    } else
+#endif
+    {
+        // Update the Display
+        FRAME_LOG("Updating DisplayManager...\n");
+        if (drawDisplay) {
+            displayManager.updateAudioVisualization(features, dashboardStatus());
+        }
+        profiler.mark(FrameStage::Display);
 
-    Serial.println("FastLED.show()");
-    FastLED.show();
+        FRAME_LOG("FastLED.show()\n");
+        ledSink.show(shown, NUM_LEDS, tuning.brightness, dither);
+        profiler.mark(FrameStage::Show);
+    }
+
+#if RECORD_FEATURES
+    recorder.service();
+#endif
 
     // Monitor memory usage
-    Serial.printf("Free Heap: %d\n", ESP.getFreeHeap());  
+    MemoryMonitor::endFrame();
+    bool memoryReportDue = HEAP_REPORT_INTERVAL_MS > 0 &&
+                           MemoryMonitor::reportDue(millis(), HEAP_REPORT_INTERVAL_MS);
+#if !TELEMETRY_ENABLED
+    if (memoryReportDue) reportHeapUsage();
+    if (memoryReportDue) displayManager.report();
+    if (memoryReportDue) reportTempo();
+#endif
+#if SYNC_MODE == SYNC_FOLLOWER && !TELEMETRY_ENABLED
+    if (memoryReportDue) reportSync();
+#endif
+#if PIXEL_INPUT_ENABLED && !TELEMETRY_ENABLED
+    if (memoryReportDue) reportPixelInput();
+#endif
+
+    FRAME_LOG("=== LOOP END ===\n");
+    // Update interval, cut short by a button so its gesture is acted on now
+    ButtonInput::wait(tuning.frameDelayMs);
+    profiler.mark(FrameStage::Idle);
+    profiler.endFrame();
+    QualityGovernor::update(profiler);
+#if DUAL_CORE_PIPELINE && !TELEMETRY_ENABLED
+    if (memoryReportDue && pipelineRunning) pipeline.report(profiler, millis());
+#endif
 
-    Serial.println("=== LOOP END ===");
-    delay(100); // Update interval
+#if TELEMETRY_ENABLED
+    telemetry.sendFeatures(features, hybridController.getCurrentIndex(),
+                           hybridController.getBuildUpFlag(), hybridController.getDropFlag());
+    telemetry.sendTimings(profiler);
+    telemetry.sendGain(audioProcessor.getGainState());
+    if (TELEMETRY_LED_DECIMATION > 0 && profiler.getFrame() % TELEMETRY_LED_EVERY == 0) {
+        telemetry.sendLeds(shown, NUM_LEDS, TELEMETRY_LED_DECIMATION);
+    }
+    if (memoryReportDue) telemetry.sendMemory(MemoryMonitor::report());
+#endif
 }
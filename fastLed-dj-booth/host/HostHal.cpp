@@ -0,0 +1,156 @@
+#include "HostHal.h"
+#include "config.h"
+#include "FrameClock.h"
+#include <Arduino.h>
+#include <string>
+
+// Sample index of the block starting now
+static uint64_t sampleAtNow() {
+    return (uint64_t)FrameClock::now() * SAMPLE_RATE / 1000;
+}
+
+static int32_t toPcm24(float v) {
+    return (int32_t)(constrain(v, -1.0f, 1.0f) * 8388607.0f);
+}
+
+// --- SyntheticAudioSource ----------------------------------------------------------
+
+int SyntheticAudioSource::read(int32_t* samples, int count) {
+    uint64_t first = sampleAtNow();
+    double beatSamples = SAMPLE_RATE * 60.0 / bpm;
+    for (int i = 0; i < count; i++) {
+        uint64_t n = first + i;
+        double t = (double)n / SAMPLE_RATE;
+        double sinceBeat = fmod((double)n, beatSamples) / SAMPLE_RATE;
+        double sinceOffbeat = fmod(n + beatSamples / 2, beatSamples) / SAMPLE_RATE;
+        // Kick: a falling 90 -> 50 Hz sine with a 120 ms decay
+        double kick = 0.7 * exp(-sinceBeat / 0.12) * sin(2 * PI * (50 * sinceBeat + 40 * 0.03 * (1 - exp(-sinceBeat / 0.03))));
+        double pad = 0.06 * sin(2 * PI * 440 * t);
+        double hat = 0.08 * exp(-sinceOffbeat / 0.02) * sin(2 * PI * 7000 * t);
+        double noise = 0.01 * ((random16() / 32768.0) - 1.0);
+        samples[i] = toPcm24((float)(kick + pad + hat + noise));
+    }
+    return count;
+}
+
+// --- WavAudioSource ----------------------------------------------------------------
+
+static uint16_t le16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t le32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+// Same reader as tools/cue_analyzer.cpp
+static bool readWav(const char* path, std::vector<float>& out, int& sampleRate, std::string& error) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { error = "cannot open"; return false; }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    const uint8_t* samples = nullptr;
+    size_t sampleBytes = 0;
+    for (size_t pos = 12; pos + 8 <= data.size();) {
+        uint32_t size = le32(&data[pos + 4]);
+        const uint8_t* body = &data[pos + 8];
+        size_t avail = std::min((size_t)size, data.size() - pos - 8);
+        if (memcmp(&data[pos], "fmt ", 4) == 0 && avail >= 16) {
+            format = le16(body);
+            channels = le16(body + 2);
+            sampleRate = le32(body + 4);
+            bits = le16(body + 14);
+            if (format == 0xFFFE && avail >= 26) format = le16(body + 24);  // WAVE_FORMAT_EXTENSIBLE
+        } else if (memcmp(&data[pos], "data", 4) == 0) {
+            samples = body;
+            sampleBytes = avail;
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+    bool flt = format == 3 && bits == 32;
+    if (!samples || channels < 1 || sampleRate <= 0 || (!pcm && !flt)) {
+        error = "unsupported WAV format (PCM 16/24/32-bit or 32-bit float)";
+        return false;
+    }
+
+    int bytes = bits / 8;
+    size_t frames = sampleBytes / (bytes * channels);
+    out.resize(frames);
+    for (size_t i = 0; i < frames; i++) {
+        float sum = 0;
+        for (int c = 0; c < channels; c++) {
+            const uint8_t* p = samples + (i * channels + c) * bytes;
+            float v;
+            if (flt) {
+                uint32_t u = le32(p);
+                memcpy(&v, &u, 4);
+            } else if (bits == 16) {
+                v = (int16_t)le16(p) / 32768.0f;
+            } else if (bits == 24) {
+                int32_t s = (p[0] << 8) | (p[1] << 16) | (p[2] << 24);
+                v = (s >> 8) / 8388608.0f;
+            } else {
+                v = (int32_t)le32(p) / 2147483648.0f;
+            }
+            sum += v;
+        }
+        out[i] = sum / channels;
+    }
+    return true;
+}
+
+bool WavAudioSource::begin() {
+    std::vector<float> raw;
+    int rate = 0;
+    std::string error;
+    if (!readWav(path, raw, rate, error)) {
+        Serial.printf("[Audio] %s: %s\n", path, error.c_str());
+        return false;
+    }
+    if (raw.empty()) {
+        Serial.printf("[Audio] %s: no samples\n", path);
+        return false;
+    }
+    // Linear resampling is plenty for band levels and beat tracking
+    size_t length = (size_t)((double)raw.size() * SAMPLE_RATE / rate);
+    pcm.resize(length > 0 ? length : 1);
+    for (size_t i = 0; i < pcm.size(); i++) {
+        double at = (double)i * rate / SAMPLE_RATE;
+        size_t k = (size_t)at;
+        float frac = (float)(at - k);
+        float a = raw[std::min(k, raw.size() - 1)];
+        float b = raw[std::min(k + 1, raw.size() - 1)];
+        pcm[i] = a + (b - a) * frac;
+    }
+    Serial.printf("[Audio] %s: %.1f s at %d Hz\n", path, (double)raw.size() / rate, rate);
+    return true;
+}
+
+int WavAudioSource::read(int32_t* samples, int count) {
+    if (pcm.empty()) return 0;
+    uint64_t first = sampleAtNow();
+    for (int i = 0; i < count; i++) samples[i] = toPcm24(pcm[(first + i) % pcm.size()]);
+    return count;
+}
+
+// --- StatsLedSink ------------------------------------------------------------------
+
+void StatsLedSink::show(const CRGB* leds, int count, uint8_t brightness, uint8_t dither) {
+    (void)dither;
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        CRGB c = leds[i];
+        c.nscale8(brightness);
+        for (int ch = 0; ch < 3; ch++) hash = (hash ^ c.raw[ch]) * 16777619u;
+        sum += c.r + c.g + c.b;
+    }
+    frames++;
+    if (count > 0) levelSum += (float)sum / (count * 3);
+}
@@ -0,0 +1,51 @@
+// HostHal.h
+// The Linux side of Hal.h: audio from a synthesized beat or a WAV file, and
+// a strip that keeps statistics instead of lighting anything. Audio is read
+// at FrameClock time, so a run with a frozen clock is the same every time.
+#pragma once
+
+#include "Hal.h"
+#include <FastLED.h>
+#include <vector>
+
+// A kick drum at `bpm` over a steady tone and a hi-hat, plus a little noise
+class SyntheticAudioSource : public AudioSource {
+public:
+    explicit SyntheticAudioSource(float bpm) : bpm(bpm) {}
+    bool begin() override { return true; }
+    int read(int32_t* samples, int count) override;
+
+private:
+    float bpm;
+};
+
+// A WAV file (PCM 16/24/32-bit or 32-bit float, mixed to mono and resampled
+// to SAMPLE_RATE), looped
+class WavAudioSource : public AudioSource {
+public:
+    explicit WavAudioSource(const char* path) : path(path) {}
+    bool begin() override;
+    int read(int32_t* samples, int count) override;
+    bool isLoaded() const { return !pcm.empty(); }
+
+private:
+    const char* path;
+    std::vector<float> pcm;
+};
+
+// Counts frames and folds every one shown into a hash, so two runs (or two
+// builds) can be compared by the last line they print
+class StatsLedSink : public LedSink {
+public:
+    void show(const CRGB* leds, int count, uint8_t brightness, uint8_t dither) override;
+
+    unsigned long getFrames() const { return frames; }
+    uint32_t getHash() const { return hash; }
+    // Average output level over all frames, 0-255
+    float getAverageLevel() const { return frames ? levelSum / frames : 0; }
+
+private:
+    unsigned long frames = 0;
+    uint32_t hash = 2166136261u;
+    float levelSum = 0;
+};
@@ -0,0 +1,160 @@
+// The Arduino core, FastLED and LittleFS calls of shim/Arduino.h,
+// shim/FastLED.h and shim/LittleFS.h, for Linux. The FastLED ones follow the
+// library's C code (FASTLED_SCALE8_FIXED, FASTLED_BLEND_FIXED) so frames come
+// out the same.
+#include <Arduino.h>
+#include <FastLED.h>
+#include <LittleFS.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+HostFS LittleFS;
+
+// --- Time ------------------------------------------------------------------------
+
+typedef std::chrono::steady_clock HostClock;
+
+static HostClock::time_point bootTime() {
+    static const HostClock::time_point boot = HostClock::now();
+    return boot;
+}
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(HostClock::now() - bootTime()).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(HostClock::now() - bootTime()).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// --- random() ----------------------------------------------------------------------
+
+// xorshift32: the device draws from its hardware RNG; here a seed repeats a run
+static uint32_t randomState = 2463534242u;
+
+long random(long max) {
+    if (max <= 0) return 0;
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (long)(randomState % (uint32_t)max);
+}
+
+long random(long min, long max) {
+    if (min >= max) return min;
+    return min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) randomState = (uint32_t)seed;
+}
+
+// --- FastLED -----------------------------------------------------------------------
+
+uint16_t rand16seed = 1337;
+
+uint8_t sin8(uint8_t theta) {
+    static const uint8_t b_m16_interleave[] = { 0, 49, 49, 41, 90, 27, 117, 10 };
+    uint8_t offset = theta;
+    if (theta & 0x40) offset = (uint8_t)255 - offset;
+    offset &= 0x3F;
+    uint8_t secoffset = offset & 0x0F;
+    if (theta & 0x40) secoffset++;
+    const uint8_t* p = b_m16_interleave + (offset >> 4) * 2;
+    uint8_t b = p[0];
+    uint8_t m16 = p[1];
+    uint8_t mx = (m16 * secoffset) >> 4;
+    int8_t y = mx + b;
+    if (theta & 0x80) y = -y;
+    return (uint8_t)(y + 128);
+}
+
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb) {
+    uint8_t hue = hsv.hue, sat = hsv.sat, val = hsv.val;
+    uint8_t offset8 = (hue & 0x1F) << 3;
+    uint8_t third = scale8(offset8, 85);
+    uint8_t twoThirds = scale8(offset8, 170);
+    uint8_t r, g, b;
+    switch (hue >> 5) {
+        case 0: r = 255 - third; g = third; b = 0; break;
+        case 1: r = 171; g = 85 + third; b = 0; break;
+        case 2: r = 171 - twoThirds; g = 170 + third; b = 0; break;
+        case 3: r = 0; g = 255 - third; b = third; break;
+        case 4: r = 0; g = 171 - twoThirds; b = 85 + twoThirds; break;
+        case 5: r = third; g = 0; b = 255 - third; break;
+        case 6: r = 85 + third; g = 0; b = 171 - third; break;
+        default: r = 170 + third; g = 0; b = 85 - third; break;
+    }
+    if (sat != 255) {
+        if (sat == 0) {
+            r = g = b = 255;
+        } else {
+            uint8_t desat = scale8_video(255 - sat, 255 - sat);
+            uint8_t satscale = 255 - desat;
+            r = scale8(r, satscale) + desat;
+            g = scale8(g, satscale) + desat;
+            b = scale8(b, satscale) + desat;
+        }
+    }
+    if (val != 255) {
+        val = scale8_video(val, val);
+        r = scale8(r, val);
+        g = scale8(g, val);
+        b = scale8(b, val);
+    }
+    rgb.r = r;
+    rgb.g = g;
+    rgb.b = b;
+}
+
+CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay) {
+    if (amountOfOverlay == 0) return existing;
+    if (amountOfOverlay == 255) return existing = overlay;
+    existing.r = blend8(existing.r, overlay.r, amountOfOverlay);
+    existing.g = blend8(existing.g, overlay.g, amountOfOverlay);
+    existing.b = blend8(existing.b, overlay.b, amountOfOverlay);
+    return existing;
+}
+
+CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amountOfP2) {
+    CRGB nu(p1);
+    nblend(nu, p2, amountOfP2);
+    return nu;
+}
+
+void fill_solid(CRGB* leds, int numToFill, const CRGB& color) {
+    for (int i = 0; i < numToFill; i++) leds[i] = color;
+}
+
+void fill_rainbow(CRGB* leds, int numToFill, uint8_t initialHue, uint8_t deltaHue) {
+    CHSV hsv(initialHue, 240, 255);
+    for (int i = 0; i < numToFill; i++) {
+        leds[i] = hsv;
+        hsv.hue += deltaHue;
+    }
+}
+
+void fadeToBlackBy(CRGB* leds, uint16_t numLeds, uint8_t fadeBy) {
+    for (uint16_t i = 0; i < numLeds; i++) leds[i].fadeToBlackBy(fadeBy);
+}
+
+void blur1d(CRGB* leds, uint16_t numLeds, fract8 blurAmount) {
+    uint8_t keep = 255 - blurAmount;
+    uint8_t seep = blurAmount >> 1;
+    CRGB carryover = CRGB::Black;
+    for (uint16_t i = 0; i < numLeds; i++) {
+        CRGB cur = leds[i];
+        CRGB part = cur;
+        part.nscale8(seep);
+        cur.nscale8(keep);
+        cur += carryover;
+        if (i) leds[i - 1] += part;
+        leds[i] = cur;
+        carryover = part;
+    }
+}
@@ -0,0 +1,340 @@
+// TFT_eSPI for Linux (shim/TFT_eSPI.h). Every primitive is clipped to the
+// viewport and ends in writeRect()/writePixels(): the panel's write into
+// its framebuffer and count, sprites' into their pixel buffer.
+#include <TFT_eSPI.h>
+#include <stdlib.h>
+#include "Snapshot.h"
+
+static inline uint16_t swap16(uint16_t c) {
+    return (uint16_t)((c >> 8) | (c << 8));
+}
+
+// --- Panel -----------------------------------------------------------------------
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
+    : _init_width(w), _init_height(h), _width(w), _height(h), rotation(0),
+      _vpX(0), _vpY(0), _vpW(w), _vpH(h), _xDatum(0), _yDatum(0),
+      cursorX(0), cursorY(0), textColor(TFT_WHITE), textBgColor(TFT_WHITE), textSize(1), textDatum(TL_DATUM),
+      textWrap(true), swapBytes(false), xPivot(0), yPivot(0), stats{ 0, 0 } {}
+
+void TFT_eSPI::init() {
+    frame.assign((size_t)_init_width * _init_height, TFT_BLACK);
+    resetPanelStats();
+    setRotation(rotation);
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+    rotation = r & 3;
+    _width = rotation & 1 ? _init_height : _init_width;
+    _height = rotation & 1 ? _init_width : _init_height;
+    setViewport(0, 0, _width, _height);
+}
+
+void TFT_eSPI::setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum) {
+    _xDatum = vpDatum ? x : 0;
+    _yDatum = vpDatum ? y : 0;
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > width()) w = width() - x;
+    if (y + h > height()) h = height() - y;
+    _vpX = x;
+    _vpY = y;
+    _vpW = w > 0 ? x + w : x;
+    _vpH = h > 0 ? y + h : y;
+}
+
+bool TFT_eSPI::clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const {
+    x += _xDatum;
+    y += _yDatum;
+    if (x < _vpX) { w -= _vpX - x; x = _vpX; }
+    if (y < _vpY) { h -= _vpY - y; y = _vpY; }
+    if (x + w > _vpW) w = _vpW - x;
+    if (y + h > _vpH) h = _vpH - y;
+    return w > 0 && h > 0;
+}
+
+// The framebuffer keeps the current rotation's layout; it holds the same
+// number of pixels in every rotation
+
+void TFT_eSPI::writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    if (frame.empty()) return;
+    for (int32_t row = 0; row < h; row++) {
+        uint16_t* p = &frame[(y + row) * _width + x];
+        for (int32_t i = 0; i < w; i++) p[i] = color;
+    }
+    stats.commands++;
+    stats.pixels += w * h;
+}
+
+void TFT_eSPI::writePixels(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, bool swapped) {
+    if (frame.empty()) return;
+    for (int32_t row = 0; row < h; row++) {
+        uint16_t* p = &frame[(y + row) * _width + x];
+        const uint16_t* q = data + row * w;
+        for (int32_t i = 0; i < w; i++) p[i] = swapped ? swap16(q[i]) : q[i];
+    }
+    stats.commands++;
+    stats.pixels += w * h;
+}
+
+uint16_t TFT_eSPI::readPanelPixel(int32_t x, int32_t y) const {
+    if (frame.empty() || x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+    return frame[y * _width + x];
+}
+
+bool TFT_eSPI::saveSnapshot(const char* path) const {
+    if (frame.empty()) return false;
+    return writeImage(path, &frame[0], _width, _height);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+    int32_t w = 1, h = 1;
+    if (clip(x, y, w, h)) writeRect(x, y, 1, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+    int32_t w = 1;
+    if (clip(x, y, w, h)) writeRect(x, y, w, h, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+    int32_t h = 1;
+    if (clip(x, y, w, h)) writeRect(x, y, w, h, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    if (clip(x, y, w, h)) writeRect(x, y, w, h, color);
+}
+
+void TFT_eSPI::fillScreen(uint32_t color) {
+    fillRect(0, 0, width(), height(), color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y + 1, h - 2, color);
+    drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+    if (r > w / 2) r = w / 2;
+    if (r > h / 2) r = h / 2;
+    fillRect(x, y + r, w, h - 2 * r, color);
+    // The corner rows, inset by how far the quarter circle is from the edge
+    for (int32_t dy = 0; dy < r; dy++) {
+        int32_t fromCentre = r - dy;
+        int32_t inset = r - (int32_t)(sqrtf((float)(r * r - fromCentre * fromCentre)) + 0.5f);
+        drawFastHLine(x + inset, y + dy, w - 2 * inset, color);
+        drawFastHLine(x + inset, y + h - 1 - dy, w - 2 * inset, color);
+    }
+}
+
+void TFT_eSPI::drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color) {
+    int32_t dx = abs(xe - xs), sx = xs < xe ? 1 : -1;
+    int32_t dy = -abs(ye - ys), sy = ys < ye ? 1 : -1;
+    int32_t err = dx + dy;
+    for (;;) {
+        int32_t x = xs, y = ys, w = 1, h = 1;
+        if (clip(x, y, w, h)) writeRect(x, y, 1, 1, color);
+        if (xs == xe && ys == ye) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; xs += sx; }
+        if (e2 <= dx) { err += dx; ys += sy; }
+    }
+}
+
+// --- Text (the built-in 6 x 8 font, scaled by the text size) ---------------------
+
+// TFT_eSPI's GLCD font (Adafruit's glcdfont.c), printable ASCII: five
+// columns per character, least significant bit at the top
+static const uint8_t glcdFont[][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 },
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 },
+    { 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 },
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+    { 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x00, 0x60, 0x60, 0x00 },
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },
+    { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 },
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 },
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x00, 0x14, 0x00, 0x00 },
+    { 0x00, 0x40, 0x34, 0x00, 0x00 }, { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 },
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, { 0x3E, 0x41, 0x5D, 0x59, 0x4E },
+    { 0x7C, 0x12, 0x11, 0x12, 0x7C }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 },
+    { 0x3E, 0x41, 0x41, 0x51, 0x73 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 },
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 },
+    { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 },
+    { 0x26, 0x49, 0x49, 0x49, 0x32 }, { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F },
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 },
+    { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x59, 0x49, 0x4D, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x41 },
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x41, 0x7F }, { 0x04, 0x02, 0x01, 0x02, 0x04 },
+    { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x03, 0x07, 0x08, 0x00 }, { 0x20, 0x54, 0x54, 0x78, 0x40 },
+    { 0x7F, 0x28, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x28 }, { 0x38, 0x44, 0x44, 0x28, 0x7F },
+    { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x00, 0x08, 0x7E, 0x09, 0x02 }, { 0x18, 0xA4, 0xA4, 0x9C, 0x78 },
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x40, 0x3D, 0x00 },
+    { 0x7F, 0x10, 0x28, 0x44, 0x00 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x78, 0x04, 0x78 },
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0xFC, 0x18, 0x24, 0x24, 0x18 },
+    { 0x18, 0x24, 0x24, 0x18, 0xFC }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x24 },
+    { 0x04, 0x04, 0x3F, 0x44, 0x24 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C },
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x4C, 0x90, 0x90, 0x90, 0x7C },
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x77, 0x00, 0x00 },
+    { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 },
+};
+
+static bool glyphBit(uint16_t c, int32_t col, int32_t row) {
+    if (c < 0x20 || c > 0x7E || col > 4) return false;
+    return glcdFont[c - 0x20][col] >> row & 1;
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size) {
+    int32_t w = 6 * size, h = 8 * size;
+    if (bg != color) {
+        // The whole cell in one window, as the library sends it
+        std::vector<uint16_t> cell((size_t)w * h);
+        for (int32_t py = 0; py < h; py++) {
+            for (int32_t px = 0; px < w; px++) cell[py * w + px] = glyphBit(c, px / size, py / size) ? color : bg;
+        }
+        writeClipped(x, y, w, h, &cell[0], false);
+        return;
+    }
+    // Same colours: transparent background, only the set pixels are drawn
+    for (int32_t col = 0; col < 5; col++) {
+        for (int32_t row = 0; row < 8; row++) {
+            if (!glyphBit(c, col, row)) continue;
+            int32_t px = x + col * size, py = y + row * size, pw = size, ph = size;
+            if (clip(px, py, pw, ph)) writeRect(px, py, pw, ph, color);
+        }
+    }
+}
+
+int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font) {
+    (void)font;
+    drawChar(x, y, uniCode, textColor, textBgColor, textSize);
+    return 6 * textSize;
+}
+
+int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y) {
+    return drawChar(uniCode, x, y, 1);
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+    if (c == '\r') return 1;
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += 8 * textSize;
+        return 1;
+    }
+    if (textWrap && cursorX + 6 * textSize > width()) {
+        cursorX = 0;
+        cursorY += 8 * textSize;
+    }
+    drawChar(cursorX, cursorY, c, textColor, textBgColor, textSize);
+    cursorX += 6 * textSize;
+    return 1;
+}
+
+int16_t TFT_eSPI::textWidth(const char* string) {
+    return (int16_t)(strlen(string) * 6 * textSize);
+}
+
+int16_t TFT_eSPI::fontHeight() {
+    return 8 * textSize;
+}
+
+int16_t TFT_eSPI::drawString(const char* string, int32_t x, int32_t y) {
+    int16_t w = textWidth(string), h = fontHeight();
+    // Datums run left/centre/right across, top/middle/bottom down
+    int column = textDatum % 3, row = textDatum / 3;
+    x -= column == 1 ? w / 2 : column == 2 ? w : 0;
+    y -= row == 1 ? h / 2 : row == 2 ? h : 0;
+    for (const char* p = string; *p; p++) x += drawChar((uint8_t)*p, x, y);
+    return w;
+}
+
+// --- Pixel pushes ----------------------------------------------------------------
+
+void TFT_eSPI::writeClipped(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, bool swapped) {
+    int32_t cx = x, cy = y, cw = w, ch = h;
+    if (!clip(cx, cy, cw, ch)) return;
+    int32_t dx = cx - (x + _xDatum), dy = cy - (y + _yDatum);
+    if (cw == w) {
+        writePixels(cx, cy, cw, ch, data + dy * w, swapped);
+        return;
+    }
+    // Still one window: the visible columns, gathered
+    std::vector<uint16_t> block((size_t)cw * ch);
+    for (int32_t row = 0; row < ch; row++) memcpy(&block[row * cw], data + (dy + row) * w + dx, cw * sizeof(uint16_t));
+    writePixels(cx, cy, cw, ch, &block[0], swapped);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+    writeClipped(x, y, w, h, data, !swapBytes);
+}
+
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* buffer) {
+    (void)buffer;
+    pushImage(x, y, w, h, data);
+}
+
+// --- Sprites ---------------------------------------------------------------------
+
+TFT_eSprite::TFT_eSprite(TFT_eSPI* tft)
+    : TFT_eSPI(0, 0), _tft(tft), _img(nullptr), _created(false), _capacity(0),
+      _iwidth(0), _iheight(0), _dwidth(0), _dheight(0), _bitwidth(0), _sx(0), _sy(0), _sw(0), _sh(0) {}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+    (void)frames;
+    if (_created) return _img;
+    if (w < 1 || h < 1) return nullptr;
+    _img = (uint16_t*)calloc((size_t)w * h, sizeof(uint16_t));
+    if (!_img) return nullptr;
+    _created = true;
+    _capacity = w * h;
+    _iwidth = _dwidth = _bitwidth = w;
+    _iheight = _dheight = h;
+    _sx = _sy = 0;
+    _sw = w;
+    _sh = h;
+    cursorX = cursorY = 0;
+    setViewport(0, 0, w, h);
+    setPivot(w / 2, h / 2);
+    return _img;
+}
+
+void TFT_eSprite::deleteSprite() {
+    free(_img);
+    _img = nullptr;
+    _created = false;
+    _capacity = 0;
+}
+
+void TFT_eSprite::writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    uint16_t stored = swap16(color);
+    for (int32_t row = 0; row < h; row++) {
+        uint16_t* p = _img + (y + row) * _iwidth + x;
+        for (int32_t i = 0; i < w; i++) p[i] = stored;
+    }
+}
+
+void TFT_eSprite::writePixels(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, bool swapped) {
+    for (int32_t row = 0; row < h; row++) {
+        uint16_t* p = _img + (y + row) * _iwidth + x;
+        const uint16_t* q = data + row * w;
+        for (int32_t i = 0; i < w; i++) p[i] = swapped ? q[i] : swap16(q[i]);
+    }
+}
+
+uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y) const {
+    if (!_created || x < 0 || y < 0 || x >= _dwidth || y >= _dheight) return 0;
+    return swap16(_img[y * _iwidth + x]);
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+    if (!_created) return;
+    bool swap = _tft->getSwapBytes();
+    _tft->setSwapBytes(false);
+    _tft->pushImage(x, y, _dwidth, _dheight, _img);
+    _tft->setSwapBytes(swap);
+}
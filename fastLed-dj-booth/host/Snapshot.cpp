@@ -0,0 +1,115 @@
+#include "Snapshot.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// 5 and 6 bit channels widened to 8 with the top bits repeated, so white
+// stays 255
+static void toRgb888(uint16_t c, uint8_t* out) {
+    uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+bool writeImage(const char* path, const uint16_t* pixels, int width, int height) {
+    size_t length = strlen(path);
+    if (length >= 4 && strcmp(path + length - 4, ".ppm") == 0) return writePpm(path, pixels, width, height);
+    return writePng(path, pixels, width, height);
+}
+
+bool writePpm(const char* path, const uint16_t* pixels, int width, int height) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(width * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) toRgb888(pixels[y * width + x], &row[x * 3]);
+        fwrite(&row[0], 1, row.size(), f);
+    }
+    return fclose(f) == 0;
+}
+
+// --- PNG -----------------------------------------------------------------------
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBe32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+static void putChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& body) {
+    putBe32(out, (uint32_t)body.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), body.begin(), body.end());
+    putBe32(out, crc32(0, &out[start], out.size() - start));
+}
+
+bool writePng(const char* path, const uint16_t* pixels, int width, int height) {
+    // Scanlines: filter type 0, then RGB
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)height * (1 + width * 3));
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        for (int x = 0; x < width; x++) {
+            uint8_t rgb[3];
+            toRgb888(pixels[y * width + x], rgb);
+            raw.insert(raw.end(), rgb, rgb + 3);
+        }
+    }
+
+    // zlib stream of stored deflate blocks
+    std::vector<uint8_t> z;
+    z.push_back(0x78);
+    z.push_back(0x01);
+    size_t pos = 0;
+    do {
+        size_t n = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+        z.push_back(pos + n == raw.size() ? 1 : 0);
+        z.push_back(n & 0xFF);
+        z.push_back(n >> 8);
+        z.push_back(~n & 0xFF);
+        z.push_back((~n >> 8) & 0xFF);
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+        pos += n;
+    } while (pos < raw.size());
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBe32(z, (b << 16) | a);
+
+    std::vector<uint8_t> header;
+    putBe32(header, width);
+    putBe32(header, height);
+    const uint8_t format[] = { 8, 2, 0, 0, 0 };  // 8-bit RGB, no interlace
+    header.insert(header.end(), format, format + sizeof(format));
+
+    static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<uint8_t> out(signature, signature + sizeof(signature));
+    putChunk(out, "IHDR", header);
+    putChunk(out, "IDAT", z);
+    putChunk(out, "IEND", std::vector<uint8_t>());
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(&out[0], 1, out.size(), f) == out.size();
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,11 @@
+// Snapshot.h
+// RGB565 pictures to image files, for dashboard snapshots
+#pragma once
+
+#include <stdint.h>
+
+// Native-order RGB565, row by row. Picks the format from the extension:
+// .png (uncompressed deflate, so no zlib needed) or .ppm (binary P6).
+bool writeImage(const char* path, const uint16_t* pixels, int width, int height);
+bool writePpm(const char* path, const uint16_t* pixels, int width, int height);
+bool writePng(const char* path, const uint16_t* pixels, int width, int height);
@@ -0,0 +1,411 @@
+// booth_host.cpp
+// The booth's frame loop on Linux: the device's own analysis, controller,
+// animation and dashboard code over the host HAL (HostHal.h) and shims
+// (shim/), for profiling and debugging with desktop tools. The FrameClock is
+// frozen and stepped a frame at a time, so a run is reproducible; stage
+// times are measured on the host clock. The dashboard is drawn into the
+// host panel's framebuffer, which can be saved as PNG or PPM snapshots.
+//
+//   booth_host                          # 600 frames of a synthesized 128 BPM beat;
+//                                       # exit 1 if it never locks or a frame
+//                                       # allocates (MemoryMonitor.h) or the strobe
+//                                       # stops alternating at 120 or 128 BPM
+//   booth_host --wav set.wav --frames 4800
+//   booth_host --golden                 # the golden-frame self test; exit 1 on mismatch
+//   booth_host --snapshot dash.png      # the dashboard after the last frame
+//   booth_host --snapshot-every 8 --snapshot out/dash_%04d.ppm
+//   booth_host --press auto@2000 --press auto@2470 --press auto@2940 --press auto@3410
+//   booth_host --midi 126               # a MIDI clock against the 128 BPM beat
+//   booth_host --replay show.ggfr       # a recorded show (RECORD_FEATURES), to its end
+//
+// Options:
+//   --frames N      frames to run (default 600, or all of a --replay)
+//   --frame-ms MS   clock step per frame; match the device loop (default 125)
+//   --wav FILE      audio from a WAV file instead of the synthesized beat
+//   --bpm BPM       tempo of the synthesized beat (default 128)
+//   --seed N        FastLED random seed (default 1337)
+//   --set NAME=VAL  tuning parameter (TuningParams.h)
+//   --no-display    skip the dashboard
+//   --snapshot FILE save the dashboard (.png or .ppm) after the last frame,
+//                   or with --snapshot-every, every N frames to FILE
+//                   formatted with the frame number
+//   --press B@MS[+HOLD]  press button B (BUTTON_TABLE) MS into the run, for
+//                   HOLD ms (default 80); repeat for more presses
+//   --midi BPM      a MIDI clock at this tempo into TempoTracker, from a
+//                   Start at the beginning of the run
+//   --replay FILE   features, clock, RNG seeds and (with
+//                   PLAYBACK_FOLLOW_DECISIONS) animation switches from a
+//                   recording, in place of audio, tempo and buttons
+//   --golden        run runGoldenSelfTest() and exit
+//
+// Build: cmake -S host -B build && cmake --build build
+#include "HostHal.h"
+#include "ButtonInput.h"
+#include "AudioProcessor.h"
+#include "DisplayManager.h"
+#include "FeatureRecorder.h"
+#include "FrameClock.h"
+#include "FrameProfiler.h"
+#include "GoldenFrames.h"
+#include "HybridController.h"
+#include "MemoryMonitor.h"
+#include "MidiClock.h"
+#include "Modulation.h"
+#include "PaletteManager.h"
+#include "QualityGovernor.h"
+#include "SpatialMap.h"
+#include "TempoTracker.h"
+#include "TuningParams.h"
+#include "config.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <vector>
+
+#define HOST_CLOCK_START 10000
+// A synthesized beat this long has to give onsets and lock the beat grid
+#define HOST_LOCK_CHECK_MS 10000
+// Frames after these may not touch the heap; the first ones set up stdio
+// and first-use statics
+#define HOST_ALLOC_WARMUP_FRAMES 8
+// The strobe is checked for this many frames at each of these tempos
+#define HOST_STROBE_CHECK_FRAMES 64
+static const float strobeCheckBpms[] = { 120, 128 };
+
+alignas(4) static CRGB leds[NUM_LEDS];
+
+static const FrameStage timedStages[] = {
+    FrameStage::Capture, FrameStage::Analyze, FrameStage::Update, FrameStage::Display, FrameStage::Show
+};
+
+struct ButtonPress {
+    int button;
+    unsigned long atMs;
+    unsigned long holdMs;
+};
+
+struct Options {
+    int frames = 0;
+    int frameMs = 125;
+    const char* wav = nullptr;
+    const char* replay = nullptr;
+    float bpm = 128;
+    float midiBpm = 0;
+    unsigned seed = 1337;
+    bool display = true;
+    bool golden = false;
+    const char* snapshot = nullptr;
+    int snapshotEvery = 0;
+    std::vector<ButtonPress> presses;
+};
+
+static bool parsePress(const char* arg, ButtonPress& press) {
+    const char* at = strchr(arg, '@');
+    if (!at) return false;
+    press.button = -1;
+    for (int b = 0; b < BUTTON_COUNT; b++) {
+        const char* name = buttonName((ButtonId)b);
+        if (strlen(name) == (size_t)(at - arg) && strncasecmp(arg, name, at - arg) == 0) press.button = b;
+    }
+    char* end;
+    press.atMs = strtoul(at + 1, &end, 10);
+    press.holdMs = *end == '+' ? strtoul(end + 1, &end, 10) : 80;
+    return press.button >= 0 && *end == '\0' && end != at + 1;
+}
+
+// Feeds ButtonInput the levels the scripted presses give, one sample
+// period at a time, up to `until` ms into the run
+static void sampleButtons(const Options& opt, unsigned long& sampledUs, unsigned long until) {
+    for (; sampledUs < until * 1000; sampledUs += BUTTON_SAMPLE_US) {
+        unsigned long ms = sampledUs / 1000;
+        for (int b = 0; b < BUTTON_COUNT; b++) {
+            bool down = false;
+            for (const ButtonPress& p : opt.presses) down |= p.button == b && ms >= p.atMs && ms < p.atMs + p.holdMs;
+            ButtonInput::sample(b, down, HOST_CLOCK_START + ms);
+        }
+    }
+}
+
+static bool saveSnapshot(const CountingTFT& tft, const char* pattern, int frame) {
+    char path[512];
+    snprintf(path, sizeof(path), pattern, frame);
+    if (tft.saveSnapshot(path)) return true;
+    fprintf(stderr, "can't write %s\n", path);
+    return false;
+}
+
+// FNV-1a over the framebuffer
+static uint32_t hashPanel(const CountingTFT& tft, int width, int height) {
+    const uint16_t* pixels = tft.getFramebuffer();
+    uint32_t h = 2166136261u;
+    for (int i = 0; pixels && i < width * height; i++) {
+        h = (h ^ (pixels[i] & 0xFF)) * 16777619u;
+        h = (h ^ (pixels[i] >> 8)) * 16777619u;
+    }
+    return h;
+}
+
+// The strobe matrix with the grid locked at `bpm`, a frame every `frameMs`:
+// it has to flip on every frame a subdivision passed in, so it is never
+// on or off for longer than a subdivision. Returns the longest run of
+// frames on or off past that limit, 0 when it alternates as it should.
+static int checkStrobe(float bpm, bool heavyBass, int frameMs) {
+    AudioFeatures features;
+    features.bpm = bpm;
+    features.bass = heavyBass ? 0.8 : 0.2;
+    features.gridLocked = true;
+    float subdivisionMs = (heavyBass ? 0.125f : 0.25f) * 60000.0f / bpm;
+    int limit = std::max(1, (int)ceilf(subdivisionMs / frameMs));
+    Modulation::reset();
+    bool lastLit = false;
+    int run = 0, longest = 0;
+    for (int frame = 0; frame < HOST_STROBE_CHECK_FRAMES; frame++) {
+        double beats = frame * (double)frameMs * bpm / 60000.0;
+        features.beatIndex = (uint32_t)beats;
+        features.beatPhase = (float)(beats - features.beatIndex);
+        Modulation::update(features);
+        strobeMatrixAnimation(leds, NUM_LEDS, features);
+        bool lit = false;
+        for (int i = 0; i < NUM_LEDS; i++) lit |= leds[i].r || leds[i].g || leds[i].b;
+        run = frame > 0 && lit == lastLit ? run + 1 : 1;
+        lastLit = lit;
+        longest = std::max(longest, run);
+    }
+    Modulation::reset();
+    return longest > limit ? longest : 0;
+}
+
+static bool setTuningValue(const char* arg) {
+    const char* eq = strchr(arg, '=');
+    if (!eq) return false;
+    char name[32];
+    size_t length = eq - arg;
+    if (length >= sizeof(name)) return false;
+    memcpy(name, arg, length);
+    name[length] = '\0';
+    const TuningDef* def = findTuning(name);
+    if (!def) return false;
+    setTuning(*def, (float)atof(eq + 1));
+    return true;
+}
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && hasValue) opt.frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frame-ms") == 0 && hasValue) opt.frameMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--wav") == 0 && hasValue) opt.wav = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && hasValue) opt.replay = argv[++i];
+        else if (strcmp(argv[i], "--bpm") == 0 && hasValue) opt.bpm = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) opt.seed = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--midi") == 0 && hasValue) opt.midiBpm = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--no-display") == 0) opt.display = false;
+        else if (strcmp(argv[i], "--golden") == 0) opt.golden = true;
+        else if (strcmp(argv[i], "--press") == 0 && hasValue) {
+            ButtonPress press;
+            if (!parsePress(argv[++i], press)) {
+                fprintf(stderr, "bad --press %s (button@ms or button@ms+holdms)\n", argv[i]);
+                return false;
+            }
+            opt.presses.push_back(press);
+        }
+        else if (strcmp(argv[i], "--snapshot") == 0 && hasValue) opt.snapshot = argv[++i];
+        else if (strcmp(argv[i], "--snapshot-every") == 0 && hasValue) opt.snapshotEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--set") == 0 && hasValue) {
+            if (!setTuningValue(argv[++i])) {
+                fprintf(stderr, "bad --set %s (name=value)\n", argv[i]);
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    if (opt.frames == 0) opt.frames = opt.replay ? INT_MAX : 600;
+    if (opt.frames <= 0 || opt.frameMs <= 0 || opt.bpm <= 0 || opt.midiBpm < 0 || opt.snapshotEvery < 0) {
+        fprintf(stderr, "--frames, --frame-ms, --bpm and --midi must be positive\n");
+        return false;
+    }
+    if (opt.snapshotEvery > 0 && (!opt.snapshot || !strchr(opt.snapshot, '%'))) {
+        fprintf(stderr, "--snapshot-every needs a --snapshot pattern such as dash_%%04d.png\n");
+        return false;
+    }
+    if (opt.replay && (opt.wav || opt.midiBpm > 0 || !opt.presses.empty())) {
+        fprintf(stderr, "--replay takes the place of --wav, --midi and --press\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        fprintf(stderr, "usage: %s [--frames N] [--frame-ms MS] [--wav file.wav] [--bpm BPM] [--seed N] "
+                        "[--set name=value] [--press button@ms[+hold]] [--midi BPM] [--replay file] [--no-display] [--golden] [--snapshot file] "
+                        "[--snapshot-every N]\n", argv[0]);
+        return 2;
+    }
+
+    SyntheticAudioSource beat(opt.bpm);
+    WavAudioSource wav(opt.wav ? opt.wav : "");
+    AudioSource& source = opt.wav ? (AudioSource&)wav : (AudioSource&)beat;
+    StatsLedSink sink;
+    AudioProcessor audioProcessor(source);
+    CountingTFT tft;
+    DisplayManager displayManager(tft);
+    HybridController hybridController;
+    TempoTracker tempoTracker;
+    MidiClock midiClock;
+    FrameProfiler profiler;
+    FeaturePlayer player;
+
+    // setup(), minus the hardware
+    FrameClock::freeze(HOST_CLOCK_START);
+    random16_set_seed((uint16_t)opt.seed);
+    randomSeed(opt.seed);
+    SpatialMap::build();
+    tft.init();
+    tft.setRotation(1);
+    displayManager.begin();
+    audioProcessor.begin();
+    if (opt.wav && !wav.isLoaded()) return 1;
+    PaletteManager::set(tuning.palette);
+    ButtonInput::begin();
+
+    MemoryMonitor::begin();
+    if (opt.golden) return runGoldenSelfTest(audioProcessor) ? 0 : 1;
+
+    hybridController.setAnimations(animations, ANIMATION_COUNT);
+    tempoTracker.addSource(hybridController.getTapTempo());
+    tempoTracker.addSource(midiClock);
+    if (opt.replay) {
+        if (!player.begin(opt.replay)) return 1;
+        hybridController.setExternalControl(PLAYBACK_FOLLOW_DECISIONS);
+    }
+    if (opt.midiBpm > 0) midiClock.feed(MidiClock::START, HOST_CLOCK_START);
+    double midiTicks = 0;
+    if (opt.display) displayManager.showStartupScreen();
+
+    uint64_t stageTotal[TELEMETRY_STAGE_COUNT] = {};
+    uint32_t stageWorst[TELEMETRY_STAGE_COUNT] = {};
+    uint64_t panelCommands = 0, panelPixels = 0;
+    uint32_t peakCommands = 0, peakPixels = 0;
+    unsigned long sampledUs = 0;
+    int onsets = 0, gridLockedFrames = 0, audioLedFrames = 0;
+    int frames = 0, allocatingFrames = 0;
+    uint32_t worstAllocs = 0;
+    for (int frame = 0; frame < opt.frames; frame++) {
+        profiler.beginFrame();
+        MemoryMonitor::beginFrame();
+        AudioFeatures features;
+        if (opt.replay) {
+            // The recording's clock and seed, as the device's playback sets them
+            if (!player.next(features)) break;
+            if (player.hasEvent()) {
+                const RecordedEvent& event = player.getEvent();
+                if (hybridController.isExternalControl()) hybridController.showAnimation(event.to, event.reason);
+            }
+        } else {
+            sampleButtons(opt, sampledUs, FrameClock::now() - HOST_CLOCK_START);
+            hybridController.pollInput();
+            audioProcessor.captureAudio();
+            profiler.mark(FrameStage::Capture);
+            features = audioProcessor.analyzeAudio();
+            // The clock bytes that arrived during the frame, on time
+            for (; opt.midiBpm > 0 && midiTicks * 60000.0 / (opt.midiBpm * MidiClock::CLOCKS_PER_BEAT) <= FrameClock::now() - HOST_CLOCK_START; midiTicks++) {
+                midiClock.feed(MidiClock::CLOCK, HOST_CLOCK_START + (uint32_t)(midiTicks * 60000.0 / (opt.midiBpm * MidiClock::CLOCKS_PER_BEAT)));
+            }
+            tempoTracker.update(features, FrameClock::now());
+        }
+        onsets += features.beatDetected;
+        gridLockedFrames += features.gridLocked;
+        const char* led = tempoTracker.getLeader();
+        audioLedFrames += led && strcmp(led, "Audio") == 0;
+        profiler.mark(FrameStage::Analyze);
+
+        PaletteManager::update();
+        Modulation::update(features);
+        hybridController.update(leds, NUM_LEDS, features);
+        profiler.mark(FrameStage::Update);
+
+        bool drawDisplay = opt.display && QualityGovernor::drawDisplay(profiler.getFrame());
+        uint8_t dither = QualityGovernor::ditherEnabled() ? BINARY_DITHER : DISABLE_DITHER;
+        tft.resetPanelStats();
+        if (drawDisplay) {
+            DashboardStatus status = DisplayManager::captureStatus(&hybridController);
+            status.playback = opt.replay != nullptr;
+            displayManager.updateAudioVisualization(features, status);
+        }
+        profiler.mark(FrameStage::Display);
+        const CountingTFT::PanelStats& panel = tft.getPanelStats();
+        panelCommands += panel.commands;
+        panelPixels += panel.pixels;
+        peakCommands = std::max(peakCommands, panel.commands);
+        peakPixels = std::max(peakPixels, panel.pixels);
+        sink.show(leds, NUM_LEDS, tuning.brightness, dither);
+        profiler.mark(FrameStage::Show);
+        profiler.endFrame();
+        MemoryMonitor::endFrame();
+        if (frame >= HOST_ALLOC_WARMUP_FRAMES && MemoryMonitor::getLastFrameAllocs() > 0) {
+            allocatingFrames++;
+            worstAllocs = std::max(worstAllocs, MemoryMonitor::getLastFrameAllocs());
+        }
+        if (opt.snapshotEvery > 0 && frame % opt.snapshotEvery == 0 && !saveSnapshot(tft, opt.snapshot, frame)) return 1;
+        QualityGovernor::update(profiler);
+
+        for (FrameStage stage : timedStages) {
+            uint32_t us = profiler.get(stage);
+            stageTotal[(int)stage] += us;
+            if (us > stageWorst[(int)stage]) stageWorst[(int)stage] = us;
+        }
+        FrameClock::advance(opt.frameMs);
+        frames++;
+    }
+
+    if (opt.replay) Serial.printf("[Host] %d frames of %s\n", frames, opt.replay);
+    else Serial.printf("[Host] %d frames of %d ms, %s\n", frames, opt.frameMs, opt.wav ? opt.wav : "synthesized beat");
+    int averaged = std::max(frames, 1);
+    for (FrameStage stage : timedStages) {
+        Serial.printf("[Host] %-8s %8.1f us avg %8lu us worst\n", FrameProfiler::name(stage),
+                      (double)stageTotal[(int)stage] / averaged, (unsigned long)stageWorst[(int)stage]);
+    }
+    if (opt.display) {
+        displayManager.report();
+        Serial.printf("[Host] panel: %.1f windows, %.0f pixels a frame (peak %lu, %lu), picture hash %08x\n",
+                      (double)panelCommands / averaged, (double)panelPixels / averaged, (unsigned long)peakCommands,
+                      (unsigned long)peakPixels, (unsigned)hashPanel(tft, tft.width(), tft.height()));
+    }
+    const char* leader = tempoTracker.getLeader();
+    Serial.printf("[Host] tempo %.1f BPM from %s, confidence %.2f\n", tempoTracker.getBpm(),
+                  leader ? leader : "nothing", tempoTracker.getConfidence());
+    Serial.printf("[Host] %d onsets, beat grid locked %d frames, audio led the tempo %d frames\n", onsets,
+                  gridLockedFrames, audioLedFrames);
+    if (opt.snapshot && opt.snapshotEvery == 0 && !saveSnapshot(tft, opt.snapshot, frames)) return 1;
+    Serial.printf("[Host] %lu frames shown, average level %.1f, hash %08x\n", sink.getFrames(),
+                  sink.getAverageLevel(), (unsigned)sink.getHash());
+    MemoryStats memory = MemoryMonitor::sample();
+    if (memory.hooks) {
+        Serial.printf("[Host] %d frames allocated after the first %d, at most %lu allocs\n", allocatingFrames,
+                      HOST_ALLOC_WARMUP_FRAMES, (unsigned long)worstAllocs);
+    }
+    if (allocatingFrames > 0) {
+        Serial.printf("[Host] FAIL: the frame loop allocates\n");
+        return 1;
+    }
+    for (float bpm : strobeCheckBpms) {
+        for (bool heavyBass : { false, true }) {
+            int stuck = checkStrobe(bpm, heavyBass, opt.frameMs);
+            if (stuck) {
+                Serial.printf("[Host] FAIL: the strobe stays %d frames on or off at %.0f BPM with %s bass\n", stuck,
+                              bpm, heavyBass ? "heavy" : "light");
+                return 1;
+            }
+        }
+    }
+    if (!opt.wav && !opt.replay && (long)frames * opt.frameMs >= HOST_LOCK_CHECK_MS && (onsets == 0 || gridLockedFrames == 0)) {
+        Serial.printf("[Host] FAIL: the synthesized beat never locked\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+// FastLED.h (host)
+// The FastLED types and math the animations use, for Linux, with FastLED's
+// results (FASTLED_SCALE8_FIXED, FASTLED_BLEND_FIXED): the same random8()
+// sequence, CHSV conversion and blur1d(), so a frame rendered here is the
+// frame the strip would show. No controllers; LEDs go out through a LedSink.
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t fract8;
+
+#define DISABLE_DITHER 0x00
+#define BINARY_DITHER 0x01
+
+// --- 8-bit math ------------------------------------------------------------------
+
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+    unsigned t = i + j;
+    return t > 255 ? 255 : (uint8_t)t;
+}
+
+inline uint8_t qsub8(uint8_t i, uint8_t j) {
+    return i > j ? (uint8_t)(i - j) : 0;
+}
+
+inline uint8_t scale8(uint8_t i, fract8 scale) {
+    return (uint8_t)((i * (1 + (unsigned)scale)) >> 8);
+}
+
+inline uint8_t scale8_video(uint8_t i, fract8 scale) {
+    return (uint8_t)(((i * (unsigned)scale) >> 8) + ((i && scale) ? 1 : 0));
+}
+
+inline uint8_t dim8_video(uint8_t x) {
+    return scale8_video(x, x);
+}
+
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+    uint16_t partial = (uint16_t)((a << 8) | b);
+    partial -= a * amountOfB;
+    partial += b * amountOfB;
+    return (uint8_t)(partial >> 8);
+}
+
+uint8_t sin8(uint8_t theta);
+
+// --- Random numbers --------------------------------------------------------------
+
+extern uint16_t rand16seed;
+
+inline uint8_t random8() {
+    rand16seed = (uint16_t)(rand16seed * 2053 + 13849);
+    return (uint8_t)((rand16seed & 0xFF) + (rand16seed >> 8));
+}
+inline uint8_t random8(uint8_t lim) {
+    return (uint8_t)((random8() * lim) >> 8);
+}
+inline uint8_t random8(uint8_t min, uint8_t lim) {
+    return (uint8_t)(random8((uint8_t)(lim - min)) + min);
+}
+inline uint16_t random16() {
+    rand16seed = (uint16_t)(rand16seed * 2053 + 13849);
+    return rand16seed;
+}
+inline uint16_t random16(uint16_t lim) {
+    return (uint16_t)(((uint32_t)random16() * lim) >> 16);
+}
+inline uint16_t random16(uint16_t min, uint16_t lim) {
+    return (uint16_t)(random16((uint16_t)(lim - min)) + min);
+}
+inline void random16_set_seed(uint16_t seed) { rand16seed = seed; }
+inline uint16_t random16_get_seed() { return rand16seed; }
+inline void random16_add_entropy(uint16_t entropy) { rand16seed += entropy; }
+
+// --- Colours ---------------------------------------------------------------------
+
+struct CHSV {
+    union {
+        struct {
+            union { uint8_t hue; uint8_t h; };
+            union { uint8_t sat; uint8_t s; };
+            union { uint8_t val; uint8_t v; };
+        };
+        uint8_t raw[3];
+    };
+    CHSV() : h(0), s(0), v(0) {}
+    CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb);
+
+struct CRGB {
+    union {
+        struct {
+            union { uint8_t r; uint8_t red; };
+            union { uint8_t g; uint8_t green; };
+            union { uint8_t b; uint8_t blue; };
+        };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode {
+        Black = 0x000000,
+        White = 0xFFFFFF,
+        Red = 0xFF0000,
+        Green = 0x008000,
+        Blue = 0x0000FF,
+    };
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+    CRGB(const CHSV& hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+    CRGB& operator=(const CHSV& hsv) {
+        hsv2rgb_rainbow(hsv, *this);
+        return *this;
+    }
+
+    uint8_t& operator[](uint8_t x) { return raw[x]; }
+    const uint8_t& operator[](uint8_t x) const { return raw[x]; }
+
+    CRGB& operator+=(const CRGB& rhs) {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+    CRGB& operator-=(const CRGB& rhs) {
+        r = qsub8(r, rhs.r);
+        g = qsub8(g, rhs.g);
+        b = qsub8(b, rhs.b);
+        return *this;
+    }
+    CRGB& nscale8(uint8_t scale) {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+    CRGB& fadeToBlackBy(uint8_t fadeFactor) { return nscale8(255 - fadeFactor); }
+
+    bool operator==(const CRGB& rhs) const { return r == rhs.r && g == rhs.g && b == rhs.b; }
+    bool operator!=(const CRGB& rhs) const { return !(*this == rhs); }
+};
+
+inline CRGB operator+(const CRGB& a, const CRGB& b) {
+    CRGB c = a;
+    return c += b;
+}
+
+CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay);
+CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amountOfP2);
+
+void fill_solid(CRGB* leds, int numToFill, const CRGB& color);
+void fill_rainbow(CRGB* leds, int numToFill, uint8_t initialHue, uint8_t deltaHue = 5);
+void blur1d(CRGB* leds, uint16_t numLeds, fract8 blurAmount);
+void fadeToBlackBy(CRGB* leds, uint16_t numLeds, uint8_t fadeBy);
@@ -0,0 +1,32 @@
+// LittleFS.h (host)
+// The LittleFS calls FeatureRecorder makes, for Linux: the "flash" is the
+// host's filesystem and a path is a host path, so booth_host --replay reads
+// a recording copied off the device where it lies.
+#pragma once
+
+#include <Arduino.h>
+
+// A handle, copied like the core's; close() once
+class File {
+public:
+    File(FILE* handle = nullptr) : handle(handle) {}
+
+    size_t read(uint8_t* buffer, size_t size) { return handle ? fread(buffer, 1, size, handle) : 0; }
+    size_t write(const uint8_t* buffer, size_t size) { return handle ? fwrite(buffer, 1, size, handle) : 0; }
+    void close() {
+        if (handle) fclose(handle);
+        handle = nullptr;
+    }
+    explicit operator bool() const { return handle != nullptr; }
+
+private:
+    FILE* handle;
+};
+
+class HostFS {
+public:
+    bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+    File open(const char* path, const char* mode) { return File(fopen(path, mode[0] == 'w' ? "wb" : "rb")); }
+};
+
+extern HostFS LittleFS;
@@ -0,0 +1,177 @@
+// TFT_eSPI.h (host)
+// The TFT_eSPI drawing calls the dashboard makes, for Linux. host/HostTft.cpp
+// implements them; sprites (and WidgetCanvas's bands) keep their pixels
+// as on the device, RGB565 with the bytes swapped for the panel.
+//
+// The panel is an RGB565 framebuffer from init() on. Each write that
+// reaches it -- one address window and its pixels on the device -- is
+// counted, and the picture can be saved as a PNG or PPM.
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// The panel before rotation; the booth's is a 135 x 240 ST7789
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 135
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 240
+#endif
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+#define TFT_PINK 0xFE19
+#define TFT_SILVER 0xC618
+
+// Text datums
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+class TFT_eSPI : public Print {
+public:
+    TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+    virtual ~TFT_eSPI() {}
+
+    void init();
+    void setRotation(uint8_t r);
+    uint8_t getRotation() const { return rotation; }
+    virtual int16_t width() { return _width; }
+    virtual int16_t height() { return _height; }
+
+    virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+    virtual void drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size);
+    virtual int16_t drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font);
+    virtual int16_t drawChar(uint16_t uniCode, int32_t x, int32_t y);
+    virtual void drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color);
+    virtual void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    virtual void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+
+    void fillScreen(uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color);
+
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void setTextColor(uint16_t color) { textColor = textBgColor = color; }
+    void setTextColor(uint16_t fg, uint16_t bg) { textColor = fg; textBgColor = bg; }
+    void setTextSize(uint8_t size) { textSize = size > 0 ? size : 1; }
+    void setTextDatum(uint8_t datum) { textDatum = datum; }
+    void setTextWrap(bool wrapX) { textWrap = wrapX; }
+    int16_t textWidth(const char* string);
+    int16_t fontHeight();
+    int16_t drawString(const char* string, int32_t x, int32_t y);
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true);
+    void setPivot(int16_t x, int16_t y) { xPivot = x; yPivot = y; }
+    void setSwapBytes(bool swap) { swapBytes = swap; }
+    bool getSwapBytes() const { return swapBytes; }
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+        return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+    }
+
+    // Pixel pushes: RGB565, byte-swapped unless swapBytes is on
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* buffer = nullptr);
+    bool initDMA(bool ctrlCs = false) { (void)ctrlCs; return true; }
+    void startWrite() {}
+    void endWrite() {}
+    bool dmaBusy() { return false; }
+    void dmaWait() {}
+
+    // Host only: windows written and pixels sent since resetPanelStats()
+    struct PanelStats {
+        uint32_t commands;
+        uint32_t pixels;
+    };
+    const PanelStats& getPanelStats() const { return stats; }
+    void resetPanelStats() { stats = PanelStats{ 0, 0 }; }
+    // Host only: the framebuffer, RGB565 row by row in the current rotation
+    const uint16_t* getFramebuffer() const { return frame.empty() ? nullptr : &frame[0]; }
+    uint16_t readPanelPixel(int32_t x, int32_t y) const;
+    // Host only: writes the framebuffer to a .png or .ppm file
+    bool saveSnapshot(const char* path) const;
+
+protected:
+    int32_t _init_width, _init_height;
+    int32_t _width, _height;
+    uint8_t rotation;
+    // Drawing is clipped to the viewport; coordinates are relative to it
+    int32_t _vpX, _vpY, _vpW, _vpH;
+    int32_t _xDatum, _yDatum;
+    int16_t cursorX, cursorY;
+    uint16_t textColor, textBgColor;
+    uint8_t textSize;
+    uint8_t textDatum;
+    bool textWrap;
+    bool swapBytes;
+    int16_t xPivot, yPivot;
+    std::vector<uint16_t> frame;
+    PanelStats stats;
+
+    // The visible part of a rectangle, in surface coordinates; false if none
+    bool clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const;
+    // A w x h block of pixels, clipped
+    void writeClipped(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, bool swapped);
+    // Where every primitive ends up: a clipped rectangle of one colour, or
+    // of pixels. The panel's go to the framebuffer and the counters.
+    virtual void writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    virtual void writePixels(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, bool swapped);
+};
+
+// An off-screen RGB565 surface with the same drawing calls. Pixels are kept
+// byte-swapped, ready for the panel, as TFT_eSPI does.
+class TFT_eSprite : public TFT_eSPI {
+public:
+    explicit TFT_eSprite(TFT_eSPI* tft);
+    ~TFT_eSprite() override { deleteSprite(); }
+
+    void* createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+    void deleteSprite();
+    bool created() const { return _created; }
+    void setColorDepth(int8_t bits) { (void)bits; }
+    void* getPointer() { return _img; }
+    int16_t width() override { return _dwidth; }
+    int16_t height() override { return _dheight; }
+
+    void fillSprite(uint32_t color) { fillRect(0, 0, _dwidth, _dheight, color); }
+    void pushSprite(int32_t x, int32_t y);
+    uint16_t readPixel(int32_t x, int32_t y) const;
+
+protected:
+    void writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override;
+    void writePixels(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, bool swapped) override;
+
+    TFT_eSPI* _tft;
+    uint16_t* _img;
+    bool _created;
+    int32_t _capacity;
+    int32_t _iwidth, _iheight;
+    int32_t _dwidth, _dheight;
+    int32_t _bitwidth;
+    int32_t _sx, _sy;
+    uint32_t _sw, _sh;
+};
@@ -0,0 +1,75 @@
+// arduinoFFT.h (host)
+// ArduinoFFT's interface over a plain radix-2 FFT, for Linux: the Hamming
+// window, forward transform and magnitudes AudioProcessor asks for (the
+// same steps tools/cue_analyzer takes). Results agree with the library to
+// rounding.
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <utility>
+
+enum class FFTDirection { Forward, Reverse };
+enum class FFTWindow { Rectangle, Hamming };
+
+#define FFT_FORWARD FFTDirection::Forward
+#define FFT_REVERSE FFTDirection::Reverse
+#define FFT_WIN_TYP_RECTANGLE FFTWindow::Rectangle
+#define FFT_WIN_TYP_HAMMING FFTWindow::Hamming
+
+template <typename T>
+class ArduinoFFT {
+public:
+    ArduinoFFT(T* vReal, T* vImag, uint_fast16_t samples, T samplingFrequency)
+        : vReal(vReal), vImag(vImag), samples(samples), samplingFrequency(samplingFrequency) {}
+
+    void windowing(FFTWindow type, FFTDirection dir) {
+        if (type != FFTWindow::Hamming) return;
+        for (uint_fast16_t i = 0; i < samples; i++) {
+            T w = 0.54 - 0.46 * cos(2.0 * M_PI * i / (samples - 1));
+            vReal[i] = dir == FFTDirection::Forward ? vReal[i] * w : vReal[i] / w;
+        }
+    }
+
+    void compute(FFTDirection dir) {
+        for (uint_fast16_t i = 1, j = 0; i < samples; i++) {
+            uint_fast16_t bit = samples >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) {
+                std::swap(vReal[i], vReal[j]);
+                std::swap(vImag[i], vImag[j]);
+            }
+        }
+        T sign = dir == FFTDirection::Forward ? -1.0 : 1.0;
+        for (uint_fast16_t len = 2; len <= samples; len <<= 1) {
+            T angle = sign * 2.0 * M_PI / len;
+            T stepRe = cos(angle), stepIm = sin(angle);
+            for (uint_fast16_t i = 0; i < samples; i += len) {
+                T wRe = 1.0, wIm = 0.0;
+                for (uint_fast16_t k = 0; k < len / 2; k++) {
+                    uint_fast16_t a = i + k, b = i + k + len / 2;
+                    T bRe = vReal[b] * wRe - vImag[b] * wIm;
+                    T bIm = vReal[b] * wIm + vImag[b] * wRe;
+                    vReal[b] = vReal[a] - bRe;
+                    vImag[b] = vImag[a] - bIm;
+                    vReal[a] += bRe;
+                    vImag[a] += bIm;
+                    T nextRe = wRe * stepRe - wIm * stepIm;
+                    wIm = wRe * stepIm + wIm * stepRe;
+                    wRe = nextRe;
+                }
+            }
+        }
+    }
+
+    void complexToMagnitude() {
+        for (uint_fast16_t i = 0; i < samples; i++) vReal[i] = sqrt(vReal[i] * vReal[i] + vImag[i] * vImag[i]);
+    }
+
+private:
+    T* vReal;
+    T* vImag;
+    uint_fast16_t samples;
+    T samplingFrequency;
+};
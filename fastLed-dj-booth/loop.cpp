@@ -1,11 +1,20 @@
 #include <Arduino.h>
-#include <TFT_eSPI.h>
-#include "VerticalBarWidget.h"
+#include "config.h"
+#include "FrameArena.h"
+#include "MemoryMonitor.h"
 
 // Helper functions that can be called from the main sketch
-void checkHeapMemory() {
-    Serial.printf("Free Heap: %d\n", ESP.getFreeHeap());
+
+// Prints MemoryMonitor's report: heap, fragmentation, per-frame allocation
+// peaks (these should stay 0 once the show is running) and stack headroom,
+// plus the frame arena's high-water mark
+void reportHeapUsage() {
+    char line[200];
+    MemoryMonitor::format(MemoryMonitor::report(), line, sizeof(line));
+    Serial.printf("[Memory] %s | frame arena peak %u/%u, overflows %u\n", line,
+                  (unsigned)FrameArena::getPeak(), (unsigned)FrameArena::getCapacity(),
+                  (unsigned)FrameArena::getOverflows());
 }
 
 // You can add other helper functions here as needed
-// These functions can be called from your main setup() or loop() in the .ino file
\ No newline at end of file
+// These functions can be called from your main setup() or loop() in the .ino file
@@ -0,0 +1,470 @@
+// cue_analyzer.cpp
+// Offline analysis of known tracks into cue timelines (CueTimeline.h) for the
+// device's timeline mode. Each WAV file is run through the device's own
+// FeatureExtractor and BeatGrid, at a higher FFT resolution, so beats are
+// numbered exactly as the live grid will number them. Files are analyzed in
+// parallel.
+//
+//   cue_analyzer track1.wav track2.wav            # writes track1.ggct, track2.ggct
+//   cue_analyzer -o out/ --fft 4096 *.wav
+//   cue_analyzer --map drop="Bass Bloom" --map breakdown="Galactic Drift" set/*.wav
+//
+// Options:
+//   -o DIR          output directory (default: next to the input)
+//   --fft N         FFT size, power of two (default 2048)
+//   --frame-ms MS   analysis interval; match the device loop (default 125)
+//   --jobs N        worker threads (default: hardware threads)
+//   --map KIND=NAME animation for sections of KIND (intro, groove, breakdown,
+//                   build-up, drop, outro); unmapped sections leave the pick
+//                   to the device, aimed at the section's energy
+//   --set NAME=VAL  tuning parameter (TuningParams.h), e.g. the venue's
+//                   beatThreshold, so beats are detected as they will be live
+//
+// Sections are found per phrase (tuning.phraseBars bars) from the phrase's
+// volume and bass before the gain control, relative to the loudest phrase of
+// the track.
+//
+// Build: g++ -std=c++11 -O2 -pthread -I.. -o cue_analyzer cue_analyzer.cpp ../FeatureExtractor.cpp ../BeatGrid.cpp ../AutoGain.cpp
+#include "../FeatureExtractor.h"
+#include "../CueTimeline.h"
+#include "../TuningParams.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The extractor reads its thresholds from here
+TuningParams tuning;
+
+static bool setTuningValue(const char* arg) {
+    const char* eq = strchr(arg, '=');
+    if (!eq) return false;
+    std::string name(arg, eq - arg);
+    float value = (float)atof(eq + 1);
+#define TUNING_SET(type, field, def, lo, hi, help) \
+    if (name == #field) { \
+        tuning.field = (TUNING_CTYPE_##type)std::min(std::max(value, (float)(lo)), (float)(hi)); \
+        return true; \
+    }
+    TUNING_TABLE(TUNING_SET)
+#undef TUNING_SET
+    return false;
+}
+
+struct Options {
+    std::string outDir;
+    int fftSize = 2048;
+    int frameMs = 125;
+    int jobs = 0;
+    std::string map[CUE_SECTION_KIND_COUNT];
+};
+
+struct FrameInfo {
+    unsigned long timeMs;
+    double volume;
+    double bass;
+    bool locked;
+    bool tick;
+    uint32_t beatIndex;
+    uint8_t beatInBar;
+    float periodMs;
+};
+
+static std::mutex printLock;
+
+// --- WAV ---------------------------------------------------------------------
+
+static uint32_t le32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t le16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+// Mono mix of a PCM 16/24/32-bit or float WAV, -1..1
+static bool readWav(const char* path, std::vector<float>& out, int& sampleRate, std::string& error) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { error = "cannot open"; return false; }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    const uint8_t* samples = nullptr;
+    size_t sampleBytes = 0;
+    for (size_t pos = 12; pos + 8 <= data.size();) {
+        uint32_t size = le32(&data[pos + 4]);
+        const uint8_t* body = &data[pos + 8];
+        size_t avail = std::min((size_t)size, data.size() - pos - 8);
+        if (memcmp(&data[pos], "fmt ", 4) == 0 && avail >= 16) {
+            format = le16(body);
+            channels = le16(body + 2);
+            sampleRate = le32(body + 4);
+            bits = le16(body + 14);
+            if (format == 0xFFFE && avail >= 26) format = le16(body + 24);  // WAVE_FORMAT_EXTENSIBLE
+        } else if (memcmp(&data[pos], "data", 4) == 0) {
+            samples = body;
+            sampleBytes = avail;
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+    bool flt = format == 3 && bits == 32;
+    if (!samples || channels < 1 || sampleRate <= 0 || (!pcm && !flt)) {
+        error = "unsupported WAV format (PCM 16/24/32-bit or 32-bit float)";
+        return false;
+    }
+
+    int bytes = bits / 8;
+    size_t frames = sampleBytes / (bytes * channels);
+    out.resize(frames);
+    for (size_t i = 0; i < frames; i++) {
+        float sum = 0;
+        for (int c = 0; c < channels; c++) {
+            const uint8_t* p = samples + (i * channels + c) * bytes;
+            float v;
+            if (flt) {
+                uint32_t u = le32(p);
+                memcpy(&v, &u, 4);
+            } else if (bits == 16) {
+                v = (int16_t)le16(p) / 32768.0f;
+            } else if (bits == 24) {
+                int32_t s = (p[0] << 8) | (p[1] << 16) | (p[2] << 24);
+                v = (s >> 8) / 8388608.0f;
+            } else {
+                v = (int32_t)le32(p) / 2147483648.0f;
+            }
+            sum += v;
+        }
+        out[i] = sum / channels;
+    }
+    return true;
+}
+
+// --- Spectrum ----------------------------------------------------------------
+
+// Hamming window, forward FFT and magnitudes, matching arduinoFFT's
+// windowing(FFT_WIN_TYP_HAMMING) + compute() + complexToMagnitude()
+static void magnitudeSpectrum(const double* samples, int n, std::vector<std::complex<double> >& work,
+                              double* magnitudes) {
+    for (int i = 0; i < n; i++) {
+        double w = 0.54 - 0.46 * cos(2.0 * M_PI * i / (n - 1));
+        work[i] = std::complex<double>(samples[i] * w, 0.0);
+    }
+
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(work[i], work[j]);
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        std::complex<double> step = std::polar(1.0, -2.0 * M_PI / len);
+        for (int i = 0; i < n; i += len) {
+            std::complex<double> w(1.0, 0.0);
+            for (int k = 0; k < len / 2; k++) {
+                std::complex<double> a = work[i + k];
+                std::complex<double> b = work[i + k + len / 2] * w;
+                work[i + k] = a + b;
+                work[i + k + len / 2] = a - b;
+                w *= step;
+            }
+        }
+    }
+
+    for (int i = 0; i < n / 2; i++) magnitudes[i] = std::abs(work[i]);
+}
+
+// --- Analysis ----------------------------------------------------------------
+
+static void analyzeFrames(const std::vector<float>& pcm, int sampleRate, const Options& opt,
+                          std::vector<FrameInfo>& frames) {
+    int n = opt.fftSize;
+    FeatureExtractor extractor(n, sampleRate);
+    std::vector<double> window(n);
+    std::vector<double> magnitudes(n / 2);
+    std::vector<std::complex<double> > work(n);
+    AudioFeatures features;
+
+    size_t hop = (size_t)sampleRate * opt.frameMs / 1000;
+    for (size_t start = 0; start + n <= pcm.size(); start += hop) {
+        for (int i = 0; i < n; i++) window[i] = pcm[start + i];
+        double rawVolume = FeatureExtractor::measureVolume(&window[0], n);
+        magnitudeSpectrum(&window[0], n, work, &magnitudes[0]);
+
+        unsigned long now = (unsigned long)((start + n) * 1000ULL / sampleRate);
+        extractor.process(rawVolume, &magnitudes[0], now, features);
+
+        FrameInfo info;
+        info.timeMs = now;
+        // Sections compare levels across the track, which the gain control
+        // would have evened out; beats still come from the gained features
+        // as they will live
+        info.volume = rawVolume;
+        info.bass = extractor.getUngainedBand(GAIN_BASS);
+        info.locked = features.gridLocked;
+        info.tick = features.gridBeat;
+        info.beatIndex = features.beatIndex;
+        info.beatInBar = features.beatInBar;
+        info.periodMs = extractor.getBeatGrid().getPeriodMs();
+        frames.push_back(info);
+    }
+}
+
+static float medianPeriod(const std::vector<FrameInfo>& frames) {
+    std::vector<float> periods;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].locked && frames[i].periodMs > 0) periods.push_back(frames[i].periodMs);
+    }
+    if (periods.empty()) return 0;
+    std::nth_element(periods.begin(), periods.begin() + periods.size() / 2, periods.end());
+    return periods[periods.size() / 2];
+}
+
+static uint8_t energyLevel(double e) {
+    return e > 0.7 ? 2 : (e > 0.4 ? 1 : 0);
+}
+
+static int findName(CueTimeline& t, const std::string& name) {
+    for (int i = 0; i < t.nameCount; i++) {
+        if (name == t.names[i]) return i;
+    }
+    if (t.nameCount >= CUE_MAX_NAMES) return CUE_NO_ANIMATION;
+    snprintf(t.names[t.nameCount], CUE_MAX_NAME_LENGTH + 1, "%s", name.c_str());
+    return t.nameCount++;
+}
+
+static void buildTimeline(const std::vector<FrameInfo>& frames, const Options& opt, CueTimeline& t,
+                          std::vector<uint32_t>& beatMs) {
+    memset(&t, 0, sizeof(t));
+    float periodMs = medianPeriod(frames);
+    t.bpmX10 = periodMs > 0 ? (uint16_t)(600000.0f / periodMs + 0.5f) : 0;
+    t.durationMs = frames.empty() ? 0 : frames.back().timeMs;
+
+    // Beats, numbered as the device will count them, with per-beat energy
+    CueBeatCounter counter;
+    counter.reset(false);
+    std::vector<double> beatVolume, beatBass;
+    double volumeSum = 0, bassSum = 0;
+    int frameCount = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const FrameInfo& f = frames[i];
+        if (!counter.update(f.timeMs, f.locked, f.tick, f.beatIndex, f.beatInBar, (unsigned long)periodMs)) continue;
+        while (beatMs.size() <= counter.getBeat()) {
+            if (!beatMs.empty()) {
+                beatVolume.push_back(frameCount ? volumeSum / frameCount : 0);
+                beatBass.push_back(frameCount ? bassSum / frameCount : 0);
+            }
+            beatMs.push_back(counter.getBeatMs());
+            volumeSum = bassSum = 0;
+            frameCount = 0;
+        }
+        volumeSum += f.volume;
+        bassSum += f.bass;
+        frameCount++;
+    }
+    if (!beatMs.empty()) {
+        beatVolume.push_back(frameCount ? volumeSum / frameCount : 0);
+        beatBass.push_back(frameCount ? bassSum / frameCount : 0);
+    }
+    t.beatCount = beatMs.size();
+
+    // Per-phrase energy relative to the loudest phrase
+    int phraseBeats = tuning.phraseBars * BeatGrid::BEATS_PER_BAR;
+    int phrases = (t.beatCount + phraseBeats - 1) / phraseBeats;
+    std::vector<double> energy(phrases), bass(phrases);
+    double maxEnergy = 1e-9, maxBass = 1e-9;
+    for (int p = 0; p < phrases; p++) {
+        int first = p * phraseBeats;
+        int last = std::min((int)t.beatCount, first + phraseBeats);
+        for (int b = first; b < last; b++) {
+            energy[p] += beatVolume[b];
+            bass[p] += beatBass[b];
+        }
+        energy[p] /= (last - first);
+        bass[p] /= (last - first);
+        maxEnergy = std::max(maxEnergy, energy[p]);
+        maxBass = std::max(maxBass, bass[p]);
+    }
+
+    std::vector<uint8_t> kinds(phrases);
+    bool reachedPeak = false;
+    for (int p = 0; p < phrases; p++) {
+        double e = energy[p] / maxEnergy;
+        double b = bass[p] / maxBass;
+        bool drop = e > 0.7 && b > 0.75;
+        if (drop) kinds[p] = CUE_SECTION_DROP;
+        else if (!reachedPeak && e <= 0.7) kinds[p] = CUE_SECTION_INTRO;
+        else if (e < 0.4) kinds[p] = CUE_SECTION_BREAKDOWN;
+        else kinds[p] = CUE_SECTION_GROOVE;
+        if (e > 0.7) reachedPeak = true;
+    }
+    for (int p = 0; p + 1 < phrases; p++) {
+        // The phrase leading into a drop, rising but with the low end held back
+        if (kinds[p + 1] == CUE_SECTION_DROP && kinds[p] != CUE_SECTION_DROP &&
+            energy[p + 1] > energy[p] && bass[p] < bass[p + 1] * 0.8) {
+            kinds[p] = CUE_SECTION_BUILDUP;
+        }
+    }
+    for (int p = phrases - 1; p > 0 && energy[p] < energy[p - 1] && kinds[p] != CUE_SECTION_DROP; p--) {
+        kinds[p] = CUE_SECTION_OUTRO;
+        if (energy[p - 1] / maxEnergy > 0.4) break;
+    }
+
+    // Merge equal neighbours into sections; cue at every section start and
+    // every fourth phrase inside long sections so the look keeps moving
+    for (int p = 0; p < phrases; p++) {
+        bool newSection = p == 0 || kinds[p] != kinds[p - 1];
+        if (newSection && t.sectionCount < CUE_MAX_SECTIONS) {
+            CueSectionMarker& s = t.sections[t.sectionCount++];
+            s.startBeat = p * phraseBeats;
+            s.kind = kinds[p];
+            s.energy = energyLevel(energy[p] / maxEnergy);
+        }
+        int section = t.sectionCount - 1;
+        int phraseInSection = (p * phraseBeats - t.sections[section].startBeat) / phraseBeats;
+        if ((newSection || phraseInSection % 4 == 0) && t.cueCount < CUE_MAX_CUES) {
+            CueEvent& c = t.cues[t.cueCount++];
+            c.beat = p * phraseBeats;
+            c.section = section;
+            c.energy = t.sections[section].energy;
+            const std::string& mapped = opt.map[kinds[p]];
+            c.name = newSection && !mapped.empty() ? findName(t, mapped) : CUE_NO_ANIMATION;
+        }
+    }
+}
+
+static bool analyzeFile(const char* path, const Options& opt) {
+    std::vector<float> pcm;
+    int sampleRate = 0;
+    std::string error;
+    if (!readWav(path, pcm, sampleRate, error)) {
+        std::lock_guard<std::mutex> lock(printLock);
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return false;
+    }
+
+    std::vector<FrameInfo> frames;
+    analyzeFrames(pcm, sampleRate, opt, frames);
+
+    CueTimeline t;
+    std::vector<uint32_t> beatMs;
+    buildTimeline(frames, opt, t, beatMs);
+    if (t.beatCount == 0) {
+        std::lock_guard<std::mutex> lock(printLock);
+        fprintf(stderr, "%s: no beat grid found\n", path);
+        return false;
+    }
+
+    std::vector<uint8_t> out(cueTimelineMaxSize(t));
+    size_t size = writeCueTimeline(t, &beatMs[0], &out[0]);
+
+    std::string name = path;
+    size_t slash = name.find_last_of("/\\");
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) name.erase(dot);
+    if (!opt.outDir.empty()) {
+        name = opt.outDir + "/" + (slash == std::string::npos ? name : name.substr(slash + 1));
+    }
+    name += ".ggct";
+
+    FILE* f = fopen(name.c_str(), "wb");
+    bool ok = f && fwrite(&out[0], 1, size, f) == size;
+    if (f) fclose(f);
+
+    std::lock_guard<std::mutex> lock(printLock);
+    if (!ok) {
+        fprintf(stderr, "%s: cannot write %s\n", path, name.c_str());
+        return false;
+    }
+    printf("%s -> %s (%zu bytes)\n", path, name.c_str(), size);
+    printf("  %.1f BPM, %u beats, first at %.2fs, %d sections, %d cues\n", t.bpmX10 / 10.0,
+           (unsigned)t.beatCount, beatMs[0] / 1000.0, t.sectionCount, t.cueCount);
+    for (int i = 0; i < t.sectionCount; i++) {
+        const CueSectionMarker& s = t.sections[i];
+        uint32_t at = s.startBeat < t.beatCount ? beatMs[s.startBeat] : t.durationMs;
+        printf("  bar %4u  %3u:%02u  %-10s energy %d\n", (unsigned)(s.startBeat / BeatGrid::BEATS_PER_BAR + 1),
+               (unsigned)(at / 60000), (unsigned)(at / 1000 % 60), cueSectionName(s.kind), s.energy);
+    }
+    return true;
+}
+
+static bool parseMap(const char* arg, Options& opt) {
+    const char* eq = strchr(arg, '=');
+    if (!eq) return false;
+    std::string kind(arg, eq - arg);
+    for (int k = 0; k < CUE_SECTION_KIND_COUNT; k++) {
+        std::string name = cueSectionName(k);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (kind == name) {
+            opt.map[k] = eq + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-o") == 0 && hasValue) opt.outDir = argv[++i];
+        else if (strcmp(argv[i], "--fft") == 0 && hasValue) opt.fftSize = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frame-ms") == 0 && hasValue) opt.frameMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--jobs") == 0 && hasValue) opt.jobs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--map") == 0 && hasValue) {
+            if (!parseMap(argv[++i], opt)) {
+                fprintf(stderr, "bad --map %s (kind=Animation Name)\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--set") == 0 && hasValue) {
+            if (!setTuningValue(argv[++i])) {
+                fprintf(stderr, "bad --set %s (name=value)\n", argv[i]);
+                return 2;
+            }
+        } else if (argv[i][0] == '-') {
+            files.clear();
+            break;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        fprintf(stderr, "usage: %s [-o dir] [--fft N] [--frame-ms MS] [--jobs N] [--map kind=name] [--set name=value] file.wav...\n",
+                argv[0]);
+        return 2;
+    }
+    if (opt.fftSize < 64 || (opt.fftSize & (opt.fftSize - 1)) != 0 || opt.frameMs <= 0) {
+        fprintf(stderr, "--fft must be a power of two >= 64 and --frame-ms positive\n");
+        return 2;
+    }
+
+    int jobs = opt.jobs > 0 ? opt.jobs : (int)std::thread::hardware_concurrency();
+    jobs = std::max(1, std::min(jobs, (int)files.size()));
+
+    std::atomic<int> next(0);
+    std::atomic<int> failed(0);
+    std::vector<std::thread> workers;
+    for (int j = 0; j < jobs; j++) {
+        workers.push_back(std::thread([&]() {
+            for (int i; (i = next++) < (int)files.size();) {
+                if (!analyzeFile(files[i], opt)) failed++;
+            }
+        }));
+    }
+    for (size_t j = 0; j < workers.size(); j++) workers[j].join();
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+// feature_inspect.cpp
+// Prints the contents of a feature recording (FeatureRecording.h) copied off
+// the device's LittleFS partition.
+//
+//   feature_inspect show.ggfr            # every frame and decision as CSV
+//   feature_inspect show.ggfr --summary  # header and statistics only
+//
+// CSV lines:
+//   F,timeMs,volume,bass,mid,treble,bpm,loudness,beat,gridLocked,beatIndex,beatPhase
+//   E,timeMs,from,to,reason
+//
+// Build: g++ -std=c++11 -O2 -o feature_inspect feature_inspect.cpp
+#include "../FeatureRecording.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    bool summaryOnly = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--summary") == 0) summaryOnly = true;
+        else path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s <recording> [--summary]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    RecordingHeader header;
+    if (data.size() < sizeof(header)) {
+        fprintf(stderr, "%s: too short\n", path);
+        return 1;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, RECORDING_MAGIC, 4) != 0 || header.version != RECORDING_VERSION) {
+        fprintf(stderr, "%s: not a version %d feature recording\n", path, RECORDING_VERSION);
+        return 1;
+    }
+
+    FeatureDecoder decoder;
+    size_t pos = sizeof(header);
+    unsigned long frames = 0, keyframes = 0, events = 0, gaps = 0, corrupt = 0;
+    uint32_t firstMs = 0, lastMs = 0;
+    RecordedFrame frame;
+    RecordedEvent event;
+
+    while (pos < data.size()) {
+        size_t consumed = 0;
+        uint8_t tag = data[pos];
+        FeatureDecoder::Result r = decoder.decode(data.data() + pos, data.size() - pos, consumed, frame, event);
+        if (r == FeatureDecoder::NEED_MORE) {
+            fprintf(stderr, "truncated record at offset %zu\n", pos);
+            break;
+        }
+        pos += consumed;
+
+        if (r == FeatureDecoder::FRAME) {
+            if (frames == 0) firstMs = frame.timeMs;
+            lastMs = frame.timeMs;
+            frames++;
+            if (tag == RECORD_KEY) keyframes++;
+            if (!summaryOnly) {
+                printf("F,%u,%.4f,%.4f,%.4f,%.4f,%.1f,%u,%d,%d,%u,%.3f\n", frame.timeMs,
+                       frame.volume / 65535.0, frame.bass / 65535.0, frame.mid / 65535.0,
+                       frame.treble / 65535.0, frame.bpmX10 / 10.0, frame.loudness,
+                       (frame.flags & RECORD_FLAG_BEAT) != 0, (frame.flags & RECORD_FLAG_GRID_LOCKED) != 0,
+                       frame.beatIndex, frame.beatPhase / 255.0);
+            }
+        } else if (r == FeatureDecoder::EVENT) {
+            events++;
+            if (!summaryOnly) printf("E,%u,%u,%u,%s\n", lastMs, event.from, event.to, event.reason);
+        } else if (r == FeatureDecoder::GAP) {
+            gaps++;
+            if (!summaryOnly) printf("# gap after %u ms\n", lastMs);
+        } else {
+            corrupt++;
+        }
+    }
+
+    double seconds = (lastMs - firstMs) / 1000.0;
+    fprintf(stderr, "%s: start %u ms, rng seed %u, keyframe every %u\n", path, header.startMs,
+            header.rngSeed, header.keyframeInterval);
+    fprintf(stderr, "%lu frames (%lu key) over %.1f s, %lu decisions, %lu gaps, %lu corrupt bytes\n",
+            frames, keyframes, seconds, events, gaps, corrupt);
+    if (frames) {
+        fprintf(stderr, "%zu bytes, %.1f bytes/frame\n", data.size(), (double)(data.size() - sizeof(header)) / frames);
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+// led_kernel_bench.cpp
+// Checks LedKernels.h against pixel-at-a-time copies of the FastLED code it
+// replaces (fadeToBlackBy, CRGB +=, blur1d, random8 gating) and times both
+// at strip lengths from the booth's 60 pixels up to 4096.
+//
+//   led_kernel_bench              # all sizes
+//   led_kernel_bench 60 300       # just these pixel counts
+//
+// Build the vectorized host version, and the word-at-a-time path (slower
+// than the reference loops here, which the compiler vectorizes, and left
+// off on the device too):
+//   g++ -std=c++11 -O3 -march=native -I.. -o led_kernel_bench led_kernel_bench.cpp ../LedKernels.cpp
+//   g++ -std=c++11 -O3 -DLED_KERNELS_FORCE_SWAR -I.. -o led_kernel_bench_swar led_kernel_bench.cpp ../LedKernels.cpp
+#include "../LedKernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+struct Pixel {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+// --- FastLED reference (FASTLED_SCALE8_FIXED) ---------------------------------
+
+uint16_t rand16seed = 1337;
+
+uint8_t random8() {
+    rand16seed = (uint16_t)(rand16seed * 2053 + 13849);
+    return (uint8_t)((rand16seed & 0xFF) + (rand16seed >> 8));
+}
+
+uint8_t qadd8(uint8_t a, uint8_t b) {
+    unsigned t = a + b;
+    return t > 255 ? 255 : (uint8_t)t;
+}
+
+void nscale8(Pixel& p, uint8_t scale) {
+    uint16_t s = scale + 1;
+    p.r = (p.r * s) >> 8;
+    p.g = (p.g * s) >> 8;
+    p.b = (p.b * s) >> 8;
+}
+
+void add(Pixel& p, const Pixel& q) {
+    p.r = qadd8(p.r, q.r);
+    p.g = qadd8(p.g, q.g);
+    p.b = qadd8(p.b, q.b);
+}
+
+void refFade(Pixel* leds, int n, uint8_t fadeBy) {
+    for (int i = 0; i < n; i++) nscale8(leds[i], 255 - fadeBy);
+}
+
+void refAdd(Pixel* leds, const Pixel* layer, int n) {
+    for (int i = 0; i < n; i++) add(leds[i], layer[i]);
+}
+
+void refAddColor(Pixel* leds, int n, Pixel c) {
+    for (int i = 0; i < n; i++) add(leds[i], c);
+}
+
+void refBlur(Pixel* leds, int n, uint8_t amount) {
+    uint8_t keep = 255 - amount;
+    uint8_t seep = amount >> 1;
+    Pixel carryover = { 0, 0, 0 };
+    for (int i = 0; i < n; i++) {
+        Pixel cur = leds[i];
+        Pixel part = cur;
+        nscale8(part, seep);
+        nscale8(cur, keep);
+        add(cur, carryover);
+        if (i) add(leds[i - 1], part);
+        leds[i] = cur;
+        carryover = part;
+    }
+}
+
+void refSparkle(Pixel* leds, int n, uint16_t threshold) {
+    for (int i = 0; i < n; i++) {
+        if (random8() < threshold) leds[i] = Pixel{ 255, 255, 255 };
+    }
+}
+
+// --- Harness ---------------------------------------------------------------------
+
+void randomize(std::vector<uint8_t>& bytes, unsigned seed) {
+    srand(seed);
+    for (size_t i = 0; i < bytes.size(); i++) bytes[i] = rand() & 0xFF;
+}
+
+// Runs fn until ~20 ms have passed; returns nanoseconds per call
+template<typename Fn>
+double timeIt(Fn fn) {
+    typedef std::chrono::steady_clock Clock;
+    long reps = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    do {
+        for (int i = 0; i < 64; i++) fn();
+        reps += 64;
+        elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    } while (elapsed < 20e6);
+    return elapsed / reps;
+}
+
+int failures = 0;
+
+void expectSame(const char* what, int pixels, size_t offset,
+                const std::vector<uint8_t>& got, const std::vector<uint8_t>& want) {
+    if (memcmp(got.data() + offset, want.data() + offset, pixels * 3) == 0) return;
+    for (int i = 0; i < pixels * 3; i++) {
+        if (got[offset + i] != want[offset + i]) {
+            printf("MISMATCH %s (%d px, offset %zu): byte %d is %u, FastLED gives %u\n",
+                   what, pixels, offset, i, got[offset + i], want[offset + i]);
+            break;
+        }
+    }
+    failures++;
+}
+
+// Every kernel against the reference, on aligned and unaligned buffers
+void verify(int pixels) {
+    for (size_t offset = 0; offset < 4; offset++) {
+        std::vector<uint8_t> base(pixels * 3 + 4), layer(pixels * 3 + 4);
+        std::vector<uint8_t> scratch(pixels * 6 + 4);
+        randomize(base, pixels + offset);
+        randomize(layer, pixels * 7 + offset);
+
+        for (int amount = 0; amount < 256; amount += 17) {
+            std::vector<uint8_t> a = base, b = base;
+            ledFade(a.data() + offset, pixels * 3, amount);
+            refFade((Pixel*)(b.data() + offset), pixels, amount);
+            expectSame("fade", pixels, offset, a, b);
+
+            a = base;
+            b = base;
+            ledBlur(a.data() + offset, pixels, amount, scratch.data());
+            refBlur((Pixel*)(b.data() + offset), pixels, amount);
+            expectSame("blur", pixels, offset, a, b);
+
+            a = base;
+            b = base;
+            Pixel c = { (uint8_t)amount, (uint8_t)(amount * 3), (uint8_t)(255 - amount) };
+            ledAddColor(a.data() + offset, pixels, c.r, c.g, c.b);
+            refAddColor((Pixel*)(b.data() + offset), pixels, c);
+            expectSame("add color", pixels, offset, a, b);
+        }
+
+        std::vector<uint8_t> a = base, b = base;
+        ledAdd(a.data() + offset, layer.data() + offset, pixels * 3);
+        refAdd((Pixel*)(b.data() + offset), (const Pixel*)(layer.data() + offset), pixels);
+        expectSame("add", pixels, offset, a, b);
+
+        a = base;
+        b = base;
+        ledAdd(a.data() + offset, layer.data(), pixels * 3);
+        refAdd((Pixel*)(b.data() + offset), (const Pixel*)layer.data(), pixels);
+        expectSame("add (misaligned)", pixels, offset, a, b);
+
+        for (uint16_t threshold = 0; threshold <= 256; threshold += 64) {
+            a = base;
+            b = base;
+            std::vector<uint8_t> mask(pixels);
+            uint16_t seed = 1337;
+            rand16seed = seed;
+            seed = ledRandomGate(mask.data(), pixels, threshold, seed);
+            ledSetWhere(a.data() + offset, mask.data(), pixels, 255, 255, 255);
+            refSparkle((Pixel*)(b.data() + offset), pixels, threshold);
+            expectSame("sparkle", pixels, offset, a, b);
+            if (seed != rand16seed) {
+                printf("MISMATCH sparkle seed (%d px): %u vs %u\n", pixels, seed, rand16seed);
+                failures++;
+            }
+        }
+    }
+}
+
+void bench(int pixels) {
+    std::vector<uint8_t> a(pixels * 3), b(pixels * 3), layer(pixels * 3);
+    std::vector<uint8_t> scratch(pixels * 6), mask(pixels);
+    randomize(a, 1);
+    randomize(layer, 2);
+    b = a;
+
+    // Fades towards black; refill so timings don't run on zeros
+    double refFadeNs = timeIt([&] { refFade((Pixel*)b.data(), pixels, 20); b[0] = 255; b[pixels] = 255; });
+    double fadeNs = timeIt([&] { ledFade(a.data(), pixels * 3, 20); a[0] = 255; a[pixels] = 255; });
+    double refAddNs = timeIt([&] { refAdd((Pixel*)b.data(), (const Pixel*)layer.data(), pixels); });
+    double addNs = timeIt([&] { ledAdd(a.data(), layer.data(), pixels * 3); });
+    double refBlurNs = timeIt([&] { refBlur((Pixel*)b.data(), pixels, 30); });
+    double blurNs = timeIt([&] { ledBlur(a.data(), pixels, 30, scratch.data()); });
+    double refSparkleNs = timeIt([&] { refSparkle((Pixel*)b.data(), pixels, 40); });
+    uint16_t seed = 1337;
+    double sparkleNs = timeIt([&] {
+        seed = ledRandomGate(mask.data(), pixels, 40, seed);
+        ledSetWhere(a.data(), mask.data(), pixels, 255, 255, 255);
+    });
+
+    printf("%6d  fade %8.0f %8.0f %5.1fx  add %8.0f %8.0f %5.1fx  blur %8.0f %8.0f %5.1fx  sparkle %8.0f %8.0f %5.1fx\n",
+           pixels,
+           refFadeNs, fadeNs, refFadeNs / fadeNs,
+           refAddNs, addNs, refAddNs / addNs,
+           refBlurNs, blurNs, refBlurNs / blurNs,
+           refSparkleNs, sparkleNs, refSparkleNs / sparkleNs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(atoi(argv[i]));
+    if (sizes.empty()) sizes = { 60, 144, 300, 1024, 4096 };
+
+    for (int pixels : sizes) {
+        if (pixels < 1) {
+            fprintf(stderr, "pixel counts must be positive\n");
+            return 1;
+        }
+        verify(pixels);
+    }
+    if (failures) {
+        printf("%d mismatches against FastLED\n", failures);
+        return 1;
+    }
+    printf("%s kernels match FastLED\n\n", LED_KERNELS_SWAR ? "SWAR" : "Plain");
+
+    printf("Nanoseconds per strip: FastLED-style, kernel, speed-up\n");
+    printf("pixels\n");
+    for (int pixels : sizes) bench(pixels);
+    return 0;
+}
@@ -0,0 +1,149 @@
+// memory_sim.cpp
+// Host stand-in for the device's frame loop, for memory work: runs the
+// portable parts of a frame (feature extraction, the LED kernels, the frame
+// arena, feature-recording encoding) over synthetic audio with
+// MemoryMonitor's malloc hooks in place, and reports allocations per frame.
+// A frame that allocates after warm-up is a regression; the exit status is 1
+// if any does.
+//
+//   memory_sim                        # 5000 frames, report every 1000
+//   memory_sim --frames 20000 --report 2000 --warmup 50
+//
+// Build: g++ -std=c++11 -O2 -I.. -o memory_sim memory_sim.cpp ../MemoryMonitor.cpp ../FeatureExtractor.cpp ../BeatGrid.cpp ../AutoGain.cpp ../LedKernels.cpp ../FrameArena.cpp
+// (no -fsanitize=address: ASan brings its own allocator and the hooks step aside)
+#include "../MemoryMonitor.h"
+#include "../FeatureExtractor.h"
+#include "../FeatureRecording.h"
+#include "../FrameArena.h"
+#include "../FixedString.h"
+#include "../FixedVector.h"
+#include "../LedKernels.h"
+#include "../TuningParams.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The extractor reads its thresholds from here
+TuningParams tuning;
+
+namespace {
+
+const int kFrameMs = 20;
+const double kPi = 3.14159265358979323846;
+
+// A widget-sized object with a label, like the display's
+struct FakeWidget {
+    FixedString<48> label;
+    double value;
+    FakeWidget(const char* text, double v) : label(text), value(v) {}
+};
+
+// 128 BPM kick over a little noise, as magnitudes in the device's bins
+void synthesize(unsigned long now, double* samples, double* magnitudes, int n) {
+    double beatPos = fmod(now / (60000.0 / 128.0), 1.0);
+    double kick = beatPos < 0.1 ? 1.0 - beatPos * 10.0 : 0.0;
+    for (int i = 0; i < n; i++) {
+        double noise = (rand() / (double)RAND_MAX - 0.5) * 0.05;
+        samples[i] = kick * 0.8 * sin(2.0 * kPi * 55.0 * i / SAMPLE_RATE) + noise;
+    }
+    for (int k = 0; k < n / 2; k++) {
+        double bass = k < 8 ? kick * 400.0 : 0.0;
+        magnitudes[k] = bass + 20.0 + (rand() % 40);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    long frames = 5000;
+    long warmup = 100;
+    long reportEvery = 1000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frames = atol(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmup = atol(argv[++i]);
+        else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) reportEvery = atol(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--frames N] [--warmup N] [--report N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (reportEvery < 1) reportEvery = frames;
+
+    MemoryMonitor::begin();
+
+    static double samples[NUM_SAMPLES];
+    static double magnitudes[NUM_SAMPLES / 2];
+    static AudioFeatures features;
+    alignas(4) static uint8_t leds[NUM_LEDS * 3];
+    alignas(4) static uint8_t blurScratch[NUM_LEDS * 6];
+    static uint8_t record[64];
+    FeatureExtractor extractor(NUM_SAMPLES, SAMPLE_RATE);
+    FeatureEncoder encoder;
+    FixedVector<int, NUM_LEDS + 1> drips;
+
+    long allocatingFrames = 0;
+    uint32_t worstAllocs = 0;
+    char line[200];
+
+    for (long frame = 0; frame < frames; frame++) {
+        unsigned long now = frame * kFrameMs;
+        MemoryMonitor::beginFrame();
+        FrameArena::reset();
+
+        synthesize(now, samples, magnitudes, NUM_SAMPLES);
+        double rawVolume = FeatureExtractor::measureVolume(samples, NUM_SAMPLES);
+        extractor.process(rawVolume, magnitudes, now, features);
+
+        // Animation and display stand-ins
+        ledFade(leds, sizeof(leds), 30);
+        if (features.beatDetected) ledAddColor(leds, NUM_LEDS, 40, 40, 40);
+        ledBlur(leds, NUM_LEDS, 30, blurScratch);
+        if (features.beatDetected) drips.push_back(0);
+        for (int& d : drips) d++;
+        drips.resize(std::remove_if(drips.begin(), drips.end(), [](int p) {
+            return p >= NUM_LEDS;
+        }) - drips.begin());
+
+        FakeWidget* bass = FrameArena::create<FakeWidget>("BASS", features.bass);
+        FakeWidget* reason = FrameArena::create<FakeWidget>("KEEP REASON", 0.0);
+        if (reason) reason->label.format("%s: %s", "KEEP REASON", features.gridLocked ? "Grid" : "No beat");
+        if (bass) bass->~FakeWidget();
+        if (reason) reason->~FakeWidget();
+
+        RecordedFrame rec = {};
+        rec.timeMs = now;
+        rec.volume = (uint16_t)(features.volume * 65535.0);
+        rec.bpmX10 = (uint16_t)(features.bpm * 10.0);
+        rec.beatIndex = features.beatIndex;
+        encoder.encodeFrame(rec, record);
+
+        MemoryMonitor::endFrame();
+        uint32_t allocs = MemoryMonitor::getLastFrameAllocs();
+
+        if (frame >= warmup && allocs > 0) {
+            allocatingFrames++;
+            if (allocs > worstAllocs) worstAllocs = allocs;
+        }
+        if ((frame + 1) % reportEvery == 0) {
+            MemoryMonitor::format(MemoryMonitor::report(), line, sizeof(line));
+            printf("frame %ld: %s | arena peak %u/%u\n", frame + 1, line,
+                   (unsigned)FrameArena::getPeak(), (unsigned)FrameArena::getCapacity());
+        }
+    }
+
+    MemoryStats stats = MemoryMonitor::sample();
+    if (!stats.hooks) {
+        printf("allocator hooks unavailable in this build; only heap totals were checked\n");
+        return 0;
+    }
+    if (allocatingFrames) {
+        printf("FAIL: %ld of %ld frames after warm-up allocated (worst %u)\n",
+               allocatingFrames, frames - warmup, (unsigned)worstAllocs);
+        return 1;
+    }
+    printf("OK: no allocations in %ld frames after warm-up (%u in total)\n",
+           frames > warmup ? frames - warmup : 0, (unsigned)stats.totalAllocs);
+    return 0;
+}
@@ -0,0 +1,401 @@
+// pixel_gen.cpp
+// Lighting-desk stand-in for the pixel input (PixelInput.h). Sends a moving
+// rainbow as Art-Net or E1.31 to a booth controller, optionally with extra
+// jitter and loss, or, with --loopback, runs PixelInput and UdpPixelTransport
+// here against its own packets over 127.0.0.1 on simulated time. The
+// loopback run checks that frames play in order, that the jitter buffer
+// evens out the arrival jitter, that the animations take over once the
+// stream stops, and that a desk restarting from sequence 1 is shown again
+// at once; the exit status is 1 if any of that fails.
+//
+//   pixel_gen 192.168.4.20                       # Art-Net, 40 fps, until ^C
+//   pixel_gen 192.168.4.20 --e131 --universe 1 --fps 30 --seconds 60
+//   pixel_gen --loopback --jitter 8 --loss 2     # self test
+//
+// Build: g++ -std=c++11 -O2 -I.. -o pixel_gen pixel_gen.cpp ../PixelInput.cpp ../UdpPixelTransport.cpp ../LedKernels.cpp
+#include "../PixelInput.h"
+#include "../UdpPixelTransport.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Options {
+    const char* host = nullptr;
+    bool e131 = false;
+    bool artSync = false;
+    bool loopback = false;
+    int universe = PIXEL_INPUT_UNIVERSE;
+    int pixels = NUM_LEDS;
+    double fps = 40.0;
+    double latencyMs = 3.0;
+    double jitterMs = 0.0;
+    double lossPercent = 0.0;
+    long seconds = 0;
+    int port = 0;
+    unsigned seed = 1;
+};
+
+typedef std::vector<uint8_t> Packet;
+
+void putBe16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+void putBe32(uint8_t* p, uint32_t v) {
+    putBe16(p, v >> 16);
+    putBe16(p + 2, v & 0xFFFF);
+}
+
+Packet artNetDmx(uint16_t universe, uint8_t sequence, const uint8_t* data, uint16_t len) {
+    uint16_t padded = (len + 1) & ~1;  // Art-Net wants an even length
+    Packet p(ARTNET_HEADER_LENGTH + padded, 0);
+    memcpy(&p[0], ARTNET_ID, sizeof(ARTNET_ID));
+    p[8] = ARTNET_OP_DMX & 0xFF;
+    p[9] = ARTNET_OP_DMX >> 8;
+    putBe16(&p[10], ARTNET_VERSION);
+    p[12] = sequence;
+    p[14] = universe & 0xFF;
+    p[15] = (universe >> 8) & 0x7F;
+    putBe16(&p[16], padded);
+    memcpy(&p[ARTNET_HEADER_LENGTH], data, len);
+    return p;
+}
+
+Packet artNetSync() {
+    Packet p(14, 0);
+    memcpy(&p[0], ARTNET_ID, sizeof(ARTNET_ID));
+    p[8] = ARTNET_OP_SYNC & 0xFF;
+    p[9] = ARTNET_OP_SYNC >> 8;
+    putBe16(&p[10], ARTNET_VERSION);
+    return p;
+}
+
+Packet e131Data(uint16_t universe, uint8_t sequence, const uint8_t* data, uint16_t len) {
+    size_t total = E131_HEADER_LENGTH + len;
+    Packet p(total, 0);
+    putBe16(&p[0], 0x0010);
+    memcpy(&p[4], E131_ID, sizeof(E131_ID));
+    putBe16(&p[16], 0x7000 | (total - 16));
+    putBe32(&p[18], E131_ROOT_VECTOR);
+    memcpy(&p[22], "pixel_gen-cid-00", 16);
+    putBe16(&p[38], 0x7000 | (total - 38));
+    putBe32(&p[40], E131_FRAMING_VECTOR);
+    snprintf((char*)&p[44], 64, "pixel_gen");
+    p[108] = 100;                  // priority
+    p[111] = sequence;
+    putBe16(&p[113], universe);
+    putBe16(&p[115], 0x7000 | (total - 115));
+    p[117] = E131_DMP_VECTOR;
+    p[118] = 0xA1;                 // address and data type
+    putBe16(&p[121], 1);           // address increment
+    putBe16(&p[123], len + 1);
+    memcpy(&p[E131_HEADER_LENGTH], data, len);
+    return p;
+}
+
+void hsvToRgb(double h, uint8_t* rgb) {
+    double x = 1.0 - fabs(fmod(h * 6.0, 2.0) - 1.0);
+    double r = 0, g = 0, b = 0;
+    switch ((int)(h * 6.0) % 6) {
+        case 0: r = 1; g = x; break;
+        case 1: r = x; g = 1; break;
+        case 2: g = 1; b = x; break;
+        case 3: g = x; b = 1; break;
+        case 4: r = x; b = 1; break;
+        default: r = 1; b = x; break;
+    }
+    rgb[0] = (uint8_t)(r * 255);
+    rgb[1] = (uint8_t)(g * 255);
+    rgb[2] = (uint8_t)(b * 255);
+}
+
+// One frame's packets. In loopback runs the first pixel of every universe
+// carries the frame number, so the receiving side can check it.
+std::vector<Packet> framePackets(const Options& opt, long frame, uint8_t sequence, bool tagged) {
+    std::vector<uint8_t> channels(opt.pixels * 3);
+    for (int i = 0; i < opt.pixels; i++) hsvToRgb(fmod(i / (double)opt.pixels + frame * 0.01, 1.0), &channels[i * 3]);
+
+    std::vector<Packet> packets;
+    for (int u = 0; u * DMX_PIXELS < opt.pixels; u++) {
+        uint8_t* data = &channels[u * DMX_PIXELS * 3];
+        int count = std::min(DMX_PIXELS, opt.pixels - u * DMX_PIXELS) * 3;
+        if (tagged) {
+            data[0] = frame & 0xFF;
+            data[1] = (frame >> 8) & 0xFF;
+            data[2] = (frame >> 16) & 0xFF;
+        }
+        uint16_t universe = opt.universe + u;
+        packets.push_back(opt.e131 ? e131Data(universe, sequence, data, count)
+                                   : artNetDmx(universe, sequence, data, count));
+    }
+    if (opt.artSync && !opt.e131) packets.push_back(artNetSync());
+    return packets;
+}
+
+long taggedFrame(const uint8_t* pixels) {
+    return pixels[0] | pixels[1] << 8 | pixels[2] << 16;
+}
+
+struct Spread {
+    double sum = 0.0, sumSq = 0.0;
+    long n = 0;
+    void add(double v) {
+        sum += v;
+        sumSq += v * v;
+        n++;
+    }
+    double mean() const { return n ? sum / n : 0.0; }
+    double deviation() const { return n > 1 ? sqrt(fmax(0.0, sumSq / n - mean() * mean())) : 0.0; }
+};
+
+// Advances a sequence number, skipping 0 on Art-Net (0 means unnumbered)
+uint8_t nextSequence(uint8_t s, bool e131) {
+    s++;
+    return (!e131 && s == 0) ? 1 : s;
+}
+
+int sendToDevice(const Options& opt) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opt.port);
+    if (fd < 0 || inet_pton(AF_INET, opt.host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "bad host %s\n", opt.host);
+        return 2;
+    }
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    printf("%s to %s:%d, universe %d, %d pixels at %.0f fps\n",
+           opt.e131 ? "E1.31" : "Art-Net", opt.host, opt.port, opt.universe, opt.pixels, opt.fps);
+
+    uint8_t sequence = 0;
+    long frames = opt.seconds > 0 ? (long)(opt.seconds * opt.fps) : -1;
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long frame = 0; frames < 0 || frame < frames; frame++) {
+        // On schedule, give or take the jitter
+        double at = frame * 1000.0 / opt.fps + (unit(rng) * 2.0 - 1.0) * opt.jitterMs;
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double elapsed = (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_nsec - start.tv_nsec) / 1e6;
+        if (at > elapsed) usleep((useconds_t)((at - elapsed) * 1000.0));
+
+        sequence = nextSequence(sequence, opt.e131);
+        for (const Packet& p : framePackets(opt, frame, sequence, false)) {
+            if (unit(rng) * 100.0 < opt.lossPercent) continue;
+            sendto(fd, p.data(), p.size(), 0, (sockaddr*)&addr, sizeof(addr));
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+// A restarted stream is up again within the jitter buffer's delay
+const long PIXEL_RESTART_LIMIT_MS = 250;
+
+int loopbackTest(const Options& opt) {
+    UdpPixelTransport transport;
+    if (!transport.begin(opt.port)) {
+        fprintf(stderr, "can't listen on port %d\n", opt.port);
+        return 2;
+    }
+    PixelInput input(transport, opt.universe);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opt.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    struct Pending {
+        long at;
+        long frame;
+        Packet packet;
+    };
+    std::vector<Pending> inFlight;
+
+    const int renderMs = 5;
+    long streamMs = (opt.seconds > 0 ? opt.seconds : 30) * 1000;
+    // After the fallback the desk comes back for a few seconds, its
+    // sequence numbers starting over
+    long restartMs = streamMs + PIXEL_TIMEOUT_MS + PIXEL_FADE_MS + 500;
+    long restartEndMs = restartMs + 3000;
+    long endMs = restartEndMs + PIXEL_TIMEOUT_MS + PIXEL_FADE_MS + 500;
+    double nextFrameAt = 0.0;
+    long frame = 0;
+    // The first stream is numbered to end half a cycle past 1, where a
+    // receiver still holding on to its numbers would take the restarted
+    // stream for packets overtaken on the way
+    long firstFrames = (long)ceil(streamMs * opt.fps / 1000.0);
+    uint8_t sequence = 0;
+    for (int start = 0; start < 256; start++) {
+        uint8_t last = (uint8_t)start;
+        for (long f = 0; f < firstFrames; f++) last = nextSequence(last, opt.e131);
+        if (last == 100) {
+            sequence = (uint8_t)start;
+            break;
+        }
+    }
+    long lastArrivedFrame = -1, lastArrivedAt = 0;
+    long lastShownFrame = -1, lastShownAt = 0;
+    long backwards = 0;
+    long fallbackAt = -1;
+    long restartFirstFrame = -1, restartShownAt = -1;
+    Spread arrivals, playouts;
+    uint8_t leds[NUM_LEDS * 3];
+    memset(leds, 0, sizeof(leds));
+
+    for (long now = 0; now < endMs; now++) {
+        if (now == restartMs) {
+            sequence = 0;
+            nextFrameAt = now;
+            restartFirstFrame = frame;
+        }
+        bool sending = now < streamMs || (now >= restartMs && now < restartEndMs);
+        if (sending && now >= nextFrameAt) {
+            // A frame's packets leave back to back and travel together
+            sequence = nextSequence(sequence, opt.e131);
+            double delay = opt.latencyMs + (unit(rng) * 2.0 - 1.0) * opt.jitterMs;
+            for (Packet& p : framePackets(opt, frame, sequence, true)) {
+                if (unit(rng) * 100.0 < opt.lossPercent) continue;
+                Pending pending = { now + (long)fmax(0.0, delay + 0.5), frame, p };
+                inFlight.push_back(pending);
+            }
+            frame++;
+            nextFrameAt += 1000.0 / opt.fps;
+        }
+        for (size_t i = 0; i < inFlight.size();) {
+            if (inFlight[i].at > now) {
+                i++;
+                continue;
+            }
+            const Packet& p = inFlight[i].packet;
+            sendto(fd, p.data(), p.size(), 0, (sockaddr*)&addr, sizeof(addr));
+            if (inFlight[i].frame > lastArrivedFrame) {
+                bool acrossRestart = lastArrivedFrame < restartFirstFrame && inFlight[i].frame >= restartFirstFrame;
+                if (lastArrivedFrame >= 0 && !acrossRestart) arrivals.add((double)(now - lastArrivedAt) / (inFlight[i].frame - lastArrivedFrame));
+                lastArrivedFrame = inFlight[i].frame;
+                lastArrivedAt = now;
+            }
+            inFlight.erase(inFlight.begin() + i);
+        }
+
+        if (now % renderMs != 0) continue;
+        input.poll(now);
+        const uint8_t* pixels = input.playout(now);
+        if (!pixels) {
+            // The animations' turn; a plain grey stands in for them
+            memset(leds, 40, sizeof(leds));
+            input.fadeOut(leds, now);
+            if (now >= streamMs && fallbackAt < 0) fallbackAt = now;
+            continue;
+        }
+        long shownFrame = taggedFrame(pixels);
+        if (shownFrame == lastShownFrame) continue;
+        if (restartFirstFrame >= 0 && shownFrame >= restartFirstFrame && restartShownAt < 0) restartShownAt = now;
+        if (shownFrame < lastShownFrame) backwards++;
+        bool acrossRestart = lastShownFrame < restartFirstFrame && shownFrame >= restartFirstFrame;
+        if (lastShownFrame >= 0 && shownFrame > lastShownFrame && !acrossRestart) {
+            playouts.add((double)(now - lastShownAt) / (shownFrame - lastShownFrame));
+        }
+        lastShownFrame = shownFrame;
+        lastShownAt = now;
+    }
+
+    const PixelStats& stats = input.getStats();
+    printf("%s, %d pixels in %d universe(s), %.0f fps, link %.0f +- %.0f ms, %.1f%% loss\n",
+           opt.e131 ? "E1.31" : "Art-Net", opt.pixels, PIXEL_UNIVERSES, opt.fps,
+           opt.latencyMs, opt.jitterMs, opt.lossPercent);
+    printf("arrivals: %ld frames sent, interval %.1f ms +- %.1f\n", frame, arrivals.mean(), arrivals.deviation());
+    printf("playout:  %lu assembled, %lu shown, interval %.1f ms +- %.1f, delay %u ms, %lu skipped, %lu late, %lu lost packets, %ld backwards\n",
+           (unsigned long)stats.frames, (unsigned long)stats.shown, playouts.mean(), playouts.deviation(),
+           stats.delayMs, (unsigned long)stats.skipped, (unsigned long)stats.late,
+           (unsigned long)stats.lostPackets, backwards);
+
+    bool ok = backwards == 0;
+    // With jitter to remove, playout must be steadier than the arrivals
+    if (opt.jitterMs > renderMs && playouts.deviation() >= arrivals.deviation()) ok = false;
+    double expected = frame * (1.0 - opt.lossPercent / 100.0 * PIXEL_UNIVERSES);
+    if (stats.shown < expected * 0.8) ok = false;
+    long lastPacketMs = streamMs - 1;
+    if (fallbackAt < 0) {
+        printf("fallback: never\n");
+        ok = false;
+    } else {
+        long after = fallbackAt - lastPacketMs;
+        printf("fallback: animations %ld ms after the stream stopped\n", after);
+        if (after > PIXEL_TIMEOUT_MS + 2 * (1000.0 / opt.fps) + opt.latencyMs + opt.jitterMs + renderMs) ok = false;
+    }
+    if (restartShownAt < 0) {
+        printf("restart: never shown\n");
+        ok = false;
+    } else {
+        long after = restartShownAt - restartMs;
+        printf("restart: shown %ld ms after the desk came back\n", after);
+        if (after > PIXEL_RESTART_LIMIT_MS + opt.latencyMs + opt.jitterMs + 2 * (1000.0 / opt.fps)) ok = false;
+    }
+    bool faded = true;
+    for (uint8_t v : leds) faded = faded && v == 40;
+    if (!faded) {
+        printf("fade-out didn't finish\n");
+        ok = false;
+    }
+    printf("%s\n", ok ? "OK" : "FAIL");
+    close(fd);
+    return ok ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--e131") == 0) opt.e131 = true;
+        else if (strcmp(argv[i], "--sync") == 0) opt.artSync = true;
+        else if (strcmp(argv[i], "--loopback") == 0) opt.loopback = true;
+        else if (strcmp(argv[i], "--universe") == 0 && hasValue) opt.universe = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--pixels") == 0 && hasValue) opt.pixels = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fps") == 0 && hasValue) opt.fps = atof(argv[++i]);
+        else if (strcmp(argv[i], "--latency") == 0 && hasValue) opt.latencyMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--jitter") == 0 && hasValue) opt.jitterMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--loss") == 0 && hasValue) opt.lossPercent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && hasValue) opt.seconds = atol(argv[++i]);
+        else if (strcmp(argv[i], "--port") == 0 && hasValue) opt.port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) opt.seed = (unsigned)atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !opt.host) opt.host = argv[i];
+        else {
+            opt.host = nullptr;
+            opt.loopback = false;
+            break;
+        }
+    }
+    if (!opt.host && !opt.loopback) {
+        fprintf(stderr, "usage: %s <host> | --loopback  [--e131] [--sync] [--universe N] [--pixels N] [--fps N]\n"
+                        "       [--latency ms] [--jitter ms] [--loss %%] [--seconds N] [--port N] [--seed N]\n", argv[0]);
+        return 2;
+    }
+    if (opt.port == 0) opt.port = opt.loopback ? 47900 : (opt.e131 ? E131_PORT : ARTNET_PORT);
+    if (opt.fps <= 0.0) opt.fps = 40.0;
+    if (opt.loopback) {
+        // The receiving side is built for NUM_LEDS pixels
+        opt.pixels = NUM_LEDS;
+        return loopbackTest(opt);
+    }
+    return sendToDevice(opt);
+}
@@ -0,0 +1,352 @@
+// sync_sim.cpp
+// Leader/follower sync (SyncLink.h) on one Linux host. A leader and a few
+// followers, each on its own offset and drifting clock, exchange packets over
+// loopback UDP through a link model that adds latency, jitter and loss. The
+// leader plays a steady 126 BPM grid and switches animation every 8 s; the
+// followers render from what reaches them. Reports each follower's clock
+// offset error, beat phase error against the leader's true grid, switch
+// latency and time spent on the wrong animation. The exit status is 1 if any
+// follower fails to converge.
+//
+//   sync_sim                                  # 3 followers, 60 s, 4 +- 3 ms, 5% loss
+//   sync_sim --followers 6 --latency 10 --jitter 8 --loss 20 --seconds 120 --seed 7
+//
+// Build: g++ -std=c++11 -O2 -I.. -o sync_sim sync_sim.cpp ../SyncLink.cpp
+#include "../SyncLink.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const int kFrameMs = 20;
+const double kBpm = 126.0;
+const double kPeriodMs = 60000.0 / kBpm;
+const unsigned long kGridStartMs = 2000;     // after the leader's start
+const unsigned long kSwitchEveryMs = 8000;
+const int kAnimations = 8;
+const long kWarmupMs = 3000;
+
+// The simulation's time; every node's clock is derived from it
+long simMs = 0;
+
+struct Clock {
+    double offsetMs;
+    double driftPpm;
+    double exact(long sim) const { return offsetMs + sim * (1.0 + driftPpm * 1e-6); }
+    unsigned long at(long sim) const { return (unsigned long)exact(sim); }
+};
+
+struct Link {
+    double latencyMs;
+    double jitterMs;
+    double loss;
+    std::mt19937 rng;
+
+    // When one copy of a packet sent now arrives, or -1 if it is lost
+    long deliverAt(long now) {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        if (unit(rng) < loss) return -1;
+        double delay = latencyMs + (unit(rng) * 2.0 - 1.0) * jitterMs;
+        return now + (long)(delay < 0.0 ? 0.0 : delay + 0.5);
+    }
+};
+
+// One node's socket on 127.0.0.1:basePort+node. Sends are held back until
+// the link model's delivery time; arrivals are stamped with the node's clock
+// when collected, the way EspNowTransport stamps them in its callback.
+class UdpTransport : public SyncTransport {
+public:
+    UdpTransport(int node, int nodeCount, int basePort, Link& link, const Clock& clock)
+        : node(node), nodeCount(nodeCount), basePort(basePort), link(link), clock(clock), fd(-1) {}
+    ~UdpTransport() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool open() {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) return false;
+        sockaddr_in addr = address(node);
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) return false;
+        return fcntl(fd, F_SETFL, O_NONBLOCK) == 0;
+    }
+
+    bool send(const uint8_t* data, size_t len) override {
+        for (int to = 0; to < nodeCount; to++) {
+            if (to == node) continue;
+            long at = link.deliverAt(simMs);
+            if (at < 0) continue;
+            Pending p;
+            p.at = at;
+            p.to = to;
+            p.bytes.assign(data, data + len);
+            outbox.push_back(p);
+        }
+        return true;
+    }
+
+    size_t receive(uint8_t* data, size_t capacity, unsigned long& arrivedMs) override {
+        if (inbox.empty()) return 0;
+        const Arrival& a = inbox.front();
+        size_t len = std::min(a.bytes.size(), capacity);
+        memcpy(data, a.bytes.data(), len);
+        arrivedMs = a.at;
+        inbox.erase(inbox.begin());
+        return len;
+    }
+
+    // Puts packets whose delivery time has come on the wire
+    void flush() {
+        for (size_t i = 0; i < outbox.size();) {
+            if (outbox[i].at > simMs) {
+                i++;
+                continue;
+            }
+            sockaddr_in addr = address(outbox[i].to);
+            sendto(fd, outbox[i].bytes.data(), outbox[i].bytes.size(), 0, (sockaddr*)&addr, sizeof(addr));
+            outbox.erase(outbox.begin() + i);
+        }
+    }
+
+    // Takes whatever loopback has delivered
+    void collect() {
+        uint8_t buffer[SYNC_MAX_PACKET];
+        ssize_t n;
+        while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            Arrival a;
+            a.at = clock.at(simMs);
+            a.bytes.assign(buffer, buffer + n);
+            inbox.push_back(a);
+        }
+    }
+
+private:
+    struct Pending {
+        long at;
+        int to;
+        std::vector<uint8_t> bytes;
+    };
+    struct Arrival {
+        unsigned long at;
+        std::vector<uint8_t> bytes;
+    };
+
+    int node;
+    int nodeCount;
+    int basePort;
+    Link& link;
+    const Clock& clock;
+    int fd;
+    std::vector<Pending> outbox;
+    std::vector<Arrival> inbox;
+
+    sockaddr_in address(int n) const {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(basePort + n);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return addr;
+    }
+};
+
+struct FollowerRun {
+    Clock clock = { 0.0, 0.0 };
+    SyncFollower* sync = nullptr;
+    UdpTransport* transport = nullptr;
+    unsigned long nextFrame = 0;
+    int animation = -1;
+    long frames = 0;
+    long heardFrames = 0;
+    long wrongFrames = 0;
+    double worstOffsetError = 0.0;
+    std::vector<double> phaseErrors;
+    double latencySum = 0.0;
+    double latencyWorst = 0.0;
+    int latencyCount = 0;
+    int lastLatencySwitch = -1;
+};
+
+double beatPosition(double leaderMs, unsigned long startMs) {
+    return (leaderMs - (double)(startMs + kGridStartMs)) / kPeriodMs;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int followers = 3;
+    double latency = 4.0;
+    double jitter = 3.0;
+    double lossPercent = 5.0;
+    long seconds = 60;
+    unsigned seed = 1;
+    int basePort = 47800;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--followers") == 0 && hasValue) followers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--latency") == 0 && hasValue) latency = atof(argv[++i]);
+        else if (strcmp(argv[i], "--jitter") == 0 && hasValue) jitter = atof(argv[++i]);
+        else if (strcmp(argv[i], "--loss") == 0 && hasValue) lossPercent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && hasValue) seconds = atol(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) seed = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--port") == 0 && hasValue) basePort = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--followers N] [--latency ms] [--jitter ms] [--loss %%] "
+                            "[--seconds N] [--seed N] [--port N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (followers < 1 || followers > 254) followers = 1;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> offsets(10000.0, 5000000.0);
+    std::uniform_real_distribution<double> drifts(-100.0, 100.0);
+    Link link = { latency, jitter, lossPercent / 100.0, std::mt19937(seed + 1) };
+
+    Clock leaderClock = { offsets(rng), drifts(rng) };
+    UdpTransport leaderTransport(0, followers + 1, basePort, link, leaderClock);
+    if (!leaderTransport.open()) {
+        perror("leader socket");
+        return 2;
+    }
+    SyncLeader leader(leaderTransport, 1);
+    unsigned long leaderStart = leaderClock.at(0);
+    unsigned long leaderNextFrame = leaderStart;
+    int leaderAnimation = 0;
+    int switchCount = 0;
+    long switchSimMs = -1;
+    uint32_t lastBeat = 0;
+
+    std::vector<FollowerRun> runs(followers);
+    for (int i = 0; i < followers; i++) {
+        FollowerRun& r = runs[i];
+        r.clock.offsetMs = offsets(rng);
+        r.clock.driftPpm = drifts(rng);
+        r.transport = new UdpTransport(i + 1, followers + 1, basePort, link, r.clock);
+        if (!r.transport->open()) {
+            perror("follower socket");
+            return 2;
+        }
+        r.sync = new SyncFollower(*r.transport, 1, i + 1);
+        // Followers boot at different points within a frame
+        r.nextFrame = r.clock.at(0) + i * 7 % kFrameMs;
+    }
+
+    for (simMs = 0; simMs < seconds * 1000; simMs++) {
+        leaderTransport.flush();
+        for (FollowerRun& r : runs) r.transport->flush();
+        leaderTransport.collect();
+        for (FollowerRun& r : runs) r.transport->collect();
+
+        unsigned long leaderNow = leaderClock.at(simMs);
+        if (leaderNow >= leaderNextFrame) {
+            leaderNextFrame += kFrameMs;
+            unsigned long elapsed = leaderNow - leaderStart;
+            if ((int)(elapsed / kSwitchEveryMs) != switchCount) {
+                switchCount = elapsed / kSwitchEveryMs;
+                int next = (leaderAnimation + 3) % kAnimations;
+                leader.sendSwitch(leaderAnimation, next, "Phrase", leaderNow);
+                leaderAnimation = next;
+                switchSimMs = simMs;
+            }
+
+            AudioFeatures features;
+            features.bpm = kBpm;
+            features.gridLocked = elapsed >= kGridStartMs;
+            if (features.gridLocked) {
+                double position = beatPosition(leaderNow, leaderStart);
+                features.beatIndex = (uint32_t)position;
+                features.beatPhase = (float)(position - features.beatIndex);
+                features.gridBeat = features.beatIndex != lastBeat;
+                features.beatDetected = features.gridBeat;
+                lastBeat = features.beatIndex;
+            }
+            features.bass = 1.0 - features.beatPhase;
+            features.volume = 0.5 + 0.5 * features.bass;
+            features.loudness = (int)(features.volume * 255);
+            leader.update(features, leaderAnimation, leaderNow);
+        }
+
+        for (FollowerRun& r : runs) {
+            unsigned long now = r.clock.at(simMs);
+            if (now < r.nextFrame) continue;
+            r.nextFrame += kFrameMs;
+
+            r.sync->poll(now);
+            AudioFeatures features;
+            bool heard = r.sync->apply(features, now);
+            int to;
+            const char* reason;
+            if (heard && r.sync->pendingSwitch(r.animation, to, reason, now)) {
+                r.animation = to;
+                if (to == leaderAnimation && switchSimMs >= 0 && r.lastLatencySwitch != switchCount) {
+                    double late = simMs - switchSimMs;
+                    r.latencySum += late;
+                    r.latencyWorst = std::max(r.latencyWorst, late);
+                    r.latencyCount++;
+                    r.lastLatencySwitch = switchCount;
+                }
+            }
+            if (simMs < kWarmupMs) continue;
+
+            r.frames++;
+            if (heard) r.heardFrames++;
+            if (r.animation != leaderAnimation) r.wrongFrames++;
+            const SyncStats& stats = r.sync->getStats();
+            if (stats.hasOffset) {
+                double trueOffset = leaderClock.exact(simMs) - r.clock.exact(simMs);
+                r.worstOffsetError = std::max(r.worstOffsetError, fabs(stats.offsetMs - trueOffset));
+            }
+            if (heard && features.gridLocked) {
+                double truth = beatPosition(leaderClock.exact(simMs), leaderStart);
+                double mine = features.beatIndex + features.beatPhase;
+                r.phaseErrors.push_back(fabs(mine - truth) * kPeriodMs);
+            }
+        }
+    }
+
+    printf("%d followers, %ld s, link %.1f +- %.1f ms, %.1f%% loss, seed %u\n",
+           followers, seconds, latency, jitter, lossPercent, seed);
+    // Tolerances: the offset can't be better than the link's asymmetry, and
+    // the phase inherits it; a switch takes a frame plus the link
+    double phaseLimit = 3.0 + jitter;
+    double latencyLimit = kFrameMs + latency + jitter + 2.0;
+    bool ok = true;
+    for (int i = 0; i < followers; i++) {
+        FollowerRun& r = runs[i];
+        const SyncStats& stats = r.sync->getStats();
+        std::vector<double>& e = r.phaseErrors;
+        std::sort(e.begin(), e.end());
+        double mean = 0.0;
+        for (double v : e) mean += v;
+        mean = e.empty() ? 0.0 : mean / e.size();
+        double p95 = e.empty() ? 0.0 : e[e.size() * 95 / 100];
+        double worst = e.empty() ? 0.0 : e.back();
+        double heard = r.frames ? 100.0 * r.heardFrames / r.frames : 0.0;
+        double wrong = r.frames ? 100.0 * r.wrongFrames / r.frames : 100.0;
+        double lost = stats.received + stats.lost ? 100.0 * stats.lost / (stats.received + stats.lost) : 0.0;
+        double latencyMean = r.latencyCount ? r.latencySum / r.latencyCount : 0.0;
+
+        bool converged = heard > 95.0 && p95 <= phaseLimit && r.animation == leaderAnimation &&
+                         wrong < 5.0 && latencyMean <= latencyLimit;
+        ok = ok && converged;
+        printf("follower %d: offset err %.1f ms (rtt %lu), phase err mean %.1f p95 %.1f max %.1f ms, "
+               "switch latency mean %.1f max %.0f ms (%d), wrong animation %.1f%%, heard %.1f%%, lost %.1f%%  %s\n",
+               i + 1, r.worstOffsetError, (unsigned long)stats.delayMs, mean, p95, worst,
+               latencyMean, r.latencyWorst, r.latencyCount, wrong, heard, lost, converged ? "OK" : "FAIL");
+    }
+    for (FollowerRun& r : runs) {
+        delete r.sync;
+        delete r.transport;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// telemetry_decode.cpp
+// Host-side decoder for the binary telemetry stream (TelemetryProtocol.h).
+//
+//   telemetry_decode /dev/ttyUSB0 -o show.glt     # live: decode, print, record
+//   telemetry_decode show.glt                     # replay a recording
+//
+// Decoded packets are printed as CSV, one line per packet:
+//   F,seq,timeMs,volume,bass,mid,treble,bpm,loudness,flags,beatIndex,animation
+//   T,seq,frame,capture,analyze,update,display,show,idle   (microseconds)
+//   L,seq,decimation,count,r g b ...
+//   M,seq,free,low,largest,frag%,allocs,frees,heapBytes,stack0 stack1 ...
+//      (per-frame peaks since the previous M; allocs/frees are -1 without
+//      allocator hooks; stacks in watch order, loop task first)
+//   G,seq,gainDb,levelDb,floorDb,gated,bassGainDb,midGainDb,trebleGainDb
+// Recordings hold the raw frames exactly as received (bad frames removed), so
+// they replay through this same tool or anything else that reads the wire format.
+//
+// Build: g++ -std=c++11 -O2 -o telemetry_decode telemetry_decode.cpp
+#include "../TelemetryProtocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+struct Stats {
+    unsigned long bytes = 0;
+    unsigned long packets = 0;
+    unsigned long badFrames = 0;
+    unsigned long seqGaps = 0;
+};
+
+static void configureSerial(int fd, speed_t baud) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) return;  // regular file
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, baud);
+    cfsetospeed(&tio, baud);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+}
+
+static void printPacket(const uint8_t* packet, int payloadLen) {
+    uint8_t type = packet[0];
+    uint8_t seq = packet[1];
+    const uint8_t* payload = packet + 2;
+
+    if (type == TELEMETRY_FEATURES && payloadLen == (int)sizeof(TelemetryFeatures)) {
+        TelemetryFeatures f;
+        memcpy(&f, payload, sizeof(f));
+        printf("F,%u,%u,%.4f,%.4f,%.4f,%.4f,%.1f,%u,0x%02x,%u,%u\n", seq, f.timeMs,
+               telemetryUnitToFloat(f.volume), telemetryUnitToFloat(f.bass),
+               telemetryUnitToFloat(f.mid), telemetryUnitToFloat(f.treble),
+               f.bpmX10 / 10.0, f.loudness, f.flags, f.beatIndex, f.animation);
+    } else if (type == TELEMETRY_TIMINGS && payloadLen == (int)sizeof(TelemetryTimings)) {
+        TelemetryTimings t;
+        memcpy(&t, payload, sizeof(t));
+        printf("T,%u,%u", seq, t.frame);
+        for (int i = 0; i < TELEMETRY_STAGE_COUNT; i++) printf(",%u", t.stageUs[i]);
+        printf("\n");
+    } else if (type == TELEMETRY_LED_FRAME && payloadLen >= (int)sizeof(TelemetryLedFrame)) {
+        TelemetryLedFrame h;
+        memcpy(&h, payload, sizeof(h));
+        if (payloadLen != (int)(sizeof(h) + h.count * 3)) {
+            printf("#,%u,bad LED frame length\n", seq);
+            return;
+        }
+        printf("L,%u,%u,%u,", seq, h.decimation, h.count);
+        const uint8_t* rgb = payload + sizeof(h);
+        for (int i = 0; i < h.count; i++) {
+            printf("%s%u %u %u", i ? " " : "", rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+        }
+        printf("\n");
+    } else if (type == TELEMETRY_MEMORY && payloadLen == (int)sizeof(TelemetryMemory)) {
+        TelemetryMemory m;
+        memcpy(&m, payload, sizeof(m));
+        bool hooks = m.flags & TELEMETRY_MEMORY_HOOKS;
+        printf("M,%u,%u,%u,%u,%u,%d,%d,%d,", seq, m.freeBytes, m.minFreeBytes, m.largestFreeBlock,
+               m.fragmentation, hooks ? m.allocsPerFrame : -1, hooks ? m.freesPerFrame : -1,
+               m.netBytesPerFrame);
+        for (int i = 0, n = 0; i < TELEMETRY_MEMORY_TASKS; i++) {
+            if (m.stackFree[i] != 0xFFFF) printf("%s%u", n++ ? " " : "", m.stackFree[i]);
+        }
+        printf("\n");
+    } else if (type == TELEMETRY_GAIN && payloadLen == (int)sizeof(TelemetryGain)) {
+        TelemetryGain g;
+        memcpy(&g, payload, sizeof(g));
+        printf("G,%u,%.2f,%.2f,%.2f,%d,%.2f,%.2f,%.2f\n", seq, g.gain / 100.0, g.level / 100.0,
+               g.noiseFloor / 100.0, (g.flags & TELEMETRY_GAIN_GATED) ? 1 : 0,
+               g.bandGain[0] / 100.0, g.bandGain[1] / 100.0, g.bandGain[2] / 100.0);
+    } else {
+        printf("#,%u,unknown type %u len %d\n", seq, type, payloadLen);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* input = nullptr;
+    const char* recordPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else input = argv[i];
+    }
+    if (!input) {
+        fprintf(stderr, "usage: %s <serial device | recording> [-o recording]\n", argv[0]);
+        return 2;
+    }
+
+    int fd = open(input, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(input);
+        return 1;
+    }
+    configureSerial(fd, B115200);
+
+    FILE* record = nullptr;
+    if (recordPath && !(record = fopen(recordPath, "wb"))) {
+        perror(recordPath);
+        return 1;
+    }
+
+    Stats stats;
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    uint8_t packet[TELEMETRY_MAX_FRAME];
+    size_t frameLen = 0;
+    bool overflow = false;
+    int lastSeq = -1;
+    uint8_t buf[512];
+    ssize_t n;
+
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        stats.bytes += n;
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != 0) {
+                if (frameLen < sizeof(frame)) frame[frameLen++] = buf[i];
+                else overflow = true;
+                continue;
+            }
+
+            // Delimiter: anything between two of them is one candidate frame
+            size_t len = overflow ? 0 : cobsDecode(frame, frameLen, packet);
+            int payloadLen = len ? telemetryCheckPacket(packet, len) : -1;
+            if (payloadLen < 0) {
+                // Text from a FRAME_DEBUG build or a partial frame at start-up
+                if (frameLen > 0) stats.badFrames++;
+            } else {
+                stats.packets++;
+                if (lastSeq >= 0 && packet[1] != (uint8_t)(lastSeq + 1)) stats.seqGaps++;
+                lastSeq = packet[1];
+                printPacket(packet, payloadLen);
+                if (record) {
+                    fwrite(frame, 1, frameLen, record);
+                    fputc(0, record);
+                }
+            }
+            frameLen = 0;
+            overflow = false;
+        }
+    }
+
+    if (record) fclose(record);
+    close(fd);
+    fprintf(stderr, "%lu bytes, %lu packets, %lu bad frames, %lu sequence gaps\n",
+            stats.bytes, stats.packets, stats.badFrames, stats.seqGaps);
+    return 0;
+}
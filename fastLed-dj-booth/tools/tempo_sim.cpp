@@ -0,0 +1,213 @@
+// tempo_sim.cpp
+// TempoTracker (TempoTracker.h) against a scripted minute of a set at a
+// steady tempo. The audio detector is modelled frame by frame: onsets a
+// little off the beat, some missed, all landing on frame boundaries, then
+// from 20 s to 45 s the mic drowned out and firing at random. A MIDI clock
+// with jittery bytes runs from 8 s until its cable is pulled at 30 s, and
+// the tap button gets six slightly uneven taps at 33 s. Reports the tempo
+// and beat phase error against the true grid for each stretch. The exit
+// status is 1 if any stretch is outside its limits. At 125 ms frames a fast
+// tempo is under three frames a beat, and the stretches that lean on the
+// audio can miss theirs there.
+//
+//   tempo_sim                               # 126 BPM, 125 ms frames, 2 ms MIDI jitter
+//   tempo_sim --bpm 174 --frame-ms 60 --midi-jitter 5 --tap-jitter 30 --seed 7
+//
+// Build: g++ -std=c++11 -O2 -I.. -o tempo_sim tempo_sim.cpp ../TempoTracker.cpp ../MidiClock.cpp ../BeatGrid.cpp
+#include "../TempoTracker.h"
+#include "../MidiClock.h"
+#include "../TapTempo.h"
+#include "../BeatGrid.h"
+#include <algorithm>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+const long kSeconds = 60;
+const long kFirstBeatMs = 1000;
+const long kDrownedFromMs = 20000;
+const long kDrownedToMs = 45000;
+const long kMidiFromMs = 8000;
+const long kMidiToMs = 30000;
+const long kTapsAtMs = 33000;
+const int kTaps = 6;
+// The detector's minimum onset spacing (tuning.beatMinMs)
+const long kBeatMinMs = 300;
+
+struct Stretch {
+    Stretch(const char* name, long fromMs, long toMs, double bpmLimit, double phaseLimitMs)
+        : name(name), fromMs(fromMs), toMs(toMs), bpmLimit(bpmLimit), phaseLimitMs(phaseLimitMs), confidence(0),
+          frames(0), leader(nullptr) {}
+
+    const char* name;
+    long fromMs;
+    long toMs;
+    double bpmLimit;
+    double phaseLimitMs;
+    std::vector<double> bpmErrors;
+    std::vector<double> phaseErrors;
+    double confidence;
+    int frames;
+    const char* leader;
+};
+
+double percentile(std::vector<double>& v, int p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, v.size() * p / 100)];
+}
+
+double mean(const std::vector<double>& v) {
+    double sum = 0.0;
+    for (double x : v) sum += x;
+    return v.empty() ? 0.0 : sum / v.size();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double bpm = 126.0;
+    long frameMs = 125;
+    double midiJitter = 2.0;
+    double tapJitter = 15.0;
+    double audioJitter = 10.0;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--bpm") == 0 && hasValue) bpm = atof(argv[++i]);
+        else if (strcmp(argv[i], "--frame-ms") == 0 && hasValue) frameMs = atol(argv[++i]);
+        else if (strcmp(argv[i], "--midi-jitter") == 0 && hasValue) midiJitter = atof(argv[++i]);
+        else if (strcmp(argv[i], "--tap-jitter") == 0 && hasValue) tapJitter = atof(argv[++i]);
+        else if (strcmp(argv[i], "--audio-jitter") == 0 && hasValue) audioJitter = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) seed = (unsigned)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--bpm N] [--frame-ms N] [--midi-jitter ms] [--tap-jitter ms] "
+                            "[--audio-jitter ms] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (bpm < 60 || bpm > 200 || frameMs < 10) {
+        fprintf(stderr, "tempo 60-200 BPM, frames of 10 ms or more\n");
+        return 2;
+    }
+    const double periodMs = 60000.0 / bpm;
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> audioError(0.0, audioJitter);
+    std::normal_distribution<double> tapError(0.0, tapJitter);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Everything each source will see, in time order
+    std::vector<double> onsets;
+    for (double t = kFirstBeatMs; t < kSeconds * 1000; t += periodMs) {
+        if (t >= kDrownedFromMs && t < kDrownedToMs) continue;
+        if (unit(rng) < 0.1) continue;
+        onsets.push_back(t + audioError(rng));
+    }
+    std::vector<std::pair<long, uint8_t>> midi;
+    long midiStart = kFirstBeatMs + (long)(ceil((kMidiFromMs - kFirstBeatMs) / periodMs) * periodMs);
+    midi.push_back(std::make_pair(midiStart - 1, MidiClock::START));
+    for (int k = 0;; k++) {
+        double t = midiStart + k * periodMs / MidiClock::CLOCKS_PER_BEAT + (unit(rng) * 2.0 - 1.0) * midiJitter;
+        if (t >= kMidiToMs) break;
+        midi.push_back(std::make_pair((long)std::max(t, (double)midiStart), MidiClock::CLOCK));
+    }
+    std::vector<long> taps;
+    long firstTap = kFirstBeatMs + (long)(ceil((kTapsAtMs - kFirstBeatMs) / periodMs) * periodMs);
+    for (int k = 0; k < kTaps; k++) taps.push_back(firstTap + (long)(k * periodMs + tapError(rng)));
+
+    Stretch stretches[] = {
+        Stretch("audio",            5000,  8000,  5.0, 80.0),
+        Stretch("midi + audio",     11000, 20000, 0.3, 10.0),
+        Stretch("midi, drowned",    20000, 30000, 0.3, 10.0),
+        Stretch("running on",       30000, 33000, 1.0, 25.0),
+        Stretch("tapped, drowned",  36000, 45000, 3.0, 200.0),
+        Stretch("audio back",       54000, 60000, 3.0, 80.0),
+    };
+
+    TempoTracker tracker;
+    MidiClock midiClock;
+    TapTempo tapTempo;
+    tracker.addSource(midiClock);
+    tracker.addSource(tapTempo);
+    BeatGrid grid;
+    size_t nextOnset = 0, nextMidi = 0, nextTap = 0;
+    long lastOnsetMs = -100000;
+    float detectorBpm = 0.0f;
+    // The tracker's beat count, which must only go forward a beat at a time
+    double lastPosition = 0.0;
+    int backSteps = 0, skippedBeats = 0;
+
+    for (long now = 0; now < kSeconds * 1000; now += frameMs) {
+        while (nextMidi < midi.size() && midi[nextMidi].first <= now) {
+            midiClock.feed(midi[nextMidi].second, (uint32_t)midi[nextMidi].first);
+            nextMidi++;
+        }
+        while (nextTap < taps.size() && taps[nextTap] <= now) tapTempo.tap((uint32_t)taps[nextTap++]);
+
+        // The detector sees an onset on the frame it falls in
+        bool onset = false;
+        while (nextOnset < onsets.size() && onsets[nextOnset] <= now) {
+            onset = true;
+            nextOnset++;
+        }
+        if (now >= kDrownedFromMs && now < kDrownedToMs && unit(rng) < 0.3) onset = true;
+        AudioFeatures features;
+        if (onset && now - lastOnsetMs > kBeatMinMs) {
+            long interval = now - lastOnsetMs;
+            if (interval < 2000) detectorBpm = 60000.0f / interval;
+            lastOnsetMs = now;
+            features.beatDetected = true;
+        }
+        features.bpm = detectorBpm;
+        grid.update(now, features.beatDetected, detectorBpm);
+        features.gridLocked = grid.isLocked();
+        features.beatPhase = grid.getBeatPhase(now);
+
+        tracker.update(features, (uint32_t)now);
+        if (tracker.isRunning()) {
+            double position = features.beatIndex + features.beatPhase;
+            if (position < lastPosition) backSteps++;
+            if (features.beatIndex > (uint32_t)lastPosition + 1) skippedBeats++;
+            lastPosition = position;
+        }
+
+        for (Stretch& s : stretches) {
+            if (now < s.fromMs || now >= s.toMs) continue;
+            s.frames++;
+            s.confidence += features.tempoConfidence;
+            if (tracker.getLeader()) s.leader = tracker.getLeader();
+            if (!tracker.isRunning()) continue;
+            s.bpmErrors.push_back(fabs(features.bpm - bpm));
+            double truth = (now - kFirstBeatMs) / periodMs;
+            double error = features.beatPhase - (truth - floor(truth));
+            error -= floor(error + 0.5);
+            s.phaseErrors.push_back(fabs(error) * periodMs);
+        }
+    }
+
+    printf("%.1f BPM, %ld ms frames, MIDI jitter +- %.1f ms, taps +- %.1f ms, onsets +- %.1f ms, seed %u\n",
+           bpm, frameMs, midiJitter, tapJitter, audioJitter, seed);
+    bool ok = true;
+    for (Stretch& s : stretches) {
+        bool tracked = (int)s.bpmErrors.size() == s.frames;
+        double bpmP95 = percentile(s.bpmErrors, 95);
+        double phaseP95 = percentile(s.phaseErrors, 95);
+        bool good = tracked && bpmP95 <= s.bpmLimit && phaseP95 <= s.phaseLimitMs;
+        ok = ok && good;
+        printf("%-16s %5.1f-%4.1f s: bpm err mean %.2f p95 %.2f, phase err mean %.1f p95 %.1f ms, "
+               "confidence %.2f, led by %s  %s\n",
+               s.name, s.fromMs / 1000.0, s.toMs / 1000.0, mean(s.bpmErrors), bpmP95,
+               mean(s.phaseErrors), phaseP95, s.frames ? s.confidence / s.frames : 0.0,
+               s.leader ? s.leader : "nothing", good ? "OK" : "FAIL");
+    }
+    printf("beat count: %d steps back, %d beats skipped  %s\n", backSteps, skippedBeats, backSteps ? "FAIL" : "OK");
+    ok = ok && backSteps == 0;
+    if (midiClock.getDropped()) printf("%lu MIDI bytes dropped\n", (unsigned long)midiClock.getDropped());
+    return ok ? 0 : 1;
+}